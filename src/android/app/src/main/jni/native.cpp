@@ -457,7 +457,8 @@ int Java_org_suyu_suyu_1emu_NativeLibrary_installFileToNand(JNIEnv* env, jobject
     auto jlambdaClass = env->GetObjectClass(jcallback);
     auto jlambdaInvokeMethod = env->GetMethodID(
         jlambdaClass, "invoke", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
-    const auto callback = [env, jcallback, jlambdaInvokeMethod](size_t max, size_t progress) {
+    const auto callback = [env, jcallback, jlambdaInvokeMethod](size_t max, size_t progress,
+                                                                size_t) {
         auto jwasCancelled = env->CallObjectMethod(jcallback, jlambdaInvokeMethod,
                                                    Common::Android::ToJDouble(env, max),
                                                    Common::Android::ToJDouble(env, progress));
@@ -0,0 +1,252 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common/fs/mapped_file.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+
+namespace Common::FS {
+
+MappedFile::MappedFile() = default;
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    Close();
+    base = std::exchange(other.base, nullptr);
+    size = std::exchange(other.size, 0);
+#ifdef _WIN32
+    file_handle = std::exchange(other.file_handle, nullptr);
+    mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#else
+    fd = std::exchange(other.fd, -1);
+#endif
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::filesystem::path& path, FileAccessMode mode, u64 size_) {
+    Close();
+
+    const bool writable = mode == FileAccessMode::ReadWrite;
+    if (!writable && mode != FileAccessMode::Read) {
+        LOG_ERROR(Common_Filesystem, "Unsupported access mode for mapping {}",
+                  PathToUTF8String(path));
+        return false;
+    }
+
+    const HANDLE file =
+        CreateFileW(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                    writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR(Common_Filesystem, "Failed to open {}, error={}", PathToUTF8String(path),
+                  GetLastError());
+        return false;
+    }
+    file_handle = file;
+
+    LARGE_INTEGER file_size{};
+    if (writable) {
+        // Mark the file as sparse so the extended area takes no space until it is written.
+        DWORD bytes_returned{};
+        DeviceIoControl(file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &bytes_returned, nullptr);
+        file_size.QuadPart = static_cast<LONGLONG>(size_);
+        if (!SetFilePointerEx(file, file_size, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            LOG_ERROR(Common_Filesystem, "Failed to resize {}, error={}", PathToUTF8String(path),
+                      GetLastError());
+            Close();
+            return false;
+        }
+    } else if (!GetFileSizeEx(file, &file_size)) {
+        Close();
+        return false;
+    }
+    if (file_size.QuadPart == 0) {
+        // Empty files cannot be mapped.
+        Close();
+        return false;
+    }
+
+    mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        LOG_ERROR(Common_Filesystem, "Failed to map {}, error={}", PathToUTF8String(path),
+                  GetLastError());
+        Close();
+        return false;
+    }
+    base = static_cast<u8*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (base == nullptr) {
+        LOG_ERROR(Common_Filesystem, "Failed to map {}, error={}", PathToUTF8String(path),
+                  GetLastError());
+        Close();
+        return false;
+    }
+    size = static_cast<u64>(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (base != nullptr) {
+        UnmapViewOfFile(base);
+        base = nullptr;
+    }
+    if (mapping_handle != nullptr) {
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+    }
+    if (file_handle != nullptr) {
+        CloseHandle(file_handle);
+        file_handle = nullptr;
+    }
+    size = 0;
+}
+
+bool MappedFile::Write(u64 offset, std::span<const u8> data) const {
+    if (base == nullptr || offset > size || data.size() > size - offset) {
+        return false;
+    }
+    while (!data.empty()) {
+        // Views of a local file are coherent with the writes made through its handle.
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const auto chunk = static_cast<DWORD>(std::min<std::size_t>(data.size(), 1U << 30));
+        DWORD written{};
+        if (!WriteFile(file_handle, data.data(), chunk, &written, &overlapped) || written == 0) {
+            LOG_ERROR(Common_Filesystem, "Failed to write to mapped file, error={}",
+                      GetLastError());
+            return false;
+        }
+        offset += written;
+        data = data.subspan(written);
+    }
+    return true;
+}
+
+bool MappedFile::Flush() const {
+    if (base == nullptr) {
+        return false;
+    }
+    return FlushFileBuffers(file_handle);
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& path, FileAccessMode mode, u64 size_) {
+    Close();
+
+    const bool writable = mode == FileAccessMode::ReadWrite;
+    if (!writable && mode != FileAccessMode::Read) {
+        LOG_ERROR(Common_Filesystem, "Unsupported access mode for mapping {}",
+                  PathToUTF8String(path));
+        return false;
+    }
+
+    fd = open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0) {
+        LOG_ERROR(Common_Filesystem, "Failed to open {}: {}", PathToUTF8String(path),
+                  strerror(errno));
+        return false;
+    }
+
+    u64 file_size = size_;
+    if (writable) {
+        // Extending the file with ftruncate leaves a hole that takes no space until written.
+        if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+            LOG_ERROR(Common_Filesystem, "Failed to resize {}: {}", PathToUTF8String(path),
+                      strerror(errno));
+            Close();
+            return false;
+        }
+    } else {
+        struct stat file_stat {};
+        if (fstat(fd, &file_stat) != 0) {
+            Close();
+            return false;
+        }
+        file_size = static_cast<u64>(file_stat.st_size);
+    }
+    if (file_size == 0) {
+        // Empty files cannot be mapped.
+        Close();
+        return false;
+    }
+
+    // The mapping is never written through, a failed write to a page of a shared mapping would
+    // raise SIGBUS instead of returning an error.
+    void* const pointer = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (pointer == MAP_FAILED) {
+        LOG_ERROR(Common_Filesystem, "Failed to map {}: {}", PathToUTF8String(path),
+                  strerror(errno));
+        Close();
+        return false;
+    }
+    base = static_cast<u8*>(pointer);
+    size = file_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (base != nullptr) {
+        munmap(base, size);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    size = 0;
+}
+
+bool MappedFile::Write(u64 offset, std::span<const u8> data) const {
+    if (base == nullptr || offset > size || data.size() > size - offset) {
+        return false;
+    }
+    while (!data.empty()) {
+        const ssize_t written = pwrite(fd, data.data(), data.size(), static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            LOG_ERROR(Common_Filesystem, "Failed to write to mapped file: {}",
+                      written < 0 ? strerror(errno) : "no space written");
+            return false;
+        }
+        offset += static_cast<u64>(written);
+        data = data.subspan(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+bool MappedFile::Flush() const {
+    if (base == nullptr) {
+        return false;
+    }
+    return fsync(fd) == 0;
+}
+
+#endif
+
+} // namespace Common::FS
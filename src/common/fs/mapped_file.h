@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "common/common_types.h"
+#include "common/fs/fs_types.h"
+
+namespace Common::FS {
+
+/**
+ * A file mapped read-only into the address space of the process.
+ * Files opened for writing are modified with Write, which reports errors such as a full disk
+ * instead of faulting on the mapped memory, and the changes are visible through the mapping.
+ */
+class MappedFile final {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * Maps a file into memory.
+     *
+     * With FileAccessMode::Read, the whole of an existing file is mapped and size is ignored.
+     * With FileAccessMode::ReadWrite, the file is created if it does not exist and its size is
+     * set to size before it is mapped, and it can be modified with Write. Space added to the file
+     * this way reads as zeroes and is not allocated on disk until it is written to, where the file
+     * system allows it. Other access modes are not supported.
+     *
+     * @param path Filesystem path
+     * @param mode File access mode
+     * @param size Size of the file, used with FileAccessMode::ReadWrite
+     *
+     * @returns True if the file was mapped, false otherwise.
+     */
+    bool Open(const std::filesystem::path& path, FileAccessMode mode, u64 size = 0);
+
+    /// Unmaps and closes the file.
+    void Close();
+
+    /// Checks whether the file is mapped.
+    [[nodiscard]] bool IsOpen() const {
+        return base != nullptr;
+    }
+
+    /// Returns the start of the mapping, or nullptr if the file is not mapped.
+    [[nodiscard]] const u8* Data() const {
+        return base;
+    }
+
+    /// Returns the size of the mapping in bytes.
+    [[nodiscard]] u64 GetSize() const {
+        return size;
+    }
+
+    /**
+     * Writes data to a file opened with FileAccessMode::ReadWrite.
+     *
+     * @param offset Offset in the file, the data must fit within the size of the mapping
+     * @param data   Data to write
+     *
+     * @returns True if all of the data was written, false otherwise.
+     */
+    bool Write(u64 offset, std::span<const u8> data) const;
+
+    /**
+     * Waits for the data written to the file to reach the disk.
+     *
+     * @returns True if the data was written, false otherwise.
+     */
+    bool Flush() const;
+
+private:
+    u8* base{};
+    u64 size{};
+#ifdef _WIN32
+    void* file_handle{};
+    void* mapping_handle{};
+#else
+    int fd{-1};
+#endif
+};
+
+} // namespace Common::FS
@@ -14,6 +14,10 @@
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
 #endif
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <string>
 #include <boost/icl/interval_set.hpp>
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -89,7 +93,7 @@ static void GetFuncAddress(Common::DynamicLibrary& dll, const char* name, T& pfn
 
 class HostMemory::Impl {
 public:
-    explicit Impl(size_t backing_size_, size_t virtual_size_)
+    explicit Impl(size_t backing_size_, size_t virtual_size_, bool /* use_huge_pages */)
         : backing_size{backing_size_}, virtual_size{virtual_size_}, process{GetCurrentProcess()},
           kernelbase_dll("Kernelbase") {
         if (!kernelbase_dll.IsOpen()) {
@@ -199,6 +203,10 @@ public:
         UNREACHABLE();
     }
 
+    HugePageStats GetHugePageStats() const {
+        return {};
+    }
+
     const size_t backing_size; ///< Size of the backing memory in bytes
     const size_t virtual_size; ///< Size of the virtual address placeholder in bytes
 
@@ -427,7 +435,7 @@ static void* ChooseVirtualBase(size_t virtual_size) {
 
 class HostMemory::Impl {
 public:
-    explicit Impl(size_t backing_size_, size_t virtual_size_)
+    explicit Impl(size_t backing_size_, size_t virtual_size_, bool use_huge_pages_)
         : backing_size{backing_size_}, virtual_size{virtual_size_} {
         bool good = false;
         SCOPE_EXIT {
@@ -462,8 +470,17 @@ public:
             throw std::bad_alloc{};
         }
 
-        backing_base = static_cast<u8*>(
-            mmap(nullptr, backing_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+#if defined(__linux__)
+        use_huge_pages = use_huge_pages_;
+        if (use_huge_pages) {
+            CheckShmemHugePages();
+            backing_base = MapHugeAlignedBacking();
+        } else
+#endif
+        {
+            backing_base = static_cast<u8*>(
+                mmap(nullptr, backing_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        }
         if (backing_base == MAP_FAILED) {
             LOG_CRITICAL(HW_Memory, "mmap failed: {}", strerror(errno));
             throw std::bad_alloc{};
@@ -511,6 +528,10 @@ public:
         void* ret = mmap(virtual_base + virtual_offset, length, flags, MAP_SHARED | MAP_FIXED, fd,
                          host_offset);
         ASSERT_MSG(ret != MAP_FAILED, "mmap failed: {}", strerror(errno));
+
+        if (use_huge_pages) {
+            TrackHugeMapping(virtual_offset, host_offset, length);
+        }
     }
 
     void Unmap(size_t virtual_offset, size_t length) {
@@ -527,6 +548,13 @@ public:
         void* ret = mmap(merged_pointer, merged_size, PROT_NONE,
                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
         ASSERT_MSG(ret != MAP_FAILED, "mmap failed: {}", strerror(errno));
+
+        if (use_huge_pages) {
+            const uintptr_t address = reinterpret_cast<uintptr_t>(virtual_base + virtual_offset);
+            std::scoped_lock lock{huge_mutex};
+            huge_ranges.subtract(
+                {AlignDown(address, HugePageSize), AlignUp(address + length, HugePageSize)});
+        }
     }
 
     void Protect(size_t virtual_offset, size_t length, bool read, bool write, bool execute) {
@@ -547,6 +575,16 @@ public:
 #endif
         int ret = mprotect(virtual_base + virtual_offset, length, flags);
         ASSERT_MSG(ret == 0, "mprotect failed: {}", strerror(errno));
+
+        if (use_huge_pages) {
+            // Huge pages fully inside the range keep their mapping, but the kernel has to split
+            // the ones the range only partially covers.
+            const uintptr_t begin = reinterpret_cast<uintptr_t>(virtual_base + virtual_offset);
+            const uintptr_t end = begin + length;
+            std::scoped_lock lock{huge_mutex};
+            huge_ranges.subtract({AlignDown(begin, HugePageSize), AlignUp(begin, HugePageSize)});
+            huge_ranges.subtract({AlignDown(end, HugePageSize), AlignUp(end, HugePageSize)});
+        }
     }
 
     bool ClearBackingRegion(size_t physical_offset, size_t length) {
@@ -566,6 +604,44 @@ public:
         virtual_base = nullptr;
     }
 
+    HugePageStats GetHugePageStats() const {
+        HugePageStats stats{};
+        if (!use_huge_pages) {
+            return stats;
+        }
+        {
+            std::scoped_lock lock{huge_mutex};
+            stats.eligible_bytes = boost::icl::length(huge_ranges);
+        }
+
+        // Sum the shared memory mapped with huge pages over the areas of both ranges.
+        const uintptr_t backing_begin = reinterpret_cast<uintptr_t>(backing_base);
+        const uintptr_t backing_end = backing_begin + backing_size;
+        const uintptr_t virtual_begin = reinterpret_cast<uintptr_t>(virtual_map_base);
+        const uintptr_t virtual_end = virtual_begin + virtual_size;
+        size_t* counter = nullptr;
+        std::ifstream smaps{"/proc/self/smaps"};
+        std::string line;
+        while (std::getline(smaps, line)) {
+            uintptr_t area_begin{};
+            uintptr_t area_end{};
+            size_t kib{};
+            if (std::sscanf(line.c_str(), "%" SCNxPTR "-%" SCNxPTR, &area_begin, &area_end) == 2) {
+                if (area_begin < backing_end && backing_begin < area_end) {
+                    counter = &stats.backing_bytes;
+                } else if (area_begin < virtual_end && virtual_begin < area_end) {
+                    counter = &stats.mapped_bytes;
+                } else {
+                    counter = nullptr;
+                }
+            } else if (counter != nullptr &&
+                       std::sscanf(line.c_str(), "ShmemPmdMapped: %zu kB", &kib) == 1) {
+                *counter += kib * 1024;
+            }
+        }
+        return stats;
+    }
+
     const size_t backing_size; ///< Size of the backing memory in bytes
     const size_t virtual_size; ///< Size of the virtual address placeholder in bytes
 
@@ -592,6 +668,79 @@ private:
         }
     }
 
+#if defined(__linux__)
+    /// Warns when the host is configured to never back shared memory with huge pages.
+    static void CheckShmemHugePages() {
+        std::ifstream file{"/sys/kernel/mm/transparent_hugepage/shmem_enabled"};
+        std::string mode;
+        std::getline(file, mode);
+        if (mode.empty()) {
+            LOG_WARNING(HW_Memory, "Transparent huge pages are not supported by the host");
+        } else if (mode.find("[never]") != std::string::npos ||
+                   mode.find("[deny]") != std::string::npos) {
+            LOG_WARNING(HW_Memory,
+                        "Transparent huge pages for shared memory are disabled on the host, set "
+                        "/sys/kernel/mm/transparent_hugepage/shmem_enabled to advise to use them");
+        } else {
+            LOG_INFO(HW_Memory, "Using transparent huge pages for guest memory");
+        }
+    }
+
+    /// Maps the backing file at a 2MiB aligned address, so its huge pages line up with the file.
+    u8* MapHugeAlignedBacking() const {
+        // Reserve enough address space to hold an aligned mapping, then trim the excess.
+        const size_t reserve_size = backing_size + HugePageSize;
+        u8* const reserve =
+            static_cast<u8*>(mmap(nullptr, reserve_size, PROT_NONE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+        if (reserve == MAP_FAILED) {
+            return reserve;
+        }
+        u8* const aligned = reinterpret_cast<u8*>(
+            AlignUp(reinterpret_cast<uintptr_t>(reserve), HugePageSize));
+        if (mmap(aligned, backing_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) ==
+            MAP_FAILED) {
+            munmap(reserve, reserve_size);
+            return reinterpret_cast<u8*>(MAP_FAILED);
+        }
+        if (aligned != reserve) {
+            munmap(reserve, aligned - reserve);
+        }
+        const size_t tail_size = reserve + reserve_size - (aligned + backing_size);
+        if (tail_size != 0) {
+            munmap(aligned + backing_size, tail_size);
+        }
+        madvise(aligned, backing_size, MADV_HUGEPAGE);
+        return aligned;
+    }
+
+    /// Asks for huge pages on a new guest mapping and records the part of it that can use them.
+    void TrackHugeMapping(size_t virtual_offset, size_t host_offset, size_t length) {
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(virtual_base + virtual_offset);
+        const uintptr_t end = begin + length;
+        std::scoped_lock lock{huge_mutex};
+
+        // The mapping replaces whatever was there, which splits the huge pages it touches.
+        huge_ranges.subtract({AlignDown(begin, HugePageSize), AlignUp(end, HugePageSize)});
+
+        // A huge page can only back the mapping where the address and the file offset are both
+        // 2MiB aligned. Elsewhere the kernel keeps using regular pages on its own.
+        if ((begin - host_offset) % HugePageSize != 0) {
+            return;
+        }
+        const uintptr_t huge_begin = AlignUp(begin, HugePageSize);
+        const uintptr_t huge_end = AlignDown(end, HugePageSize);
+        if (huge_begin >= huge_end) {
+            return;
+        }
+        // The mmap replaced the advice given to the placeholder, so give it again.
+        madvise(reinterpret_cast<void*>(begin), length, MADV_HUGEPAGE);
+        huge_ranges.add({huge_begin, huge_end});
+    }
+#else
+    void TrackHugeMapping(size_t, size_t, size_t) {}
+#endif
+
     void AdjustMap(size_t* virtual_offset, size_t* length) {
         if (virtual_base != nullptr) {
             return;
@@ -615,13 +764,18 @@ private:
 
     int fd{-1}; // memfd file descriptor, -1 is the error value of memfd_create
     FreeRegionManager free_manager{};
+
+    bool use_huge_pages{};
+    mutable std::mutex huge_mutex;
+    boost::icl::interval_set<uintptr_t> huge_ranges; ///< Mapped ranges eligible for huge pages
 };
 
 #else // ^^^ Linux ^^^ vvv Generic vvv
 
 class HostMemory::Impl {
 public:
-    explicit Impl(size_t /*backing_size */, size_t /* virtual_size */) {
+    explicit Impl(size_t /*backing_size */, size_t /* virtual_size */,
+                  bool /* use_huge_pages */) {
         // This is just a place holder.
         // Please implement fastmem in a proper way on your platform.
         throw std::bad_alloc{};
@@ -639,20 +793,24 @@ public:
 
     void EnableDirectMappedAddress() {}
 
+    HugePageStats GetHugePageStats() const {
+        return {};
+    }
+
     u8* backing_base{nullptr};
     u8* virtual_base{nullptr};
 };
 
 #endif // ^^^ Generic ^^^
 
-HostMemory::HostMemory(size_t backing_size_, size_t virtual_size_)
+HostMemory::HostMemory(size_t backing_size_, size_t virtual_size_, bool use_huge_pages)
     : backing_size(backing_size_), virtual_size(virtual_size_) {
     try {
         // Try to allocate a fastmem arena.
         // The implementation will fail with std::bad_alloc on errors.
-        impl =
-            std::make_unique<HostMemory::Impl>(AlignUp(backing_size, PageAlignment),
-                                               AlignUp(virtual_size, PageAlignment) + HugePageSize);
+        impl = std::make_unique<HostMemory::Impl>(
+            AlignUp(backing_size, PageAlignment),
+            AlignUp(virtual_size, PageAlignment) + HugePageSize, use_huge_pages);
         backing_base = impl->backing_base;
         virtual_base = impl->virtual_base;
 
@@ -720,6 +878,10 @@ void HostMemory::ClearBackingRegion(size_t physical_offset, size_t length, u32 f
     }
 }
 
+HostMemory::HugePageStats HostMemory::GetHugePageStats() const {
+    return impl ? impl->GetHugePageStats() : HugePageStats{};
+}
+
 void HostMemory::EnableDirectMappedAddress() {
     if (impl) {
         impl->EnableDirectMappedAddress();
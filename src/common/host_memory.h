@@ -24,7 +24,22 @@ DECLARE_ENUM_FLAG_OPERATORS(MemoryPermission)
  */
 class HostMemory {
 public:
-    explicit HostMemory(size_t backing_size_, size_t virtual_size_);
+    /// Amount of guest memory backed by 2MiB pages, see GetHugePageStats.
+    struct HugePageStats {
+        /// Bytes of the backing memory currently mapped with huge pages on the host.
+        size_t backing_bytes;
+        /// Bytes of the virtual arena currently mapped with huge pages on the host.
+        size_t mapped_bytes;
+        /// Bytes of the virtual arena whose mappings are laid out so huge pages can back them.
+        size_t eligible_bytes;
+    };
+
+    /**
+     * Creates the buffer. When use_huge_pages is set, the host is asked to back guest memory with
+     * transparent huge pages wherever the guest mappings are aligned so that a 2MiB page fits.
+     * Mappings that split a huge page transparently fall back to regular pages.
+     */
+    explicit HostMemory(size_t backing_size_, size_t virtual_size_, bool use_huge_pages = false);
     ~HostMemory();
 
     /**
@@ -51,6 +66,12 @@ public:
 
     void ClearBackingRegion(size_t physical_offset, size_t length, u32 fill_value);
 
+    /**
+     * Returns how much guest memory is backed by huge pages. The backing and mapped sizes are
+     * queried from the host and are zero when huge pages are disabled or unsupported.
+     */
+    [[nodiscard]] HugePageStats GetHugePageStats() const;
+
     [[nodiscard]] u8* BackingBasePointer() noexcept {
         return backing_base;
     }
@@ -1,10 +1,16 @@
 // SPDX-FileCopyrightText: 2014 Citra Emulator Project & 2024 suyu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -23,6 +29,7 @@
 #include "common/logging/backend.h"
 #include "common/logging/log.h"
 #include "common/logging/log_entry.h"
+#include "common/logging/log_ring.h"
 #include "common/logging/text_formatter.h"
 #include "common/settings.h"
 #ifdef _WIN32
@@ -32,6 +39,8 @@
 
 namespace Common::Log {
 
+using namespace Common::Literals;
+
 namespace {
 
 /**
@@ -106,7 +115,6 @@ public:
 
         bytes_written += file->WriteString(FormatLogMessage(entry).append(1, '\n'));
 
-        using namespace Common::Literals;
         // Prevent logs from exceeding a set maximum size in the event that log entries are spammed.
         const auto write_limit = Settings::values.extended_logging.GetValue() ? 1_GiB : 100_MiB;
         const bool write_limit_exceeded = bytes_written > write_limit;
@@ -177,6 +185,16 @@ public:
 
 bool initialization_in_progress_suppress_logging = true;
 
+/// How often the backend thread polls the per-thread rings while deferred formatting is enabled.
+constexpr std::chrono::milliseconds DeferredDrainInterval{2};
+
+/// How long a critical message waits for the backend thread to write it out.
+constexpr std::chrono::seconds DeferredFlushTimeout{1};
+
+using DeferredRing = LogRing<Detail::DeferredRingSize>;
+static_assert(DeferredRing::MaxRecordSize ==
+              sizeof(Detail::DeferredRecord) + Detail::MaxDeferredArgsSize);
+
 /**
  * Static state as a singleton.
  */
@@ -233,11 +251,81 @@ public:
         }
         message_queue.EmplaceWait(
             CreateEntry(log_class, log_level, filename, line_num, function, std::move(message)));
+        if (log_level >= Level::Critical) {
+            FlushDeferred();
+        }
+    }
+
+    bool IsDeferredFormattingEnabled() const {
+        return deferred_formatting.load(std::memory_order_relaxed);
+    }
+
+    void SetDeferredFormattingEnabled(bool enabled) {
+        if (deferred_formatting.exchange(enabled) == enabled) {
+            return;
+        }
+        // Wake the backend thread up so it switches between blocking on the queue and polling.
+        message_queue.EmplaceWait(Entry{});
+    }
+
+    u8* ReserveDeferredRecord(Class log_class, Level log_level, const char* filename,
+                              unsigned int line_num, const char* function, fmt::string_view format,
+                              Detail::DeferredFormatter formatter, std::size_t args_size) {
+        if (!filter.CheckMessage(log_class, log_level)) {
+            return nullptr;
+        }
+        DeferredRing& ring = GetThreadRing();
+        u8* const data = ring.Reserve(sizeof(Detail::DeferredRecord) + args_size);
+        if (data == nullptr) {
+            return nullptr;
+        }
+        const Detail::DeferredRecord record{
+            .time = std::chrono::steady_clock::now(),
+            .filename = filename,
+            .function = function,
+            .format_data = format.data(),
+            .format_size = format.size(),
+            .formatter = formatter,
+            .line_num = line_num,
+            .log_class = log_class,
+            .log_level = log_level,
+        };
+        std::memcpy(data, &record, sizeof(record));
+        return data + sizeof(record);
+    }
+
+    void CommitDeferredRecord(Level log_level) {
+        GetThreadRing().Commit();
+        if (log_level >= Level::Critical) {
+            FlushDeferred();
+        }
     }
 
 private:
     Impl(const std::filesystem::path& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename} {}
+        : filter{filter_}, file_backend{file_backend_filename},
+          deferred_formatting{Settings::values.log_deferred_formatting.GetValue()} {}
+
+    /**
+     * Waits until the backend thread has written out every message captured so far, so that the
+     * messages leading to a crash are not lost.
+     */
+    void FlushDeferred() {
+        if (!IsDeferredFormattingEnabled() || !backend_thread.joinable()) {
+            return;
+        }
+        if (std::this_thread::get_id() == backend_thread.get_id()) {
+            DrainDeferred();
+            ForEachBackend([](Backend& backend) { backend.Flush(); });
+            return;
+        }
+        std::unique_lock lock{flush_mutex};
+        const u64 request = ++flush_requested;
+        flush_cv.notify_all();
+        flush_cv.wait_for(lock, DeferredFlushTimeout, [this, request] {
+            return flush_completed >= request;
+        });
+    }
 
     ~Impl() = default;
 
@@ -249,6 +337,26 @@ private:
                 ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
             };
             while (!stop_token.stop_requested()) {
+                if (IsDeferredFormattingEnabled()) {
+                    const u64 request = [this] {
+                        std::scoped_lock lock{flush_mutex};
+                        return flush_requested;
+                    }();
+                    const std::size_t written = DrainDeferred();
+                    std::unique_lock lock{flush_mutex};
+                    if (request != flush_completed) {
+                        ForEachBackend([](Backend& backend) { backend.Flush(); });
+                        flush_completed = request;
+                        flush_cv.notify_all();
+                    }
+                    if (written == 0) {
+                        flush_cv.wait_for(lock, DeferredDrainInterval, [this, &stop_token] {
+                            return flush_requested != flush_completed ||
+                                   stop_token.stop_requested();
+                        });
+                    }
+                    continue;
+                }
                 message_queue.PopWait(entry, stop_token);
                 if (entry.filename != nullptr) {
                     write_logs();
@@ -260,9 +368,77 @@ private:
             while (max_logs_to_write-- && message_queue.TryPop(entry)) {
                 write_logs();
             }
+            // Everything captured in the rings is written, the rings are bounded anyway.
+            DrainDeferred();
         });
     }
 
+    DeferredRing& GetThreadRing() {
+        thread_local const std::shared_ptr<DeferredRing> ring = [this] {
+            auto new_ring = std::make_shared<DeferredRing>();
+            std::scoped_lock lock{rings_mutex};
+            rings.push_back(new_ring);
+            return new_ring;
+        }();
+        return *ring;
+    }
+
+    /**
+     * Formats and writes everything pending in the per-thread rings and in the message queue,
+     * ordered by timestamp.
+     * @returns Number of entries written.
+     */
+    std::size_t DrainDeferred() {
+        deferred_batch.clear();
+
+        Entry entry;
+        while (message_queue.TryPop(entry)) {
+            if (entry.filename != nullptr) {
+                deferred_batch.push_back(std::move(entry));
+            }
+        }
+
+        {
+            std::scoped_lock lock{rings_mutex};
+            for (const auto& ring : rings) {
+                ring->Drain([this](const u8* data, std::size_t) {
+                    Detail::DeferredRecord record;
+                    std::memcpy(&record, data, sizeof(record));
+                    const fmt::string_view format{record.format_data, record.format_size};
+                    deferred_batch.push_back({
+                        .timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                            record.time - time_origin),
+                        .log_class = record.log_class,
+                        .log_level = record.log_level,
+                        .filename = record.filename,
+                        .line_num = record.line_num,
+                        .function = record.function,
+                        .message = record.formatter(format, data + sizeof(record)),
+                    });
+                });
+                if (const u64 dropped = ring->TakeDroppedCount(); dropped != 0) {
+                    deferred_batch.push_back(CreateEntry(
+                        Class::Log, Level::Warning, TrimSourcePath(__FILE__), __LINE__, __func__,
+                        fmt::format("Dropped {} log messages, the logging ring was full",
+                                    dropped)));
+                }
+            }
+            // Forget rings of threads that have exited once everything they logged is written.
+            std::erase_if(rings, [](const std::shared_ptr<DeferredRing>& ring) {
+                return ring.use_count() == 1 && ring->Empty();
+            });
+        }
+
+        std::stable_sort(deferred_batch.begin(), deferred_batch.end(),
+                         [](const Entry& lhs, const Entry& rhs) {
+                             return lhs.timestamp < rhs.timestamp;
+                         });
+        for (const Entry& entry : deferred_batch) {
+            ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
+        }
+        return deferred_batch.size();
+    }
+
     void StopBackendThread() {
         backend_thread.request_stop();
         if (backend_thread.joinable()) {
@@ -314,6 +490,17 @@ private:
 
     MPSCQueue<Entry> message_queue{};
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
+
+    std::atomic_bool deferred_formatting{false};
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<DeferredRing>> rings;
+    std::vector<Entry> deferred_batch;
+
+    std::mutex flush_mutex;
+    std::condition_variable flush_cv;
+    u64 flush_requested{};
+    u64 flush_completed{};
+
     std::jthread backend_thread;
 };
 } // namespace
@@ -342,6 +529,10 @@ void SetColorConsoleBackendEnabled(bool enabled) {
     Impl::Instance().SetColorConsoleBackendEnabled(enabled);
 }
 
+void SetDeferredFormattingEnabled(bool enabled) {
+    Impl::Instance().SetDeferredFormattingEnabled(enabled);
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, fmt::string_view format,
                        const fmt::format_args& args) {
@@ -350,4 +541,24 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                                    fmt::vformat(format, args));
     }
 }
+
+namespace Detail {
+
+bool IsDeferredFormattingEnabled() {
+    return !initialization_in_progress_suppress_logging &&
+           Impl::Instance().IsDeferredFormattingEnabled();
+}
+
+u8* ReserveDeferredRecord(Class log_class, Level log_level, const char* filename,
+                          unsigned int line_num, const char* function, fmt::string_view format,
+                          DeferredFormatter formatter, std::size_t args_size) {
+    return Impl::Instance().ReserveDeferredRecord(log_class, log_level, filename, line_num,
+                                                  function, format, formatter, args_size);
+}
+
+void CommitDeferredRecord(Level log_level) {
+    Impl::Instance().CommitDeferredRecord(log_level);
+}
+
+} // namespace Detail
 } // namespace Common::Log
@@ -25,4 +25,10 @@ void DisableLoggingInTests();
 void SetGlobalFilter(const Filter& filter);
 
 void SetColorConsoleBackendEnabled(bool enabled);
+
+/**
+ * When enabled, call sites only capture the format string and raw arguments into a per-thread
+ * ring, and all formatting is done on the logging backend thread.
+ */
+void SetDeferredFormattingEnabled(bool enabled);
 } // namespace Common::Log
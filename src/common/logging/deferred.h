@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/logging/formatter.h"
+#include "common/logging/types.h"
+
+namespace Common::Log::Detail {
+
+/**
+ * Deferred formatting support.
+ *
+ * Instead of formatting a message on the calling thread, the call site copies the raw argument
+ * values into a per-thread ring buffer alongside a pointer to the (static) format string and a
+ * type-specific decoder. The logging backend thread later decodes the arguments and performs
+ * the actual formatting.
+ *
+ * Only argument types that can be safely captured by value are deferred: arithmetic types,
+ * enums, non-character pointers and strings (which are copied). Messages with any other argument
+ * type fall back to eager formatting.
+ */
+
+/// Decodes the serialized arguments and formats the message.
+using DeferredFormatter = std::string (*)(fmt::string_view format, const u8* args);
+
+template <typename T>
+constexpr bool IsDeferredString =
+    std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*> ||
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+template <typename T>
+constexpr bool IsDeferredValue =
+    std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+    (std::is_pointer_v<T> && !IsDeferredString<T>);
+
+template <typename T>
+constexpr bool IsDeferrable = IsDeferredString<T> || IsDeferredValue<T>;
+
+template <typename... Args>
+constexpr bool CanDefer = (IsDeferrable<Args> && ...);
+
+/// Type an argument is reconstructed as on the backend thread.
+template <typename T>
+using DecodedType = std::conditional_t<IsDeferredString<T>, std::string_view, std::decay_t<T>>;
+
+template <typename T>
+std::string_view AsStringView(const T& value) {
+    if constexpr (std::is_pointer_v<T>) {
+        return value != nullptr ? std::string_view{value} : std::string_view{"(null)"};
+    } else {
+        return std::string_view{value};
+    }
+}
+
+template <typename T>
+std::size_t EncodedSize(const T& value) {
+    if constexpr (IsDeferredString<T>) {
+        return sizeof(u32) + AsStringView(value).size();
+    } else {
+        return sizeof(T);
+    }
+}
+
+template <typename T>
+u8* EncodeArg(u8* dst, const T& value) {
+    if constexpr (IsDeferredString<T>) {
+        const std::string_view str = AsStringView(value);
+        const u32 size = static_cast<u32>(str.size());
+        std::memcpy(dst, &size, sizeof(size));
+        std::memcpy(dst + sizeof(size), str.data(), size);
+        return dst + sizeof(size) + size;
+    } else {
+        std::memcpy(dst, &value, sizeof(T));
+        return dst + sizeof(T);
+    }
+}
+
+template <typename T>
+DecodedType<T> DecodeArg(const u8*& src) {
+    if constexpr (IsDeferredString<T>) {
+        u32 size;
+        std::memcpy(&size, src, sizeof(size));
+        const std::string_view str{reinterpret_cast<const char*>(src + sizeof(size)), size};
+        src += sizeof(size) + size;
+        return str;
+    } else {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        src += sizeof(T);
+        return value;
+    }
+}
+
+/// Returns the number of bytes needed to serialize the given arguments.
+template <typename... Args>
+std::size_t DeferredArgsSize(const Args&... args) {
+    return (std::size_t{0} + ... + EncodedSize(args));
+}
+
+/// Serializes the given arguments into dst, which must be at least DeferredArgsSize bytes long.
+template <typename... Args>
+void EncodeDeferredArgs([[maybe_unused]] u8* dst, const Args&... args) {
+    ((dst = EncodeArg(dst, args)), ...);
+}
+
+/// Reconstructs arguments serialized by EncodeDeferredArgs and formats them.
+template <typename... Args>
+std::string FormatDeferred(fmt::string_view format, [[maybe_unused]] const u8* args) {
+    // Braced initialization guarantees left-to-right evaluation of the decoders.
+    const std::tuple<DecodedType<Args>...> values{DecodeArg<Args>(args)...};
+    return std::apply(
+        [format](const auto&... unpacked) {
+            return fmt::vformat(format, fmt::make_format_args(unpacked...));
+        },
+        values);
+}
+
+/**
+ * Fixed-size header written in front of the serialized arguments of every deferred message.
+ */
+struct DeferredRecord {
+    std::chrono::steady_clock::time_point time;
+    const char* filename;
+    const char* function;
+    const char* format_data;
+    std::size_t format_size;
+    DeferredFormatter formatter;
+    unsigned int line_num;
+    Class log_class;
+    Level log_level;
+};
+static_assert(std::is_trivially_copyable_v<DeferredRecord>);
+
+/// Size of the per-thread ring deferred messages are captured into.
+constexpr std::size_t DeferredRingSize = 256 * 1024;
+
+/// Largest serialized arguments of a deferred message, larger messages are formatted eagerly.
+constexpr std::size_t MaxDeferredArgsSize = DeferredRingSize / 4 - sizeof(DeferredRecord);
+
+/// Returns true if messages with deferrable arguments should be captured instead of formatted.
+bool IsDeferredFormattingEnabled();
+
+/**
+ * Reserves space for a deferred message and its serialized arguments in the calling thread's
+ * ring. Returns nullptr if the message is filtered out or the ring is full, in which case the
+ * message is dropped. A successful reservation must be followed by CommitDeferredRecord.
+ */
+u8* ReserveDeferredRecord(Class log_class, Level log_level, const char* filename,
+                          unsigned int line_num, const char* function, fmt::string_view format,
+                          DeferredFormatter formatter, std::size_t args_size);
+
+/**
+ * Publishes the record reserved by the last call to ReserveDeferredRecord to the backend. Critical
+ * messages are written out before returning.
+ */
+void CommitDeferredRecord(Level log_level);
+
+/**
+ * Captures a message to be formatted by the backend thread.
+ * @returns False if the arguments are too large to be deferred, in which case the message has to
+ *          be formatted eagerly.
+ */
+template <typename... Args>
+bool DeferredLogMessage(Class log_class, Level log_level, const char* filename,
+                        unsigned int line_num, const char* function, fmt::string_view format,
+                        const Args&... args) {
+    const std::size_t args_size = DeferredArgsSize(args...);
+    if (args_size > MaxDeferredArgsSize) {
+        return false;
+    }
+    u8* const dst = ReserveDeferredRecord(log_class, log_level, filename, line_num, function,
+                                          format, &FormatDeferred<Args...>, args_size);
+    if (dst == nullptr) {
+        return true;
+    }
+    EncodeDeferredArgs(dst, args...);
+    CommitDeferredRecord(log_level);
+    return true;
+}
+
+} // namespace Common::Log::Detail
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#include "common/alignment.h"
+#include "common/common_types.h"
+
+namespace Common::Log {
+
+/**
+ * Lock-free single-producer/single-consumer ring of variable-sized records.
+ *
+ * Every thread that logs with deferred formatting owns one of these. Records are never split
+ * across the end of the buffer; the producer writes a padding marker instead and continues at
+ * the beginning. When the ring is full, records are dropped and counted rather than blocking the
+ * producer.
+ */
+template <std::size_t Capacity>
+class LogRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+    static constexpr u32 PaddingMarker = 0xFFFFFFFF;
+    static constexpr std::size_t RecordAlignment = 8;
+    static constexpr std::size_t HeaderSize = RecordAlignment;
+
+public:
+    /// Largest payload a single record can hold.
+    static constexpr std::size_t MaxRecordSize = Capacity / 4;
+
+    /**
+     * Reserves a record with a payload of the given size.
+     * @returns Pointer to the payload, or nullptr if the ring does not have enough space.
+     */
+    [[nodiscard]] u8* Reserve(std::size_t size) {
+        if (size > MaxRecordSize) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        const std::size_t record_size = Common::AlignUp(HeaderSize + size, RecordAlignment);
+        const std::size_t write = write_index.load(std::memory_order_relaxed);
+        const std::size_t offset = write % Capacity;
+        const std::size_t padding = offset + record_size > Capacity ? Capacity - offset : 0;
+        const std::size_t used = write - read_index.load(std::memory_order_acquire);
+        if (used + padding + record_size > Capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        if (padding != 0) {
+            WriteHeader(offset, PaddingMarker);
+        }
+        const std::size_t record_offset = (write + padding) % Capacity;
+        WriteHeader(record_offset, static_cast<u32>(size));
+        pending_index = write + padding + record_size;
+        return buffer.data() + record_offset + HeaderSize;
+    }
+
+    /// Publishes the record returned by the last successful call to Reserve.
+    void Commit() {
+        write_index.store(pending_index, std::memory_order_release);
+    }
+
+    /**
+     * Consumes all published records, invoking func(const u8* payload, std::size_t size) on each.
+     * The payload pointer is only valid for the duration of the call.
+     * @returns Number of records consumed.
+     */
+    template <typename Func>
+    std::size_t Drain(Func&& func) {
+        std::size_t read = read_index.load(std::memory_order_relaxed);
+        const std::size_t write = write_index.load(std::memory_order_acquire);
+        std::size_t count = 0;
+        while (read != write) {
+            const std::size_t offset = read % Capacity;
+            u32 size;
+            std::memcpy(&size, buffer.data() + offset, sizeof(size));
+            if (size == PaddingMarker) {
+                read += Capacity - offset;
+                continue;
+            }
+            func(static_cast<const u8*>(buffer.data() + offset + HeaderSize),
+                 static_cast<std::size_t>(size));
+            read += Common::AlignUp(HeaderSize + size, RecordAlignment);
+            ++count;
+        }
+        read_index.store(read, std::memory_order_release);
+        return count;
+    }
+
+    /// Returns true if there are no published records left to consume.
+    [[nodiscard]] bool Empty() const {
+        return read_index.load(std::memory_order_acquire) ==
+               write_index.load(std::memory_order_acquire);
+    }
+
+    /// Returns the number of records dropped since the last call, and resets the counter.
+    u64 TakeDroppedCount() {
+        return dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    void WriteHeader(std::size_t offset, u32 value) {
+        std::memcpy(buffer.data() + offset, &value, sizeof(value));
+    }
+
+    alignas(128) std::atomic_size_t write_index{0};
+    std::size_t pending_index{0};
+    alignas(128) std::atomic_size_t read_index{0};
+    alignas(128) std::atomic<u64> dropped{0};
+    alignas(RecordAlignment) std::array<u8, Capacity> buffer{};
+};
+
+} // namespace Common::Log
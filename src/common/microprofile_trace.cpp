@@ -0,0 +1,328 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/microprofile_trace.h"
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
+
+namespace Common::MicroProfileTrace {
+
+#if MICROPROFILE_ENABLED
+
+namespace {
+
+/// How often the thread logs are collected.
+constexpr std::chrono::milliseconds PollInterval{20};
+
+/// Maximum number of log entries copied out of a single thread log at once.
+constexpr size_t MaxEntriesPerBatch = 0x10000;
+
+/// Size at which formatted events are written out to the file.
+constexpr size_t FlushThreshold = 0x100000;
+
+/// Process id used for all events, the trace only ever contains one process.
+constexpr int TracePid = 1;
+
+/// Returns the number of entries from one position of a thread log to another.
+u32 LogDistance(u32 from, u32 to) {
+    return (to + MICROPROFILE_BUFFER_SIZE - from) % MICROPROFILE_BUFFER_SIZE;
+}
+
+void AppendEscaped(std::string& out, std::string_view str) {
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<u32>(c));
+            } else {
+                out += c;
+            }
+            break;
+        }
+    }
+}
+
+class Exporter {
+public:
+    explicit Exporter(const std::filesystem::path& path)
+        : file{path, FS::FileAccessMode::Write, FS::FileType::TextFile},
+          ticks_per_us{static_cast<double>(MicroProfileTicksPerSecondCpu()) / 1'000'000.0},
+          base_tick{static_cast<u64>(MP_TICK()) & MP_LOG_TICK_MASK} {
+        scratch.reserve(MaxEntriesPerBatch);
+        out.reserve(FlushThreshold + 0x1000);
+    }
+
+    ~Exporter() {
+        Stop();
+    }
+
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+
+    [[nodiscard]] bool IsOpen() const {
+        return file.IsOpen();
+    }
+
+    void Start() {
+        // Use the JSON array format, which trace viewers accept without the closing bracket.
+        // This keeps the trace readable even if the process does not exit cleanly.
+        out += "[\n";
+        {
+            std::scoped_lock lock{MicroProfileGetMutex()};
+            MicroProfileSetForceEnable(true);
+            MicroProfileSetEnableAllGroups(true);
+            // Skip everything logged before the trace was started.
+            MicroProfile* const profile = MicroProfileGet();
+            for (size_t i = 0; i < threads.size(); ++i) {
+                if (const MicroProfileThreadLog* const log = profile->Pool[i]) {
+                    threads[i].read_pos = log->nPut.load(std::memory_order_acquire);
+                    threads[i].thread_id = log->nThreadId;
+                    threads[i].valid = true;
+                    EmitThreadName(i, log->ThreadName);
+                }
+            }
+        }
+        worker = std::jthread([this](std::stop_token stop_token) {
+            Common::SetCurrentThreadName("MicroProfileTrace");
+            while (!stop_token.stop_requested()) {
+                Collect();
+                Common::StoppableTimedWait(stop_token, PollInterval);
+            }
+            Collect();
+        });
+    }
+
+    void Stop() {
+        if (!worker.joinable()) {
+            return;
+        }
+        worker.request_stop();
+        worker.join();
+        if (dropped_entries > 0) {
+            LOG_WARNING(Common, "Dropped {} MicroProfile entries overwritten before collection",
+                        dropped_entries);
+        }
+        // Close every scope still open so the last events show up with a duration.
+        const u64 tick = static_cast<u64>(MP_TICK());
+        for (size_t i = 0; i < threads.size(); ++i) {
+            CloseScopes(i, threads[i], tick);
+        }
+        // End with a metadata event, as trailing commas are not allowed.
+        fmt::format_to(std::back_inserter(out),
+                       "{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},"
+                       "\"args\":{{\"name\":\"suyu\"}}}}]\n",
+                       TracePid);
+        FlushOutput();
+        file.Flush();
+        file.Close();
+        MicroProfileSetForceEnable(false);
+    }
+
+private:
+    struct ThreadState {
+        u32 read_pos{};
+        ThreadIdType thread_id{};
+        u32 depth{};
+        bool valid{};
+    };
+
+    void Collect() {
+        MicroProfile* const profile = MicroProfileGet();
+        for (size_t i = 0; i < threads.size(); ++i) {
+            ThreadState& thread = threads[i];
+            do {
+                scratch.clear();
+                u32 dropped = 0;
+                {
+                    std::scoped_lock lock{MicroProfileGetMutex()};
+                    const MicroProfileThreadLog* const log = profile->Pool[i];
+                    if (log == nullptr || log->nActive == 0) {
+                        thread.valid = false;
+                        break;
+                    }
+                    if (!thread.valid || thread.thread_id != log->nThreadId) {
+                        // The log was created or reused by a new thread since the last pass.
+                        thread = {.thread_id = log->nThreadId, .valid = true};
+                        EmitThreadName(i, log->ThreadName);
+                    }
+                    // MicroProfileFlip moves nGet up to nPut every frame, after which the thread
+                    // may overwrite the entries before nGet. Only the entries from nGet to nPut
+                    // are kept while the lock is held, so unread entries before nGet are dropped.
+                    const u32 put = log->nPut.load(std::memory_order_acquire);
+                    const u32 get = log->nGet.load(std::memory_order_relaxed);
+                    if (LogDistance(get, thread.read_pos) > LogDistance(get, put)) {
+                        dropped = LogDistance(thread.read_pos, get);
+                        thread.read_pos = get;
+                    }
+                    while (thread.read_pos != put && scratch.size() < MaxEntriesPerBatch) {
+                        scratch.push_back(log->Log[thread.read_pos]);
+                        thread.read_pos = (thread.read_pos + 1) % MICROPROFILE_BUFFER_SIZE;
+                    }
+                    CopyTimerNames(*profile);
+                }
+                if (dropped > 0) {
+                    OnOverrun(i, thread, dropped);
+                }
+                EmitEntries(i, thread);
+                if (out.size() >= FlushThreshold) {
+                    FlushOutput();
+                }
+            } while (scratch.size() == MaxEntriesPerBatch);
+        }
+        FlushOutput();
+    }
+
+    void OnOverrun(size_t tid, ThreadState& thread, u32 dropped) {
+        if (dropped_entries == 0) {
+            LOG_WARNING(Common, "MicroProfile thread log {} overran, dropping {} entries", tid,
+                        dropped);
+        }
+        dropped_entries += dropped;
+
+        // The ends of the open scopes may have been dropped, end them before the next entry.
+        const u64 tick = scratch.empty() ? static_cast<u64>(MP_TICK())
+                                         : static_cast<u64>(MicroProfileLogGetTick(scratch[0]));
+        CloseScopes(tid, thread, tick);
+    }
+
+    void CloseScopes(size_t tid, ThreadState& thread, u64 tick) {
+        const double ts = TickToUs(tick);
+        for (; thread.depth > 0; --thread.depth) {
+            fmt::format_to(std::back_inserter(out),
+                           "{{\"ph\":\"E\",\"ts\":{:.3f},\"pid\":{},\"tid\":{}}},\n", ts,
+                           TracePid, tid);
+        }
+    }
+
+    void CopyTimerNames(const MicroProfile& profile) {
+        // Timers can be registered at any time, pick up the new ones while the lock is held.
+        for (u32 index = num_timer_names; index < profile.nTotalTimers; ++index) {
+            const MicroProfileTimerInfo& info = profile.TimerInfo[index];
+            std::string name;
+            AppendEscaped(name, std::string_view{info.pName, info.nNameLen});
+            std::string group;
+            AppendEscaped(group, profile.GroupInfo[profile.TimerToGroup[index]].pName);
+            timer_names[index] = {std::move(name), std::move(group)};
+        }
+        num_timer_names = profile.nTotalTimers;
+    }
+
+    void EmitEntries(size_t tid, ThreadState& thread) {
+        for (const MicroProfileLogEntry entry : scratch) {
+            const int type = MicroProfileLogType(entry);
+            const double ts = TickToUs(static_cast<u64>(MicroProfileLogGetTick(entry)));
+            if (type == MP_LOG_ENTER) {
+                const auto& [name, group] = timer_names[MicroProfileLogTimerIndex(entry)];
+                fmt::format_to(std::back_inserter(out),
+                               "{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"B\",\"ts\":{:.3f},"
+                               "\"pid\":{},\"tid\":{}}},\n",
+                               name, group, ts, TracePid, tid);
+                ++thread.depth;
+            } else if (type == MP_LOG_LEAVE && thread.depth > 0) {
+                // Scopes entered before the trace started have no begin event; drop their end.
+                fmt::format_to(std::back_inserter(out),
+                               "{{\"ph\":\"E\",\"ts\":{:.3f},\"pid\":{},\"tid\":{}}},\n", ts,
+                               TracePid, tid);
+                --thread.depth;
+            }
+        }
+    }
+
+    void EmitThreadName(size_t tid, std::string_view name) {
+        out += fmt::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},\"tid\":{},"
+                           "\"args\":{{\"name\":\"",
+                           TracePid, tid);
+        AppendEscaped(out, name);
+        out += "\"}},\n";
+    }
+
+    double TickToUs(u64 tick) const {
+        // Log entries only keep the low bits of the tick, so compute the difference in that width.
+        const u64 delta = (tick - base_tick) & MP_LOG_TICK_MASK;
+        return static_cast<double>(delta) / ticks_per_us;
+    }
+
+    void FlushOutput() {
+        if (out.empty()) {
+            return;
+        }
+        void(file.WriteString(out));
+        out.clear();
+    }
+
+    FS::IOFile file;
+    const double ticks_per_us;
+    const u64 base_tick;
+
+    std::array<ThreadState, MICROPROFILE_MAX_THREADS> threads{};
+    std::array<std::pair<std::string, std::string>, MICROPROFILE_MAX_TIMERS> timer_names{};
+    u32 num_timer_names{};
+    u64 dropped_entries{};
+
+    std::vector<MicroProfileLogEntry> scratch;
+    std::string out;
+    std::jthread worker;
+};
+
+std::unique_ptr<Exporter> exporter;
+
+} // Anonymous namespace
+
+bool Start(const std::filesystem::path& path) {
+    Stop();
+    // Make sure the trace is completed on exit() as well, before MicroProfile itself is torn down.
+    [[maybe_unused]] static const bool registered_atexit = [] {
+        static_cast<void>(MicroProfileGetMutex());
+        std::atexit(Stop);
+        return true;
+    }();
+    auto new_exporter = std::make_unique<Exporter>(path);
+    if (!new_exporter->IsOpen()) {
+        LOG_ERROR(Common, "Failed to open trace file {}", path.string());
+        return false;
+    }
+    exporter = std::move(new_exporter);
+    exporter->Start();
+    LOG_INFO(Common, "Writing MicroProfile trace to {}", path.string());
+    return true;
+}
+
+void Stop() {
+    exporter.reset();
+}
+
+#else
+
+bool Start(const std::filesystem::path& path) {
+    LOG_ERROR(Common, "Cannot write a trace to {}, MicroProfile is disabled in this build",
+              path.string());
+    return false;
+}
+
+void Stop() {}
+
+#endif
+
+} // namespace Common::MicroProfileTrace
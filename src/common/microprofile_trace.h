@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+
+namespace Common::MicroProfileTrace {
+
+/**
+ * Starts streaming every MICROPROFILE_SCOPE enter and exit, together with the thread names, to a
+ * file in the Chrome Trace Event format, which can be opened by chrome://tracing and Perfetto.
+ *
+ * Events are collected from the microprofile thread logs by a background thread, so the memory
+ * used by the exporter is bounded no matter how long it runs. MicroProfile must have been
+ * initialized, e.g. by MicroProfileOnThreadCreate, before calling this.
+ *
+ * @returns false if the file could not be opened or MicroProfile is disabled in this build.
+ */
+bool Start(const std::filesystem::path& path);
+
+/// Writes out all remaining events and closes the trace file.
+void Stop();
+
+} // namespace Common::MicroProfileTrace
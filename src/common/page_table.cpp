@@ -47,6 +47,20 @@ bool PageTable::ContinueTraversal(TraversalEntry* out_entry, TraversalContext* c
     return true;
 }
 
+std::size_t PageTable::GetContiguousPageCount(std::size_t page_index,
+                                              std::size_t max_pages) const {
+    // Contiguous pages of the same mapping store the same offset from their virtual address to
+    // the host pointer and to the backing memory, together with the same type bits.
+    const uintptr_t raw = pointers[page_index].Raw();
+    const u64 backing = backing_addr[page_index];
+    std::size_t count = 1;
+    while (count < max_pages && pointers[page_index + count].Raw() == raw &&
+           backing_addr[page_index + count] == backing) {
+        ++count;
+    }
+    return count;
+}
+
 void PageTable::Resize(std::size_t address_space_width_in_bits, std::size_t page_size_in_bits) {
     const std::size_t num_page_table_entries{1ULL
                                              << (address_space_width_in_bits - page_size_in_bits)};
@@ -114,6 +114,16 @@ struct PageTable {
      */
     void Resize(std::size_t address_space_width_in_bits, std::size_t page_size_in_bits);
 
+    /**
+     * Returns how many pages, starting at the given page and up to max_pages, have the same type as
+     * the first one and are backed by contiguous memory. A run like this can be accessed as a
+     * single block instead of page by page.
+     *
+     * @param page_index Index of the first page of the run.
+     * @param max_pages  Maximum number of pages to look at, at least one.
+     */
+    std::size_t GetContiguousPageCount(std::size_t page_index, std::size_t max_pages) const;
+
     std::size_t GetAddressSpaceBits() const {
         return current_address_space_width_in_bits;
     }
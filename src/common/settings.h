@@ -212,6 +212,7 @@ struct Values {
                                              true,
                                              true,
                                              &use_speed_limit};
+    Setting<bool> use_huge_pages{linkage, false, "use_huge_pages", Category::Core};
 
     // Cpu
     SwitchableSetting<CpuBackend, true> cpu_backend{linkage,
@@ -572,6 +573,20 @@ struct Values {
                                         Category::DataStorage};
     Setting<std::string> gamecard_path{linkage, std::string(), "gamecard_path",
                                        Category::DataStorage};
+    Setting<bool> use_content_cache{linkage, false, "use_content_cache", Category::DataStorage};
+    Setting<u16> content_cache_limit_gib{linkage, 32, "content_cache_limit_gib",
+                                         Category::DataStorage};
+    Setting<bool> verify_content_integrity{linkage, false, "verify_content_integrity",
+                                           Category::DataStorage};
+    Setting<bool> integrity_verify_ahead{linkage, true, "integrity_verify_ahead",
+                                         Category::DataStorage};
+    Setting<u16> compressed_block_cache_size_mib{linkage, 128, "compressed_block_cache_size_mib",
+                                                 Category::DataStorage};
+    Setting<bool> compressed_storage_read_ahead{linkage, true, "compressed_storage_read_ahead",
+                                                Category::DataStorage};
+    Setting<bool> map_real_files{linkage, false, "map_real_files", Category::DataStorage};
+    Setting<bool> real_file_read_ahead{linkage, false, "real_file_read_ahead",
+                                       Category::DataStorage};
 
     // Debugging
     bool record_frame_times;
@@ -585,6 +600,10 @@ struct Values {
         false};
     Setting<bool> dump_macros{
         linkage, false, "dump_macros", Category::DebuggingGraphics, Specialization::Default, false};
+    Setting<bool> dump_gpu_trace{linkage, false, "dump_gpu_trace", Category::DebuggingGraphics,
+                                 Specialization::Default, false};
+    Setting<bool> profile_macros{linkage, false, "profile_macros", Category::DebuggingGraphics,
+                                 Specialization::Default, false};
     Setting<bool> enable_fs_access_log{linkage, false, "enable_fs_access_log", Category::Debugging};
     Setting<bool> reporting_services{
         linkage, false, "reporting_services", Category::Debugging, Specialization::Default, false};
@@ -593,6 +612,9 @@ struct Values {
                                     Category::DebuggingGraphics};
     Setting<bool> disable_macro_hle{linkage, false, "disable_macro_hle",
                                     Category::DebuggingGraphics};
+    // Only used by builds with SUYU_ARM64_MACRO_JIT, as that JIT has not been tested on arm64 yet.
+    Setting<bool> enable_arm64_macro_jit{linkage, false, "enable_arm64_macro_jit",
+                                         Category::DebuggingGraphics};
     Setting<bool> extended_logging{
         linkage, false, "extended_logging", Category::Debugging, Specialization::Default, false};
     Setting<bool> use_debug_asserts{linkage, false, "use_debug_asserts", Category::Debugging};
@@ -604,6 +626,8 @@ struct Values {
 
     // Miscellaneous
     Setting<std::string> log_filter{linkage, "*:Info", "log_filter", Category::Miscellaneous};
+    Setting<bool> log_deferred_formatting{linkage, false, "log_deferred_formatting",
+                                          Category::Miscellaneous};
     Setting<bool> use_dev_keys{linkage, false, "use_dev_keys", Category::Miscellaneous};
 
     // Network
@@ -0,0 +1,252 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "common/task_scheduler.h"
+#include "common/thread.h"
+
+namespace Common {
+
+namespace {
+/// Scheduler and worker index of the calling thread, if it is a scheduler worker.
+thread_local const TaskScheduler* current_scheduler = nullptr;
+thread_local size_t current_worker = 0;
+} // Anonymous namespace
+
+TaskScheduler::TaskScheduler(size_t num_workers) {
+    workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // Start the threads only after every worker exists, as they steal from each other.
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers[i]->thread =
+            std::jthread([this, i](std::stop_token stop_token) { WorkerLoop(stop_token, i); });
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    for (auto& worker : workers) {
+        worker->thread.request_stop();
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+TaskScheduler& TaskScheduler::Instance() {
+    static TaskScheduler scheduler{std::max(std::thread::hardware_concurrency(), 2U)};
+    return scheduler;
+}
+
+void TaskScheduler::Submit(TaskPriority priority, Task task) {
+    const size_t priority_index = static_cast<size_t>(priority);
+    if (current_scheduler == this) {
+        Worker& worker = *workers[current_worker];
+        std::scoped_lock lock{worker.mutex};
+        worker.deques[priority_index].push_back(std::move(task));
+    } else {
+        std::scoped_lock lock{injection_mutex};
+        injection_queues[priority_index].push_back(std::move(task));
+    }
+    ++num_pending;
+    std::scoped_lock lock{sleep_mutex};
+    sleep_condition.notify_one();
+}
+
+void TaskScheduler::WorkerLoop(std::stop_token stop_token, size_t index) {
+    Common::SetCurrentThreadName(fmt::format("TaskWorker_{}", index).c_str());
+    current_scheduler = this;
+    current_worker = index;
+
+    while (!stop_token.stop_requested()) {
+        Task task;
+        if (TryPop(index, task)) {
+            --num_pending;
+            task();
+            continue;
+        }
+        std::unique_lock lock{sleep_mutex};
+        Common::CondvarWait(sleep_condition, lock, stop_token,
+                            [this] { return num_pending.load() != 0; });
+    }
+}
+
+bool TaskScheduler::TryPop(size_t index, Task& task) {
+    const auto pop_back = [&task](std::deque<Task>& deque) {
+        if (deque.empty()) {
+            return false;
+        }
+        task = std::move(deque.back());
+        deque.pop_back();
+        return true;
+    };
+    const auto pop_front = [&task](std::deque<Task>& deque) {
+        if (deque.empty()) {
+            return false;
+        }
+        task = std::move(deque.front());
+        deque.pop_front();
+        return true;
+    };
+    // Exhaust every source of a priority class before looking at the next one.
+    for (size_t priority = 0; priority < NumPriorities; ++priority) {
+        {
+            // Own work is taken newest first while it is still hot in cache.
+            Worker& worker = *workers[index];
+            std::scoped_lock lock{worker.mutex};
+            if (pop_back(worker.deques[priority])) {
+                return true;
+            }
+        }
+        {
+            std::scoped_lock lock{injection_mutex};
+            if (pop_front(injection_queues[priority])) {
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < workers.size(); ++offset) {
+            // Steal the oldest work of the other workers.
+            Worker& victim = *workers[(index + offset) % workers.size()];
+            std::scoped_lock lock{victim.mutex};
+            if (pop_front(victim.deques[priority])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Shared between a TaskQueue and the tokens it has submitted to the scheduler, so tokens that
+ * run after the queue is destroyed are harmless.
+ *
+ * Tasks are not submitted to the scheduler directly. Instead, the queue keeps up to
+ * max_concurrency tokens in flight; each token pops and runs the oldest pending task. This keeps
+ * the FIFO order and concurrency limit of the queue, and lets waiting threads run pending tasks
+ * themselves by claiming the slot of a token that has not started yet.
+ */
+struct TaskQueue::State {
+    explicit State(TaskScheduler& scheduler_, TaskPriority priority_, size_t max_concurrency_)
+        : scheduler{scheduler_}, priority{priority_}, max_concurrency{max_concurrency_} {}
+
+    /// Submits tokens until every pending task has one or the concurrency limit is reached.
+    void Refill(const std::shared_ptr<State>& self) {
+        while (pending.size() > queued_tokens && running + queued_tokens < max_concurrency) {
+            ++queued_tokens;
+            scheduler.Submit(priority, [self] { self->RunToken(self); });
+        }
+    }
+
+    /// Pops and runs the oldest pending task. The lock is released while the task runs.
+    void RunOne(std::unique_lock<std::mutex>& lock, const std::shared_ptr<State>& self) {
+        Task task = std::move(pending.front());
+        pending.pop();
+        ++running;
+        lock.unlock();
+        task();
+        task = {};
+        lock.lock();
+        --running;
+        Refill(self);
+        condition.notify_all();
+    }
+
+    void RunToken(const std::shared_ptr<State>& self) {
+        std::unique_lock lock{mutex};
+        if (claimed_tokens > 0) {
+            // A waiting thread already took over this token's slot.
+            --claimed_tokens;
+            return;
+        }
+        --queued_tokens;
+        if (pending.empty()) {
+            condition.notify_all();
+            return;
+        }
+        RunOne(lock, self);
+    }
+
+    /// Takes a concurrency slot for the calling thread, if one is available.
+    bool TryClaimSlot() {
+        if (pending.empty()) {
+            return false;
+        }
+        if (running + queued_tokens < max_concurrency) {
+            return true;
+        }
+        if (queued_tokens > 0) {
+            --queued_tokens;
+            ++claimed_tokens;
+            return true;
+        }
+        return false;
+    }
+
+    bool CanHelp() const {
+        return !pending.empty() && (running + queued_tokens < max_concurrency || queued_tokens > 0);
+    }
+
+    void DiscardPending() {
+        std::queue<Task> discarded;
+        std::swap(discarded, pending);
+    }
+
+    TaskScheduler& scheduler;
+    const TaskPriority priority;
+    const size_t max_concurrency;
+
+    std::mutex mutex;
+    std::condition_variable_any condition;
+    std::queue<Task> pending;
+    size_t queued_tokens{};
+    size_t claimed_tokens{};
+    size_t running{};
+};
+
+TaskQueue::TaskQueue(TaskPriority priority, size_t max_concurrency, TaskScheduler& scheduler)
+    : state{std::make_shared<State>(scheduler, priority, std::max<size_t>(max_concurrency, 1))} {}
+
+TaskQueue::~TaskQueue() {
+    std::unique_lock lock{state->mutex};
+    state->DiscardPending();
+    state->condition.wait(lock, [this] { return state->running == 0; });
+}
+
+void TaskQueue::QueueWork(Task work) {
+    std::scoped_lock lock{state->mutex};
+    state->pending.push(std::move(work));
+    state->Refill(state);
+}
+
+void TaskQueue::WaitForRequests(std::stop_token stop_token) {
+    std::unique_lock lock{state->mutex};
+    while (true) {
+        if (stop_token.stop_requested()) {
+            state->DiscardPending();
+        }
+        if (state->pending.empty() && state->running == 0) {
+            return;
+        }
+        if (state->TryClaimSlot()) {
+            state->RunOne(lock, state);
+            continue;
+        }
+        const auto can_proceed = [this] {
+            return (state->pending.empty() && state->running == 0) || state->CanHelp();
+        };
+        if (stop_token.stop_requested()) {
+            state->condition.wait(lock, can_proceed);
+        } else {
+            state->condition.wait(lock, stop_token, can_proceed);
+        }
+    }
+}
+
+} // namespace Common
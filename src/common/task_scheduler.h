@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
+
+namespace Common {
+
+/// Priority classes of the process-wide task scheduler, from most to least urgent.
+enum class TaskPriority : u32 {
+    FrameCritical,    ///< Work the current frame is blocked on, e.g. synchronous texture decodes.
+    ShaderCompile,    ///< Shader and pipeline builds.
+    TextureTranscode, ///< Asynchronous texture decoding and transcoding.
+    BackgroundIO,     ///< Work nobody is waiting on, e.g. writing caches to disk.
+    Count,
+};
+
+/**
+ * Process-wide work-stealing thread pool shared by all subsystems.
+ *
+ * Every worker owns a deque per priority class; tasks submitted from a worker go to its own
+ * deque, tasks submitted from other threads go to a shared injection queue. Idle workers steal
+ * from each other. Workers always pick the most urgent task available, so a backlog of low
+ * priority work can never delay more urgent work by more than one task.
+ *
+ * Subsystems should not submit to the scheduler directly but go through a TaskQueue.
+ */
+class TaskScheduler {
+public:
+    using Task = UniqueFunction<void>;
+
+    explicit TaskScheduler(size_t num_workers);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    TaskScheduler(TaskScheduler&&) = delete;
+    TaskScheduler& operator=(TaskScheduler&&) = delete;
+
+    /// Returns the scheduler shared by the whole process, sized from the host's thread count.
+    [[nodiscard]] static TaskScheduler& Instance();
+
+    /// Queues a task to be run on one of the workers.
+    void Submit(TaskPriority priority, Task task);
+
+    [[nodiscard]] size_t NumWorkers() const noexcept {
+        return workers.size();
+    }
+
+private:
+    static constexpr size_t NumPriorities = static_cast<size_t>(TaskPriority::Count);
+
+    using TaskDeques = std::array<std::deque<Task>, NumPriorities>;
+
+    struct Worker {
+        std::mutex mutex;
+        TaskDeques deques;
+        std::jthread thread;
+    };
+
+    void WorkerLoop(std::stop_token stop_token, size_t index);
+
+    bool TryPop(size_t index, Task& task);
+
+    TaskDeques injection_queues;
+    std::mutex injection_mutex;
+
+    std::atomic<size_t> num_pending{};
+    std::mutex sleep_mutex;
+    std::condition_variable_any sleep_condition;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+};
+
+/**
+ * View onto the process-wide TaskScheduler with a fixed priority and a concurrency limit.
+ *
+ * Tasks queued on the same TaskQueue start in FIFO order, and at most max_concurrency of them run
+ * at the same time, so a queue with a limit of one behaves like a dedicated serial thread.
+ * Drop-in replacement for a Common::ThreadWorker owning its own threads.
+ */
+class TaskQueue {
+public:
+    using Task = UniqueFunction<void>;
+
+    explicit TaskQueue(TaskPriority priority, size_t max_concurrency,
+                       TaskScheduler& scheduler = TaskScheduler::Instance());
+    ~TaskQueue();
+
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    TaskQueue(TaskQueue&&) = delete;
+    TaskQueue& operator=(TaskQueue&&) = delete;
+
+    void QueueWork(Task work);
+
+    /**
+     * Waits until every task queued so far has finished. The calling thread helps running the
+     * queued tasks while waiting. When stop_token is triggered, tasks that have not started yet
+     * are discarded.
+     */
+    void WaitForRequests(std::stop_token stop_token = {});
+
+private:
+    struct State;
+
+    std::shared_ptr<State> state;
+};
+
+} // namespace Common
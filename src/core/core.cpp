@@ -398,6 +398,32 @@ struct System::Impl {
         return status;
     }
 
+    SystemResultStatus SetupForGPUReplay(System& system, Frontend::EmuWindow& emu_window) {
+        InitializeKernel(system);
+
+        telemetry_session = std::make_unique<Core::TelemetrySession>();
+
+        host1x_core = std::make_unique<Tegra::Host1x::Host1x>(system);
+        gpu_core = VideoCore::CreateGPU(emu_window, system);
+        if (!gpu_core) {
+            LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                         static_cast<int>(SystemResultStatus::ErrorVideoCore));
+            ShutdownMainProcess();
+            return SystemResultStatus::ErrorVideoCore;
+        }
+
+        // Replays have no application, and nothing but the GPU runs.
+        is_powered_on = true;
+        exit_locked = false;
+        exit_requested = false;
+
+        perf_stats = std::make_unique<PerfStats>(0);
+        GetAndResetPerfStats();
+
+        status = SystemResultStatus::Success;
+        return status;
+    }
+
     void ShutdownMainProcess() {
         SetShuttingDown(true);
 
@@ -558,6 +584,7 @@ struct System::Impl {
     std::stop_source stop_event;
 
     std::array<u64, Core::Hardware::NUM_CPU_CORES> dynarmic_ticks{};
+    std::array<PerfStats::Clock::time_point, Core::Hardware::NUM_CPU_CORES> cpu_enter_time{};
     std::array<MicroProfileToken, Core::Hardware::NUM_CPU_CORES> microprofile_cpu{};
 
     std::array<Core::GPUDirtyMemoryManager, Core::Hardware::NUM_CPU_CORES>
@@ -637,6 +664,10 @@ SystemResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::stri
     return impl->Load(*this, emu_window, filepath, params);
 }
 
+SystemResultStatus System::SetupForGPUReplay(Frontend::EmuWindow& emu_window) {
+    return impl->SetupForGPUReplay(*this, emu_window);
+}
+
 bool System::IsPoweredOn() const {
     return impl->is_powered_on.load(std::memory_order::relaxed);
 }
@@ -948,11 +979,15 @@ void System::RegisterHostThread() {
 void System::EnterCPUProfile() {
     std::size_t core = impl->kernel.GetCurrentHostThreadID();
     impl->dynarmic_ticks[core] = MicroProfileEnter(impl->microprofile_cpu[core]);
+    impl->cpu_enter_time[core] = PerfStats::Clock::now();
 }
 
 void System::ExitCPUProfile() {
     std::size_t core = impl->kernel.GetCurrentHostThreadID();
     MicroProfileLeave(impl->microprofile_cpu[core], impl->dynarmic_ticks[core]);
+    if (impl->perf_stats) {
+        impl->perf_stats->AddCoreTime(core, PerfStats::Clock::now() - impl->cpu_enter_time[core]);
+    }
 }
 
 bool System::IsMulticore() const {
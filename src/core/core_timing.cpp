@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <tuple>
@@ -26,6 +27,7 @@ std::shared_ptr<EventType> CreateEvent(std::string name, TimedCallback&& callbac
     return std::make_shared<EventType>(std::move(callback), std::move(name));
 }
 
+#ifndef SUYU_CORE_TIMING_WHEEL
 struct CoreTiming::Event {
     s64 time;
     u64 fifo_order;
@@ -43,6 +45,7 @@ struct CoreTiming::Event {
         return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
     }
 };
+#endif
 
 CoreTiming::CoreTiming() : clock{Common::CreateOptimalClock()} {}
 
@@ -63,7 +66,9 @@ void CoreTiming::ThreadEntry(CoreTiming& instance) {
 void CoreTiming::Initialize(std::function<void()>&& on_thread_init_) {
     Reset();
     on_thread_init = std::move(on_thread_init_);
+#ifndef SUYU_CORE_TIMING_WHEEL
     event_fifo_id = 0;
+#endif
     shutting_down = false;
     cpu_ticks = 0;
     if (is_multicore) {
@@ -72,8 +77,13 @@ void CoreTiming::Initialize(std::function<void()>&& on_thread_init_) {
 }
 
 void CoreTiming::ClearPendingEvents() {
+#ifdef SUYU_CORE_TIMING_WHEEL
+    std::scoped_lock lock{advance_lock};
+    event_queue.Clear();
+#else
     std::scoped_lock lock{advance_lock, basic_lock};
     event_queue.clear();
+#endif
     event.Set();
 }
 
@@ -111,12 +121,23 @@ bool CoreTiming::IsRunning() const {
 }
 
 bool CoreTiming::HasPendingEvents() const {
+#ifdef SUYU_CORE_TIMING_WHEEL
+    return !(wait_set && event_queue.Empty());
+#else
     std::scoped_lock lock{basic_lock};
     return !(wait_set && event_queue.empty());
+#endif
 }
 
 void CoreTiming::ScheduleEvent(std::chrono::nanoseconds ns_into_future,
                                const std::shared_ptr<EventType>& event_type, bool absolute_time) {
+#ifdef SUYU_CORE_TIMING_WHEEL
+    const auto next_time{absolute_time ? ns_into_future : GetGlobalTimeNs() + ns_into_future};
+    event_queue.Push(next_time.count(), event_type, 0);
+    if (next_time.count() < wakeup_time.load()) {
+        event.Set();
+    }
+#else
     {
         std::scoped_lock scope{basic_lock};
         const auto next_time{absolute_time ? ns_into_future : GetGlobalTimeNs() + ns_into_future};
@@ -126,12 +147,20 @@ void CoreTiming::ScheduleEvent(std::chrono::nanoseconds ns_into_future,
     }
 
     event.Set();
+#endif
 }
 
 void CoreTiming::ScheduleLoopingEvent(std::chrono::nanoseconds start_time,
                                       std::chrono::nanoseconds resched_time,
                                       const std::shared_ptr<EventType>& event_type,
                                       bool absolute_time) {
+#ifdef SUYU_CORE_TIMING_WHEEL
+    const auto next_time{absolute_time ? start_time : GetGlobalTimeNs() + start_time};
+    event_queue.Push(next_time.count(), event_type, resched_time.count());
+    if (next_time.count() < wakeup_time.load()) {
+        event.Set();
+    }
+#else
     {
         std::scoped_lock scope{basic_lock};
         const auto next_time{absolute_time ? start_time : GetGlobalTimeNs() + start_time};
@@ -142,10 +171,17 @@ void CoreTiming::ScheduleLoopingEvent(std::chrono::nanoseconds start_time,
     }
 
     event.Set();
+#endif
 }
 
 void CoreTiming::UnscheduleEvent(const std::shared_ptr<EventType>& event_type,
                                  UnscheduleEventType type) {
+#ifdef SUYU_CORE_TIMING_WHEEL
+    // Wake the timer thread, which removes the queued events of this type when it advances, so it
+    // does not keep waiting for one of them.
+    event_queue.Cancel(*event_type);
+    event.Set();
+#else
     {
         std::scoped_lock lk{basic_lock};
 
@@ -163,6 +199,7 @@ void CoreTiming::UnscheduleEvent(const std::shared_ptr<EventType>& event_type,
 
         event_type->sequence_number++;
     }
+#endif
 
     // Force any in-progress events to finish
     if (type == UnscheduleEventType::Wait) {
@@ -197,6 +234,54 @@ u64 CoreTiming::GetGPUTicks() const {
     return Common::WallClock::CPUTickToGPUTick(cpu_ticks);
 }
 
+#ifdef SUYU_CORE_TIMING_WHEEL
+std::optional<s64> CoreTiming::Advance() {
+    std::scoped_lock lock{advance_lock};
+    while (true) {
+        global_timer = GetGlobalTimeNs().count();
+        event_queue.Advance(global_timer);
+
+        while (auto evt = event_queue.PopDue(global_timer)) {
+            const auto event_type{evt->type.lock()};
+            if (!event_type || evt->sequence_number != event_type->sequence_number) {
+                // The event was unscheduled.
+                continue;
+            }
+
+            const auto evt_time = evt->time;
+            const auto new_schedule_time{event_type->callback(
+                evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time})};
+
+            if (evt->reschedule_time != 0 && evt->sequence_number == event_type->sequence_number) {
+                const auto next_schedule_time{new_schedule_time.has_value()
+                                                  ? new_schedule_time.value().count()
+                                                  : evt->reschedule_time};
+
+                // If this event was scheduled into a pause, its time now is going to be way
+                // behind. Re-set this event to continue from the end of the pause.
+                auto next_time{evt_time + next_schedule_time};
+                if (evt_time < pause_end_time) {
+                    next_time = pause_end_time + next_schedule_time;
+                }
+
+                evt->reschedule_time = next_schedule_time;
+                event_queue.Reschedule(std::move(evt), next_time);
+            }
+
+            global_timer = GetGlobalTimeNs().count();
+            event_queue.Advance(global_timer);
+        }
+
+        // Publish the wakeup time before checking for new events, so any event pushed after the
+        // check sees it and signals the timer thread if it is due earlier.
+        const auto next_time = event_queue.NextTime();
+        wakeup_time.store(next_time.value_or(std::numeric_limits<s64>::max()));
+        if (!event_queue.HasIncoming()) {
+            return next_time;
+        }
+    }
+}
+#else
 std::optional<s64> CoreTiming::Advance() {
     std::scoped_lock lock{advance_lock, basic_lock};
     global_timer = GetGlobalTimeNs().count();
@@ -206,7 +291,7 @@ std::optional<s64> CoreTiming::Advance() {
 
         if (const auto event_type{evt.type.lock()}) {
             const auto evt_time = evt.time;
-            const auto evt_sequence_num = event_type->sequence_number;
+            const auto evt_sequence_num = event_type->sequence_number.load();
 
             if (evt.reschedule_time == 0) {
                 event_queue.pop();
@@ -255,6 +340,7 @@ std::optional<s64> CoreTiming::Advance() {
         return std::nullopt;
     }
 }
+#endif
 
 void CoreTiming::ThreadLoop() {
     has_started = true;
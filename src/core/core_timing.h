@@ -12,12 +12,18 @@
 #include <string>
 #include <thread>
 
+#ifndef SUYU_CORE_TIMING_WHEEL
 #include <boost/heap/fibonacci_heap.hpp>
+#endif
 
 #include "common/common_types.h"
 #include "common/thread.h"
 #include "common/wall_clock.h"
 
+#ifdef SUYU_CORE_TIMING_WHEEL
+#include "core/core_timing_wheel.h"
+#endif
+
 namespace Core::Timing {
 
 /// A callback that may be scheduled for a particular core timing event.
@@ -35,7 +41,7 @@ struct EventType {
     const std::string name;
     /// A monotonic sequence number, incremented when this event is
     /// changed externally.
-    size_t sequence_number;
+    std::atomic<size_t> sequence_number;
 };
 
 enum class UnscheduleEventType {
@@ -139,7 +145,9 @@ public:
 #endif
 
 private:
+#ifndef SUYU_CORE_TIMING_WHEEL
     struct Event;
+#endif
 
     static void ThreadEntry(CoreTiming& instance);
     void ThreadLoop();
@@ -154,11 +162,17 @@ private:
     s64 timer_resolution_ns;
 #endif
 
+#ifdef SUYU_CORE_TIMING_WHEEL
+    TimerWheel event_queue;
+    /// Time the timer thread wakes up on its own, producers only signal it for earlier events.
+    std::atomic<s64> wakeup_time{};
+#else
     using heap_t =
         boost::heap::fibonacci_heap<CoreTiming::Event, boost::heap::compare<std::greater<>>>;
 
     heap_t event_queue;
     u64 event_fifo_id = 0;
+#endif
 
     Common::Event event{};
     Common::Event pause_event{};
@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <tuple>
+#include <vector>
+
+#include "core/core_timing.h"
+#include "core/core_timing_wheel.h"
+
+namespace Core::Timing {
+
+namespace {
+
+/// Orders the ready heap so the earliest event is at the front.
+bool LaterThan(const TimerWheel::Event* left, const TimerWheel::Event* right) {
+    return std::tie(left->time, left->fifo_order) > std::tie(right->time, right->fifo_order);
+}
+
+/// Returns true if the type of the event was destroyed or cancelled since it was pushed.
+bool IsCancelled(const TimerWheel::Event& event) {
+    const auto type = event.type.lock();
+    return !type || event.sequence_number != type->sequence_number.load(std::memory_order_relaxed);
+}
+
+} // Anonymous namespace
+
+TimerWheel::TimerWheel() = default;
+
+TimerWheel::~TimerWheel() {
+    Clear();
+}
+
+void TimerWheel::Push(s64 time, const std::shared_ptr<EventType>& type, s64 reschedule_time) {
+    // Spread producer threads over the inboxes, the assignment only has to be stable per thread.
+    static std::atomic<size_t> next_inbox{};
+    thread_local const size_t inbox_index = next_inbox.fetch_add(1, std::memory_order_relaxed);
+
+    auto* const event = new Event{
+        .time = time,
+        .fifo_order = fifo_id.fetch_add(1, std::memory_order_relaxed),
+        .type = type,
+        .reschedule_time = reschedule_time,
+        .sequence_number = type->sequence_number.load(std::memory_order_relaxed),
+        .next = nullptr,
+    };
+    num_events.fetch_add(1, std::memory_order_relaxed);
+
+    std::atomic<Event*>& head = inboxes[inbox_index % NumInboxes].head;
+    event->next = head.load(std::memory_order_relaxed);
+    // Sequentially consistent, so a consumer checking HasIncoming after publishing its wakeup
+    // time either sees this event or the producer sees the new wakeup time.
+    while (!head.compare_exchange_weak(event->next, event, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+    }
+}
+
+bool TimerWheel::HasIncoming() const {
+    return std::ranges::any_of(inboxes, [](const Inbox& inbox) {
+        return inbox.head.load(std::memory_order_seq_cst) != nullptr;
+    });
+}
+
+bool TimerWheel::Empty() const {
+    return num_events.load(std::memory_order_relaxed) == 0;
+}
+
+void TimerWheel::Cancel(EventType& type) {
+    type.sequence_number.fetch_add(1, std::memory_order_relaxed);
+    has_cancelled.store(true, std::memory_order_release);
+}
+
+void TimerWheel::Advance(s64 now) {
+    DrainInboxes();
+    if (has_cancelled.exchange(false, std::memory_order_acquire)) {
+        DropCancelled();
+    }
+
+    const u64 now_tick = TickOf(now);
+    while (true) {
+        const auto level_it =
+            std::ranges::find_if(occupied, [](u64 bitmap) { return bitmap != 0; });
+        if (level_it == occupied.end()) {
+            break;
+        }
+        // All slots of a level are ahead of the current tick and lower levels are always earlier,
+        // so the lowest occupied slot of the lowest occupied level holds the earliest events.
+        const u32 level = static_cast<u32>(std::distance(occupied.begin(), level_it));
+        const u32 slot = static_cast<u32>(std::countr_zero(*level_it));
+        const u64 start = SlotStart(level, slot);
+        if (start > now_tick) {
+            break;
+        }
+        current_tick = start;
+
+        // Cascade the events of the slot to the lower levels, or to the ready queue.
+        Event* event = std::exchange(slots[level][slot], nullptr);
+        occupied[level] &= ~(u64{1} << slot);
+        while (event != nullptr) {
+            Event* const next = event->next;
+            Insert(event);
+            event = next;
+        }
+    }
+
+    if (now_tick <= current_tick) {
+        return;
+    }
+    const bool crossed_wheel = (now_tick >> WheelBits) != (current_tick >> WheelBits);
+    current_tick = now_tick;
+    if (crossed_wheel && !overflow.empty()) {
+        // The wheel now covers a different range, some overflowed events may fit in it.
+        std::vector<Event*> pending;
+        pending.swap(overflow);
+        for (Event* const event : pending) {
+            Insert(event);
+        }
+    }
+}
+
+std::unique_ptr<TimerWheel::Event> TimerWheel::PopDue(s64 now) {
+    if (ready.empty() || ready.front()->time > now) {
+        return nullptr;
+    }
+    std::ranges::pop_heap(ready, LaterThan);
+    std::unique_ptr<Event> event{ready.back()};
+    ready.pop_back();
+    num_events.fetch_sub(1, std::memory_order_relaxed);
+    return event;
+}
+
+void TimerWheel::Reschedule(std::unique_ptr<Event> event, s64 time) {
+    event->time = time;
+    event->fifo_order = fifo_id.fetch_add(1, std::memory_order_relaxed);
+    num_events.fetch_add(1, std::memory_order_relaxed);
+    Insert(event.release());
+}
+
+std::optional<s64> TimerWheel::NextTime() const {
+    if (!ready.empty()) {
+        return ready.front()->time;
+    }
+    for (u32 level = 0; level < NumLevels; ++level) {
+        if (occupied[level] != 0) {
+            const u32 slot = static_cast<u32>(std::countr_zero(occupied[level]));
+            return static_cast<s64>(SlotStart(level, slot) << TickShift);
+        }
+    }
+    if (!overflow.empty()) {
+        return (*std::ranges::min_element(overflow, {}, &Event::time))->time;
+    }
+    return std::nullopt;
+}
+
+void TimerWheel::Clear() {
+    DrainInboxes();
+    size_t num_deleted = 0;
+    for (u32 level = 0; level < NumLevels; ++level) {
+        for (Event*& head : slots[level]) {
+            num_deleted += DeleteList(std::exchange(head, nullptr));
+        }
+        occupied[level] = 0;
+    }
+    for (std::vector<Event*>* const list : {&overflow, &ready}) {
+        for (Event* const event : *list) {
+            delete event;
+        }
+        num_deleted += list->size();
+        list->clear();
+    }
+    num_events.fetch_sub(num_deleted, std::memory_order_relaxed);
+}
+
+u64 TimerWheel::TickOf(s64 time) {
+    return static_cast<u64>(std::max<s64>(time, 0)) >> TickShift;
+}
+
+void TimerWheel::Insert(Event* event) {
+    const u64 tick = TickOf(event->time);
+    if (tick <= current_tick) {
+        ready.push_back(event);
+        std::ranges::push_heap(ready, LaterThan);
+        return;
+    }
+    // The level is given by the highest bit that differs from the current tick.
+    const u32 level = (static_cast<u32>(std::bit_width(tick ^ current_tick)) - 1) / LevelBits;
+    if (level >= NumLevels) {
+        overflow.push_back(event);
+        return;
+    }
+    const u32 slot = static_cast<u32>(tick >> (level * LevelBits)) & (SlotsPerLevel - 1);
+    event->next = slots[level][slot];
+    slots[level][slot] = event;
+    occupied[level] |= u64{1} << slot;
+}
+
+void TimerWheel::DrainInboxes() {
+    for (Inbox& inbox : inboxes) {
+        Event* event = inbox.head.exchange(nullptr, std::memory_order_acquire);
+        while (event != nullptr) {
+            Event* const next = event->next;
+            Insert(event);
+            event = next;
+        }
+    }
+}
+
+void TimerWheel::DropCancelled() {
+    size_t num_dropped = 0;
+    const auto drop = [&num_dropped](Event* event) {
+        if (!IsCancelled(*event)) {
+            return false;
+        }
+        delete event;
+        ++num_dropped;
+        return true;
+    };
+
+    for (u32 level = 0; level < NumLevels; ++level) {
+        for (u32 slot = 0; slot < SlotsPerLevel; ++slot) {
+            Event** link = &slots[level][slot];
+            while (Event* const event = *link) {
+                Event* const next = event->next;
+                if (drop(event)) {
+                    *link = next;
+                } else {
+                    link = &event->next;
+                }
+            }
+            if (slots[level][slot] == nullptr) {
+                occupied[level] &= ~(u64{1} << slot);
+            }
+        }
+    }
+    std::erase_if(overflow, drop);
+    if (std::erase_if(ready, drop) != 0) {
+        std::ranges::make_heap(ready, LaterThan);
+    }
+    num_events.fetch_sub(num_dropped, std::memory_order_relaxed);
+}
+
+u64 TimerWheel::SlotStart(u32 level, u32 slot) const {
+    const u32 shift = level * LevelBits;
+    const u64 upper = (current_tick >> (shift + LevelBits)) << (shift + LevelBits);
+    return upper | (u64{slot} << shift);
+}
+
+size_t TimerWheel::DeleteList(Event* event) {
+    size_t count = 0;
+    while (event != nullptr) {
+        delete std::exchange(event, event->next);
+        ++count;
+    }
+    return count;
+}
+
+} // namespace Core::Timing
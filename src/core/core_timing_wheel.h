@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Core::Timing {
+
+struct EventType;
+
+/**
+ * Hierarchical timer wheel used as the event queue of CoreTiming when built with
+ * SUYU_CORE_TIMING_WHEEL.
+ *
+ * Any thread can Push events without taking a lock; pushed events land in one of several
+ * lock-free inboxes, picked per producer thread to keep producers off each other's cache lines.
+ * Everything else must be called by a single consumer at a time (CoreTiming holds advance_lock),
+ * which moves the inboxes into the wheel and collects the events that are due.
+ *
+ * Cancelling a type increments its sequence number and flags the wheel, and the consumer removes
+ * the events of cancelled types from the wheel the next time it advances, so they neither wake it
+ * up nor count as queued afterwards. Every event also remembers the sequence number of its type
+ * when it was pushed, so an event pushed while its type is cancelled is still dropped when due.
+ */
+class TimerWheel {
+public:
+    struct Event {
+        s64 time;
+        u64 fifo_order;
+        std::weak_ptr<EventType> type;
+        s64 reschedule_time;
+        size_t sequence_number;
+        Event* next;
+    };
+
+    TimerWheel();
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    TimerWheel(TimerWheel&&) = delete;
+    TimerWheel& operator=(TimerWheel&&) = delete;
+
+    /// Queues an event for the given absolute time. Thread-safe and lock-free.
+    void Push(s64 time, const std::shared_ptr<EventType>& type, s64 reschedule_time);
+
+    /// Returns true if there are pushed events the consumer has not collected yet. Thread-safe.
+    [[nodiscard]] bool HasIncoming() const;
+
+    /// Returns true if no events are queued, including cancelled ones not dropped yet. Thread-safe.
+    [[nodiscard]] bool Empty() const;
+
+    /// Unschedules the queued events of a type, they are removed at the next Advance. Thread-safe.
+    void Cancel(EventType& type);
+
+    /// Collects the pushed events, drops the cancelled ones and advances the wheel to the time.
+    void Advance(s64 now);
+
+    /// Removes and returns the earliest event due at the given time, if any.
+    [[nodiscard]] std::unique_ptr<Event> PopDue(s64 now);
+
+    /// Queues a popped event again for the given time, without going through the inboxes.
+    void Reschedule(std::unique_ptr<Event> event, s64 time);
+
+    /**
+     * Returns the time of the earliest event, or a time before it when the event is still in one
+     * of the coarse levels of the wheel. Advancing to that time makes the result more precise.
+     */
+    [[nodiscard]] std::optional<s64> NextTime() const;
+
+    /// Drops every queued event.
+    void Clear();
+
+private:
+    /// Each tick of the wheel is 1024ns.
+    static constexpr u32 TickShift = 10;
+    static constexpr u32 LevelBits = 6;
+    static constexpr u32 SlotsPerLevel = 1U << LevelBits;
+    /// Six levels of 64 slots cover 2^36 ticks, about 19.5 hours, beyond that events overflow.
+    static constexpr u32 NumLevels = 6;
+    static constexpr u32 WheelBits = LevelBits * NumLevels;
+    static constexpr size_t NumInboxes = 8;
+
+    struct alignas(64) Inbox {
+        std::atomic<Event*> head{};
+    };
+
+    static u64 TickOf(s64 time);
+
+    /// Places an event in the ready queue, a slot of the wheel or the overflow list.
+    void Insert(Event* event);
+
+    /// Moves the events of the inboxes into the wheel.
+    void DrainInboxes();
+
+    /// Removes the events whose type was cancelled since they were pushed.
+    void DropCancelled();
+
+    /// Returns the start tick of a slot, relative to the current tick.
+    [[nodiscard]] u64 SlotStart(u32 level, u32 slot) const;
+
+    /// Deletes a list of events and returns how many there were.
+    static size_t DeleteList(Event* event);
+
+    std::array<Inbox, NumInboxes> inboxes{};
+    std::atomic<u64> fifo_id{};
+    std::atomic<size_t> num_events{};
+    std::atomic<bool> has_cancelled{};
+
+    u64 current_tick{};
+    std::array<std::array<Event*, SlotsPerLevel>, NumLevels> slots{};
+    std::array<u64, NumLevels> occupied{};
+    std::vector<Event*> overflow;
+    /// Events due at or before the current tick, kept as a min-heap on (time, fifo_order).
+    std::vector<Event*> ready;
+};
+
+} // namespace Core::Timing
@@ -0,0 +1,370 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+#include <mbedtls/aes.h>
+
+#if defined(ARCHITECTURE_arm64)
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+#include "common/assert.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/task_scheduler.h"
+#include "core/crypto/aes_engine.h"
+#include "core/crypto/aes_engine_backends.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Core::Crypto {
+
+namespace {
+
+using namespace Common::Literals;
+using AesBackends::AesRoundKeys;
+using AesBackends::BlockSize;
+using AesBackends::NumRounds;
+
+/// Requests at least this big are split across the workers of the task scheduler.
+constexpr std::size_t ParallelThreshold = 1_MiB;
+/// Size of the pieces requests are split into.
+constexpr std::size_t ChunkSize = 256_KiB;
+
+constexpr u8 Multiply(u8 a, u8 b) {
+    u8 result = 0;
+    while (b != 0) {
+        if (b & 1) {
+            result ^= a;
+        }
+        a = static_cast<u8>((a << 1) ^ ((a & 0x80) ? 0x1B : 0));
+        b >>= 1;
+    }
+    return result;
+}
+
+constexpr u8 RotateLeft(u8 value, u32 shift) {
+    return static_cast<u8>((value << shift) | (value >> (8 - shift)));
+}
+
+constexpr std::array<u8, 256> MakeSbox() {
+    // Walks the multiplicative group with p going through the powers of 3 and q through those of
+    // its inverse, so q is the inverse of p at every step.
+    std::array<u8, 256> sbox{};
+    u8 p = 1;
+    u8 q = 1;
+    do {
+        p = static_cast<u8>(p ^ (p << 1) ^ ((p & 0x80) ? 0x1B : 0));
+        q = static_cast<u8>(q ^ (q << 1));
+        q = static_cast<u8>(q ^ (q << 2));
+        q = static_cast<u8>(q ^ (q << 4));
+        q = static_cast<u8>(q ^ ((q & 0x80) ? 0x09 : 0));
+        sbox[p] = q ^ RotateLeft(q, 1) ^ RotateLeft(q, 2) ^ RotateLeft(q, 3) ^ RotateLeft(q, 4) ^
+                  0x63;
+    } while (p != 1);
+    sbox[0] = 0x63;
+    return sbox;
+}
+
+constexpr std::array<u8, 256> Sbox = MakeSbox();
+static_assert(Sbox[0x00] == 0x63 && Sbox[0x53] == 0xED && Sbox[0xFF] == 0x16);
+
+/// Expands an AES-128 key into the round keys of the cipher and of the equivalent inverse cipher.
+AesRoundKeys ExpandKey(std::span<const u8, BlockSize> key) {
+    static constexpr std::array<u8, NumRounds> RoundConstants{0x01, 0x02, 0x04, 0x08, 0x10,
+                                                              0x20, 0x40, 0x80, 0x1B, 0x36};
+    AesRoundKeys keys{};
+    u8* const words = keys.encrypt.data();
+    std::memcpy(words, key.data(), BlockSize);
+    for (std::size_t i = 4; i < (NumRounds + 1) * 4; ++i) {
+        const u8* const previous = words + (i - 1) * 4;
+        std::array<u8, 4> temp{previous[0], previous[1], previous[2], previous[3]};
+        if (i % 4 == 0) {
+            temp = {static_cast<u8>(Sbox[temp[1]] ^ RoundConstants[i / 4 - 1]), Sbox[temp[2]],
+                    Sbox[temp[3]], Sbox[temp[0]]};
+        }
+        for (std::size_t j = 0; j < 4; ++j) {
+            words[i * 4 + j] = words[(i - 4) * 4 + j] ^ temp[j];
+        }
+    }
+
+    // The inverse cipher uses the round keys in reverse order, with InvMixColumns applied to all
+    // but the first and the last.
+    for (std::size_t round = 0; round <= NumRounds; ++round) {
+        const u8* const in = keys.encrypt.data() + (NumRounds - round) * BlockSize;
+        u8* const out = keys.decrypt.data() + round * BlockSize;
+        if (round == 0 || round == NumRounds) {
+            std::memcpy(out, in, BlockSize);
+            continue;
+        }
+        for (std::size_t column = 0; column < 4; ++column) {
+            const u8* const a = in + column * 4;
+            u8* const b = out + column * 4;
+            b[0] = Multiply(a[0], 14) ^ Multiply(a[1], 11) ^ Multiply(a[2], 13) ^ Multiply(a[3], 9);
+            b[1] = Multiply(a[0], 9) ^ Multiply(a[1], 14) ^ Multiply(a[2], 11) ^ Multiply(a[3], 13);
+            b[2] = Multiply(a[0], 13) ^ Multiply(a[1], 9) ^ Multiply(a[2], 14) ^ Multiply(a[3], 11);
+            b[3] = Multiply(a[0], 11) ^ Multiply(a[1], 13) ^ Multiply(a[2], 9) ^ Multiply(a[3], 14);
+        }
+    }
+    return keys;
+}
+
+/// Big endian 128-bit counter, as used for CTR counters and XTS tweaks.
+struct Counter128 {
+    u64 hi;
+    u64 lo;
+
+    static Counter128 Load(std::span<const u8, BlockSize> bytes) {
+        Counter128 counter;
+        std::memcpy(&counter.hi, bytes.data(), sizeof(u64));
+        std::memcpy(&counter.lo, bytes.data() + sizeof(u64), sizeof(u64));
+        return {Common::swap64(counter.hi), Common::swap64(counter.lo)};
+    }
+
+    void Store(u8* bytes) const {
+        const u64 hi_be = Common::swap64(hi);
+        const u64 lo_be = Common::swap64(lo);
+        std::memcpy(bytes, &hi_be, sizeof(u64));
+        std::memcpy(bytes + sizeof(u64), &lo_be, sizeof(u64));
+    }
+
+    [[nodiscard]] Counter128 operator+(u64 value) const {
+        const u64 sum = lo + value;
+        return {hi + (sum < lo ? 1 : 0), sum};
+    }
+};
+
+/**
+ * Calls func(first, count) for ranges of units covering [0, num_units). Large requests are
+ * split across the workers of the task scheduler, the calling thread taking part in the work.
+ */
+template <typename Func>
+void ForEachChunk(std::size_t num_units, std::size_t unit_size, Func&& func) {
+    if (num_units * unit_size < ParallelThreshold) {
+        func(std::size_t{0}, num_units);
+        return;
+    }
+    const std::size_t units_per_chunk = std::max<std::size_t>(ChunkSize / unit_size, 1);
+    auto& scheduler = Common::TaskScheduler::Instance();
+    Common::TaskQueue queue{Common::TaskPriority::FrameCritical, scheduler.NumWorkers(),
+                            scheduler};
+    for (std::size_t first = units_per_chunk; first < num_units; first += units_per_chunk) {
+        const std::size_t count = std::min(units_per_chunk, num_units - first);
+        queue.QueueWork([&func, first, count] { func(first, count); });
+    }
+    func(std::size_t{0}, std::min(units_per_chunk, num_units));
+    queue.WaitForRequests();
+}
+
+#if defined(ARCHITECTURE_arm64)
+bool HostHasArmCrypto() {
+#if defined(__APPLE__)
+    // Every Apple processor with an arm64 ABI implements the Crypto Extensions.
+    return true;
+#elif defined(_WIN32)
+    return IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+} // Anonymous namespace
+
+bool IsAesBackendSupported(AesBackend backend) {
+    switch (backend) {
+    case AesBackend::Software:
+        return true;
+#if defined(ARCHITECTURE_x86_64)
+    case AesBackend::AesNi: {
+        const auto& caps = Common::GetCPUCaps();
+        return caps.aes && caps.sse4_1;
+    }
+    case AesBackend::Vaes: {
+        const auto& caps = Common::GetCPUCaps();
+        return caps.aes && caps.sse4_1 && caps.avx2 && caps.vaes;
+    }
+#elif defined(ARCHITECTURE_arm64)
+    case AesBackend::ArmCrypto:
+        return HostHasArmCrypto();
+#endif
+    default:
+        return false;
+    }
+}
+
+AesBackend GetAesBackend() {
+    static const AesBackend backend = [] {
+        AesBackend best = AesBackend::Software;
+        for (const AesBackend candidate :
+             {AesBackend::Vaes, AesBackend::AesNi, AesBackend::ArmCrypto}) {
+            if (IsAesBackendSupported(candidate)) {
+                best = candidate;
+                break;
+            }
+        }
+        LOG_INFO(Crypto, "Using the {} AES engine", GetAesBackendName(best));
+        return best;
+    }();
+    return backend;
+}
+
+std::string_view GetAesBackendName(AesBackend backend) {
+    switch (backend) {
+    case AesBackend::Software:
+        return "software";
+    case AesBackend::AesNi:
+        return "AES-NI";
+    case AesBackend::Vaes:
+        return "VAES";
+    case AesBackend::ArmCrypto:
+        return "ARMv8 Crypto";
+    }
+    return "unknown";
+}
+
+struct AesCtrEngine::Impl {
+    AesRoundKeys keys;
+    AesBackends::CtrFunction function{};
+    mbedtls_aes_context context;
+
+    /// Transcodes whole blocks, starting at the given counter.
+    void TranscodeBlocks(const u8* src, u8* dest, std::size_t num_blocks, Counter128 counter) {
+        if (function != nullptr) {
+            function(keys, src, dest, num_blocks, counter.hi, counter.lo);
+            return;
+        }
+        std::array<u8, BlockSize> nonce_counter;
+        std::array<u8, BlockSize> stream_block;
+        std::size_t stream_offset = 0;
+        counter.Store(nonce_counter.data());
+        mbedtls_aes_crypt_ctr(&context, num_blocks * BlockSize, &stream_offset,
+                              nonce_counter.data(), stream_block.data(), src, dest);
+    }
+};
+
+AesCtrEngine::AesCtrEngine(std::span<const u8, 0x10> key, AesBackend backend)
+    : impl{std::make_unique<Impl>()} {
+    ASSERT(IsAesBackendSupported(backend));
+    impl->keys = ExpandKey(key);
+    mbedtls_aes_init(&impl->context);
+    switch (backend) {
+#if defined(ARCHITECTURE_x86_64)
+    case AesBackend::AesNi:
+        impl->function = &AesBackends::CtrAesNi;
+        break;
+    case AesBackend::Vaes:
+        impl->function = &AesBackends::CtrVaes;
+        break;
+#elif defined(ARCHITECTURE_arm64)
+    case AesBackend::ArmCrypto:
+        impl->function = &AesBackends::CtrArmCrypto;
+        break;
+#endif
+    default:
+        mbedtls_aes_setkey_enc(&impl->context, key.data(), 128);
+        break;
+    }
+}
+
+AesCtrEngine::~AesCtrEngine() {
+    mbedtls_aes_free(&impl->context);
+}
+
+void AesCtrEngine::Transcode(const u8* src, u8* dest, std::size_t size,
+                             std::span<const u8, 0x10> counter) const {
+    const Counter128 first_counter = Counter128::Load(counter);
+    const std::size_t num_blocks = size / BlockSize;
+    ForEachChunk(num_blocks, BlockSize, [&](std::size_t first, std::size_t count) {
+        impl->TranscodeBlocks(src + first * BlockSize, dest + first * BlockSize, count,
+                              first_counter + first);
+    });
+
+    // A partial last block uses the start of the key stream of its counter.
+    if (const std::size_t remainder = size % BlockSize; remainder != 0) {
+        const std::size_t offset = num_blocks * BlockSize;
+        std::array<u8, BlockSize> block{};
+        std::memcpy(block.data(), src + offset, remainder);
+        impl->TranscodeBlocks(block.data(), block.data(), 1, first_counter + num_blocks);
+        std::memcpy(dest + offset, block.data(), remainder);
+    }
+}
+
+struct AesXtsEngine::Impl {
+    AesRoundKeys data_keys;
+    AesRoundKeys tweak_keys;
+    AesBackends::XtsFunction function{};
+    mbedtls_aes_xts_context context;
+
+    /// Decrypts whole sectors, starting at the given tweak.
+    void DecryptSectors(const u8* src, u8* dest, std::size_t num_sectors,
+                        std::size_t sector_size, Counter128 tweak) {
+        if (function != nullptr) {
+            function(data_keys, tweak_keys, src, dest, num_sectors, sector_size, tweak.hi,
+                     tweak.lo);
+            return;
+        }
+        std::array<u8, BlockSize> data_unit;
+        for (std::size_t i = 0; i < num_sectors; ++i) {
+            (tweak + i).Store(data_unit.data());
+            mbedtls_aes_crypt_xts(&context, MBEDTLS_AES_DECRYPT, sector_size, data_unit.data(),
+                                  src + i * sector_size, dest + i * sector_size);
+        }
+    }
+};
+
+AesXtsEngine::AesXtsEngine(std::span<const u8, 0x20> key, AesBackend backend)
+    : impl{std::make_unique<Impl>()} {
+    ASSERT(IsAesBackendSupported(backend));
+    impl->data_keys = ExpandKey(key.first<BlockSize>());
+    impl->tweak_keys = ExpandKey(key.last<BlockSize>());
+    mbedtls_aes_xts_init(&impl->context);
+    switch (backend) {
+#if defined(ARCHITECTURE_x86_64)
+    case AesBackend::AesNi:
+        impl->function = &AesBackends::XtsDecryptAesNi;
+        break;
+    case AesBackend::Vaes:
+        impl->function = &AesBackends::XtsDecryptVaes;
+        break;
+#elif defined(ARCHITECTURE_arm64)
+    case AesBackend::ArmCrypto:
+        impl->function = &AesBackends::XtsDecryptArmCrypto;
+        break;
+#endif
+    default:
+        mbedtls_aes_xts_setkey_dec(&impl->context, key.data(), 256);
+        break;
+    }
+}
+
+AesXtsEngine::~AesXtsEngine() {
+    mbedtls_aes_xts_free(&impl->context);
+}
+
+void AesXtsEngine::Decrypt(const u8* src, u8* dest, std::size_t size, std::size_t sector_size,
+                           std::span<const u8, 0x10> tweak) const {
+    ASSERT(sector_size != 0 && sector_size % BlockSize == 0);
+    ASSERT_MSG(size % sector_size == 0, "XTS decryption size must be a multiple of sector size.");
+
+    const Counter128 first_tweak = Counter128::Load(tweak);
+    ForEachChunk(size / sector_size, sector_size, [&](std::size_t first, std::size_t count) {
+        impl->DecryptSectors(src + first * sector_size, dest + first * sector_size, count,
+                             sector_size, first_tweak + first);
+    });
+}
+
+} // namespace Core::Crypto
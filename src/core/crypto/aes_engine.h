@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include "common/common_types.h"
+
+namespace Core::Crypto {
+
+/// Implementations of the AES engines.
+enum class AesBackend {
+    Software,  ///< mbedtls, used when the host has no AES instructions.
+    AesNi,     ///< x86-64 AES-NI, eight blocks in flight.
+    Vaes,      ///< x86-64 VAES on 256-bit registers, sixteen blocks in flight.
+    ArmCrypto, ///< ARMv8 Crypto Extensions, eight blocks in flight.
+};
+
+/// Returns true if the host can run the given backend.
+[[nodiscard]] bool IsAesBackendSupported(AesBackend backend);
+
+/// Returns the fastest backend supported by the host.
+[[nodiscard]] AesBackend GetAesBackend();
+
+[[nodiscard]] std::string_view GetAesBackendName(AesBackend backend);
+
+/**
+ * AES-128-CTR engine for bulk data.
+ *
+ * Counters of consecutive blocks are generated in registers and many blocks are encrypted at
+ * once. Large requests are split across the workers of the task scheduler.
+ */
+class AesCtrEngine {
+public:
+    explicit AesCtrEngine(std::span<const u8, 0x10> key, AesBackend backend = GetAesBackend());
+    ~AesCtrEngine();
+
+    AesCtrEngine(const AesCtrEngine&) = delete;
+    AesCtrEngine& operator=(const AesCtrEngine&) = delete;
+
+    /**
+     * Encrypts or decrypts data, the two being the same operation in CTR mode.
+     *
+     * @param src     Data to transcode.
+     * @param dest    Output buffer, may be the same as src.
+     * @param size    Size of the data in bytes. Only the last block may be partial.
+     * @param counter Big endian counter of the first block, incremented for every block.
+     */
+    void Transcode(const u8* src, u8* dest, std::size_t size,
+                   std::span<const u8, 0x10> counter) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+/**
+ * AES-128-XTS decryption engine for bulk data.
+ *
+ * The tweaks of the blocks of a sector are derived in registers and many blocks are decrypted at
+ * once. Large requests are split across the workers of the task scheduler.
+ */
+class AesXtsEngine {
+public:
+    /// key holds the data key followed by the tweak key.
+    explicit AesXtsEngine(std::span<const u8, 0x20> key, AesBackend backend = GetAesBackend());
+    ~AesXtsEngine();
+
+    AesXtsEngine(const AesXtsEngine&) = delete;
+    AesXtsEngine& operator=(const AesXtsEngine&) = delete;
+
+    /**
+     * Decrypts whole sectors.
+     *
+     * @param src         Data to decrypt.
+     * @param dest        Output buffer, may be the same as src.
+     * @param size        Size of the data in bytes, a multiple of sector_size.
+     * @param sector_size Size of a sector in bytes, a multiple of the AES block size.
+     * @param tweak       Big endian tweak of the first sector, incremented for every sector.
+     */
+    void Decrypt(const u8* src, u8* dest, std::size_t size, std::size_t sector_size,
+                 std::span<const u8, 0x10> tweak) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace Core::Crypto
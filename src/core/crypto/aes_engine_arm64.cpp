@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <arm_neon.h>
+
+#include "common/swap.h"
+#include "core/crypto/aes_engine_backends.h"
+
+// This file is built with the Crypto Extensions enabled, its functions are only called after
+// checking the host supports them.
+
+#if defined(__GNUC__) || defined(__clang__)
+// Fully unrolled loops keep every block in flight in a register.
+#define UNROLL _Pragma("GCC unroll 16")
+#else
+#define UNROLL
+#endif
+
+namespace Core::Crypto::AesBackends {
+
+namespace {
+
+/// Number of blocks processed at once, enough to hide the latency of the AES instructions.
+constexpr std::size_t Lanes = 8;
+
+struct RoundKeys128 {
+    uint8x16_t keys[NumRounds + 1];
+};
+
+RoundKeys128 LoadRoundKeys(const std::array<u8, (NumRounds + 1) * BlockSize>& keys) {
+    RoundKeys128 result;
+    for (std::size_t i = 0; i <= NumRounds; ++i) {
+        result.keys[i] = vld1q_u8(keys.data() + i * BlockSize);
+    }
+    return result;
+}
+
+/// Returns the big endian byte representation of a 128-bit number.
+uint8x16_t MakeBlock(u64 hi, u64 lo) {
+    return vreinterpretq_u8_u64(
+        vcombine_u64(vcreate_u64(Common::swap64(hi)), vcreate_u64(Common::swap64(lo))));
+}
+
+void Increment(u64& hi, u64& lo) {
+    if (++lo == 0) {
+        ++hi;
+    }
+}
+
+/// Multiplies an XTS tweak by the primitive element of GF(2^128).
+uint8x16_t MultiplyByAlpha(uint8x16_t tweak) {
+    static constexpr u32 Polynomial[4]{0x87, 1, 1, 1};
+    const uint32x4_t words = vreinterpretq_u32_u8(tweak);
+    const uint32x4_t signs = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u8(tweak), 31));
+    const uint32x4_t carries = vandq_u32(vextq_u32(signs, signs, 3), vld1q_u32(Polynomial));
+    return vreinterpretq_u8_u32(veorq_u32(vshlq_n_u32(words, 1), carries));
+}
+
+uint8x16_t EncryptBlock(const RoundKeys128& keys, uint8x16_t block) {
+    UNROLL
+    for (std::size_t round = 0; round < NumRounds - 1; ++round) {
+        block = vaesmcq_u8(vaeseq_u8(block, keys.keys[round]));
+    }
+    block = vaeseq_u8(block, keys.keys[NumRounds - 1]);
+    return veorq_u8(block, keys.keys[NumRounds]);
+}
+
+uint8x16_t DecryptBlock(const RoundKeys128& keys, uint8x16_t block) {
+    UNROLL
+    for (std::size_t round = 0; round < NumRounds - 1; ++round) {
+        block = vaesimcq_u8(vaesdq_u8(block, keys.keys[round]));
+    }
+    block = vaesdq_u8(block, keys.keys[NumRounds - 1]);
+    return veorq_u8(block, keys.keys[NumRounds]);
+}
+
+} // Anonymous namespace
+
+void CtrArmCrypto(const AesRoundKeys& keys, const u8* src, u8* dest, std::size_t num_blocks,
+                  u64 counter_hi, u64 counter_lo) {
+    const RoundKeys128 round_keys = LoadRoundKeys(keys.encrypt);
+
+    for (; num_blocks >= Lanes; num_blocks -= Lanes) {
+        uint8x16_t state[Lanes];
+        UNROLL
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            state[i] = MakeBlock(counter_hi, counter_lo);
+            Increment(counter_hi, counter_lo);
+        }
+        UNROLL
+        for (std::size_t round = 0; round < NumRounds - 1; ++round) {
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                state[i] = vaesmcq_u8(vaeseq_u8(state[i], round_keys.keys[round]));
+            }
+        }
+        UNROLL
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            state[i] = vaeseq_u8(state[i], round_keys.keys[NumRounds - 1]);
+            state[i] = veorq_u8(state[i], round_keys.keys[NumRounds]);
+            vst1q_u8(dest + i * BlockSize, veorq_u8(vld1q_u8(src + i * BlockSize), state[i]));
+        }
+        src += Lanes * BlockSize;
+        dest += Lanes * BlockSize;
+    }
+    for (std::size_t i = 0; i < num_blocks; ++i) {
+        const uint8x16_t stream = EncryptBlock(round_keys, MakeBlock(counter_hi, counter_lo));
+        vst1q_u8(dest + i * BlockSize, veorq_u8(vld1q_u8(src + i * BlockSize), stream));
+        Increment(counter_hi, counter_lo);
+    }
+}
+
+void XtsDecryptArmCrypto(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys,
+                         const u8* src, u8* dest, std::size_t num_sectors,
+                         std::size_t sector_size, u64 tweak_hi, u64 tweak_lo) {
+    const RoundKeys128 decrypt_keys = LoadRoundKeys(data_keys.decrypt);
+    const RoundKeys128 tweak_encrypt_keys = LoadRoundKeys(tweak_keys.encrypt);
+
+    for (std::size_t s = 0; s < num_sectors; ++s) {
+        uint8x16_t tweak = EncryptBlock(tweak_encrypt_keys, MakeBlock(tweak_hi, tweak_lo));
+        Increment(tweak_hi, tweak_lo);
+
+        std::size_t num_blocks = sector_size / BlockSize;
+        for (; num_blocks >= Lanes; num_blocks -= Lanes) {
+            uint8x16_t tweaks[Lanes];
+            uint8x16_t state[Lanes];
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                tweaks[i] = tweak;
+                state[i] = veorq_u8(vld1q_u8(src + i * BlockSize), tweak);
+                tweak = MultiplyByAlpha(tweak);
+            }
+            UNROLL
+            for (std::size_t round = 0; round < NumRounds - 1; ++round) {
+                UNROLL
+                for (std::size_t i = 0; i < Lanes; ++i) {
+                    state[i] = vaesimcq_u8(vaesdq_u8(state[i], decrypt_keys.keys[round]));
+                }
+            }
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                state[i] = vaesdq_u8(state[i], decrypt_keys.keys[NumRounds - 1]);
+                state[i] = veorq_u8(state[i], decrypt_keys.keys[NumRounds]);
+                vst1q_u8(dest + i * BlockSize, veorq_u8(state[i], tweaks[i]));
+            }
+            src += Lanes * BlockSize;
+            dest += Lanes * BlockSize;
+        }
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+            const uint8x16_t block = veorq_u8(vld1q_u8(src + i * BlockSize), tweak);
+            vst1q_u8(dest + i * BlockSize, veorq_u8(DecryptBlock(decrypt_keys, block), tweak));
+            tweak = MultiplyByAlpha(tweak);
+        }
+        src += num_blocks * BlockSize;
+        dest += num_blocks * BlockSize;
+    }
+}
+
+} // namespace Core::Crypto::AesBackends
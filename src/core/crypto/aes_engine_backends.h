@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "common/common_types.h"
+
+// Hardware implementations of the AES engines, only to be used by aes_engine.cpp.
+namespace Core::Crypto::AesBackends {
+
+constexpr std::size_t BlockSize = 0x10;
+constexpr std::size_t NumRounds = 10;
+
+/// Expanded AES-128 key, in the layout used by both AES-NI and the ARMv8 Crypto Extensions.
+struct AesRoundKeys {
+    /// Round keys of the cipher.
+    alignas(16) std::array<u8, (NumRounds + 1) * BlockSize> encrypt;
+    /// Round keys of the equivalent inverse cipher, in the order they are used.
+    alignas(16) std::array<u8, (NumRounds + 1) * BlockSize> decrypt;
+};
+
+/**
+ * Encrypts num_blocks consecutive counter blocks and xors them with src.
+ * The counter of the first block is the big endian 128-bit number counter_hi:counter_lo.
+ */
+using CtrFunction = void (*)(const AesRoundKeys& keys, const u8* src, u8* dest,
+                             std::size_t num_blocks, u64 counter_hi, u64 counter_lo);
+
+/**
+ * Decrypts num_sectors consecutive sectors of sector_size bytes in XTS mode.
+ * The tweak of the first sector is the big endian 128-bit number tweak_hi:tweak_lo.
+ */
+using XtsFunction = void (*)(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys,
+                             const u8* src, u8* dest, std::size_t num_sectors,
+                             std::size_t sector_size, u64 tweak_hi, u64 tweak_lo);
+
+#if defined(ARCHITECTURE_x86_64)
+void CtrAesNi(const AesRoundKeys& keys, const u8* src, u8* dest, std::size_t num_blocks,
+              u64 counter_hi, u64 counter_lo);
+void XtsDecryptAesNi(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys, const u8* src,
+                     u8* dest, std::size_t num_sectors, std::size_t sector_size, u64 tweak_hi,
+                     u64 tweak_lo);
+
+void CtrVaes(const AesRoundKeys& keys, const u8* src, u8* dest, std::size_t num_blocks,
+             u64 counter_hi, u64 counter_lo);
+void XtsDecryptVaes(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys, const u8* src,
+                    u8* dest, std::size_t num_sectors, std::size_t sector_size, u64 tweak_hi,
+                    u64 tweak_lo);
+#elif defined(ARCHITECTURE_arm64)
+void CtrArmCrypto(const AesRoundKeys& keys, const u8* src, u8* dest, std::size_t num_blocks,
+                  u64 counter_hi, u64 counter_lo);
+void XtsDecryptArmCrypto(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys,
+                         const u8* src, u8* dest, std::size_t num_sectors,
+                         std::size_t sector_size, u64 tweak_hi, u64 tweak_lo);
+#endif
+
+} // namespace Core::Crypto::AesBackends
@@ -0,0 +1,293 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+#include "core/crypto/aes_engine_backends.h"
+
+// The functions of this file are only called after checking the host supports the instructions
+// they use, so they are compiled for those instructions without raising the baseline of the
+// rest of the build.
+#if defined(__GNUC__) || defined(__clang__)
+#define AES_NI_TARGET __attribute__((target("aes,sse4.1")))
+#define VAES_TARGET __attribute__((target("aes,sse4.1,avx2,vaes")))
+// Fully unrolled loops keep every block in flight in a register.
+#define UNROLL _Pragma("GCC unroll 16")
+#else
+#define AES_NI_TARGET
+#define VAES_TARGET
+#define UNROLL
+#endif
+
+namespace Core::Crypto::AesBackends {
+
+namespace {
+
+/// Number of blocks processed at once, enough to hide the latency of the AES instructions.
+constexpr std::size_t Lanes = 8;
+
+struct RoundKeys128 {
+    __m128i keys[NumRounds + 1];
+};
+
+AES_NI_TARGET RoundKeys128
+LoadRoundKeys(const std::array<u8, (NumRounds + 1) * BlockSize>& keys) {
+    RoundKeys128 result;
+    for (std::size_t i = 0; i <= NumRounds; ++i) {
+        result.keys[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(keys.data()) + i);
+    }
+    return result;
+}
+
+AES_NI_TARGET __m128i LoadBlock(const u8* data) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+AES_NI_TARGET void StoreBlock(u8* data, __m128i block) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), block);
+}
+
+/// Converts a little endian 128-bit number to its big endian byte representation and back.
+AES_NI_TARGET __m128i ByteSwap(__m128i value) {
+    return _mm_shuffle_epi8(value,
+                            _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+/// Increments a little endian 128-bit number.
+AES_NI_TARGET __m128i Increment(__m128i value) {
+    value = _mm_add_epi64(value, _mm_set_epi64x(0, 1));
+    // Carry into the upper half when the lower half wrapped around to zero.
+    const __m128i carry = _mm_slli_si128(_mm_cmpeq_epi64(value, _mm_setzero_si128()), 8);
+    return _mm_sub_epi64(value, carry);
+}
+
+/// Multiplies an XTS tweak by the primitive element of GF(2^128).
+AES_NI_TARGET __m128i MultiplyByAlpha(__m128i tweak) {
+    const __m128i carries = _mm_shuffle_epi32(_mm_srai_epi32(tweak, 31), 0x93);
+    return _mm_xor_si128(_mm_slli_epi32(tweak, 1),
+                         _mm_and_si128(carries, _mm_set_epi32(1, 1, 1, 0x87)));
+}
+
+AES_NI_TARGET __m128i EncryptBlock(const RoundKeys128& keys, __m128i block) {
+    block = _mm_xor_si128(block, keys.keys[0]);
+    UNROLL
+    for (std::size_t round = 1; round < NumRounds; ++round) {
+        block = _mm_aesenc_si128(block, keys.keys[round]);
+    }
+    return _mm_aesenclast_si128(block, keys.keys[NumRounds]);
+}
+
+AES_NI_TARGET __m128i DecryptBlock(const RoundKeys128& keys, __m128i block) {
+    block = _mm_xor_si128(block, keys.keys[0]);
+    UNROLL
+    for (std::size_t round = 1; round < NumRounds; ++round) {
+        block = _mm_aesdec_si128(block, keys.keys[round]);
+    }
+    return _mm_aesdeclast_si128(block, keys.keys[NumRounds]);
+}
+
+/// Transcodes the blocks of a CTR request one at a time, returns the next counter.
+AES_NI_TARGET __m128i CtrSingleBlocks(const RoundKeys128& keys, const u8* src, u8* dest,
+                                      std::size_t num_blocks, __m128i counter) {
+    for (std::size_t i = 0; i < num_blocks; ++i) {
+        const __m128i stream = EncryptBlock(keys, ByteSwap(counter));
+        StoreBlock(dest + i * BlockSize, _mm_xor_si128(LoadBlock(src + i * BlockSize), stream));
+        counter = Increment(counter);
+    }
+    return counter;
+}
+
+/// Decrypts the blocks of an XTS sector one at a time, returns the next tweak.
+AES_NI_TARGET __m128i XtsSingleBlocks(const RoundKeys128& keys, const u8* src, u8* dest,
+                                      std::size_t num_blocks, __m128i tweak) {
+    for (std::size_t i = 0; i < num_blocks; ++i) {
+        const __m128i block = _mm_xor_si128(LoadBlock(src + i * BlockSize), tweak);
+        StoreBlock(dest + i * BlockSize, _mm_xor_si128(DecryptBlock(keys, block), tweak));
+        tweak = MultiplyByAlpha(tweak);
+    }
+    return tweak;
+}
+
+VAES_TARGET __m256i Broadcast(__m128i value) {
+    return _mm256_broadcastsi128_si256(value);
+}
+
+VAES_TARGET __m256i Combine(__m128i low, __m128i high) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+}
+
+} // Anonymous namespace
+
+AES_NI_TARGET void CtrAesNi(const AesRoundKeys& keys, const u8* src, u8* dest,
+                            std::size_t num_blocks, u64 counter_hi, u64 counter_lo) {
+    const RoundKeys128 round_keys = LoadRoundKeys(keys.encrypt);
+    __m128i counter =
+        _mm_set_epi64x(static_cast<s64>(counter_hi), static_cast<s64>(counter_lo));
+
+    for (; num_blocks >= Lanes; num_blocks -= Lanes) {
+        __m128i state[Lanes];
+        UNROLL
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            state[i] = _mm_xor_si128(ByteSwap(counter), round_keys.keys[0]);
+            counter = Increment(counter);
+        }
+        UNROLL
+        for (std::size_t round = 1; round < NumRounds; ++round) {
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                state[i] = _mm_aesenc_si128(state[i], round_keys.keys[round]);
+            }
+        }
+        UNROLL
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            state[i] = _mm_aesenclast_si128(state[i], round_keys.keys[NumRounds]);
+            StoreBlock(dest + i * BlockSize,
+                       _mm_xor_si128(LoadBlock(src + i * BlockSize), state[i]));
+        }
+        src += Lanes * BlockSize;
+        dest += Lanes * BlockSize;
+    }
+    CtrSingleBlocks(round_keys, src, dest, num_blocks, counter);
+}
+
+AES_NI_TARGET void XtsDecryptAesNi(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys,
+                                   const u8* src, u8* dest, std::size_t num_sectors,
+                                   std::size_t sector_size, u64 tweak_hi, u64 tweak_lo) {
+    const RoundKeys128 decrypt_keys = LoadRoundKeys(data_keys.decrypt);
+    const RoundKeys128 tweak_encrypt_keys = LoadRoundKeys(tweak_keys.encrypt);
+    __m128i sector = _mm_set_epi64x(static_cast<s64>(tweak_hi), static_cast<s64>(tweak_lo));
+
+    for (std::size_t s = 0; s < num_sectors; ++s) {
+        __m128i tweak = EncryptBlock(tweak_encrypt_keys, ByteSwap(sector));
+        sector = Increment(sector);
+
+        std::size_t num_blocks = sector_size / BlockSize;
+        for (; num_blocks >= Lanes; num_blocks -= Lanes) {
+            __m128i tweaks[Lanes];
+            __m128i state[Lanes];
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                tweaks[i] = tweak;
+                state[i] = _mm_xor_si128(_mm_xor_si128(LoadBlock(src + i * BlockSize), tweak),
+                                         decrypt_keys.keys[0]);
+                tweak = MultiplyByAlpha(tweak);
+            }
+            UNROLL
+            for (std::size_t round = 1; round < NumRounds; ++round) {
+                UNROLL
+                for (std::size_t i = 0; i < Lanes; ++i) {
+                    state[i] = _mm_aesdec_si128(state[i], decrypt_keys.keys[round]);
+                }
+            }
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                state[i] = _mm_aesdeclast_si128(state[i], decrypt_keys.keys[NumRounds]);
+                StoreBlock(dest + i * BlockSize, _mm_xor_si128(state[i], tweaks[i]));
+            }
+            src += Lanes * BlockSize;
+            dest += Lanes * BlockSize;
+        }
+        XtsSingleBlocks(decrypt_keys, src, dest, num_blocks, tweak);
+        src += num_blocks * BlockSize;
+        dest += num_blocks * BlockSize;
+    }
+}
+
+VAES_TARGET void CtrVaes(const AesRoundKeys& keys, const u8* src, u8* dest,
+                         std::size_t num_blocks, u64 counter_hi, u64 counter_lo) {
+    const RoundKeys128 round_keys = LoadRoundKeys(keys.encrypt);
+    __m256i wide_keys[NumRounds + 1];
+    for (std::size_t round = 0; round <= NumRounds; ++round) {
+        wide_keys[round] = Broadcast(round_keys.keys[round]);
+    }
+    __m128i counter =
+        _mm_set_epi64x(static_cast<s64>(counter_hi), static_cast<s64>(counter_lo));
+
+    // Every register holds two blocks.
+    for (; num_blocks >= Lanes * 2; num_blocks -= Lanes * 2) {
+        __m256i state[Lanes];
+        UNROLL
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            const __m128i first = ByteSwap(counter);
+            counter = Increment(counter);
+            const __m128i second = ByteSwap(counter);
+            counter = Increment(counter);
+            state[i] = _mm256_xor_si256(Combine(first, second), wide_keys[0]);
+        }
+        UNROLL
+        for (std::size_t round = 1; round < NumRounds; ++round) {
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                state[i] = _mm256_aesenc_epi128(state[i], wide_keys[round]);
+            }
+        }
+        UNROLL
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            state[i] = _mm256_aesenclast_epi128(state[i], wide_keys[NumRounds]);
+            const __m256i data =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * BlockSize * 2));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * BlockSize * 2),
+                                _mm256_xor_si256(data, state[i]));
+        }
+        src += Lanes * BlockSize * 2;
+        dest += Lanes * BlockSize * 2;
+    }
+    CtrSingleBlocks(round_keys, src, dest, num_blocks, counter);
+}
+
+VAES_TARGET void XtsDecryptVaes(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys,
+                                const u8* src, u8* dest, std::size_t num_sectors,
+                                std::size_t sector_size, u64 tweak_hi, u64 tweak_lo) {
+    const RoundKeys128 decrypt_keys = LoadRoundKeys(data_keys.decrypt);
+    const RoundKeys128 tweak_encrypt_keys = LoadRoundKeys(tweak_keys.encrypt);
+    __m256i wide_keys[NumRounds + 1];
+    for (std::size_t round = 0; round <= NumRounds; ++round) {
+        wide_keys[round] = Broadcast(decrypt_keys.keys[round]);
+    }
+    __m128i sector = _mm_set_epi64x(static_cast<s64>(tweak_hi), static_cast<s64>(tweak_lo));
+
+    for (std::size_t s = 0; s < num_sectors; ++s) {
+        __m128i tweak = EncryptBlock(tweak_encrypt_keys, ByteSwap(sector));
+        sector = Increment(sector);
+
+        std::size_t num_blocks = sector_size / BlockSize;
+        for (; num_blocks >= Lanes * 2; num_blocks -= Lanes * 2) {
+            __m256i tweaks[Lanes];
+            __m256i state[Lanes];
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                const __m128i first = tweak;
+                const __m128i second = MultiplyByAlpha(first);
+                tweak = MultiplyByAlpha(second);
+                tweaks[i] = Combine(first, second);
+                const __m256i data =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * BlockSize * 2));
+                state[i] = _mm256_xor_si256(_mm256_xor_si256(data, tweaks[i]), wide_keys[0]);
+            }
+            UNROLL
+            for (std::size_t round = 1; round < NumRounds; ++round) {
+                UNROLL
+                for (std::size_t i = 0; i < Lanes; ++i) {
+                    state[i] = _mm256_aesdec_epi128(state[i], wide_keys[round]);
+                }
+            }
+            UNROLL
+            for (std::size_t i = 0; i < Lanes; ++i) {
+                state[i] = _mm256_aesdeclast_epi128(state[i], wide_keys[NumRounds]);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * BlockSize * 2),
+                                    _mm256_xor_si256(state[i], tweaks[i]));
+            }
+            src += Lanes * BlockSize * 2;
+            dest += Lanes * BlockSize * 2;
+        }
+        XtsSingleBlocks(decrypt_keys, src, dest, num_blocks, tweak);
+        src += num_blocks * BlockSize;
+        dest += num_blocks * BlockSize;
+    }
+}
+
+} // namespace Core::Crypto::AesBackends
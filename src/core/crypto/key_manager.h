@@ -4,9 +4,12 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <filesystem>
 #include <map>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <span>
 #include <string>
 
@@ -287,8 +290,9 @@ public:
 
     void PopulateFromPartitionData(PartitionDataManager& data);
 
-    const std::map<u128, Ticket>& GetCommonTickets() const;
-    const std::map<u128, Ticket>& GetPersonalizedTickets() const;
+    // Copies, as tickets may be added while the caller iterates them.
+    std::map<u128, Ticket> GetCommonTickets() const;
+    std::map<u128, Ticket> GetPersonalizedTickets() const;
 
     bool AddTicket(const Ticket& ticket);
 
@@ -298,13 +302,16 @@ public:
 private:
     KeyManager();
 
+    // Keys and tickets are looked up and added from the threads scanning the game list.
+    mutable std::shared_mutex key_mutex;
     std::map<KeyIndex<S128KeyType>, Key128> s128_keys;
     std::map<KeyIndex<S256KeyType>, Key256> s256_keys;
 
     // Map from rights ID to ticket
+    mutable std::mutex ticket_mutex;
     std::map<u128, Ticket> common_tickets;
     std::map<u128, Ticket> personal_tickets;
-    bool ticket_databases_loaded = false;
+    std::atomic<bool> ticket_databases_loaded = false;
 
     std::array<std::array<u8, 0xB0>, 0x20> encrypted_keyblobs{};
     std::array<std::array<u8, 0x90>, 0x20> keyblobs{};
@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(ARCHITECTURE_arm64)
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/crypto/sha256_engine.h"
+#include "core/crypto/sha256_engine_backends.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Core::Crypto {
+
+namespace Sha256Backends {
+
+const u32 RoundConstants[64]{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+} // namespace Sha256Backends
+
+namespace {
+
+constexpr std::array<u32, 8> InitialState{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                          0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+void CompressPortable(u32* state, const u8* data, std::size_t num_blocks) {
+    for (; num_blocks > 0; --num_blocks, data += Sha256::BlockSize) {
+        std::array<u32, 64> w;
+        for (std::size_t i = 0; i < 16; ++i) {
+            u32 word;
+            std::memcpy(&word, data + i * sizeof(u32), sizeof(u32));
+            w[i] = Common::swap32(word);
+        }
+        for (std::size_t i = 16; i < 64; ++i) {
+            const u32 s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const u32 s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        u32 a = state[0], b = state[1], c = state[2], d = state[3];
+        u32 e = state[4], f = state[5], g = state[6], h = state[7];
+        for (std::size_t i = 0; i < 64; ++i) {
+            const u32 s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+            const u32 choice = (e & f) ^ (~e & g);
+            const u32 temp1 = h + s1 + choice + Sha256Backends::RoundConstants[i] + w[i];
+            const u32 s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+            const u32 majority = (a & b) ^ (a & c) ^ (b & c);
+            const u32 temp2 = s0 + majority;
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+struct Backend {
+    Sha256Backends::CompressFunction compress;
+    std::string_view name;
+};
+
+Backend SelectBackend() {
+#if defined(ARCHITECTURE_x86_64)
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.sha && caps.sse4_1) {
+        return {&Sha256Backends::CompressShaNi, "SHA-NI"};
+    }
+#elif defined(ARCHITECTURE_arm64)
+#if defined(__APPLE__)
+    // Every Apple processor with an arm64 ABI implements the SHA2 instructions.
+    return {&Sha256Backends::CompressArmSha2, "ARMv8 SHA2"};
+#elif defined(_WIN32)
+    if (IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE)) {
+        return {&Sha256Backends::CompressArmSha2, "ARMv8 SHA2"};
+    }
+#elif defined(__linux__)
+    if ((getauxval(AT_HWCAP) & HWCAP_SHA2) != 0) {
+        return {&Sha256Backends::CompressArmSha2, "ARMv8 SHA2"};
+    }
+#endif
+#endif
+    return {&CompressPortable, "software"};
+}
+
+const Backend& GetBackend() {
+    static const Backend backend = [] {
+        const Backend selected = SelectBackend();
+        LOG_INFO(Crypto, "Using the {} SHA-256 implementation", selected.name);
+        return selected;
+    }();
+    return backend;
+}
+
+} // Anonymous namespace
+
+std::string_view GetSha256BackendName() {
+    return GetBackend().name;
+}
+
+Sha256::Sha256() : state{InitialState} {}
+
+void Sha256::Update(std::span<const u8> data) {
+    const auto compress = GetBackend().compress;
+    length += data.size();
+
+    if (buffer_size != 0) {
+        const std::size_t copy_size = std::min(BlockSize - buffer_size, data.size());
+        std::memcpy(buffer.data() + buffer_size, data.data(), copy_size);
+        buffer_size += copy_size;
+        data = data.subspan(copy_size);
+        if (buffer_size < BlockSize) {
+            return;
+        }
+        compress(state.data(), buffer.data(), 1);
+        buffer_size = 0;
+    }
+
+    const std::size_t num_blocks = data.size() / BlockSize;
+    if (num_blocks != 0) {
+        compress(state.data(), data.data(), num_blocks);
+        data = data.subspan(num_blocks * BlockSize);
+    }
+
+    std::memcpy(buffer.data(), data.data(), data.size());
+    buffer_size = data.size();
+}
+
+SHA256Hash Sha256::Finalize() {
+    const auto compress = GetBackend().compress;
+    const u64 bit_length = length * 8;
+
+    // Append the terminator and pad with zeroes up to the length field.
+    buffer[buffer_size++] = 0x80;
+    if (buffer_size > BlockSize - sizeof(u64)) {
+        std::fill(buffer.begin() + buffer_size, buffer.end(), u8{0});
+        compress(state.data(), buffer.data(), 1);
+        buffer_size = 0;
+    }
+    std::fill(buffer.begin() + buffer_size, buffer.end() - sizeof(u64), u8{0});
+    const u64 bit_length_be = Common::swap64(bit_length);
+    std::memcpy(buffer.data() + BlockSize - sizeof(u64), &bit_length_be, sizeof(u64));
+    compress(state.data(), buffer.data(), 1);
+
+    SHA256Hash hash;
+    for (std::size_t i = 0; i < state.size(); ++i) {
+        const u32 word = Common::swap32(state[i]);
+        std::memcpy(hash.data() + i * sizeof(u32), &word, sizeof(u32));
+    }
+    return hash;
+}
+
+SHA256Hash Sha256::Compute(std::span<const u8> data) {
+    Sha256 sha;
+    sha.Update(data);
+    return sha.Finalize();
+}
+
+} // namespace Core::Crypto
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <string_view>
+
+#include "common/common_types.h"
+
+namespace Core::Crypto {
+
+using SHA256Hash = std::array<u8, 0x20>;
+
+/// Returns the name of the SHA-256 implementation used on this host, for logging.
+[[nodiscard]] std::string_view GetSha256BackendName();
+
+/**
+ * SHA-256 on the SHA extensions of the host CPU: SHA-NI on x86-64, the ARMv8 SHA2 instructions on
+ * arm64. Falls back to a portable implementation on hosts without them.
+ */
+class Sha256 {
+public:
+    static constexpr std::size_t BlockSize = 0x40;
+
+    Sha256();
+
+    void Update(std::span<const u8> data);
+
+    /// Returns the hash of all data passed to Update. The object must not be used afterwards.
+    [[nodiscard]] SHA256Hash Finalize();
+
+    /// Returns the hash of data.
+    [[nodiscard]] static SHA256Hash Compute(std::span<const u8> data);
+
+private:
+    std::array<u32, 8> state;
+    std::array<u8, BlockSize> buffer{};
+    std::size_t buffer_size{};
+    u64 length{};
+};
+
+} // namespace Core::Crypto
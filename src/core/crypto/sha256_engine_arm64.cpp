@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <arm_neon.h>
+
+#include "core/crypto/sha256_engine_backends.h"
+
+// This file is built with the Crypto Extensions enabled, see aes_engine_arm64.cpp.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define UNROLL _Pragma("GCC unroll 16")
+#else
+#define UNROLL
+#endif
+
+namespace Core::Crypto::Sha256Backends {
+
+void CompressArmSha2(u32* state, const u8* data, std::size_t num_blocks) {
+    uint32x4_t state0 = vld1q_u32(state);     // ABCD
+    uint32x4_t state1 = vld1q_u32(state + 4); // EFGH
+
+    for (; num_blocks > 0; --num_blocks, data += 64) {
+        const uint32x4_t abcd_save = state0;
+        const uint32x4_t efgh_save = state1;
+
+        // Every iteration runs four rounds, keeping the last sixteen words of the schedule.
+        uint32x4_t messages[4];
+        UNROLL
+        for (std::size_t i = 0; i < 16; ++i) {
+            uint32x4_t& message = messages[i % 4];
+            if (i < 4) {
+                message = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+            } else {
+                message = vsha256su0q_u32(message, messages[(i + 1) % 4]);
+                message = vsha256su1q_u32(message, messages[(i + 2) % 4], messages[(i + 3) % 4]);
+            }
+            const uint32x4_t words = vaddq_u32(message, vld1q_u32(RoundConstants + i * 4));
+            const uint32x4_t previous_state0 = state0;
+            state0 = vsha256hq_u32(state0, state1, words);
+            state1 = vsha256h2q_u32(state1, previous_state0, words);
+        }
+
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
+    }
+
+    vst1q_u32(state, state0);
+    vst1q_u32(state + 4, state1);
+}
+
+} // namespace Core::Crypto::Sha256Backends
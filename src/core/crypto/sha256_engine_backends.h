@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/common_types.h"
+
+// Hardware implementations of SHA-256, only to be used by sha256_engine.cpp.
+namespace Core::Crypto::Sha256Backends {
+
+/// Round constants of SHA-256.
+extern const u32 RoundConstants[64];
+
+/// Runs the compression function over num_blocks consecutive 64-byte blocks.
+using CompressFunction = void (*)(u32* state, const u8* data, std::size_t num_blocks);
+
+#if defined(ARCHITECTURE_x86_64)
+void CompressShaNi(u32* state, const u8* data, std::size_t num_blocks);
+#elif defined(ARCHITECTURE_arm64)
+void CompressArmSha2(u32* state, const u8* data, std::size_t num_blocks);
+#endif
+
+} // namespace Core::Crypto::Sha256Backends
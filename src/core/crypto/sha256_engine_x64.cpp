@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+#include "core/crypto/sha256_engine_backends.h"
+
+// Only called after checking the host supports SHA-NI, so compiled for it without raising the
+// baseline of the rest of the build.
+#if defined(__GNUC__) || defined(__clang__)
+#define SHA_NI_TARGET __attribute__((target("sha,sse4.1")))
+#define UNROLL _Pragma("GCC unroll 16")
+#else
+#define SHA_NI_TARGET
+#define UNROLL
+#endif
+
+namespace Core::Crypto::Sha256Backends {
+
+SHA_NI_TARGET void CompressShaNi(u32* state, const u8* data, std::size_t num_blocks) {
+    // Converts the big endian words of a message to host order.
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The instructions work on the state split into ABEF and CDGH.
+    __m128i temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)),
+                                     0xB1); // CDAB
+    __m128i state1 =
+        _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)),
+                          0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(temp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, temp, 0xF0);      // CDGH
+
+    for (; num_blocks > 0; --num_blocks, data += 64) {
+        const __m128i abef_save = state0;
+        const __m128i cdgh_save = state1;
+
+        // Every iteration runs four rounds, keeping the last sixteen words of the schedule.
+        __m128i messages[4];
+        UNROLL
+        for (std::size_t i = 0; i < 16; ++i) {
+            __m128i& message = messages[i % 4];
+            if (i < 4) {
+                message = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)), byte_swap);
+            } else {
+                const __m128i w7 =
+                    _mm_alignr_epi8(messages[(i + 3) % 4], messages[(i + 2) % 4], 4);
+                message = _mm_sha256msg1_epu32(message, messages[(i + 1) % 4]);
+                message = _mm_sha256msg2_epu32(_mm_add_epi32(message, w7), messages[(i + 3) % 4]);
+            }
+            __m128i words = _mm_add_epi32(
+                message, _mm_loadu_si128(reinterpret_cast<const __m128i*>(RoundConstants + i * 4)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+            words = _mm_shuffle_epi32(words, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, words);
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    temp = _mm_shuffle_epi32(state0, 0x1B);       // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+    state0 = _mm_blend_epi16(temp, state1, 0xF0); // DCBA
+    state1 = _mm_alignr_epi8(state1, temp, 8);    // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+} // namespace Core::Crypto::Sha256Backends
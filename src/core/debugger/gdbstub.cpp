@@ -25,6 +25,8 @@
 #include "core/hle/kernel/k_thread.h"
 #include "core/loader/loader.h"
 #include "core/memory.h"
+#include "video_core/gpu.h"
+#include "video_core/macro/macro_profiler.h"
 
 namespace Core {
 
@@ -615,6 +617,7 @@ void GDBStub::HandleRcmd(const std::vector<u8>& command) {
     const char* commands = "Commands:\n"
                            "  get fastmem\n"
                            "  get info\n"
+                           "  get macros\n"
                            "  get mappings\n";
 
     if (command_str == "get fastmem") {
@@ -657,6 +660,12 @@ void GDBStub::HandleRcmd(const std::vector<u8>& command) {
             reply += fmt::format("  {:#012x} - {:#012x} {}\n", vaddr,
                                  GetInteger(Core::GetModuleEnd(process, vaddr)), name);
         }
+    } else if (command_str == "get macros") {
+        if (Settings::values.profile_macros.GetValue()) {
+            reply = system.GPU().MacroProfiler().GetReport();
+        } else {
+            reply = "Macro profiling is not enabled.\n";
+        }
     } else if (command_str == "get mappings") {
         reply = "Mappings:\n";
         VAddr cur_addr = 0;
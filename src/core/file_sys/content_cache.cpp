@@ -0,0 +1,365 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+
+#include "common/common_funcs.h"
+#include "common/div_ceil.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "common/swap.h"
+#include "core/file_sys/content_cache.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr u32 BitmapMagic = Common::MakeMagic('S', 'C', 'C', 'B');
+constexpr u32 BitmapVersion = 2;
+
+struct BitmapHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le size;
+    u64_le block_size;
+    u64_le generation;
+};
+static_assert(sizeof(BitmapHeader) == 0x20, "BitmapHeader has incorrect size.");
+
+constexpr std::string_view DataExtension = ".bin";
+constexpr std::string_view BitmapExtension = ".map";
+
+std::mutex registry_mutex;
+std::unordered_map<std::string, std::weak_ptr<ContentCacheFile>> open_files;
+
+/// Returns a random generation number for a new data file, never zero.
+u64 NewGeneration() {
+    std::random_device device;
+    std::uniform_int_distribution<u64> distribution{1};
+    return distribution(device);
+}
+
+std::filesystem::path GetCacheDir() {
+    return Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "content";
+}
+
+/**
+ * Deletes the least recently used entries of the cache until an entry of the given size fits in
+ * the size limit. Entries in use are kept. Must be called with registry_mutex held.
+ */
+bool MakeRoom(const std::filesystem::path& dir, const std::string& key, u64 needed) {
+    const u64 limit = u64{Settings::values.content_cache_limit_gib.GetValue()} << 30;
+    if (needed > limit) {
+        return false;
+    }
+
+    struct Entry {
+        std::filesystem::path data_path;
+        std::filesystem::path bitmap_path;
+        u64 size;
+        std::filesystem::file_time_type last_use;
+    };
+    std::vector<Entry> entries;
+    u64 total_size = 0;
+    Common::FS::IterateDirEntries(
+        dir,
+        [&](const std::filesystem::directory_entry& entry) {
+            if (entry.path().extension() != DataExtension) {
+                return true;
+            }
+            const std::string entry_key = Common::FS::PathToUTF8String(entry.path().stem());
+            if (entry_key == key) {
+                // The entry being opened is already accounted for by the caller.
+                return true;
+            }
+            std::error_code ec;
+            const u64 entry_size = entry.file_size(ec);
+            std::filesystem::path bitmap_path = entry.path();
+            bitmap_path.replace_extension(BitmapExtension);
+            // The bitmap is written while an entry is filled and when it is closed, so it tracks
+            // when the entry was last used.
+            auto last_use = std::filesystem::last_write_time(bitmap_path, ec);
+            if (ec) {
+                last_use = std::filesystem::file_time_type::min();
+            }
+            total_size += entry_size;
+            if (const auto it = open_files.find(entry_key);
+                it == open_files.end() || it->second.expired()) {
+                entries.push_back({entry.path(), std::move(bitmap_path), entry_size, last_use});
+            }
+            return true;
+        },
+        Common::FS::DirEntryFilter::File);
+
+    std::ranges::sort(entries, {}, &Entry::last_use);
+    for (const Entry& entry : entries) {
+        if (total_size + needed <= limit) {
+            break;
+        }
+        LOG_INFO(Service_FS, "Evicting {} from the content cache",
+                 Common::FS::PathToUTF8String(entry.data_path.filename()));
+        Common::FS::RemoveFile(entry.bitmap_path);
+        if (Common::FS::RemoveFile(entry.data_path)) {
+            total_size -= entry.size;
+        }
+    }
+    return total_size + needed <= limit;
+}
+
+} // Anonymous namespace
+
+ContentCacheFile::ContentCacheFile(VirtualFile source_, std::filesystem::path bitmap_path_)
+    : source{std::move(source_)}, bitmap_path{std::move(bitmap_path_)}, size{source->GetSize()},
+      bitmap(Common::DivCeil(Common::DivCeil(size, BlockSize), size_t{64})) {}
+
+ContentCacheFile::~ContentCacheFile() {
+    if (!data.IsOpen()) {
+        // Failed to open, the file was never registered.
+        return;
+    }
+    SaveBitmap();
+
+    std::scoped_lock lock{registry_mutex};
+    const std::string key = Common::FS::PathToUTF8String(bitmap_path.stem());
+    if (const auto it = open_files.find(key); it != open_files.end() && it->second.expired()) {
+        open_files.erase(it);
+    }
+}
+
+std::shared_ptr<ContentCacheFile> ContentCacheFile::Open(VirtualFile source,
+                                                         std::filesystem::path data_path,
+                                                         std::filesystem::path bitmap_path) {
+    std::shared_ptr<ContentCacheFile> file{
+        new ContentCacheFile(std::move(source), std::move(bitmap_path))};
+    if (!file->data.Open(data_path, Common::FS::FileAccessMode::ReadWrite,
+                         file->size + sizeof(u64))) {
+        LOG_WARNING(Service_FS, "Failed to open content cache file {}",
+                    Common::FS::PathToUTF8String(data_path));
+        return nullptr;
+    }
+
+    // The data file ends with its generation number, which reads as zero when the file was just
+    // created or was truncated since. The bitmap is only used with the generation it was saved
+    // with, so blocks missing from the data file are never served from it.
+    std::memcpy(&file->generation, file->data.Data() + file->size, sizeof(u64));
+    if (file->generation != 0) {
+        file->LoadBitmap();
+        return file;
+    }
+    file->generation = NewGeneration();
+    const std::span generation_bytes{reinterpret_cast<const u8*>(&file->generation), sizeof(u64)};
+    if (!file->data.Write(file->size, generation_bytes)) {
+        LOG_WARNING(Service_FS, "Failed to write content cache file {}",
+                    Common::FS::PathToUTF8String(data_path));
+        file->data.Close();
+        return nullptr;
+    }
+    return file;
+}
+
+std::string ContentCacheFile::GetName() const {
+    return source->GetName();
+}
+
+std::size_t ContentCacheFile::GetSize() const {
+    return size;
+}
+
+bool ContentCacheFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+VirtualDir ContentCacheFile::GetContainingDirectory() const {
+    return source->GetContainingDirectory();
+}
+
+bool ContentCacheFile::IsWritable() const {
+    return false;
+}
+
+bool ContentCacheFile::IsReadable() const {
+    return true;
+}
+
+std::size_t ContentCacheFile::Read(u8* out, std::size_t length, std::size_t offset) const {
+    if (offset >= size || length == 0) {
+        return 0;
+    }
+    length = std::min(length, size - offset);
+
+    const std::size_t first_block = offset / BlockSize;
+    const std::size_t last_block = (offset + length - 1) / BlockSize;
+    if (!HasBlocks(first_block, last_block) && !FillBlocks(first_block, last_block)) {
+        return source->Read(out, length, offset);
+    }
+    std::memcpy(out, data.Data() + offset, length);
+    return length;
+}
+
+std::span<const u8> ContentCacheFile::GetView(std::size_t length, std::size_t offset) const {
+    if (offset >= size || length == 0) {
+        return {};
+    }
+    length = std::min(length, size - offset);
+
+    const std::size_t first_block = offset / BlockSize;
+    const std::size_t last_block = (offset + length - 1) / BlockSize;
+    if (!HasBlocks(first_block, last_block) && !FillBlocks(first_block, last_block)) {
+        return {};
+    }
+    return {data.Data() + offset, length};
+}
+
+std::size_t ContentCacheFile::Write(const u8* in, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+bool ContentCacheFile::Rename(std::string_view new_name) {
+    return false;
+}
+
+bool ContentCacheFile::HasBlock(std::size_t block) const {
+    return (bitmap[block / 64].load(std::memory_order_acquire) >> (block % 64)) & 1;
+}
+
+bool ContentCacheFile::HasBlocks(std::size_t first_block, std::size_t last_block) const {
+    for (std::size_t block = first_block; block <= last_block; ++block) {
+        if (!HasBlock(block)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ContentCacheFile::FillBlocks(std::size_t first_block, std::size_t last_block) const {
+    // No lock is held while reading the source, so threads reading other blocks are not delayed.
+    // Threads racing for the same block write the same contents to the copy.
+    std::vector<u8> buffer;
+    std::size_t block = first_block;
+    while (block <= last_block) {
+        if (HasBlock(block)) {
+            ++block;
+            continue;
+        }
+        // Read each run of missing blocks with a single request to the source.
+        std::size_t end_block = block + 1;
+        while (end_block <= last_block && end_block - block < MaxFillBlocks &&
+               !HasBlock(end_block)) {
+            ++end_block;
+        }
+        const std::size_t begin = block * BlockSize;
+        const std::size_t end = std::min(end_block * BlockSize, size);
+        buffer.resize(end - begin);
+        if (source->Read(buffer.data(), buffer.size(), begin) != buffer.size() ||
+            !data.Write(begin, buffer)) {
+            return false;
+        }
+        const std::size_t num_blocks = end_block - block;
+        for (; block < end_block; ++block) {
+            bitmap[block / 64].fetch_or(u64{1} << (block % 64), std::memory_order_release);
+        }
+
+        // Save the bitmap from time to time, so the blocks filled so far survive a crash.
+        std::size_t unsaved =
+            unsaved_blocks.fetch_add(num_blocks, std::memory_order_relaxed) + num_blocks;
+        if (unsaved >= BitmapSaveInterval &&
+            unsaved_blocks.compare_exchange_strong(unsaved, 0, std::memory_order_relaxed)) {
+            SaveBitmap();
+        }
+    }
+    return true;
+}
+
+void ContentCacheFile::LoadBitmap() {
+    const Common::FS::IOFile file{bitmap_path, Common::FS::FileAccessMode::Read,
+                                  Common::FS::FileType::BinaryFile};
+    BitmapHeader header{};
+    if (!file.IsOpen() || !file.ReadObject(header)) {
+        return;
+    }
+    if (header.magic != BitmapMagic || header.version != BitmapVersion || header.size != size ||
+        header.block_size != BlockSize || header.generation != generation) {
+        LOG_INFO(Service_FS, "Discarding outdated content cache {}",
+                 Common::FS::PathToUTF8String(bitmap_path));
+        return;
+    }
+    std::vector<u64> words(bitmap.size());
+    if (file.ReadSpan<u64>(words) != words.size()) {
+        return;
+    }
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        bitmap[i].store(words[i], std::memory_order_relaxed);
+    }
+}
+
+void ContentCacheFile::SaveBitmap() const {
+    std::scoped_lock lock{save_mutex};
+
+    // Blocks are marked as present after they are written, so every block in this copy of the
+    // bitmap is on disk once the data is flushed.
+    std::vector<u64> words(bitmap.size());
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        words[i] = bitmap[i].load(std::memory_order_acquire);
+    }
+    if (!data.Flush()) {
+        LOG_WARNING(Service_FS, "Failed to flush content cache {}",
+                    Common::FS::PathToUTF8String(bitmap_path));
+        return;
+    }
+
+    const Common::FS::IOFile file{bitmap_path, Common::FS::FileAccessMode::Write,
+                                  Common::FS::FileType::BinaryFile};
+    const BitmapHeader header{
+        .magic = BitmapMagic,
+        .version = BitmapVersion,
+        .size = size,
+        .block_size = BlockSize,
+        .generation = generation,
+    };
+    if (!file.IsOpen() || !file.WriteObject(header) ||
+        file.WriteSpan<u64>(words) != words.size()) {
+        LOG_WARNING(Service_FS, "Failed to write content cache bitmap {}",
+                    Common::FS::PathToUTF8String(bitmap_path));
+    }
+}
+
+VirtualFile CacheContent(VirtualFile romfs, std::string_view key) {
+    if (!Settings::values.use_content_cache.GetValue() || romfs == nullptr ||
+        romfs->GetSize() == 0) {
+        return romfs;
+    }
+
+    std::scoped_lock lock{registry_mutex};
+    const std::string key_string{key};
+    if (const auto it = open_files.find(key_string); it != open_files.end()) {
+        if (auto file = it->second.lock()) {
+            return file;
+        }
+    }
+
+    const auto dir = GetCacheDir();
+    if (!Common::FS::CreateDirs(dir)) {
+        return romfs;
+    }
+    if (!MakeRoom(dir, key_string, romfs->GetSize())) {
+        LOG_WARNING(Service_FS, "RomFS of {} bytes does not fit in the content cache size limit",
+                    romfs->GetSize());
+        return romfs;
+    }
+    auto file = ContentCacheFile::Open(romfs, dir / (key_string + std::string{DataExtension}),
+                                       dir / (key_string + std::string{BitmapExtension}));
+    if (file == nullptr) {
+        return romfs;
+    }
+    LOG_INFO(Service_FS, "Serving RomFS from content cache entry {}", key_string);
+    open_files.insert_or_assign(key_string, file);
+    return file;
+}
+
+} // namespace FileSys
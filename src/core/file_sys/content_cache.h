@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/fs/mapped_file.h"
+#include "core/file_sys/vfs/vfs.h"
+
+namespace FileSys {
+
+/**
+ * A read-only file serving the contents of another file from a sparse copy on disk.
+ *
+ * Blocks missing from the copy are read from the source file on first access and written to the
+ * copy, which is memory mapped for reading. A bitmap of the blocks present is kept next to the
+ * copy, so later sessions skip decrypting and decompressing the source for every block already
+ * read. The copy ends with a random generation number saved in the bitmap too, so a bitmap is
+ * discarded when the copy it describes was deleted or truncated.
+ */
+class ContentCacheFile : public VfsFile {
+public:
+    /// Size of the blocks read from the source at once.
+    static constexpr std::size_t BlockSize = 0x10000;
+
+    /// Maximum number of blocks read from the source with a single request.
+    static constexpr std::size_t MaxFillBlocks = 32;
+
+    /// Number of blocks filled between the saves of the bitmap while the file is open.
+    static constexpr std::size_t BitmapSaveInterval = 1024;
+
+    ~ContentCacheFile() override;
+
+    /**
+     * Opens the cached copy of a file, creating it if it does not exist.
+     *
+     * @param source      File to cache.
+     * @param data_path   Path of the sparse copy of the source.
+     * @param bitmap_path Path of the bitmap of the blocks present in the copy.
+     *
+     * @returns The cached file, or nullptr if the copy could not be created.
+     */
+    static std::shared_ptr<ContentCacheFile> Open(VirtualFile source,
+                                                  std::filesystem::path data_path,
+                                                  std::filesystem::path bitmap_path);
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    VirtualDir GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    std::span<const u8> GetView(std::size_t length, std::size_t offset) const override;
+    bool Rename(std::string_view new_name) override;
+
+private:
+    explicit ContentCacheFile(VirtualFile source, std::filesystem::path bitmap_path);
+
+    /// Returns true if the block is present in the copy.
+    bool HasBlock(std::size_t block) const;
+
+    /// Returns true if all blocks in the range are present in the copy.
+    bool HasBlocks(std::size_t first_block, std::size_t last_block) const;
+
+    /// Reads the missing blocks in the range from the source, returns false on failure.
+    bool FillBlocks(std::size_t first_block, std::size_t last_block) const;
+
+    void LoadBitmap();
+
+    /// Writes the bitmap once the blocks it marks as present have reached the disk.
+    void SaveBitmap() const;
+
+    VirtualFile source;
+    std::filesystem::path bitmap_path;
+    Common::FS::MappedFile data;
+    std::size_t size;
+    u64 generation{};
+
+    mutable std::vector<std::atomic<u64>> bitmap;
+    mutable std::atomic<std::size_t> unsaved_blocks{};
+    mutable std::mutex save_mutex;
+};
+
+/**
+ * Returns a file serving the reads of a fully patched RomFS from the on-disk content cache, when
+ * it is enabled in the settings.
+ *
+ * @param romfs RomFS to cache.
+ * @param key   Identifier of the contents of the RomFS, unique for every combination of base and
+ *              update content.
+ *
+ * @returns The cached RomFS, or romfs itself if it cannot be cached.
+ */
+VirtualFile CacheContent(VirtualFile romfs, std::string_view key);
+
+} // namespace FileSys
@@ -0,0 +1,338 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/hex_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/task_scheduler.h"
+#include "common/thread.h"
+#include "core/crypto/sha256_engine.h"
+#include "core/file_sys/content_verifier.h"
+#include "core/file_sys/vfs/vfs.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr auto ProgressInterval = 100ms;
+
+constexpr u32 RecordMagic = Common::MakeMagic('S', 'C', 'V', 'R');
+constexpr u32 RecordVersion = 1;
+
+struct RecordHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le entry_count;
+    u64_le payload_hash;
+};
+static_assert(sizeof(RecordHeader) == 0x18, "RecordHeader has incorrect size.");
+
+struct RecordEntry {
+    u64_le path_hash;
+    u64_le size;
+    u64_le modified;
+};
+static_assert(sizeof(RecordEntry) == 0x18, "RecordEntry has incorrect size.");
+
+u64 HashPayload(std::span<const RecordEntry> payload) {
+    return Common::CityHash64(reinterpret_cast<const char*>(payload.data()), payload.size_bytes());
+}
+
+} // Anonymous namespace
+
+ContentVerificationRecord::ContentVerificationRecord(std::filesystem::path path_)
+    : path{std::move(path_)} {
+    Load();
+}
+
+std::filesystem::path ContentVerificationRecord::GetRecordPath(std::string_view name) {
+    return Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "verification" /
+           fmt::format("{}.bin", name);
+}
+
+bool ContentVerificationRecord::Contains(const VfsFile& file) const {
+    return entries.contains(MakeEntry(file));
+}
+
+void ContentVerificationRecord::Insert(const VfsFile& file) {
+    is_dirty |= entries.insert(MakeEntry(file)).second;
+}
+
+void ContentVerificationRecord::Clear() {
+    entries.clear();
+    is_dirty = false;
+    Common::FS::RemoveFile(path);
+}
+
+ContentVerificationRecord::Entry ContentVerificationRecord::MakeEntry(const VfsFile& file) {
+    const std::string full_path = file.GetFullPath();
+    const auto dir = file.GetContainingDirectory();
+    const u64 modified = dir != nullptr ? dir->GetFileTimeStamp(file.GetName()).modified : 0;
+    return {Common::CityHash64(full_path.data(), full_path.size()), file.GetSize(), modified};
+}
+
+void ContentVerificationRecord::Load() {
+    if (!Common::FS::Exists(path)) {
+        return;
+    }
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                                  Common::FS::FileType::BinaryFile};
+    RecordHeader header{};
+    if (!file.IsOpen() || !file.ReadObject(header)) {
+        return;
+    }
+    if (header.magic != RecordMagic || header.version != RecordVersion) {
+        LOG_INFO(Loader, "Discarding outdated verification record {}",
+                 Common::FS::PathToUTF8String(path));
+        return;
+    }
+
+    std::vector<RecordEntry> payload;
+    if (header.entry_count == (file.GetSize() - sizeof(RecordHeader)) / sizeof(RecordEntry)) {
+        payload.resize(header.entry_count);
+    }
+    if (payload.size() != header.entry_count ||
+        file.ReadSpan<RecordEntry>(payload) != payload.size() ||
+        HashPayload(payload) != header.payload_hash) {
+        LOG_WARNING(Loader, "Discarding corrupted verification record {}",
+                    Common::FS::PathToUTF8String(path));
+        return;
+    }
+
+    for (const RecordEntry& entry : payload) {
+        entries.emplace(entry.path_hash, entry.size, entry.modified);
+    }
+}
+
+void ContentVerificationRecord::Save() {
+    if (!is_dirty) {
+        return;
+    }
+
+    std::vector<RecordEntry> payload;
+    payload.reserve(entries.size());
+    for (const auto& [path_hash, size, modified] : entries) {
+        payload.push_back({path_hash, size, modified});
+    }
+    const RecordHeader header{
+        .magic = RecordMagic,
+        .version = RecordVersion,
+        .entry_count = payload.size(),
+        .payload_hash = HashPayload(payload),
+    };
+
+    // Write a new record next to the old one and swap them, so the record on disk is always whole.
+    if (!Common::FS::CreateDirs(path.parent_path())) {
+        return;
+    }
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        const Common::FS::IOFile file{temp_path, Common::FS::FileAccessMode::Write,
+                                      Common::FS::FileType::BinaryFile};
+        if (!file.IsOpen() || !file.WriteObject(header) ||
+            file.WriteSpan<RecordEntry>(payload) != payload.size() || !file.Flush()) {
+            LOG_WARNING(Loader, "Failed to write verification record {}",
+                        Common::FS::PathToUTF8String(temp_path));
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        LOG_WARNING(Loader, "Failed to replace verification record {}: {}",
+                    Common::FS::PathToUTF8String(path), ec.message());
+        return;
+    }
+    is_dirty = false;
+}
+
+ContentVerifier::ContentVerifier(ProgressCallback progress_callback_,
+                                 ResultCallback result_callback_,
+                                 ContentVerificationRecord* record_)
+    : progress_callback{std::move(progress_callback_)},
+      result_callback{std::move(result_callback_)}, record{record_} {}
+
+ContentVerifier::~ContentVerifier() = default;
+
+void ContentVerifier::Queue(VirtualFile file) {
+    if (file != nullptr) {
+        files.push_back(std::move(file));
+    }
+}
+
+bool ContentVerifier::Run() {
+    auto run_files = std::exchange(files, {});
+    if (run_files.empty()) {
+        return true;
+    }
+
+    // Start with the largest NCAs, so the verification does not end on one large NCA alone.
+    std::ranges::stable_sort(run_files, std::greater{},
+                             [](const VirtualFile& file) { return file->GetSize(); });
+
+    std::size_t total_size = 0;
+    for (const VirtualFile& file : run_files) {
+        total_size += file->GetSize();
+    }
+
+    std::atomic<std::size_t> processed_size{};
+    std::atomic<std::size_t> num_done{};
+    std::atomic_bool cancelled{};
+    Common::Event done_event;
+
+    std::mutex results_mutex;
+    std::vector<std::pair<VirtualFile, Loader::ResultStatus>> results;
+    const auto report_results = [&] {
+        decltype(results) new_results;
+        {
+            std::scoped_lock lock{results_mutex};
+            new_results = std::exchange(results, {});
+        }
+        for (const auto& [file, status] : new_results) {
+            if (record != nullptr && status == Loader::ResultStatus::Success) {
+                record->Insert(*file);
+            }
+            if (result_callback) {
+                result_callback(file, status);
+            }
+        }
+    };
+
+    Common::TaskQueue queue{Common::TaskPriority::BackgroundIO,
+                            Common::TaskScheduler::Instance().NumWorkers()};
+    for (const VirtualFile& file : run_files) {
+        if (record != nullptr && record->Contains(*file)) {
+            processed_size += file->GetSize();
+            {
+                std::scoped_lock lock{results_mutex};
+                results.emplace_back(file, Loader::ResultStatus::Success);
+            }
+            if (++num_done == run_files.size()) {
+                done_event.Set();
+            }
+            continue;
+        }
+
+        queue.QueueWork([&, file] {
+            if (!cancelled) {
+                std::size_t last_processed = 0;
+                const auto status = VerifyNCA(file, [&](std::size_t processed, std::size_t) {
+                    processed_size += processed - last_processed;
+                    last_processed = processed;
+                    return !cancelled;
+                });
+                // Verifications interrupted by a cancel have no result.
+                if (!cancelled) {
+                    std::scoped_lock lock{results_mutex};
+                    results.emplace_back(file, status);
+                }
+            }
+            if (++num_done == run_files.size()) {
+                done_event.Set();
+            }
+        });
+    }
+
+    // Frontends are called back from the thread that started the verification only.
+    do {
+        done_event.WaitFor(ProgressInterval);
+        report_results();
+        if (progress_callback && !cancelled && progress_callback(total_size, processed_size)) {
+            cancelled = true;
+        }
+    } while (num_done != run_files.size());
+    queue.WaitForRequests();
+    report_results();
+
+    if (record != nullptr) {
+        record->Save();
+    }
+    return !cancelled;
+}
+
+Loader::ResultStatus ContentVerifier::VerifyNCA(const VirtualFile& file,
+                                                const NCAProgressCallback& progress_callback) {
+    constexpr size_t NcaFileNameWithHashLength = 36;
+    constexpr size_t NcaFileNameHashLength = 32;
+    constexpr size_t NcaSha256HalfHashLength = Core::Crypto::SHA256Hash{}.size() / 2;
+
+    // Get the file name.
+    const auto name = file->GetName();
+
+    // We won't try to verify meta NCAs.
+    if (name.ends_with(".cnmt.nca")) {
+        return Loader::ResultStatus::Success;
+    }
+
+    // Check if we can verify this file. NCAs should be named after their hashes.
+    if (!name.ends_with(".nca") || name.size() != NcaFileNameWithHashLength) {
+        LOG_WARNING(Loader, "Unable to validate NCA with name {}", name);
+        return Loader::ResultStatus::ErrorIntegrityVerificationNotImplemented;
+    }
+
+    // Get the expected truncated hash of the NCA.
+    const auto input_hash = Common::HexStringToVector(name.substr(0, NcaFileNameHashLength), false);
+
+    // Declare buffer to read into.
+    std::vector<u8> buffer(BlockSize);
+    Core::Crypto::Sha256 sha;
+
+    // Declare counters.
+    const size_t total_size = file->GetSize();
+    size_t processed_size = 0;
+
+    // Begin iterating the file.
+    while (processed_size < total_size) {
+        // Refill the buffer.
+        const size_t intended_read_size = std::min(buffer.size(), total_size - processed_size);
+        const size_t read_size = file->Read(buffer.data(), intended_read_size, processed_size);
+        if (read_size != intended_read_size) {
+            LOG_ERROR(Loader, "Failed to read NCA {} at offset {:X}", name, processed_size);
+            return Loader::ResultStatus::ErrorIntegrityVerificationFailed;
+        }
+
+        // Update the hash function with the buffer contents.
+        sha.Update(std::span{buffer.data(), read_size});
+
+        // Update counters.
+        processed_size += read_size;
+
+        // Call the progress function.
+        if (!progress_callback(processed_size, total_size)) {
+            return Loader::ResultStatus::ErrorIntegrityVerificationFailed;
+        }
+    }
+
+    // Compare to expected.
+    const auto output_hash = sha.Finalize();
+    if (std::memcmp(input_hash.data(), output_hash.data(), NcaSha256HalfHashLength) != 0) {
+        LOG_ERROR(Loader, "NCA hash mismatch detected for file {}", name);
+        return Loader::ResultStatus::ErrorIntegrityVerificationFailed;
+    }
+
+    // File verified.
+    return Loader::ResultStatus::Success;
+}
+
+} // namespace FileSys
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <set>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "core/file_sys/vfs/vfs_types.h"
+
+namespace Loader {
+enum class ResultStatus : u16;
+}
+
+namespace FileSys {
+
+using namespace Common::Literals;
+
+/**
+ * On-disk record of the files a verification found intact, so an interrupted verification can
+ * resume where it stopped. Files are identified by their path, size and modification time, so a
+ * file that changed since it was verified is verified again.
+ */
+class ContentVerificationRecord {
+public:
+    /// Loads the record stored at the path. A missing or invalid record is treated as empty.
+    explicit ContentVerificationRecord(std::filesystem::path path);
+
+    /// Returns the path of the record with the given name in the cache directory.
+    static std::filesystem::path GetRecordPath(std::string_view name);
+
+    bool Contains(const VfsFile& file) const;
+
+    void Insert(const VfsFile& file);
+
+    /// Forgets all verified files, and removes the record from disk.
+    void Clear();
+
+    /// Writes the record to disk, if it changed since it was loaded or saved.
+    void Save();
+
+    bool IsEmpty() const {
+        return entries.empty();
+    }
+
+private:
+    /// Hash of the path, size and modification time of a file.
+    using Entry = std::tuple<u64, u64, u64>;
+
+    static Entry MakeEntry(const VfsFile& file);
+
+    void Load();
+
+    std::filesystem::path path;
+    std::set<Entry> entries;
+    bool is_dirty{};
+};
+
+/**
+ * Verifies NCAs against the SHA-256 they are named after.
+ *
+ * Queued NCAs are hashed concurrently on the task scheduler, largest first, each streamed through
+ * a single block sized buffer. Progress and the result of every NCA are reported on the thread
+ * calling Run as they come in.
+ */
+class ContentVerifier {
+public:
+    /// Size of the blocks NCAs are read and hashed in.
+    static constexpr std::size_t BlockSize = 4_MiB;
+
+    /// Receives the total and processed size of the queued NCAs. Returning true cancels Run.
+    using ProgressCallback = std::function<bool(std::size_t, std::size_t)>;
+    /// Receives the result of every verified NCA.
+    using ResultCallback = std::function<void(const VirtualFile&, Loader::ResultStatus)>;
+    /// Receives the processed and total size of an NCA. Returning false cancels VerifyNCA.
+    using NCAProgressCallback = std::function<bool(std::size_t, std::size_t)>;
+
+    /**
+     * When a record is given, NCAs found in it are skipped and reported as verified, and NCAs
+     * verified by Run are added to it.
+     */
+    explicit ContentVerifier(ProgressCallback progress_callback = {},
+                             ResultCallback result_callback = {},
+                             ContentVerificationRecord* record = nullptr);
+    ~ContentVerifier();
+
+    ContentVerifier(const ContentVerifier&) = delete;
+    ContentVerifier& operator=(const ContentVerifier&) = delete;
+
+    void Queue(VirtualFile file);
+
+    /// Verifies all queued NCAs. Returns false if the verification was cancelled.
+    bool Run();
+
+    /// Verifies a single NCA on the calling thread. A cancelled verification fails.
+    static Loader::ResultStatus VerifyNCA(const VirtualFile& file,
+                                          const NCAProgressCallback& progress_callback);
+
+private:
+    ProgressCallback progress_callback;
+    ResultCallback result_callback;
+    ContentVerificationRecord* record;
+
+    std::vector<VirtualFile> files;
+};
+
+} // namespace FileSys
@@ -2,13 +2,20 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <cstring>
+#include <set>
 #include <span>
 #include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/cityhash.h"
+#include "common/logging/log.h"
 #include "core/file_sys/fsmitm_romfsbuild.h"
 #include "core/file_sys/ips_layer.h"
+#include "core/file_sys/romfs.h"
 #include "core/file_sys/vfs/vfs.h"
+#include "core/file_sys/vfs/vfs_offset.h"
 #include "core/file_sys/vfs/vfs_vector.h"
 
 namespace FileSys {
@@ -76,6 +83,10 @@ struct RomFSBuildFileContext {
     std::shared_ptr<RomFSBuildDirectoryContext> parent;
     std::shared_ptr<RomFSBuildFileContext> sibling;
     VirtualFile source;
+    u64 source_offset = 0;
+    u64 source_size = 0;
+    u32 source_layer = 0;
+    u32 ips_layer = RomFSBuildCache::NoLayer;
 };
 
 static u32 romfs_calc_path_hash(u32 parent, std::string_view path, u32 start,
@@ -106,60 +117,355 @@ static u64 romfs_get_hash_table_count(u64 num_entries) {
     return count;
 }
 
-void RomFSBuildContext::VisitDirectory(VirtualDir romfs_dir, VirtualDir ext_dir,
-                                       std::shared_ptr<RomFSBuildDirectoryContext> parent) {
-    for (auto& child_romfs_file : romfs_dir->GetFiles()) {
-        const auto name = child_romfs_file->GetName();
-        const auto child = std::make_shared<RomFSBuildFileContext>();
-        // Set child's path.
-        child->cur_path_ofs = parent->path_len + 1;
-        child->path_len = child->cur_path_ofs + static_cast<u32>(name.size());
-        child->path = parent->path + "/" + name;
+static u64 romfs_hash_combine(u64 seed, std::string_view data) {
+    return Common::CityHash64WithSeed(data.data(), data.size(), seed);
+}
+
+static u64 romfs_hash_combine(u64 seed, u64 value) {
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(&value), sizeof(value), seed);
+}
+
+// Hashes the names and sizes of all entries below a directory.
+static u64 romfs_hash_directory(u64 seed, const VirtualDir& dir) {
+    for (const auto& file : dir->GetFiles()) {
+        seed = romfs_hash_combine(romfs_hash_combine(seed, file->GetName()), file->GetSize());
+    }
+    for (const auto& subdir : dir->GetSubdirectories()) {
+        seed = romfs_hash_directory(romfs_hash_combine(seed, "/" + subdir->GetName()), subdir);
+    }
+    return romfs_hash_combine(seed, "..");
+}
+
+// Identifies a RomFS by its header and tables, which describe all of its files.
+static std::optional<u64> romfs_get_identity(const VirtualFile& romfs) {
+    RomFSHeader header{};
+    if (romfs->ReadObject(&header) != sizeof(RomFSHeader) ||
+        header.header_size != sizeof(RomFSHeader)) {
+        return std::nullopt;
+    }
+    const auto dir_table = romfs->ReadBytes(header.dir_table_size, header.dir_table_ofs);
+    const auto file_table = romfs->ReadBytes(header.file_table_size, header.file_table_ofs);
+
+    u64 identity = romfs_hash_combine(romfs->GetSize(),
+                                      {reinterpret_cast<const char*>(&header), sizeof(header)});
+    identity = romfs_hash_combine(
+        identity, {reinterpret_cast<const char*>(dir_table.data()), dir_table.size()});
+    return romfs_hash_combine(
+        identity, {reinterpret_cast<const char*>(file_table.data()), file_table.size()});
+}
+
+// Returns the name of the top level entry a path is below, or an empty name for files at the root.
+static std::string_view romfs_get_subtree(std::string_view path, bool is_directory) {
+    const auto end = path.find('/', 1);
+    if (end == std::string_view::npos && !is_directory) {
+        return {};
+    }
+    return path.substr(1, end == std::string_view::npos ? end : end - 1);
+}
+
+// Returns the file of the highest priority ext layer with the given name.
+static VirtualFile romfs_find_ext_file(const std::vector<VirtualDir>& ext_dirs,
+                                       const std::string& name, u32& layer) {
+    for (layer = 0; layer < ext_dirs.size(); ++layer) {
+        if (ext_dirs[layer] == nullptr) {
+            continue;
+        }
+        if (auto file = ext_dirs[layer]->GetFile(name)) {
+            return file;
+        }
+    }
+    layer = RomFSBuildCache::NoLayer;
+    return nullptr;
+}
+
+void RomFSBuildContext::VisitLayers(const Layers& dirs, const Layers& ext_dirs,
+                                    std::shared_ptr<RomFSBuildDirectoryContext> parent) {
+    VisitFiles(dirs, ext_dirs, parent);
+
+    // Merge the subdirectories of all layers, in the order they are first found.
+    std::vector<std::pair<std::string, Layers>> subdirs;
+    std::unordered_map<std::string, std::size_t> subdir_indices;
+    for (std::size_t layer = 0; layer < dirs.size(); ++layer) {
+        if (dirs[layer] == nullptr) {
+            continue;
+        }
+        for (auto& child_romfs_dir : dirs[layer]->GetSubdirectories()) {
+            auto name = child_romfs_dir->GetName();
+            const auto [it, is_new] = subdir_indices.emplace(name, subdirs.size());
+            if (is_new) {
+                subdirs.emplace_back(std::move(name), Layers(dirs.size()));
+            }
+            subdirs[it->second].second[layer] = std::move(child_romfs_dir);
+        }
+    }
+
+    for (const auto& [name, child_dirs] : subdirs) {
+        VisitSubdirectory(child_dirs, ext_dirs, parent, name);
+    }
+}
 
-        if (ext_dir != nullptr && ext_dir->GetFile(name + ".stub") != nullptr) {
+void RomFSBuildContext::VisitFiles(const Layers& dirs, const Layers& ext_dirs,
+                                   std::shared_ptr<RomFSBuildDirectoryContext> parent) {
+    std::unordered_set<std::string> names;
+    for (u32 layer = 0; layer < dirs.size(); ++layer) {
+        if (dirs[layer] == nullptr) {
             continue;
         }
+        for (auto& child_romfs_file : dirs[layer]->GetFiles()) {
+            const auto name = child_romfs_file->GetName();
+            if (!names.insert(name).second) {
+                continue;
+            }
+            const auto child = std::make_shared<RomFSBuildFileContext>();
+            // Set child's path.
+            child->cur_path_ofs = parent->path_len + 1;
+            child->path_len = child->cur_path_ofs + static_cast<u32>(name.size());
+            child->path = parent->path + "/" + name;
+
+            u32 ext_layer;
+            if (romfs_find_ext_file(ext_dirs, name + ".stub", ext_layer) != nullptr) {
+                continue;
+            }
 
-        // Sanity check on path_len
-        ASSERT(child->path_len < FS_MAX_PATH);
+            // Sanity check on path_len
+            ASSERT(child->path_len < FS_MAX_PATH);
 
-        child->source = std::move(child_romfs_file);
+            child->source = std::move(child_romfs_file);
+            child->source_layer = layer;
+            child->source_size = child->source->GetSize();
+            if (!cache_path.empty() && layer == num_mod_layers) {
+                // Files of the base RomFS were extracted as views of it.
+                child->source_offset =
+                    static_cast<const OffsetVfsFile&>(*child->source).GetOffset();
+            }
 
-        if (ext_dir != nullptr) {
-            if (const auto ips = ext_dir->GetFile(name + ".ips")) {
+            if (const auto ips = romfs_find_ext_file(ext_dirs, name + ".ips", ext_layer)) {
                 if (auto patched = PatchIPS(child->source, ips)) {
                     child->source = std::move(patched);
+                    child->ips_layer = ext_layer;
                 }
             }
+
+            child->size = child->source->GetSize();
+
+            AddFile(parent, std::move(child));
         }
+    }
+}
+
+void RomFSBuildContext::VisitSubdirectory(const Layers& dirs, const Layers& ext_dirs,
+                                          std::shared_ptr<RomFSBuildDirectoryContext> parent,
+                                          const std::string& name) {
+    const auto child = std::make_shared<RomFSBuildDirectoryContext>();
+    // Set child's path.
+    child->cur_path_ofs = parent->path_len + 1;
+    child->path_len = child->cur_path_ofs + static_cast<u32>(name.size());
+    child->path = parent->path + "/" + name;
+
+    u32 ext_layer;
+    if (romfs_find_ext_file(ext_dirs, name + ".stub", ext_layer) != nullptr) {
+        return;
+    }
+
+    // Sanity check on path_len
+    ASSERT(child->path_len < FS_MAX_PATH);
+
+    if (!AddDirectory(parent, child)) {
+        return;
+    }
 
-        child->size = child->source->GetSize();
+    Layers child_ext_dirs(ext_dirs.size());
+    for (std::size_t layer = 0; layer < ext_dirs.size(); ++layer) {
+        if (ext_dirs[layer] != nullptr) {
+            child_ext_dirs[layer] = ext_dirs[layer]->GetSubdirectory(name);
+        }
+    }
+    VisitLayers(dirs, child_ext_dirs, child);
+}
 
-        AddFile(parent, std::move(child));
+void RomFSBuildContext::ExtractBase() {
+    // The base RomFS is only extracted once a part of it has to be visited.
+    if (layers.size() == num_mod_layers) {
+        auto extracted = ExtractRomFS(base_romfs);
+        layers.push_back(extracted != nullptr ? std::move(extracted)
+                                              : std::make_shared<VectorVfsDirectory>());
     }
+}
 
-    for (auto& child_romfs_dir : romfs_dir->GetSubdirectories()) {
-        const auto name = child_romfs_dir->GetName();
+void RomFSBuildContext::VisitSubtree(const std::string& name) {
+    ExtractBase();
+
+    if (name.empty()) {
+        VisitFiles(layers, ext_layers, root);
+        return;
+    }
+
+    Layers dirs(layers.size());
+    bool found = false;
+    for (std::size_t layer = 0; layer < layers.size(); ++layer) {
+        dirs[layer] = layers[layer]->GetSubdirectory(name);
+        found |= dirs[layer] != nullptr;
+    }
+    if (found) {
+        VisitSubdirectory(dirs, ext_layers, root, name);
+    }
+}
+
+bool RomFSBuildContext::ReuseSubtree(
+    const std::vector<const std::string*>& subtree_dirs,
+    const std::vector<const RomFSBuildCache::File*>& subtree_files) {
+    std::unordered_map<std::string_view, std::shared_ptr<RomFSBuildDirectoryContext>> dir_ctxs;
+    const auto find_parent = [&](std::string_view path) {
+        const auto separator = path.rfind('/');
+        if (separator == 0) {
+            return root;
+        }
+        const auto it = dir_ctxs.find(path.substr(0, separator));
+        return it != dir_ctxs.end() ? it->second : nullptr;
+    };
+
+    // Directories are sorted by path, so parents come before their children.
+    std::vector<std::shared_ptr<RomFSBuildDirectoryContext>> new_dirs;
+    for (const std::string* path : subtree_dirs) {
         const auto child = std::make_shared<RomFSBuildDirectoryContext>();
-        // Set child's path.
-        child->cur_path_ofs = parent->path_len + 1;
-        child->path_len = child->cur_path_ofs + static_cast<u32>(name.size());
-        child->path = parent->path + "/" + name;
+        child->parent = find_parent(*path);
+        if (child->parent == nullptr) {
+            return false;
+        }
+        child->path = *path;
+        child->cur_path_ofs = child->parent->path_len + 1;
+        child->path_len = static_cast<u32>(child->path.size());
+        dir_ctxs.emplace(child->path, child);
+        new_dirs.push_back(child);
+    }
 
-        if (ext_dir != nullptr && ext_dir->GetFile(name + ".stub") != nullptr) {
-            continue;
+    std::vector<std::shared_ptr<RomFSBuildFileContext>> new_files;
+    for (const RomFSBuildCache::File* file : subtree_files) {
+        const auto child = std::make_shared<RomFSBuildFileContext>();
+        child->parent = find_parent(file->path);
+        child->source = OpenCachedFile(*file);
+        if (child->parent == nullptr || child->source == nullptr ||
+            child->source->GetSize() != file->size) {
+            return false;
+        }
+        child->path = file->path;
+        child->cur_path_ofs = child->parent->path_len + 1;
+        child->path_len = static_cast<u32>(child->path.size());
+        child->offset = file->offset;
+        child->size = file->size;
+        child->source_offset = file->source_offset;
+        child->source_size = file->source_size;
+        child->source_layer = file->source_layer;
+        child->ips_layer = file->ips_layer;
+        new_files.push_back(child);
+    }
+
+    for (auto& child : new_dirs) {
+        auto parent = std::move(child->parent);
+        AddDirectory(std::move(parent), std::move(child));
+    }
+    for (auto& child : new_files) {
+        auto parent = std::move(child->parent);
+        AddFile(std::move(parent), std::move(child));
+    }
+    return true;
+}
+
+VirtualFile RomFSBuildContext::OpenCachedFile(const RomFSBuildCache::File& file) const {
+    VirtualFile source;
+    if (file.source_layer < num_mod_layers) {
+        source = layers[file.source_layer]->GetFileRelative(file.path);
+    } else if (file.source_layer == num_mod_layers) {
+        source = std::make_shared<OffsetVfsFile>(base_romfs, file.source_size, file.source_offset,
+                                                 file.path.substr(file.path.rfind('/') + 1));
+    }
+    if (source == nullptr || source->GetSize() != file.source_size) {
+        return nullptr;
+    }
+
+    if (file.ips_layer == RomFSBuildCache::NoLayer) {
+        return source;
+    }
+    if (file.ips_layer >= ext_layers.size() || ext_layers[file.ips_layer] == nullptr) {
+        return nullptr;
+    }
+    const auto ips = ext_layers[file.ips_layer]->GetFileRelative(file.path + ".ips");
+    return ips != nullptr ? PatchIPS(source, ips) : nullptr;
+}
+
+void RomFSBuildContext::ComputeFingerprints() {
+    const auto add = [this](std::string_view name, u64 value) {
+        const auto [it, is_new] = fingerprints.try_emplace(std::string(name), 0);
+        it->second = romfs_hash_combine(it->second, value);
+    };
+    const auto add_layer = [&](const VirtualDir& dir, u64 layer_tag) {
+        for (const auto& file : dir->GetFiles()) {
+            add("", romfs_hash_combine(romfs_hash_combine(layer_tag, file->GetName()),
+                                       file->GetSize()));
         }
+        for (const auto& subdir : dir->GetSubdirectories()) {
+            add(subdir->GetName(), romfs_hash_directory(layer_tag, subdir));
+        }
+    };
 
-        // Sanity check on path_len
-        ASSERT(child->path_len < FS_MAX_PATH);
+    for (std::size_t layer = 0; layer < layers.size(); ++layer) {
+        add_layer(layers[layer], layer);
+    }
+    for (std::size_t layer = 0; layer < ext_layers.size(); ++layer) {
+        const u64 layer_tag = (u64{1} << 32) | layer;
+        add_layer(ext_layers[layer], layer_tag);
+
+        // Stubs at the root hide whole top level directories.
+        for (const auto& file : ext_layers[layer]->GetFiles()) {
+            const auto name = file->GetName();
+            if (name.ends_with(".stub")) {
+                add(std::string_view{name}.substr(0, name.size() - 5),
+                    romfs_hash_combine(layer_tag, name));
+            }
+        }
+    }
+}
 
-        if (!AddDirectory(parent, child)) {
+u64 RomFSBuildContext::GetFingerprint(std::string_view name) const {
+    const auto it = fingerprints.find(name);
+    return it != fingerprints.end() ? it->second : 0;
+}
+
+void RomFSBuildContext::SaveCache(std::span<const u8> header, std::span<const u8> metadata) const {
+    RomFSBuildCache new_cache{
+        .base_identity = base_identity,
+        .num_layers = static_cast<u32>(num_mod_layers),
+        .num_ext_layers = static_cast<u32>(ext_layers.size()),
+        .subtrees{fingerprints.begin(), fingerprints.end()},
+        .header{header.begin(), header.end()},
+        .metadata{metadata.begin(), metadata.end()},
+    };
+    new_cache.subtrees.try_emplace("", GetFingerprint(""));
+
+    new_cache.directories.reserve(directories.size());
+    for (const auto& cur_dir : directories) {
+        if (cur_dir == root) {
             continue;
         }
+        const auto subtree = romfs_get_subtree(cur_dir->path, true);
+        new_cache.subtrees.try_emplace(std::string(subtree), GetFingerprint(subtree));
+        new_cache.directories.push_back(cur_dir->path);
+    }
 
-        auto child_ext_dir = ext_dir != nullptr ? ext_dir->GetSubdirectory(name) : nullptr;
-        this->VisitDirectory(child_romfs_dir, child_ext_dir, child);
+    new_cache.files.reserve(files.size());
+    for (const auto& cur_file : files) {
+        new_cache.files.push_back({
+            .path = cur_file->path,
+            .size = cur_file->size,
+            .offset = cur_file->offset,
+            .source_offset = cur_file->source_offset,
+            .source_size = cur_file->source_size,
+            .source_layer = cur_file->source_layer,
+            .ips_layer = cur_file->ips_layer,
+        });
     }
+
+    new_cache.Save(cache_path);
 }
 
 bool RomFSBuildContext::AddDirectory(std::shared_ptr<RomFSBuildDirectoryContext> parent_dir_ctx,
@@ -186,20 +492,99 @@ bool RomFSBuildContext::AddFile(std::shared_ptr<RomFSBuildDirectoryContext> pare
     return true;
 }
 
-RomFSBuildContext::RomFSBuildContext(VirtualDir base_, VirtualDir ext_)
-    : base(std::move(base_)), ext(std::move(ext_)) {
+void RomFSBuildContext::InitializeRoot() {
     root = std::make_shared<RomFSBuildDirectoryContext>();
     root->path = "\0";
     directories.emplace_back(root);
     num_dirs = 1;
     dir_table_size = 0x18;
+}
+
+RomFSBuildContext::RomFSBuildContext(VirtualDir base, VirtualDir ext) : layers{std::move(base)} {
+    if (ext != nullptr) {
+        ext_layers.push_back(std::move(ext));
+    }
+    InitializeRoot();
+
+    VisitLayers(layers, ext_layers, root);
+}
 
-    VisitDirectory(base, ext, root);
+RomFSBuildContext::RomFSBuildContext(VirtualFile base_romfs_, std::vector<VirtualDir> layers_,
+                                     std::vector<VirtualDir> ext_layers_,
+                                     std::filesystem::path cache_path_)
+    : base_romfs{std::move(base_romfs_)}, layers{std::move(layers_)},
+      ext_layers{std::move(ext_layers_)}, num_mod_layers{layers.size()},
+      cache_path{std::move(cache_path_)} {
+    InitializeRoot();
+
+    const auto identity = romfs_get_identity(base_romfs);
+    if (!identity) {
+        is_valid = false;
+        return;
+    }
+    base_identity = *identity;
+    ComputeFingerprints();
+
+    cache = RomFSBuildCache::Load(cache_path);
+    if (!cache || cache->base_identity != base_identity || cache->num_layers != num_mod_layers ||
+        cache->num_ext_layers != ext_layers.size() || cache->header.size() != sizeof(RomFSHeader)) {
+        cache.reset();
+        ExtractBase();
+        VisitLayers(layers, ext_layers, root);
+        return;
+    }
+
+    // Group the cached entries by the top level entry they are below.
+    using SubtreeEntries =
+        std::pair<std::vector<const std::string*>, std::vector<const RomFSBuildCache::File*>>;
+    std::unordered_map<std::string_view, SubtreeEntries> cached_subtrees;
+    for (const std::string& path : cache->directories) {
+        cached_subtrees[romfs_get_subtree(path, true)].first.push_back(&path);
+    }
+    for (const RomFSBuildCache::File& file : cache->files) {
+        cached_subtrees[romfs_get_subtree(file.path, false)].second.push_back(&file);
+    }
+
+    // Reuse the entries of the subtrees the layers did not change, and visit the others again.
+    std::set<std::string, std::less<>> subtrees{""};
+    for (const auto& [name, fingerprint] : cache->subtrees) {
+        subtrees.insert(name);
+    }
+    for (const auto& [name, fingerprint] : fingerprints) {
+        subtrees.insert(name);
+    }
+    std::size_t num_visited = 0;
+    for (const std::string& name : subtrees) {
+        const auto cached = cache->subtrees.find(name);
+        if (cached != cache->subtrees.end() && cached->second == GetFingerprint(name)) {
+            const auto entries = cached_subtrees.find(name);
+            if (entries == cached_subtrees.end() ||
+                ReuseSubtree(entries->second.first, entries->second.second)) {
+                continue;
+            }
+        }
+        VisitSubtree(name);
+        ++num_visited;
+    }
+
+    reuse_cached_layout = num_visited == 0;
+    if (!reuse_cached_layout) {
+        cache.reset();
+    }
+    LOG_INFO(Loader, "    RomFS: Reused the cached LayeredFS layout of {} of {} top level entries",
+             subtrees.size() - num_visited, subtrees.size());
 }
 
 RomFSBuildContext::~RomFSBuildContext() = default;
 
 std::vector<std::pair<u64, VirtualFile>> RomFSBuildContext::Build() {
+    if (!is_valid) {
+        return {};
+    }
+    if (reuse_cached_layout) {
+        return BuildFromCache();
+    }
+
     const u64 dir_hash_table_entry_count = romfs_get_hash_table_count(num_dirs);
     const u64 file_hash_table_entry_count = romfs_get_hash_table_count(num_files);
     dir_hash_table_size = 4 * dir_hash_table_entry_count;
@@ -340,6 +725,10 @@ std::vector<std::pair<u64, VirtualFile>> RomFSBuildContext::Build() {
                     cur_dir->path.data() + cur_dir->cur_path_ofs, name_size);
     }
 
+    if (!cache_path.empty()) {
+        SaveCache({reinterpret_cast<const u8*>(&header), sizeof(RomFSHeader)}, metadata);
+    }
+
     // Write metadata.
     out.emplace_back(header.dir_hash_table_ofs,
                      std::make_shared<VectorVfsFile>(std::move(metadata)));
@@ -351,4 +740,24 @@ std::vector<std::pair<u64, VirtualFile>> RomFSBuildContext::Build() {
     return out;
 }
 
+std::vector<std::pair<u64, VirtualFile>> RomFSBuildContext::BuildFromCache() {
+    RomFSHeader header{};
+    std::memcpy(&header, cache->header.data(), sizeof(RomFSHeader));
+
+    // The cached layout is unchanged, so only the sources of the files have to be resolved.
+    std::sort(files.begin(), files.end(),
+              [](const auto& a, const auto& b) { return a->offset < b->offset; });
+
+    std::vector<std::pair<u64, VirtualFile>> out;
+    out.reserve(files.size() + 2);
+    out.emplace_back(0, std::make_shared<VectorVfsFile>(std::move(cache->header)));
+    for (const auto& cur_file : files) {
+        out.emplace_back(cur_file->offset + ROMFS_FILEPARTITION_OFS, std::move(cur_file->source));
+    }
+    out.emplace_back(header.dir_hash_table_ofs,
+                     std::make_shared<VectorVfsFile>(std::move(cache->metadata)));
+
+    return out;
+}
+
 } // namespace FileSys
@@ -3,10 +3,16 @@
 
 #pragma once
 
+#include <filesystem>
 #include <map>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "common/common_types.h"
+#include "core/file_sys/romfs_build_cache.h"
 #include "core/file_sys/vfs/vfs.h"
 
 namespace FileSys {
@@ -19,14 +25,33 @@ struct RomFSFileEntry;
 class RomFSBuildContext {
 public:
     explicit RomFSBuildContext(VirtualDir base, VirtualDir ext = nullptr);
+
+    /**
+     * Lays out the RomFS base_romfs with the layers and ext_layers on top, in decreasing priority.
+     * The layout is cached at cache_path, and the parts of it below the top level entries the
+     * layers did not change since are reused instead of being visited again.
+     */
+    RomFSBuildContext(VirtualFile base_romfs, std::vector<VirtualDir> layers,
+                      std::vector<VirtualDir> ext_layers, std::filesystem::path cache_path);
     ~RomFSBuildContext();
 
-    // This finalizes the context.
+    // This finalizes the context. Returns an empty vector if the base RomFS is invalid.
     std::vector<std::pair<u64, VirtualFile>> Build();
 
 private:
-    VirtualDir base;
-    VirtualDir ext;
+    using Layers = std::vector<VirtualDir>;
+
+    VirtualFile base_romfs;
+    Layers layers;
+    Layers ext_layers;
+    std::size_t num_mod_layers = 0;
+    std::filesystem::path cache_path;
+    std::optional<RomFSBuildCache> cache;
+    std::map<std::string, u64, std::less<>> fingerprints;
+    u64 base_identity = 0;
+    bool is_valid = true;
+    bool reuse_cached_layout = false;
+
     std::shared_ptr<RomFSBuildDirectoryContext> root;
     std::vector<std::shared_ptr<RomFSBuildDirectoryContext>> directories;
     std::vector<std::shared_ptr<RomFSBuildFileContext>> files;
@@ -38,8 +63,32 @@ private:
     u64 file_hash_table_size = 0;
     u64 file_partition_size = 0;
 
-    void VisitDirectory(VirtualDir filesys, VirtualDir ext_dir,
-                        std::shared_ptr<RomFSBuildDirectoryContext> parent);
+    void InitializeRoot();
+
+    void VisitLayers(const Layers& dirs, const Layers& ext_dirs,
+                     std::shared_ptr<RomFSBuildDirectoryContext> parent);
+    void VisitFiles(const Layers& dirs, const Layers& ext_dirs,
+                    std::shared_ptr<RomFSBuildDirectoryContext> parent);
+    void VisitSubdirectory(const Layers& dirs, const Layers& ext_dirs,
+                           std::shared_ptr<RomFSBuildDirectoryContext> parent,
+                           const std::string& name);
+
+    void ExtractBase();
+
+    /// Visits the files at the root for an empty name, or else the top level directory name.
+    void VisitSubtree(const std::string& name);
+
+    /// Adds the entries below a top level entry from the cache. Returns false if they are stale.
+    bool ReuseSubtree(const std::vector<const std::string*>& subtree_dirs,
+                      const std::vector<const RomFSBuildCache::File*>& subtree_files);
+
+    VirtualFile OpenCachedFile(const RomFSBuildCache::File& file) const;
+
+    void ComputeFingerprints();
+    u64 GetFingerprint(std::string_view name) const;
+
+    void SaveCache(std::span<const u8> header, std::span<const u8> metadata) const;
+    std::vector<std::pair<u64, VirtualFile>> BuildFromCache();
 
     bool AddDirectory(std::shared_ptr<RomFSBuildDirectoryContext> parent_dir_ctx,
                       std::shared_ptr<RomFSBuildDirectoryContext> dir_ctx);
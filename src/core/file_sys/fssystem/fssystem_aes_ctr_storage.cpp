@@ -32,7 +32,7 @@ AesCtrStorage::AesCtrStorage(VirtualFile base, const void* key, size_t key_size,
     std::memcpy(m_key.data(), key, KeySize);
     std::memcpy(m_iv.data(), iv, IvSize);
 
-    m_cipher.emplace(m_key, Core::Crypto::Mode::CTR);
+    m_cipher.emplace(m_key);
 }
 
 size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
@@ -57,8 +57,7 @@ size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
     AddCounter(ctr.data(), IvSize, offset / BlockSize);
 
     // Decrypt.
-    m_cipher->SetIV(ctr);
-    m_cipher->Transcode(buffer, size, buffer, Core::Crypto::Op::Decrypt);
+    m_cipher->Transcode(buffer, buffer, size, ctr);
 
     return size;
 }
@@ -104,9 +103,8 @@ size_t AesCtrStorage::Write(const u8* buffer, size_t size, size_t offset) {
         }
 
         // Encrypt the data.
-        m_cipher->SetIV(ctr);
-        m_cipher->Transcode(buffer, write_size, reinterpret_cast<u8*>(write_buf),
-                            Core::Crypto::Op::Encrypt);
+        m_cipher->Transcode(buffer + cur_offset, reinterpret_cast<u8*>(write_buf), write_size,
+                            ctr);
 
         // Write the encrypted data.
         m_base_storage->Write(reinterpret_cast<u8*>(write_buf), write_size, offset + cur_offset);
@@ -5,7 +5,7 @@
 
 #include <optional>
 
-#include "core/crypto/aes_util.h"
+#include "core/crypto/aes_engine.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/fssystem/fs_i_storage.h"
@@ -37,7 +37,7 @@ private:
     VirtualFile m_base_storage;
     std::array<u8, KeySize> m_key;
     std::array<u8, IvSize> m_iv;
-    mutable std::optional<Core::Crypto::AESCipher<Core::Crypto::Key128>> m_cipher;
+    std::optional<Core::Crypto::AesCtrEngine> m_cipher;
 };
 
 } // namespace FileSys
@@ -35,7 +35,7 @@ AesXtsStorage::AesXtsStorage(VirtualFile base, const void* key1, const void* key
     std::memcpy(m_key.data() + 0x10, key2, KeySize / 2);
     std::memcpy(m_iv.data(), iv, IvSize);
 
-    m_cipher.emplace(m_key, Core::Crypto::Mode::XTS);
+    m_cipher.emplace(m_key);
 }
 
 size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
@@ -75,9 +75,8 @@ size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
             std::memset(tmp_buf.GetBuffer(), 0, skip_size);
             std::memcpy(tmp_buf.GetBuffer() + skip_size, buffer, data_size);
 
-            m_cipher->SetIV(ctr);
-            m_cipher->Transcode(tmp_buf.GetBuffer(), m_block_size, tmp_buf.GetBuffer(),
-                                Core::Crypto::Op::Decrypt);
+            u8* const tmp = reinterpret_cast<u8*>(tmp_buf.GetBuffer());
+            m_cipher->Decrypt(tmp, tmp, m_block_size, m_block_size, ctr);
 
             std::memcpy(buffer, tmp_buf.GetBuffer() + skip_size, data_size);
         }
@@ -87,19 +86,27 @@ size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
         ASSERT(processed_size == std::min(size, m_block_size - skip_size));
     }
 
-    // Decrypt aligned chunks.
-    char* cur = reinterpret_cast<char*>(buffer) + processed_size;
-    size_t remaining = size - processed_size;
-    while (remaining > 0) {
-        const size_t cur_size = std::min(m_block_size, remaining);
+    // Decrypt all aligned blocks at once.
+    u8* cur = buffer + processed_size;
+    const size_t remaining = size - processed_size;
+    const size_t aligned_size = Common::AlignDown(remaining, m_block_size);
+    if (aligned_size > 0) {
+        m_cipher->Decrypt(cur, cur, aligned_size, m_block_size, ctr);
+        AddCounter(ctr.data(), IvSize, aligned_size / m_block_size);
+    }
 
-        m_cipher->SetIV(ctr);
-        m_cipher->Transcode(cur, cur_size, cur, Core::Crypto::Op::Decrypt);
+    // Handle any unaligned data after the end.
+    if (const size_t tail_size = remaining - aligned_size; tail_size > 0) {
+        PooledBuffer tmp_buf(m_block_size, m_block_size);
+        ASSERT(tmp_buf.GetSize() >= m_block_size);
 
-        remaining -= cur_size;
-        cur += cur_size;
+        std::memcpy(tmp_buf.GetBuffer(), cur + aligned_size, tail_size);
+        std::memset(tmp_buf.GetBuffer() + tail_size, 0, m_block_size - tail_size);
 
-        AddCounter(ctr.data(), IvSize, 1);
+        u8* const tmp = reinterpret_cast<u8*>(tmp_buf.GetBuffer());
+        m_cipher->Decrypt(tmp, tmp, m_block_size, m_block_size, ctr);
+
+        std::memcpy(cur + aligned_size, tmp_buf.GetBuffer(), tail_size);
     }
 
     return size;
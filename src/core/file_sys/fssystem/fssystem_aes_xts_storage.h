@@ -6,7 +6,7 @@
 #include <mutex>
 #include <optional>
 
-#include "core/crypto/aes_util.h"
+#include "core/crypto/aes_engine.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/fssystem/fs_i_storage.h"
 
@@ -37,7 +37,7 @@ private:
     std::array<u8, IvSize> m_iv;
     const size_t m_block_size;
     std::mutex m_mutex;
-    mutable std::optional<Core::Crypto::AESCipher<Core::Crypto::Key256>> m_cipher;
+    std::optional<Core::Crypto::AesXtsEngine> m_cipher;
 };
 
 } // namespace FileSys
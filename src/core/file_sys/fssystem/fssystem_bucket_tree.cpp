@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <bit>
+
+#include "common/scope_exit.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/fssystem/fssystem_bucket_tree.h"
 #include "core/file_sys/fssystem/fssystem_bucket_tree_utils.h"
@@ -142,8 +145,40 @@ public:
     }
 };
 
+/// Stores the sorted offsets in Eytzinger order, returns the next index in sorted.
+size_t BuildEytzinger(std::vector<s64>& offsets, std::vector<s32>& ranks,
+                      const std::vector<s64>& sorted, size_t sorted_index, size_t position) {
+    if (position < offsets.size()) {
+        sorted_index = BuildEytzinger(offsets, ranks, sorted, sorted_index, 2 * position);
+        offsets[position] = sorted[sorted_index];
+        ranks[position] = static_cast<s32>(sorted_index++);
+        sorted_index = BuildEytzinger(offsets, ranks, sorted, sorted_index, 2 * position + 1);
+    }
+    return sorted_index;
+}
+
 } // namespace
 
+s32 BucketTree::LookupIndex::Find(s64 virtual_address) const {
+    // Descend the implicit tree, the position ends up past a leaf.
+    const size_t size = offsets.size();
+    size_t position = 1;
+    while (position < size) {
+#if defined(__GNUC__) || defined(__clang__)
+        // The offsets four levels down share a cache line.
+        __builtin_prefetch(offsets.data() + 16 * position);
+#endif
+        position = 2 * position + (offsets[position] <= virtual_address ? 1 : 0);
+    }
+
+    // Go back up to the first entry starting after the address.
+    position >>= std::countr_one(position) + 1;
+    if (position == 0) {
+        return static_cast<s32>(size) - 2;
+    }
+    return ranks[position] - 1;
+}
+
 void BucketTree::Header::Format(s32 entry_count_) {
     ASSERT(entry_count_ >= 0);
 
@@ -245,6 +280,11 @@ void BucketTree::Initialize(size_t node_size, s64 end_offset) {
 
 void BucketTree::Finalize() {
     if (this->IsInitialized()) {
+        m_lookup_index.entry_storage = {};
+        m_lookup_index.offsets = {};
+        m_lookup_index.ranks = {};
+        m_lookup_index.is_built = false;
+
         m_node_storage = VirtualFile();
         m_entry_storage = VirtualFile();
         m_node_l1.Free(m_node_size);
@@ -275,6 +315,93 @@ Result BucketTree::Find(Visitor* visitor, s64 virtual_address) {
     R_RETURN(visitor->Find(virtual_address));
 }
 
+void BucketTree::SetLookupIndexEnabled(bool enabled) {
+    std::scoped_lock lk{m_lookup_index.mutex};
+    m_lookup_index.is_enabled = enabled;
+    if (!enabled) {
+        m_lookup_index.entry_storage = {};
+        m_lookup_index.offsets = {};
+        m_lookup_index.ranks = {};
+    }
+    m_lookup_index.is_built = !enabled;
+}
+
+const BucketTree::LookupIndex* BucketTree::GetLookupIndex() const {
+    if (!m_lookup_index.is_built.load(std::memory_order_acquire)) {
+        this->BuildLookupIndex();
+    }
+    return m_lookup_index.offsets.empty() ? nullptr : std::addressof(m_lookup_index);
+}
+
+void BucketTree::BuildLookupIndex() const {
+    std::scoped_lock lk{m_lookup_index.mutex};
+    if (m_lookup_index.is_built.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Lookups search the storages if the index cannot be built, the checks below fail again
+    // there.
+    SCOPE_EXIT {
+        m_lookup_index.is_built.store(true, std::memory_order_release);
+    };
+    if (!m_lookup_index.is_enabled || m_entry_storage == nullptr || m_entry_count <= 0) {
+        return;
+    }
+
+    // Copy the entry storage.
+    const size_t storage_size = static_cast<size_t>(m_entry_set_count) * m_node_size;
+    if (storage_size > LookupIndexStorageSizeMax) {
+        return;
+    }
+    std::vector<u8> entry_storage(storage_size);
+    if (m_entry_storage->Read(entry_storage.data(), storage_size, 0) != storage_size) {
+        return;
+    }
+
+    // Collect the entry offsets. Every entry set but the last must be full, so the location of
+    // an entry follows from its index.
+    const s32 entry_count_per_set = GetEntryCount(m_node_size, m_entry_size);
+    std::vector<s64> sorted;
+    sorted.reserve(static_cast<size_t>(m_entry_count));
+    for (s32 entry_set_index = 0; entry_set_index < m_entry_set_count; ++entry_set_index) {
+        const s64 entry_set_offset = entry_set_index * static_cast<s64>(m_node_size);
+
+        NodeHeader header;
+        std::memcpy(std::addressof(header), entry_storage.data() + entry_set_offset,
+                    sizeof(header));
+        if (R_FAILED(header.Verify(entry_set_index, m_node_size, m_entry_size)) ||
+            (entry_set_index + 1 < m_entry_set_count && header.count != entry_count_per_set)) {
+            return;
+        }
+
+        for (s32 entry_index = 0; entry_index < header.count; ++entry_index) {
+            const s64 entry_offset =
+                impl::GetBucketTreeEntryOffset(entry_set_offset, m_entry_size, entry_index);
+            const s64 offset = impl::SafeValue::GetInt64(entry_storage.data() + entry_offset);
+            if (!sorted.empty() && offset < sorted.back()) {
+                return;
+            }
+            sorted.push_back(offset);
+        }
+    }
+
+    // Lay out the offsets for the search.
+    m_lookup_index.offsets.resize(sorted.size() + 1);
+    m_lookup_index.ranks.resize(sorted.size() + 1);
+    BuildEytzinger(m_lookup_index.offsets, m_lookup_index.ranks, sorted, 0, 1);
+    m_lookup_index.entry_storage = std::move(entry_storage);
+    m_lookup_index.entry_count_per_set = entry_count_per_set;
+}
+
+void BucketTree::ReadEntryStorage(void* buffer, size_t size, s64 offset) const {
+    if (const auto* const index = this->GetLookupIndex(); index != nullptr) {
+        ASSERT(offset + size <= index->entry_storage.size());
+        std::memcpy(buffer, index->entry_storage.data() + offset, size);
+        return;
+    }
+    m_entry_storage->Read(static_cast<u8*>(buffer), size, offset);
+}
+
 Result BucketTree::InvalidateCache() {
     // Reset our offsets.
     m_offset_cache.is_initialized = false;
@@ -349,7 +476,8 @@ Result BucketTree::Visitor::MoveNext() {
         const auto entry_set_size = m_tree->m_node_size;
         const auto entry_set_offset = entry_set_index * static_cast<s64>(entry_set_size);
 
-        m_tree->m_entry_storage->ReadObject(std::addressof(m_entry_set), entry_set_offset);
+        m_tree->ReadEntryStorage(std::addressof(m_entry_set), sizeof(m_entry_set),
+                                 entry_set_offset);
         R_TRY(m_entry_set.header.Verify(entry_set_index, entry_set_size, m_tree->m_entry_size));
 
         R_UNLESS(m_entry_set.info.start == end && m_entry_set.info.start < m_entry_set.info.end,
@@ -364,7 +492,7 @@ Result BucketTree::Visitor::MoveNext() {
     const auto entry_size = m_tree->m_entry_size;
     const auto entry_offset = impl::GetBucketTreeEntryOffset(
         m_entry_set.info.index, m_tree->m_node_size, entry_size, entry_index);
-    m_tree->m_entry_storage->Read(reinterpret_cast<u8*>(m_entry), entry_size, entry_offset);
+    m_tree->ReadEntryStorage(m_entry, entry_size, entry_offset);
 
     // Note that we changed index.
     m_entry_index = entry_index;
@@ -387,7 +515,8 @@ Result BucketTree::Visitor::MovePrevious() {
         const auto entry_set_index = m_entry_set.info.index - 1;
         const auto entry_set_offset = entry_set_index * static_cast<s64>(entry_set_size);
 
-        m_tree->m_entry_storage->ReadObject(std::addressof(m_entry_set), entry_set_offset);
+        m_tree->ReadEntryStorage(std::addressof(m_entry_set), sizeof(m_entry_set),
+                                 entry_set_offset);
         R_TRY(m_entry_set.header.Verify(entry_set_index, entry_set_size, m_tree->m_entry_size));
 
         R_UNLESS(m_entry_set.info.end == start && m_entry_set.info.start < m_entry_set.info.end,
@@ -404,7 +533,7 @@ Result BucketTree::Visitor::MovePrevious() {
     const auto entry_size = m_tree->m_entry_size;
     const auto entry_offset = impl::GetBucketTreeEntryOffset(
         m_entry_set.info.index, m_tree->m_node_size, entry_size, entry_index);
-    m_tree->m_entry_storage->Read(reinterpret_cast<u8*>(m_entry), entry_size, entry_offset);
+    m_tree->ReadEntryStorage(m_entry, entry_size, entry_offset);
 
     // Note that we changed index.
     m_entry_index = entry_index;
@@ -418,6 +547,15 @@ Result BucketTree::Visitor::Find(s64 virtual_address) {
     const auto* const node = m_tree->m_node_l1.Get<Node>();
     R_UNLESS(virtual_address < node->GetEndOffset(), ResultOutOfRange);
 
+    // Search the lookup index, if we have one.
+    if (const auto* const index = m_tree->GetLookupIndex(); index != nullptr) {
+        R_TRY(this->FindWithIndex(*index, virtual_address));
+
+        // Set count.
+        m_entry_set_count = m_tree->m_entry_set_count;
+        R_SUCCEED();
+    }
+
     // Get the entry set index.
     s32 entry_set_index = -1;
     if (m_tree->IsExistOffsetL2OnL1() && virtual_address < node->GetBeginOffset()) {
@@ -460,6 +598,29 @@ Result BucketTree::Visitor::Find(s64 virtual_address) {
     R_SUCCEED();
 }
 
+Result BucketTree::Visitor::FindWithIndex(const LookupIndex& index, s64 virtual_address) {
+    // Find the entry.
+    const s32 found = index.Find(virtual_address);
+    R_UNLESS(found >= 0, ResultOutOfRange);
+
+    // Determine its location.
+    const auto entry_size = m_tree->m_entry_size;
+    const auto entry_set_index = found / index.entry_count_per_set;
+    const auto entry_index = found % index.entry_count_per_set;
+    const auto entry_set_offset = entry_set_index * static_cast<s64>(m_tree->m_node_size);
+    const auto entry_offset =
+        impl::GetBucketTreeEntryOffset(entry_set_offset, entry_size, entry_index);
+
+    // Copy the entry set header and the entry.
+    std::memcpy(std::addressof(m_entry_set), index.entry_storage.data() + entry_set_offset,
+                sizeof(EntrySetHeader));
+    std::memcpy(m_entry, index.entry_storage.data() + entry_offset, entry_size);
+
+    // Set our entry index.
+    m_entry_index = entry_index;
+    R_SUCCEED();
+}
+
 Result BucketTree::Visitor::FindEntrySet(s32* out_index, s64 virtual_address, s32 node_index) {
     const auto node_size = m_tree->m_node_size;
 
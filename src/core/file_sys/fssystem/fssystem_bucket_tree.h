@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <vector>
 
 #include "common/alignment.h"
 #include "common/common_funcs.h"
@@ -28,6 +30,9 @@ public:
     static constexpr size_t NodeSizeMin = 1_KiB;
     static constexpr size_t NodeSizeMax = 512_KiB;
 
+    /// Largest entry storage copied to memory to build a lookup index for.
+    static constexpr size_t LookupIndexStorageSizeMax = 64_MiB;
+
 public:
     class Visitor;
 
@@ -122,6 +127,26 @@ public:
     };
 
 private:
+    /**
+     * In-memory copy of the entry storage, along with the offsets of all entries in Eytzinger
+     * order. Finding an entry is a single branchless search through the offsets, without reading
+     * the nodes or entry sets from the storages.
+     */
+    struct LookupIndex {
+        std::vector<u8> entry_storage;
+        std::vector<s64> offsets;
+        std::vector<s32> ranks;
+        s32 entry_count_per_set;
+        std::mutex mutex;
+        std::atomic<bool> is_built;
+        bool is_enabled;
+
+        LookupIndex() : entry_count_per_set(), mutex(), is_built(false), is_enabled(true) {}
+
+        /// Returns the index of the last entry starting at or before the offset, or -1.
+        s32 Find(s64 virtual_address) const;
+    };
+
     class NodeBuffer {
         SUYU_NON_COPYABLE(NodeBuffer);
 
@@ -221,7 +246,8 @@ private:
 public:
     BucketTree()
         : m_node_storage(), m_entry_storage(), m_node_l1(), m_node_size(), m_entry_size(),
-          m_entry_count(), m_offset_count(), m_entry_set_count(), m_offset_cache() {}
+          m_entry_count(), m_offset_count(), m_entry_set_count(), m_offset_cache(),
+          m_lookup_index() {}
     ~BucketTree() {
         this->Finalize();
     }
@@ -241,6 +267,9 @@ public:
     Result Find(Visitor* visitor, s64 virtual_address);
     Result InvalidateCache();
 
+    /// Enables or disables the lookup index built on the first lookup, enabled by default.
+    void SetLookupIndexEnabled(bool enabled);
+
     s32 GetEntryCount() const {
         return m_entry_count;
     }
@@ -317,6 +346,11 @@ private:
 
     Result EnsureOffsetCache();
 
+    const LookupIndex* GetLookupIndex() const;
+    void BuildLookupIndex() const;
+
+    void ReadEntryStorage(void* buffer, size_t size, s64 offset) const;
+
 private:
     mutable VirtualFile m_node_storage;
     mutable VirtualFile m_entry_storage;
@@ -327,6 +361,7 @@ private:
     s32 m_offset_count;
     s32 m_entry_set_count;
     OffsetCache m_offset_cache;
+    mutable LookupIndex m_lookup_index;
 };
 
 class BucketTree::Visitor {
@@ -380,6 +415,7 @@ private:
     Result Initialize(const BucketTree* tree, const BucketTree::Offsets& offsets);
 
     Result Find(s64 virtual_address);
+    Result FindWithIndex(const LookupIndex& index, s64 virtual_address);
 
     Result FindEntrySet(s32* out_index, s64 virtual_address, s32 node_index);
     Result FindEntrySetWithBuffer(s32* out_index, s64 virtual_address, s32 node_index,
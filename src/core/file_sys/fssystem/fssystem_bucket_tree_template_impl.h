@@ -35,19 +35,24 @@ Result BucketTree::ScanContinuousReading(ContinuousReadingInfo* out_info,
     R_UNLESS(entry.GetVirtualOffset() <= cur_offset, ResultOutOfRange);
 
     // Create a pooled buffer for our scan.
-    PooledBuffer pool(m_node_size, 1);
-    char* buffer = nullptr;
+    PooledBuffer pool;
+    const char* buffer = nullptr;
 
     s64 entry_storage_size = m_entry_storage->GetSize();
-
-    // Read the node.
-    if (m_node_size <= pool.GetSize()) {
-        buffer = pool.GetBuffer();
-        const auto ofs = param.entry_set.index * static_cast<s64>(m_node_size);
-        R_UNLESS(m_node_size + ofs <= static_cast<size_t>(entry_storage_size),
-                 ResultInvalidBucketTreeNodeEntryCount);
-
-        m_entry_storage->Read(reinterpret_cast<u8*>(buffer), m_node_size, ofs);
+    const auto node_offset = param.entry_set.index * static_cast<s64>(m_node_size);
+    R_UNLESS(m_node_size + node_offset <= static_cast<size_t>(entry_storage_size),
+             ResultInvalidBucketTreeNodeEntryCount);
+
+    // Read the node, unless the lookup index holds it in memory.
+    if (const auto* const index = this->GetLookupIndex(); index != nullptr) {
+        buffer = reinterpret_cast<const char*>(index->entry_storage.data()) + node_offset;
+    } else {
+        pool.Allocate(m_node_size, 1);
+        if (m_node_size <= pool.GetSize()) {
+            m_entry_storage->Read(reinterpret_cast<u8*>(pool.GetBuffer()), m_node_size,
+                                  node_offset);
+            buffer = pool.GetBuffer();
+        }
     }
 
     // Calculate extents.
@@ -82,7 +87,7 @@ Result BucketTree::ScanContinuousReading(ContinuousReadingInfo* out_info,
             } else {
                 const auto ofs = impl::GetBucketTreeEntryOffset(param.entry_set.index, m_node_size,
                                                                 m_entry_size, entry_index + 1);
-                m_entry_storage->ReadObject(std::addressof(next_entry), ofs);
+                this->ReadEntryStorage(std::addressof(next_entry), sizeof(next_entry), ofs);
             }
 
             next_entry_offset = next_entry.GetVirtualOffset();
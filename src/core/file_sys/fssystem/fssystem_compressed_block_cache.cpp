@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/literals.h"
+#include "common/settings.h"
+#include "core/file_sys/fssystem/fssystem_compressed_block_cache.h"
+
+namespace FileSys {
+
+using namespace Common::Literals;
+
+CompressedBlockCache& CompressedBlockCache::Instance() {
+    static CompressedBlockCache cache{0};
+    cache.SetCapacity(Settings::values.compressed_block_cache_size_mib.GetValue() * 1_MiB);
+    return cache;
+}
+
+void CompressedBlockCache::SetCapacity(size_t capacity) {
+    if (m_capacity.exchange(capacity, std::memory_order_relaxed) <= capacity) {
+        return;
+    }
+    std::scoped_lock lk{m_mutex};
+    this->EvictLocked(capacity);
+}
+
+CompressedBlockCache::Block CompressedBlockCache::Find(u64 storage_key, s64 offset) {
+    {
+        std::scoped_lock lk{m_mutex};
+        if (const auto it = m_entries.find({storage_key, offset}); it != m_entries.end()) {
+            // Move the block to the back, the most recently used end.
+            m_lru.splice(m_lru.end(), m_lru, it->second);
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second->block;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+bool CompressedBlockCache::Contains(u64 storage_key, s64 offset) const {
+    std::scoped_lock lk{m_mutex};
+    return m_entries.contains({storage_key, offset});
+}
+
+void CompressedBlockCache::Insert(u64 storage_key, s64 offset, Block block) {
+    const size_t capacity = m_capacity.load(std::memory_order_relaxed);
+    if (block->size() > capacity) {
+        return;
+    }
+
+    std::scoped_lock lk{m_mutex};
+    const Key key{storage_key, offset};
+    if (m_entries.contains(key)) {
+        // Decompressed concurrently by a read and ahead of it, keep the first copy.
+        return;
+    }
+    this->EvictLocked(capacity - block->size());
+    m_size += block->size();
+    m_lru.push_back({key, std::move(block)});
+    m_entries.emplace(key, std::prev(m_lru.end()));
+}
+
+CompressedBlockCache::Statistics CompressedBlockCache::GetStatistics() const {
+    return {
+        .hits = m_hits.load(std::memory_order_relaxed),
+        .misses = m_misses.load(std::memory_order_relaxed),
+        .read_ahead_blocks = m_read_ahead_blocks.load(std::memory_order_relaxed),
+        .decompressed_bytes = m_decompressed_bytes.load(std::memory_order_relaxed),
+        .decompression_time =
+            std::chrono::nanoseconds{m_decompression_time_ns.load(std::memory_order_relaxed)},
+    };
+}
+
+void CompressedBlockCache::EvictLocked(size_t capacity) {
+    while (m_size > capacity) {
+        const Entry& entry = m_lru.front();
+        m_size -= entry.block->size();
+        m_entries.erase(entry.key);
+        m_lru.pop_front();
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/hash.h"
+
+namespace FileSys {
+
+/**
+ * Least recently used cache of the blocks decompressed by CompressedStorage, shared by all of
+ * its instances.
+ *
+ * Blocks are keyed by the identity of the contents of their storage, taken from the hash of its
+ * NCA section header, and their virtual offset, so opening the same content again finds the
+ * blocks decompressed before.
+ */
+class CompressedBlockCache {
+    SUYU_NON_COPYABLE(CompressedBlockCache);
+    SUYU_NON_MOVEABLE(CompressedBlockCache);
+
+public:
+    using Block = std::shared_ptr<const std::vector<u8>>;
+
+    struct Statistics {
+        u64 hits;
+        u64 misses;
+        u64 read_ahead_blocks;
+        u64 decompressed_bytes;
+        std::chrono::nanoseconds decompression_time;
+    };
+
+public:
+    explicit CompressedBlockCache(size_t capacity) : m_capacity(capacity) {}
+
+    /// Returns the cache shared by every CompressedStorage, sized from the settings.
+    static CompressedBlockCache& Instance();
+
+    bool IsEnabled() const {
+        return m_capacity.load(std::memory_order_relaxed) != 0;
+    }
+
+    /// Changes the maximum size of the cached blocks, evicting blocks past it.
+    void SetCapacity(size_t capacity);
+
+    /// Returns the block at the offset, or nullptr and counts a miss if it is not cached.
+    Block Find(u64 storage_key, s64 offset);
+
+    /// Returns true if the block at the offset is cached, without counting a hit or miss.
+    bool Contains(u64 storage_key, s64 offset) const;
+
+    void Insert(u64 storage_key, s64 offset, Block block);
+
+    /// Records the decompression of a block, done by a read or ahead of it.
+    void RecordDecompression(size_t size, std::chrono::nanoseconds duration, bool read_ahead) {
+        m_decompressed_bytes.fetch_add(size, std::memory_order_relaxed);
+        m_decompression_time_ns.fetch_add(static_cast<u64>(duration.count()),
+                                          std::memory_order_relaxed);
+        if (read_ahead) {
+            m_read_ahead_blocks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Statistics GetStatistics() const;
+
+private:
+    using Key = std::pair<u64, s64>;
+
+    struct Entry {
+        Key key;
+        Block block;
+    };
+
+    void EvictLocked(size_t capacity);
+
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_lru;
+    std::unordered_map<Key, std::list<Entry>::iterator, Common::PairHash> m_entries;
+    size_t m_size{};
+    std::atomic<size_t> m_capacity;
+
+    std::atomic<u64> m_hits{};
+    std::atomic<u64> m_misses{};
+    std::atomic<u64> m_read_ahead_blocks{};
+    std::atomic<u64> m_decompressed_bytes{};
+    std::atomic<u64> m_decompression_time_ns{};
+};
+
+} // namespace FileSys
@@ -3,11 +3,19 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
 #include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "common/task_scheduler.h"
 
 #include "core/file_sys/errors.h"
 #include "core/file_sys/fssystem/fs_i_storage.h"
 #include "core/file_sys/fssystem/fssystem_bucket_tree.h"
+#include "core/file_sys/fssystem/fssystem_compressed_block_cache.h"
 #include "core/file_sys/fssystem/fssystem_compression_common.h"
 #include "core/file_sys/fssystem/fssystem_pooled_buffer.h"
 #include "core/file_sys/vfs/vfs.h"
@@ -16,6 +24,13 @@ namespace FileSys {
 
 using namespace Common::Literals;
 
+/**
+ * Storage decompressing the blocks of a compressed NCA section.
+ *
+ * Decompressed blocks are kept in the CompressedBlockCache shared by all instances. Sequential
+ * reads queue the decompression of the blocks following them on the task scheduler, one task per
+ * run of physically continuous blocks, so they are decompressed in parallel before being read.
+ */
 class CompressedStorage : public IReadOnlyStorage {
     SUYU_NON_COPYABLE(CompressedStorage);
     SUYU_NON_MOVEABLE(CompressedStorage);
@@ -23,6 +38,12 @@ class CompressedStorage : public IReadOnlyStorage {
 public:
     static constexpr size_t NodeSize = 16_KiB;
 
+    /// How far ahead of a sequential read blocks are decompressed in the background.
+    static constexpr s64 ReadAheadSize = 2_MiB;
+
+    /// Maximum physical size of the blocks decompressed by a single read-ahead task.
+    static constexpr s64 ReadAheadRunSizeMax = 256_KiB;
+
     struct Entry {
         s64 virt_offset;
         s64 phys_offset;
@@ -46,6 +67,22 @@ public:
     }
 
 private:
+    /// A compressed block to decompress ahead of reads.
+    struct ReadAheadBlock {
+        s64 virtual_offset;
+        s64 virtual_size;
+        s64 physical_offset;
+        s64 physical_size;
+        CompressionType compression_type;
+    };
+
+    /// Blocks whose compressed data is continuous, read from the data storage at once.
+    struct ReadAheadRun {
+        s64 physical_offset;
+        s64 physical_size;
+        std::vector<ReadAheadBlock> blocks;
+    };
+
     class CompressedStorageCore {
         SUYU_NON_COPYABLE(CompressedStorageCore);
         SUYU_NON_MOVEABLE(CompressedStorageCore);
@@ -87,6 +124,11 @@ private:
             }
         }
 
+        void SetBlockCache(CompressedBlockCache* block_cache, u64 cache_key) {
+            m_block_cache = block_cache;
+            m_cache_key = cache_key;
+        }
+
         VirtualFile GetDataStorage() {
             return m_data_storage;
         }
@@ -299,6 +341,7 @@ private:
                 u32 gap_from_prev;
                 u32 physical_size;
                 u32 virtual_size;
+                s64 virtual_offset;
             };
             std::array<Entries, EntriesCountMax> entries;
             s32 entry_count = 0;
@@ -451,10 +494,12 @@ private:
                                                                entries[entry_idx].virtual_size);
 
                                                         // Perform the decompression.
-                                                        R_RETURN(decompressor(
+                                                        R_RETURN(this->DecompressBlock(
                                                             dst, entries[entry_idx].virtual_size,
                                                             buffer + buffer_offset,
-                                                            entries[entry_idx].physical_size));
+                                                            entries[entry_idx].physical_size,
+                                                            entries[entry_idx].virtual_offset,
+                                                            decompressor, false));
                                                     }));
 
                                     break;
@@ -514,6 +559,44 @@ private:
                 offset, size,
                 [&](bool* out_continuous, const Entry& entry, s64 virtual_data_size,
                     s64 data_offset, s64 read_size) -> Result {
+                    // Serve blocks decompressed before from the block cache.
+                    if (m_block_cache != nullptr &&
+                        CompressionTypeUtility::IsBlockAlignmentRequired(entry.compression_type) &&
+                        data_offset == 0 && virtual_data_size == read_size) {
+                        const auto block = m_block_cache->Find(m_cache_key, entry.virt_offset);
+                        if (block != nullptr && block->size() == static_cast<size_t>(read_size)) {
+                            // Perform the pending data storage operation first, as the read
+                            // function must be called in order.
+                            const Result rc = PerformRequiredRead();
+                            if (R_FAILED(rc)) {
+                                R_THROW(rc);
+                            }
+
+                            // Reset our requirements.
+                            prev_entry.virt_offset = -1;
+                            required_access_physical_size = 0;
+                            entry_count = 0;
+                            will_allocate_pooled_buffer = false;
+
+                            // Copy the cached block.
+                            const Result copy_rc = read_func(
+                                block->size(), [&](void* dst, size_t dst_size) -> Result {
+                                    // Check that the size is valid.
+                                    ASSERT(dst_size == block->size());
+
+                                    std::memcpy(dst, block->data(), dst_size);
+                                    R_SUCCEED();
+                                });
+                            if (R_FAILED(copy_rc)) {
+                                R_THROW(copy_rc);
+                            }
+
+                            // We're continuous.
+                            *out_continuous = true;
+                            R_SUCCEED();
+                        }
+                    }
+
                     // Determine the physical extents.
                     s64 physical_offset, physical_size;
                     if (CompressionTypeUtility::IsRandomAccessible(entry.compression_type)) {
@@ -596,6 +679,7 @@ private:
                             .gap_from_prev = static_cast<u32>(gap_from_prev),
                             .physical_size = static_cast<u32>(physical_size),
                             .virtual_size = static_cast<u32>(read_size),
+                            .virtual_offset = entry.virt_offset + data_offset,
                         };
                     } else {
                         // Verify that we're allowed to be operating on the non-data-storage-access
@@ -615,6 +699,7 @@ private:
                                 .gap_from_prev = 0,
                                 .physical_size = 0,
                                 .virtual_size = static_cast<u32>(read_size),
+                                .virtual_offset = entry.virt_offset + data_offset,
                             };
                         } else {
                             // We have no entries, so we can just perform the read.
@@ -650,7 +735,107 @@ private:
             R_SUCCEED();
         }
 
+        Result CollectReadAheadRuns(std::vector<ReadAheadRun>* out_runs, s64 offset, s64 size) {
+            // Check pre-conditions.
+            ASSERT(out_runs != nullptr);
+            ASSERT(m_block_cache != nullptr);
+
+            R_RETURN(this->OperatePerEntry(
+                offset, size,
+                [&](bool* out_continuous, const Entry& entry, s64 virtual_data_size,
+                    s64 data_offset, s64 read_size) -> Result {
+                    // We want to see every entry in the range.
+                    *out_continuous = true;
+
+                    // Only whole compressed blocks not cached yet need decompressing.
+                    if (!CompressionTypeUtility::IsBlockAlignmentRequired(entry.compression_type) ||
+                        data_offset != 0 || virtual_data_size != read_size ||
+                        m_block_cache->Contains(m_cache_key, entry.virt_offset)) {
+                        R_SUCCEED();
+                    }
+
+                    // Add the block to the last run if its data follows, or start a new run.
+                    const s64 physical_size = entry.GetPhysicalSize();
+                    if (out_runs->empty() || [&] {
+                            const auto& run = out_runs->back();
+                            const s64 run_end = run.physical_offset + run.physical_size;
+                            return !(run_end <= entry.phys_offset &&
+                                     entry.phys_offset <=
+                                         Common::AlignUp(run_end, CompressionBlockAlignment)) ||
+                                   entry.phys_offset + physical_size - run.physical_offset >
+                                       ReadAheadRunSizeMax;
+                        }()) {
+                        out_runs->push_back({
+                            .physical_offset = entry.phys_offset,
+                            .physical_size = 0,
+                            .blocks{},
+                        });
+                    }
+
+                    auto& run = out_runs->back();
+                    run.physical_size = entry.phys_offset + physical_size - run.physical_offset;
+                    run.blocks.push_back({
+                        .virtual_offset = entry.virt_offset,
+                        .virtual_size = read_size,
+                        .physical_offset = entry.phys_offset,
+                        .physical_size = physical_size,
+                        .compression_type = entry.compression_type,
+                    });
+                    R_SUCCEED();
+                }));
+        }
+
+        Result DecompressToCache(const ReadAheadRun& run) {
+            // Read the compressed data of the whole run at once. A short read would leave part of
+            // the buffer unset, so the run is skipped rather than caching blocks made from it.
+            std::vector<u8> buffer(static_cast<size_t>(run.physical_size));
+            R_UNLESS(m_data_storage->Read(buffer.data(), buffer.size(),
+                                          static_cast<size_t>(run.physical_offset)) ==
+                         buffer.size(),
+                     ResultOutOfRange);
+
+            for (const auto& block : run.blocks) {
+                // A read may have decompressed the block in the meantime.
+                if (m_block_cache->Contains(m_cache_key, block.virtual_offset)) {
+                    continue;
+                }
+
+                // Get the decompressor.
+                const auto decompressor = this->GetDecompressor(block.compression_type);
+                R_UNLESS(decompressor != nullptr, ResultUnexpectedInCompressedStorageB);
+
+                // Decompress the block, which adds it to the cache.
+                std::vector<u8> decompressed(static_cast<size_t>(block.virtual_size));
+                R_TRY(this->DecompressBlock(
+                    decompressed.data(), decompressed.size(),
+                    buffer.data() + (block.physical_offset - run.physical_offset),
+                    static_cast<size_t>(block.physical_size), block.virtual_offset, decompressor,
+                    true));
+            }
+
+            R_SUCCEED();
+        }
+
     private:
+        Result DecompressBlock(void* dst, size_t dst_size, const void* src, size_t src_size,
+                               s64 virtual_offset, DecompressorFunction decompressor,
+                               bool read_ahead) {
+            // Perform the decompression.
+            const auto start = std::chrono::steady_clock::now();
+            R_TRY(decompressor(dst, dst_size, src, src_size));
+            if (m_block_cache == nullptr) {
+                R_SUCCEED();
+            }
+            m_block_cache->RecordDecompression(dst_size, std::chrono::steady_clock::now() - start,
+                                               read_ahead);
+
+            // Keep a copy of the block in the cache.
+            const auto* const data = static_cast<const u8*>(dst);
+            m_block_cache->Insert(m_cache_key, virtual_offset,
+                                  std::make_shared<const std::vector<u8>>(data, data + dst_size));
+            R_SUCCEED();
+        }
+
         DecompressorFunction GetDecompressor(CompressionType type) const {
             // Check that we can get a decompressor for the type.
             if (CompressionTypeUtility::IsUnknownType(type)) {
@@ -671,6 +856,8 @@ private:
         BucketTree m_table;
         VirtualFile m_data_storage;
         GetDecompressorFunction m_get_decompressor_function;
+        CompressedBlockCache* m_block_cache{};
+        u64 m_cache_key{};
     };
 
     class CacheManager {
@@ -901,10 +1088,13 @@ public:
         this->Finalize();
     }
 
+    /// cache_key identifies the decompressed contents in the shared block cache. Storages with
+    /// the same key must hold the same contents, 0 keeps the blocks out of the cache.
     Result Initialize(VirtualFile data_storage, VirtualFile node_storage, VirtualFile entry_storage,
                       s32 bktr_entry_count, size_t block_size_max,
                       size_t continuous_reading_size_max, GetDecompressorFunction get_decompressor,
-                      size_t cache_size_0, size_t cache_size_1, s32 max_cache_entries) {
+                      size_t cache_size_0, size_t cache_size_1, s32 max_cache_entries,
+                      u64 cache_key) {
         // Initialize our core.
         R_TRY(m_core.Initialize(data_storage, node_storage, entry_storage, bktr_entry_count,
                                 block_size_max, continuous_reading_size_max, get_decompressor));
@@ -916,10 +1106,36 @@ public:
         // Initialize our cache manager.
         R_TRY(m_cache_manager.Initialize(core_size, cache_size_0, cache_size_1, max_cache_entries));
 
+        // Set up the shared block cache and read-ahead.
+        auto& block_cache = CompressedBlockCache::Instance();
+        if (block_cache.IsEnabled() && cache_key != 0) {
+            m_core.SetBlockCache(std::addressof(block_cache), cache_key);
+            m_storage_size = core_size;
+            if (Settings::values.compressed_storage_read_ahead.GetValue()) {
+                m_read_ahead_queue = std::make_unique<Common::TaskQueue>(
+                    Common::TaskPriority::BackgroundIO,
+                    Common::TaskScheduler::Instance().NumWorkers());
+            }
+        }
+
         R_SUCCEED();
     }
 
     void Finalize() {
+        // Stop decompressing ahead before releasing the storages it reads.
+        if (m_read_ahead_queue) {
+            m_read_ahead_queue.reset();
+
+            const auto stats = CompressedBlockCache::Instance().GetStatistics();
+            LOG_DEBUG(Service_FS,
+                      "Compressed block cache: {} hits, {} misses, {} blocks decompressed ahead, "
+                      "{} MiB decompressed in {} ms",
+                      stats.hits, stats.misses, stats.read_ahead_blocks,
+                      stats.decompressed_bytes / 1_MiB,
+                      std::chrono::duration_cast<std::chrono::milliseconds>(
+                          stats.decompression_time)
+                          .count());
+        }
         m_core.Finalize();
     }
 
@@ -948,16 +1164,49 @@ public:
     }
 
     virtual size_t Read(u8* buffer, size_t size, size_t offset) const override {
-        if (R_SUCCEEDED(m_cache_manager.Read(m_core, offset, buffer, size))) {
-            return size;
-        } else {
+        if (R_FAILED(m_cache_manager.Read(m_core, offset, buffer, size))) {
             return 0;
         }
+
+        // Decompress the blocks following a sequential read in the background.
+        if (m_read_ahead_queue && m_last_read_end.exchange(offset + size) == offset) {
+            this->QueueReadAhead(static_cast<s64>(offset + size));
+        }
+        return size;
+    }
+
+private:
+    void QueueReadAhead(s64 offset) const {
+        // Continue after the blocks queued before, unless the reads moved elsewhere.
+        const s64 end_offset = std::min(offset + ReadAheadSize, m_storage_size);
+        s64 begin_offset = m_read_ahead_end.load();
+        if (begin_offset < offset || begin_offset > end_offset) {
+            begin_offset = offset;
+        }
+        if (begin_offset >= end_offset) {
+            return;
+        }
+        m_read_ahead_end = end_offset;
+
+        std::vector<ReadAheadRun> runs;
+        if (R_FAILED(m_core.CollectReadAheadRuns(std::addressof(runs), begin_offset,
+                                                 end_offset - begin_offset))) {
+            return;
+        }
+        for (auto& run : runs) {
+            m_read_ahead_queue->QueueWork(
+                [this, run = std::move(run)] { m_core.DecompressToCache(run); });
+        }
     }
 
 private:
     mutable CompressedStorageCore m_core;
     mutable CacheManager m_cache_manager;
+
+    s64 m_storage_size{};
+    mutable std::atomic<size_t> m_last_read_end{};
+    mutable std::atomic<s64> m_read_ahead_end{};
+    std::unique_ptr<Common::TaskQueue> m_read_ahead_queue;
 };
 
 } // namespace FileSys
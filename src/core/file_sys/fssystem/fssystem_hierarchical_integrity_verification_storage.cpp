@@ -27,7 +27,7 @@ Result HierarchicalIntegrityVerificationStorage::Initialize(
     m_verify_storages[0]->Initialize(storage[HierarchicalStorageInformation::MasterStorage],
                                      storage[HierarchicalStorageInformation::Layer1Storage],
                                      static_cast<s64>(1) << info.info[0].block_order, HashSize,
-                                     false);
+                                     false, std::addressof(m_read_mutex));
 
     // Ensure we don't leak state if further initialization goes wrong.
     ON_RESULT_FAILURE {
@@ -59,7 +59,8 @@ Result HierarchicalIntegrityVerificationStorage::Initialize(
         m_verify_storages[level + 1]->Initialize(
             std::move(buffer_storage), storage[level + 2],
             static_cast<s64>(1) << info.info[level + 1].block_order,
-            static_cast<s64>(1) << info.info[level].block_order, false);
+            static_cast<s64>(1) << info.info[level].block_order, false,
+            std::addressof(m_read_mutex));
 
         // Initialize the buffer storage.
         m_buffer_storages[level + 1] = m_verify_storages[level + 1];
@@ -75,7 +76,8 @@ Result HierarchicalIntegrityVerificationStorage::Initialize(
         m_verify_storages[level + 1]->Initialize(
             std::move(buffer_storage), storage[level + 2],
             static_cast<s64>(1) << info.info[level + 1].block_order,
-            static_cast<s64>(1) << info.info[level].block_order, true);
+            static_cast<s64>(1) << info.info[level].block_order, true,
+            std::addressof(m_read_mutex));
 
         // Initialize the buffer storage.
         m_buffer_storages[level + 1] = m_verify_storages[level + 1];
@@ -116,7 +118,8 @@ size_t HierarchicalIntegrityVerificationStorage::Read(u8* buffer, size_t size,
     // Validate arguments.
     ASSERT(buffer != nullptr);
 
-    // Read the data.
+    // Read the data, while no level verifies blocks ahead from the storages below.
+    std::scoped_lock lk{m_read_mutex};
     return m_buffer_storages[m_max_layers - 2]->Read(buffer, size, offset);
 }
 
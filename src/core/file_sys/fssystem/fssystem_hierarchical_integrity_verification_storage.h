@@ -159,6 +159,9 @@ private:
     std::array<VirtualFile, MaxLayers - 1> m_buffer_storages;
     s64 m_data_size;
     s32 m_max_layers;
+
+    /// Held by every read, serializing them with the verification of blocks ahead.
+    mutable std::mutex m_read_mutex;
 };
 
 } // namespace FileSys
@@ -2,8 +2,12 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "common/alignment.h"
+#include "common/logging/log.h"
 #include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/crypto/sha256_engine.h"
 #include "core/file_sys/fssystem/fssystem_hierarchical_sha256_storage.h"
+#include "core/file_sys/fssystem/fssystem_pooled_buffer.h"
 
 namespace FileSys {
 
@@ -63,6 +67,22 @@ Result HierarchicalSha256Storage::Initialize(VirtualFile* base_storages, s32 lay
     base_storages[1]->Read(reinterpret_cast<u8*>(m_hash_buffer),
                            static_cast<size_t>(hash_storage_size), 0);
 
+    // Set up verification, starting with the hash table.
+    m_verify_enabled = Settings::values.verify_content_integrity.GetValue();
+    if (m_verify_enabled) {
+        const auto hash = Core::Crypto::Sha256::Compute(
+            {reinterpret_cast<const u8*>(m_hash_buffer), static_cast<size_t>(hash_storage_size)});
+        if (hash != master_hash) {
+            LOG_ERROR(Service_FS, "Hash table does not match the master hash, the content is "
+                                  "corrupted");
+            m_reported_corruption = true;
+        }
+
+        const s64 block_count = Common::DivideUp(m_base_storage_size, m_hash_target_block_size);
+        m_verified_blocks = std::vector<std::atomic<u64>>(
+            static_cast<size_t>(Common::DivideUp(block_count, s64{64})));
+    }
+
     R_SUCCEED();
 }
 
@@ -76,7 +96,52 @@ size_t HierarchicalSha256Storage::Read(u8* buffer, size_t size, size_t offset) c
     ASSERT(buffer != nullptr);
 
     // Read the data.
-    return m_base_storage->Read(buffer, size, offset);
+    const size_t result = m_base_storage->Read(buffer, size, offset);
+    if (m_verify_enabled) {
+        this->VerifyBlocks(buffer, size, offset);
+    }
+    return result;
+}
+
+void HierarchicalSha256Storage::VerifyBlocks(const u8* buffer, size_t size, size_t offset) const {
+    PooledBuffer block_buffer;
+
+    const s64 first_block = static_cast<s64>(offset) / m_hash_target_block_size;
+    const s64 end_block = Common::DivideUp(
+        std::min(static_cast<s64>(offset + size), m_base_storage_size), m_hash_target_block_size);
+    for (s64 block = first_block; block < end_block; ++block) {
+        if (this->IsBlockVerified(block)) {
+            continue;
+        }
+
+        // The last block is hashed over its actual size.
+        const size_t block_offset = static_cast<size_t>(block * m_hash_target_block_size);
+        const size_t block_size = static_cast<size_t>(std::min<s64>(
+            m_hash_target_block_size, m_base_storage_size - static_cast<s64>(block_offset)));
+
+        // Hash the block from the buffer when it holds it entirely, or read it separately.
+        const u8* data;
+        if (block_offset >= offset && block_offset + block_size <= offset + size) {
+            data = buffer + (block_offset - offset);
+        } else {
+            if (block_buffer.GetBuffer() == nullptr) {
+                block_buffer.Allocate(m_hash_target_block_size, m_hash_target_block_size);
+            }
+            u8* const block_data = reinterpret_cast<u8*>(block_buffer.GetBuffer());
+            m_base_storage->Read(block_data, block_size, block_offset);
+            data = block_data;
+        }
+
+        const auto hash = Core::Crypto::Sha256::Compute({data, block_size});
+        if (std::memcmp(hash.data(), m_hash_buffer + block * HashSize, HashSize) == 0) {
+            this->MarkBlockVerified(block);
+        } else if (!m_reported_corruption.exchange(true)) {
+            // Keep serving the data, the log points at the corruption.
+            LOG_ERROR(Service_FS,
+                      "Integrity verification failed at offset {:#x}, the content is corrupted",
+                      block_offset);
+        }
+    }
 }
 
 } // namespace FileSys
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <vector>
 
 #include "core/file_sys/errors.h"
 #include "core/file_sys/fssystem/fs_i_storage.h"
@@ -11,6 +13,11 @@
 
 namespace FileSys {
 
+/**
+ * When verify_content_integrity is enabled, checks the hash table against the master hash on
+ * initialization and every block read against the hash table. Verified blocks are recorded in a
+ * bitmap, so each block is hashed at most once per session.
+ */
 class HierarchicalSha256Storage : public IReadOnlyStorage {
     SUYU_NON_COPYABLE(HierarchicalSha256Storage);
     SUYU_NON_MOVEABLE(HierarchicalSha256Storage);
@@ -31,6 +38,19 @@ public:
 
     virtual size_t Read(u8* buffer, size_t length, size_t offset) const override;
 
+private:
+    void VerifyBlocks(const u8* buffer, size_t size, size_t offset) const;
+
+    bool IsBlockVerified(s64 block_index) const {
+        return (m_verified_blocks[block_index / 64].load(std::memory_order_relaxed) &
+                (1ULL << (block_index % 64))) != 0;
+    }
+
+    void MarkBlockVerified(s64 block_index) const {
+        m_verified_blocks[block_index / 64].fetch_or(1ULL << (block_index % 64),
+                                                     std::memory_order_relaxed);
+    }
+
 private:
     VirtualFile m_base_storage;
     s64 m_base_storage_size;
@@ -39,6 +59,10 @@ private:
     s32 m_hash_target_block_size;
     s32 m_log_size_ratio;
     std::mutex m_mutex;
+
+    bool m_verify_enabled{};
+    mutable std::vector<std::atomic<u64>> m_verified_blocks;
+    mutable std::atomic<bool> m_reported_corruption{};
 };
 
 } // namespace FileSys
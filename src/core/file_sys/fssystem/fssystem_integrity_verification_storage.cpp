@@ -2,17 +2,41 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "common/alignment.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "common/task_scheduler.h"
+#include "core/crypto/sha256_engine.h"
 #include "core/file_sys/fssystem/fssystem_integrity_verification_storage.h"
+#include "core/file_sys/fssystem/fssystem_pooled_buffer.h"
 
 namespace FileSys {
 
+namespace {
+
+using namespace Common::Literals;
+
+/// How far ahead of a sequential read blocks are verified in the background.
+constexpr s64 VerifyAheadSize = 1_MiB;
+
+} // namespace
+
 constexpr inline u32 ILog2(u32 val) {
     ASSERT(val > 0);
     return static_cast<u32>((sizeof(u32) * 8) - 1 - std::countl_zero<u32>(val));
 }
 
+IntegrityVerificationStorage::IntegrityVerificationStorage()
+    : m_verification_block_size(0), m_verification_block_order(0),
+      m_upper_layer_verification_block_size(0), m_upper_layer_verification_block_order(0) {}
+
+IntegrityVerificationStorage::~IntegrityVerificationStorage() {
+    this->Finalize();
+}
+
 void IntegrityVerificationStorage::Initialize(VirtualFile hs, VirtualFile ds, s64 verif_block_size,
-                                              s64 upper_layer_verif_block_size, bool is_real_data) {
+                                              s64 upper_layer_verif_block_size, bool is_real_data,
+                                              std::mutex* read_mutex) {
     // Validate preconditions.
     ASSERT(verif_block_size >= HashSize);
 
@@ -40,11 +64,34 @@ void IntegrityVerificationStorage::Initialize(VirtualFile hs, VirtualFile ds, s6
 
     // Set data.
     m_is_real_data = is_real_data;
+    m_read_mutex = read_mutex;
+
+    // Set up verification.
+    m_verify_enabled = Settings::values.verify_content_integrity.GetValue();
+    if (m_verify_enabled) {
+        m_block_count = static_cast<s64>(Common::DivideUp(
+            static_cast<u64>(m_data_storage->GetSize()), static_cast<u64>(verif_block_size)));
+        m_verified_blocks = std::vector<std::atomic<u64>>(
+            static_cast<size_t>(Common::DivideUp(static_cast<u64>(m_block_count), u64{64})));
+        m_reported_corruption = false;
+        m_last_read_end = 0;
+        m_verify_ahead_end = 0;
+        if (m_read_mutex != nullptr && Settings::values.integrity_verify_ahead.GetValue()) {
+            m_verify_ahead_queue =
+                std::make_unique<Common::TaskQueue>(Common::TaskPriority::BackgroundIO, 1);
+        }
+    }
 }
 
 void IntegrityVerificationStorage::Finalize() {
+    // Stop background verification before releasing the storages it reads.
+    m_verify_ahead_queue.reset();
+    m_verified_blocks.clear();
+    m_verify_enabled = false;
+
     m_hash_storage = VirtualFile();
     m_data_storage = VirtualFile();
+    m_read_mutex = nullptr;
 }
 
 size_t IntegrityVerificationStorage::Read(u8* buffer, size_t size, size_t offset) const {
@@ -81,7 +128,127 @@ size_t IntegrityVerificationStorage::Read(u8* buffer, size_t size, size_t offset
     }
 
     // Perform the read.
-    return m_data_storage->Read(buffer, read_size, offset);
+    const size_t result = m_data_storage->Read(buffer, read_size, offset);
+    if (!m_verify_enabled || result != read_size) {
+        return result;
+    }
+
+    // Verify the blocks that were read, the buffer holds them with their padding.
+    const s64 first_block = static_cast<s64>(offset) >> m_verification_block_order;
+    const s64 end_block =
+        static_cast<s64>(Common::AlignUp(offset + size, m_verification_block_size)) >>
+        m_verification_block_order;
+    this->VerifyBlocks(first_block, std::min(end_block, m_block_count), buffer, size, offset,
+                       false);
+
+    // Verify the blocks following a sequential read in the background.
+    if (m_verify_ahead_queue && m_last_read_end.exchange(offset + size) == offset) {
+        this->QueueVerifyAhead(offset + size);
+    }
+
+    return result;
+}
+
+void IntegrityVerificationStorage::VerifyBlocks(s64 first_block, s64 end_block, const u8* buffer,
+                                                size_t buffer_size, size_t buffer_offset,
+                                                bool is_ahead) const {
+    // Reads made ahead run next to the reads of the callers, which hold the read mutex.
+    const auto read_storage = [&](const VirtualFile& storage, u8* out, size_t out_size,
+                                  size_t offset) {
+        std::unique_lock<std::mutex> lock;
+        if (is_ahead) {
+            lock = std::unique_lock{*m_read_mutex};
+        }
+        return storage->Read(out, out_size, offset) == out_size;
+    };
+
+    PooledBuffer block_buffer;
+    std::vector<BlockHash> hashes;
+
+    s64 block = first_block;
+    while (block < end_block) {
+        // Skip blocks that were already verified.
+        if (this->IsBlockVerified(block)) {
+            ++block;
+            continue;
+        }
+
+        // Read the hashes of the following run of unverified blocks at once.
+        const s64 run_begin = block;
+        s64 run_end = run_begin + 1;
+        while (run_end < end_block && !this->IsBlockVerified(run_end)) {
+            ++run_end;
+        }
+        hashes.resize(static_cast<size_t>(run_end - run_begin));
+        if (!read_storage(m_hash_storage, reinterpret_cast<u8*>(hashes.data()),
+                          hashes.size() * HashSize, static_cast<size_t>(run_begin * HashSize))) {
+            // Leave the blocks unverified, the next reads of them try again.
+            block = run_end;
+            continue;
+        }
+
+        for (; block < run_end; ++block) {
+            const size_t block_offset = static_cast<size_t>(block << m_verification_block_order);
+            const size_t block_size = static_cast<size_t>(m_verification_block_size);
+
+            // Hash the block from the buffer when it holds it entirely, or read it separately.
+            const u8* data;
+            if (buffer != nullptr && block_offset >= buffer_offset &&
+                block_offset + block_size <= buffer_offset + buffer_size) {
+                data = buffer + (block_offset - buffer_offset);
+            } else {
+                if (block_buffer.GetBuffer() == nullptr) {
+                    block_buffer.Allocate(block_size, block_size);
+                }
+                u8* const block_data = reinterpret_cast<u8*>(block_buffer.GetBuffer());
+                const size_t data_size = std::min(
+                    block_size, static_cast<size_t>(m_data_storage->GetSize()) - block_offset);
+                if (!read_storage(m_data_storage, block_data, data_size, block_offset)) {
+                    continue;
+                }
+                std::memset(block_data + data_size, 0, block_size - data_size);
+                data = block_data;
+            }
+
+            this->VerifyBlock(block, data, hashes[static_cast<size_t>(block - run_begin)]);
+        }
+    }
+}
+
+void IntegrityVerificationStorage::VerifyBlock(s64 block_index, const u8* data,
+                                               const BlockHash& expected_hash) const {
+    const auto hash = Core::Crypto::Sha256::Compute(
+        {data, static_cast<size_t>(m_verification_block_size)});
+    if (std::memcmp(hash.data(), expected_hash.hash.data(), HashSize) == 0) {
+        this->MarkBlockVerified(block_index);
+        return;
+    }
+
+    // Keep serving the data, the log points at the corruption.
+    if (!m_reported_corruption.exchange(true)) {
+        LOG_ERROR(Service_FS,
+                  "Integrity verification failed at offset {:#x}, the content is corrupted",
+                  block_index << m_verification_block_order);
+    }
+}
+
+void IntegrityVerificationStorage::QueueVerifyAhead(size_t offset) const {
+    const s64 next_block =
+        static_cast<s64>(Common::AlignUp(offset, m_verification_block_size)) >>
+        m_verification_block_order;
+    const s64 ahead_begin = std::max(next_block, m_verify_ahead_end.load());
+    const s64 ahead_end = std::min(
+        next_block + std::max<s64>(VerifyAheadSize >> m_verification_block_order, 1),
+        m_block_count);
+    if (ahead_begin >= ahead_end) {
+        return;
+    }
+
+    // Concurrent readers may queue the same blocks twice, which only costs a lookup.
+    m_verify_ahead_end = ahead_end;
+    m_verify_ahead_queue->QueueWork([this, ahead_begin, ahead_end] {
+        this->VerifyBlocks(ahead_begin, ahead_end, nullptr, 0, 0, true);
+    });
 }
 
 size_t IntegrityVerificationStorage::GetSize() const {
@@ -3,13 +3,32 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 #include "core/file_sys/fssystem/fs_i_storage.h"
 #include "core/file_sys/fssystem/fs_types.h"
 
+namespace Common {
+class TaskQueue;
+}
+
 namespace FileSys {
 
+/**
+ * Checks every block read against its SHA-256 hash from the hash storage, when
+ * verify_content_integrity is enabled. Verified blocks are recorded in a bitmap, so each block is
+ * hashed at most once per session. With integrity_verify_ahead, sequential reads also queue the
+ * verification of the blocks following them on the task scheduler.
+ *
+ * The storages below are not safe to read concurrently, AesCtrStorage shares its cipher context
+ * between reads. Callers hold read_mutex during every read, and the verification running ahead
+ * takes it around each of its reads of the hash and data storages. Blocks are only verified ahead
+ * when a read mutex is given.
+ */
 class IntegrityVerificationStorage : public IReadOnlyStorage {
     SUYU_NON_COPYABLE(IntegrityVerificationStorage);
     SUYU_NON_MOVEABLE(IntegrityVerificationStorage);
@@ -23,15 +42,12 @@ public:
     static_assert(std::is_trivial_v<BlockHash>);
 
 public:
-    IntegrityVerificationStorage()
-        : m_verification_block_size(0), m_verification_block_order(0),
-          m_upper_layer_verification_block_size(0), m_upper_layer_verification_block_order(0) {}
-    virtual ~IntegrityVerificationStorage() override {
-        this->Finalize();
-    }
+    IntegrityVerificationStorage();
+    virtual ~IntegrityVerificationStorage() override;
 
     void Initialize(VirtualFile hs, VirtualFile ds, s64 verif_block_size,
-                    s64 upper_layer_verif_block_size, bool is_real_data);
+                    s64 upper_layer_verif_block_size, bool is_real_data,
+                    std::mutex* read_mutex = nullptr);
     void Finalize();
 
     virtual size_t Read(u8* buffer, size_t size, size_t offset) const override;
@@ -41,6 +57,27 @@ public:
         return m_verification_block_size;
     }
 
+    /// Returns true if a block failed verification since the storage was initialized.
+    bool HasDetectedCorruption() const {
+        return m_reported_corruption.load(std::memory_order_relaxed);
+    }
+
+private:
+    void VerifyBlocks(s64 first_block, s64 end_block, const u8* buffer, size_t buffer_size,
+                      size_t buffer_offset, bool is_ahead) const;
+    void VerifyBlock(s64 block_index, const u8* data, const BlockHash& expected_hash) const;
+    void QueueVerifyAhead(size_t offset) const;
+
+    bool IsBlockVerified(s64 block_index) const {
+        return (m_verified_blocks[block_index / 64].load(std::memory_order_relaxed) &
+                (1ULL << (block_index % 64))) != 0;
+    }
+
+    void MarkBlockVerified(s64 block_index) const {
+        m_verified_blocks[block_index / 64].fetch_or(1ULL << (block_index % 64),
+                                                     std::memory_order_relaxed);
+    }
+
 private:
     static void SetValidationBit(BlockHash* hash) {
         ASSERT(hash != nullptr);
@@ -60,6 +97,15 @@ private:
     s64 m_upper_layer_verification_block_size;
     s64 m_upper_layer_verification_block_order;
     bool m_is_real_data;
+    std::mutex* m_read_mutex{};
+
+    bool m_verify_enabled{};
+    s64 m_block_count{};
+    mutable std::vector<std::atomic<u64>> m_verified_blocks;
+    mutable std::atomic<bool> m_reported_corruption{};
+    mutable std::atomic<size_t> m_last_read_end{};
+    mutable std::atomic<s64> m_verify_ahead_end{};
+    std::unique_ptr<Common::TaskQueue> m_verify_ahead_queue;
 };
 
 } // namespace FileSys
@@ -63,6 +63,14 @@ inline s64 GetFsEndOffset(const NcaReader& reader, s32 fs_index) {
     return static_cast<s64>(reader.GetFsEndOffset(fs_index));
 }
 
+inline u64 GetCompressedBlockCacheKey(const NcaReader& reader, s32 fs_index) {
+    // The fs header holds the master hash of the section, so its hash identifies the contents of
+    // the section exactly and is the same when the content is opened again.
+    u64 key;
+    std::memcpy(std::addressof(key), reader.GetFsHeaderHash(fs_index).value.data(), sizeof(key));
+    return key;
+}
+
 using Sha256DataRegion = NcaFsHeader::Region;
 using IntegrityLevelInfo = NcaFsHeader::HashData::IntegrityMetaInfo::LevelHashInfo;
 using IntegrityDataInfo = IntegrityLevelInfo::HierarchicalIntegrityVerificationLevelInformation;
@@ -317,7 +325,8 @@ Result NcaFileSystemDriver::CreateStorageByRawStorage(VirtualFile* out,
             std::addressof(storage),
             ctx != nullptr ? std::addressof(ctx->compressed_storage) : nullptr,
             ctx != nullptr ? std::addressof(ctx->compressed_storage_meta_storage) : nullptr,
-            std::move(storage), header_reader->GetCompressionInfo()));
+            std::move(storage), header_reader->GetCompressionInfo(),
+            GetCompressedBlockCacheKey(*m_reader, header_reader->GetFsIndex())));
     }
 
     // Set output storage.
@@ -1292,15 +1301,18 @@ Result NcaFileSystemDriver::CreateRegionSwitchStorage(VirtualFile* out,
 Result NcaFileSystemDriver::CreateCompressedStorage(VirtualFile* out,
                                                     std::shared_ptr<CompressedStorage>* out_cmp,
                                                     VirtualFile* out_meta, VirtualFile base_storage,
-                                                    const NcaCompressionInfo& compression_info) {
+                                                    const NcaCompressionInfo& compression_info,
+                                                    u64 cache_key) {
     R_RETURN(this->CreateCompressedStorage(out, out_cmp, out_meta, std::move(base_storage),
-                                           compression_info, m_reader->GetDecompressor()));
+                                           compression_info, cache_key,
+                                           m_reader->GetDecompressor()));
 }
 
 Result NcaFileSystemDriver::CreateCompressedStorage(VirtualFile* out,
                                                     std::shared_ptr<CompressedStorage>* out_cmp,
                                                     VirtualFile* out_meta, VirtualFile base_storage,
                                                     const NcaCompressionInfo& compression_info,
+                                                    u64 cache_key,
                                                     GetDecompressorFunction get_decompressor) {
     // Check pre-conditions.
     ASSERT(out != nullptr);
@@ -1336,7 +1348,7 @@ Result NcaFileSystemDriver::CreateCompressedStorage(VirtualFile* out,
         std::make_shared<OffsetVfsFile>(base_storage, table_offset, 0),
         std::make_shared<OffsetVfsFile>(base_storage, node_size, table_offset),
         std::make_shared<OffsetVfsFile>(base_storage, entry_size, table_offset + node_size),
-        header.entry_count, 64_KiB, 640_KiB, get_decompressor, 16_KiB, 16_KiB, 32));
+        header.entry_count, 64_KiB, 640_KiB, get_decompressor, 16_KiB, 16_KiB, 32, cache_key));
 
     // Potentially set the output compressed storage.
     if (out_cmp) {
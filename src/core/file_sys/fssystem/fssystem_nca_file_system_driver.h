@@ -348,12 +348,12 @@ private:
 
     Result CreateCompressedStorage(VirtualFile* out, std::shared_ptr<CompressedStorage>* out_cmp,
                                    VirtualFile* out_meta, VirtualFile base_storage,
-                                   const NcaCompressionInfo& compression_info);
+                                   const NcaCompressionInfo& compression_info, u64 cache_key);
 
 public:
     Result CreateCompressedStorage(VirtualFile* out, std::shared_ptr<CompressedStorage>* out_cmp,
                                    VirtualFile* out_meta, VirtualFile base_storage,
-                                   const NcaCompressionInfo& compression_info,
+                                   const NcaCompressionInfo& compression_info, u64 cache_key,
                                    GetDecompressorFunction get_decompressor);
 
 private:
@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <utility>
+
+#include "common/alignment.h"
+#include "common/hex_util.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "common/thread_worker.h"
+#include "core/crypto/sha256_engine.h"
+#include "core/file_sys/install_pipeline.h"
+#include "core/file_sys/vfs/vfs.h"
+
+namespace FileSys {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr auto ProgressInterval = 250ms;
+
+/// Buffers are page aligned, so hosts can transfer them without bouncing.
+using Buffer = std::vector<u8, Common::AlignmentAllocator<u8, 4096>>;
+
+/// Pool of the buffers of a file, handed out in order and returned once all stages used them.
+class BufferRing {
+public:
+    explicit BufferRing(u32 stages_) : stages{stages_} {
+        for (Buffer& buffer : buffers) {
+            buffer.resize(InstallPipeline::BlockSize);
+        }
+    }
+
+    /// Waits for the buffer of the next block to be free, and returns its slot.
+    std::size_t Acquire() {
+        std::unique_lock lock{mutex};
+        condition.wait(lock, [this] { return num_in_flight < buffers.size(); });
+        ++num_in_flight;
+        const std::size_t slot = next_slot;
+        next_slot = (next_slot + 1) % buffers.size();
+        pending_stages[slot] = stages;
+        return slot;
+    }
+
+    /// Marks a stage done with the buffer in slot.
+    void Release(std::size_t slot) {
+        {
+            std::scoped_lock lock{mutex};
+            if (--pending_stages[slot] != 0) {
+                return;
+            }
+            --num_in_flight;
+        }
+        condition.notify_one();
+    }
+
+    u8* Data(std::size_t slot) {
+        return buffers[slot].data();
+    }
+
+private:
+    std::array<Buffer, InstallPipeline::BuffersPerFile> buffers;
+    std::array<u32, InstallPipeline::BuffersPerFile> pending_stages{};
+    u32 stages;
+    std::size_t next_slot{};
+    std::size_t num_in_flight{};
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+} // Anonymous namespace
+
+InstallPipeline::InstallPipeline(ProgressCallback callback_, bool verify_hashes_)
+    : callback{std::move(callback_)}, verify_hashes{verify_hashes_} {}
+
+InstallPipeline::~InstallPipeline() = default;
+
+void InstallPipeline::Queue(VirtualFile src, VirtualFile dest, std::optional<NcaID> expected_id) {
+    jobs.push_back({std::move(src), std::move(dest), expected_id});
+}
+
+void InstallPipeline::Clear() {
+    jobs.clear();
+}
+
+bool InstallPipeline::Run() {
+    const auto run_jobs = std::exchange(jobs, {});
+    if (run_jobs.empty()) {
+        return true;
+    }
+
+    std::size_t total_size = 0;
+    for (const Job& job : run_jobs) {
+        total_size += job.src != nullptr ? job.src->GetSize() : 0;
+    }
+    installed_size = 0;
+    cancelled = false;
+
+    std::atomic_bool failed{};
+    std::atomic<std::size_t> num_done{};
+    Common::Event done_event;
+    {
+        Common::ThreadWorker workers{std::min(run_jobs.size(), MaxConcurrentFiles),
+                                     "InstallPipeline"};
+        for (const Job& job : run_jobs) {
+            workers.QueueWork([this, &job, &failed, &num_done, &done_event, &run_jobs] {
+                if (!Copy(job)) {
+                    failed = true;
+                }
+                if (++num_done == run_jobs.size()) {
+                    done_event.Set();
+                }
+            });
+        }
+
+        // Some frontends can only be called back from the thread that started the install.
+        const auto start_time = std::chrono::steady_clock::now();
+        auto last_time = start_time;
+        std::size_t last_size = 0;
+        do {
+            done_event.WaitFor(ProgressInterval);
+
+            const auto now = std::chrono::steady_clock::now();
+            const std::size_t size = installed_size;
+            const auto elapsed = std::chrono::duration<double>(now - last_time).count();
+            const double speed =
+                elapsed > 0 ? static_cast<double>(size - last_size) / elapsed : 0.0;
+            const InstallProgress progress{
+                .total_size = total_size,
+                .installed_size = size,
+                .bytes_per_second = static_cast<std::size_t>(speed),
+            };
+            last_time = now;
+            last_size = size;
+            if (callback && !cancelled && callback(progress)) {
+                cancelled = true;
+            }
+        } while (num_done != run_jobs.size());
+        workers.WaitForRequests();
+
+        const auto total_time = std::chrono::duration<double>(last_time - start_time).count();
+        LOG_INFO(Loader, "Installed {} files, {} MiB in {:.2f} s", run_jobs.size(),
+                 installed_size.load() / 1_MiB, total_time);
+    }
+
+    return !failed && !cancelled;
+}
+
+bool InstallPipeline::Copy(const Job& job) {
+    if (job.src == nullptr || job.dest == nullptr) {
+        return false;
+    }
+    const std::size_t size = job.src->GetSize();
+    if (!job.dest->Resize(size)) {
+        return false;
+    }
+
+    const bool verify = verify_hashes && job.expected_id.has_value();
+    Core::Crypto::Sha256 sha;
+    std::atomic_bool failed{};
+
+    BufferRing ring{verify ? 2U : 1U};
+    {
+        // Both stages process the blocks in order, on one thread each.
+        Common::ThreadWorker hasher{verify ? 1U : 0U, "InstallHasher"};
+        Common::ThreadWorker writer{1, "InstallWriter"};
+
+        for (std::size_t offset = 0; offset < size && !failed && !cancelled; offset += BlockSize) {
+            const std::size_t slot = ring.Acquire();
+            const std::size_t length = std::min(BlockSize, size - offset);
+            if (job.src->Read(ring.Data(slot), length, offset) != length) {
+                LOG_ERROR(Loader, "Failed to read {} at offset {:X}", job.src->GetName(), offset);
+                failed = true;
+                break;
+            }
+
+            if (verify) {
+                hasher.QueueWork([&sha, &ring, slot, length] {
+                    sha.Update(std::span{ring.Data(slot), length});
+                    ring.Release(slot);
+                });
+            }
+            writer.QueueWork([this, &job, &ring, &failed, slot, length, offset] {
+                if (failed) {
+                    // Blocks queued before another stage failed are not written.
+                } else if (job.dest->Write(ring.Data(slot), length, offset) != length) {
+                    LOG_ERROR(Loader, "Failed to write {} at offset {:X}", job.dest->GetName(),
+                              offset);
+                    failed = true;
+                } else {
+                    installed_size += length;
+                }
+                ring.Release(slot);
+            });
+        }
+
+        hasher.WaitForRequests();
+        writer.WaitForRequests();
+    }
+
+    if (!failed && !cancelled && verify) {
+        const auto hash = sha.Finalize();
+        if (std::memcmp(hash.data(), job.expected_id->data(), job.expected_id->size()) != 0) {
+            LOG_ERROR(Loader, "Hash of {} does not match NcaID {}, the file is corrupted",
+                      job.src->GetName(), Common::HexToString(*job.expected_id, false));
+            failed = true;
+        }
+    }
+
+    if (failed || cancelled) {
+        job.dest->Resize(0);
+        return false;
+    }
+    return true;
+}
+
+} // namespace FileSys
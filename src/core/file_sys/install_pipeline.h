@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "core/file_sys/registered_cache.h"
+#include "core/file_sys/vfs/vfs_types.h"
+
+namespace FileSys {
+
+using namespace Common::Literals;
+
+struct InstallProgress {
+    std::size_t total_size;
+    std::size_t installed_size;
+    std::size_t bytes_per_second;
+};
+
+/**
+ * Copies the NCAs of a package into a registered cache.
+ *
+ * Every file goes through a read, a verify and a write stage, which run concurrently on large
+ * buffers, and several files are copied at once. The verify stage checks the SHA-256 of the file
+ * against the NcaID it was listed under, which is the start of that hash.
+ */
+class InstallPipeline {
+public:
+    /// Size of the buffers files are copied in.
+    static constexpr std::size_t BlockSize = 4_MiB;
+    /// Number of buffers of each file in flight between the stages.
+    static constexpr std::size_t BuffersPerFile = 4;
+    /// Number of files copied at once.
+    static constexpr std::size_t MaxConcurrentFiles = 4;
+
+    /// Receives the progress of Run. Returning true cancels the install.
+    using ProgressCallback = std::function<bool(const InstallProgress&)>;
+
+    explicit InstallPipeline(ProgressCallback callback = {}, bool verify_hashes = false);
+    ~InstallPipeline();
+
+    InstallPipeline(const InstallPipeline&) = delete;
+    InstallPipeline& operator=(const InstallPipeline&) = delete;
+
+    /// Queues copying src to dest. When expected_id is set, the hash of src is verified against it.
+    void Queue(VirtualFile src, VirtualFile dest, std::optional<NcaID> expected_id = {});
+
+    /// Drops the queued files without copying them.
+    void Clear();
+
+    /**
+     * Copies all queued files, and reports the progress on the calling thread until they are.
+     * Returns false if a copy failed or was cancelled, in which case its destination is emptied.
+     */
+    bool Run();
+
+private:
+    struct Job {
+        VirtualFile src;
+        VirtualFile dest;
+        std::optional<NcaID> expected_id;
+    };
+
+    bool Copy(const Job& job);
+
+    ProgressCallback callback;
+    bool verify_hashes;
+
+    std::vector<Job> jobs;
+    std::atomic<std::size_t> installed_size{};
+    std::atomic_bool cancelled{};
+};
+
+} // namespace FileSys
@@ -6,6 +6,7 @@
 #include <cstddef>
 #include <cstring>
 
+#include "common/cityhash.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
@@ -16,11 +17,13 @@
 #include "core/core.h"
 #include "core/file_sys/common_funcs.h"
 #include "core/file_sys/content_archive.h"
+#include "core/file_sys/content_cache.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/ips_layer.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/romfs.h"
+#include "core/file_sys/romfs_build_cache.h"
 #include "core/file_sys/vfs/vfs_cached.h"
 #include "core/file_sys/vfs/vfs_layered.h"
 #include "core/file_sys/vfs/vfs_vector.h"
@@ -395,21 +398,8 @@ static void ApplyLayeredFS(VirtualFile& romfs, u64 title_id, ContentRecordType t
         return;
     }
 
-    auto extracted = ExtractRomFS(romfs);
-    if (extracted == nullptr) {
-        return;
-    }
-
-    layers.emplace_back(std::move(extracted));
-
-    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
-    if (layered == nullptr) {
-        return;
-    }
-
-    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
-
-    auto packed = CreateRomFS(std::move(layered), std::move(layered_ext));
+    auto packed = CreateLayeredRomFS(romfs, std::move(layers), std::move(layers_ext),
+                                     RomFSBuildCache::GetCachePath(title_id, type));
     if (packed == nullptr) {
         return;
     }
@@ -430,6 +420,7 @@ VirtualFile PatchManager::PatchRomFS(const NCA* base_nca, VirtualFile base_romfs
     }
 
     auto romfs = base_romfs;
+    VirtualFile applied_update;
 
     // Game Updates
     const auto update_tid = GetUpdateTitleID(title_id);
@@ -446,6 +437,7 @@ VirtualFile PatchManager::PatchRomFS(const NCA* base_nca, VirtualFile base_romfs
             LOG_INFO(Loader, "    RomFS: Update ({}) applied successfully",
                      FormatTitleVersion(content_provider.GetEntryVersion(update_tid).value_or(0)));
             romfs = new_nca->GetRomFS();
+            applied_update = update_raw;
             const auto version =
                 FormatTitleVersion(content_provider.GetEntryVersion(update_tid).value_or(0));
         }
@@ -455,7 +447,18 @@ VirtualFile PatchManager::PatchRomFS(const NCA* base_nca, VirtualFile base_romfs
             new_nca->GetRomFS() != nullptr) {
             LOG_INFO(Loader, "    RomFS: Update (PACKED) applied successfully");
             romfs = new_nca->GetRomFS();
+            applied_update = packed_update_raw;
+        }
+    }
+
+    // Content cache, keyed by the base and update NCAs, which are named after their content IDs
+    if (type == ContentRecordType::Program && base_nca != nullptr && romfs != nullptr) {
+        std::string contents = fmt::format("{}:{}", base_nca->GetName(), romfs->GetSize());
+        if (applied_update != nullptr) {
+            contents += fmt::format(":{}:{}", applied_update->GetName(), applied_update->GetSize());
         }
+        const u64 hash = Common::CityHash64(contents.data(), contents.size());
+        romfs = CacheContent(romfs, fmt::format("{:016X}_{:016X}", title_id, hash));
     }
 
     // LayeredFS
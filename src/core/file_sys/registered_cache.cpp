@@ -14,10 +14,13 @@
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/common_funcs.h"
 #include "core/file_sys/content_archive.h"
+#include "core/file_sys/install_pipeline.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/registered_cache.h"
+#include "core/file_sys/registered_cache_index.h"
 #include "core/file_sys/submission_package.h"
 #include "core/file_sys/vfs/vfs_concat.h"
+#include "core/file_sys/vfs/vfs_vector.h"
 #include "core/loader/loader.h"
 
 namespace FileSys {
@@ -25,6 +28,13 @@ namespace FileSys {
 // The size of blocks to use when vfs raw copying into nand.
 constexpr size_t VFS_RC_LARGE_COPY_BLOCK = 0x400000;
 
+// Copies ncas with a copy function for plain files, which has no use for their NcaID.
+static auto WrapCopyFunction(const VfsCopyFunction& copy) {
+    return [&copy](const VirtualFile& src, const VirtualFile& dest, const NcaID&) {
+        return copy(src, dest, VFS_RC_LARGE_COPY_BLOCK);
+    };
+}
+
 std::string ContentProviderEntry::DebugInfo() const {
     return fmt::format("title_id={:016X}, content_type={:02X}", title_id, static_cast<u8>(type));
 }
@@ -204,7 +214,7 @@ bool PlaceholderCache::Register(RegisteredCache* cache, const NcaID& placeholder
     if (file == nullptr)
         return false;
 
-    const auto res = cache->RawInstallNCA(NCA{file}, &VfsRawCopy, false, install);
+    const auto res = cache->RawInstallNCA(NCA{file}, WrapCopyFunction(&VfsRawCopy), false, install);
 
     if (res != InstallResult::Success)
         return false;
@@ -326,7 +336,7 @@ VirtualFile RegisteredCache::OpenFileOrDirectoryConcat(const VirtualDir& open_di
     return ConcatenatedVfsFile::MakeConcatenatedFile(std::move(name), std::move(concat));
 }
 
-VirtualFile RegisteredCache::GetFileAtID(NcaID id) const {
+VirtualFile RegisteredCache::GetFileAtID(NcaID id, std::string* out_path) const {
     VirtualFile file;
     // Try all five relevant modes of file storage:
     // (bit 2 = uppercase/lower, bit 1 = within a two-digit dir, bit 0 = .cnmt suffix)
@@ -341,12 +351,23 @@ VirtualFile RegisteredCache::GetFileAtID(NcaID id) const {
         const auto path =
             GetRelativePathFromNcaID(id, (i & 0b100) == 0, (i & 0b010) == 0, (i & 0b001) == 0b001);
         file = OpenFileOrDirectoryConcat(dir, path);
-        if (file != nullptr)
+        if (file != nullptr) {
+            if (out_path != nullptr) {
+                *out_path = path;
+            }
             return file;
+        }
     }
     return file;
 }
 
+bool RegisteredCache::IsIndexEntryCurrent(const std::string& path, u64 size,
+                                          u64 modified) const {
+    const auto file = OpenFileOrDirectoryConcat(dir, path);
+    return file != nullptr && file->GetSize() == size &&
+           dir->GetFileTimeStamp(path).modified == modified;
+}
+
 static std::optional<NcaID> CheckMapForContentRecord(const std::map<u64, CNMT>& map, u64 title_id,
                                                      ContentRecordType type) {
     const auto cmnt_iter = map.find(title_id);
@@ -413,28 +434,66 @@ std::vector<NcaID> RegisteredCache::AccumulateFiles() const {
 }
 
 void RegisteredCache::ProcessFiles(const std::vector<NcaID>& ids) {
+    std::size_t num_parsed = 0;
     for (const auto& id : ids) {
-        const auto file = GetFileAtID(id);
+        // Use the results of parsing the NCA before if it did not change since.
+        if (const auto* const entry = index != nullptr ? index->Find(id) : nullptr;
+            entry != nullptr && IsIndexEntryCurrent(entry->path, entry->size, entry->modified)) {
+            if (!entry->cnmt.empty()) {
+                meta.insert_or_assign(entry->title_id,
+                                      CNMT(std::make_shared<VectorVfsFile>(entry->cnmt)));
+                meta_id.insert_or_assign(entry->title_id, id);
+            }
+            continue;
+        }
+
+        std::string path;
+        const auto file = GetFileAtID(id, &path);
 
         if (file == nullptr)
             continue;
         const auto nca = std::make_shared<NCA>(parser(file, id));
-        if (nca->GetStatus() != Loader::ResultStatus::Success ||
-            nca->GetType() != NCAContentType::Meta || nca->GetSubdirectories().empty()) {
+        // NCAs failing to parse are not indexed, they may parse once the keys are available.
+        if (nca->GetStatus() != Loader::ResultStatus::Success) {
             continue;
         }
+        ++num_parsed;
+
+        RegisteredCacheIndex::Entry entry{
+            .path = path,
+            .size = file->GetSize(),
+            .modified = dir->GetFileTimeStamp(path).modified,
+            .type = nca->GetType(),
+            .title_id = nca->GetTitleId(),
+            .cnmt{},
+        };
+
+        if (nca->GetType() == NCAContentType::Meta && !nca->GetSubdirectories().empty()) {
+            const auto section0 = nca->GetSubdirectories()[0];
+
+            for (const auto& section0_file : section0->GetFiles()) {
+                if (section0_file->GetExtension() != "cnmt")
+                    continue;
+
+                entry.cnmt = section0_file->ReadAllBytes();
+                meta.insert_or_assign(nca->GetTitleId(),
+                                      CNMT(std::make_shared<VectorVfsFile>(entry.cnmt)));
+                meta_id.insert_or_assign(nca->GetTitleId(), id);
+                break;
+            }
+        }
 
-        const auto section0 = nca->GetSubdirectories()[0];
-
-        for (const auto& section0_file : section0->GetFiles()) {
-            if (section0_file->GetExtension() != "cnmt")
-                continue;
-
-            meta.insert_or_assign(nca->GetTitleId(), CNMT(section0_file));
-            meta_id.insert_or_assign(nca->GetTitleId(), id);
-            break;
+        if (index != nullptr) {
+            index->Insert(id, std::move(entry));
         }
     }
+
+    if (index != nullptr) {
+        index->Retain(ids);
+        index->Save();
+        LOG_DEBUG(Loader, "Parsed {} of {} NCAs in {}", num_parsed, ids.size(),
+                  dir->GetFullPath());
+    }
 }
 
 void RegisteredCache::AccumulateSuyuMeta() {
@@ -465,6 +524,12 @@ void RegisteredCache::Refresh() {
 
 RegisteredCache::RegisteredCache(VirtualDir dir_, ContentProviderParsingFunction parsing_function)
     : dir(std::move(dir_)), parser(std::move(parsing_function)) {
+    if (dir != nullptr) {
+        if (const auto full_path = dir->GetFullPath(); !full_path.empty()) {
+            index = std::make_unique<RegisteredCacheIndex>(
+                RegisteredCacheIndex::GetIndexPath(full_path));
+        }
+    }
     Refresh();
 }
 
@@ -565,6 +630,50 @@ InstallResult RegisteredCache::InstallEntry(const XCI& xci, bool overwrite_if_ex
 
 InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_exists,
                                             const VfsCopyFunction& copy) {
+    std::vector<NcaID> created_ids;
+    const auto result =
+        InstallNSP(nsp, overwrite_if_exists,
+                   [&copy, &created_ids](const VirtualFile& src, const VirtualFile& dest,
+                                         const NcaID& id) {
+                       created_ids.push_back(id);
+                       return copy(src, dest, VFS_RC_LARGE_COPY_BLOCK);
+                   });
+    if (result != InstallResult::Success && result != InstallResult::OverwriteExisting) {
+        RemoveNCAs(created_ids);
+    }
+    Refresh();
+    return result;
+}
+
+InstallResult RegisteredCache::InstallEntry(const XCI& xci, bool overwrite_if_exists,
+                                            InstallPipeline& pipeline) {
+    return InstallEntry(*xci.GetSecurePartitionNSP(), overwrite_if_exists, pipeline);
+}
+
+InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_exists,
+                                            InstallPipeline& pipeline) {
+    // The ncas are only queued here, and copied all at once when the package checked out.
+    std::vector<NcaID> created_ids;
+    auto result = InstallNSP(nsp, overwrite_if_exists,
+                             [&pipeline, &created_ids](const VirtualFile& src,
+                                                       const VirtualFile& dest, const NcaID& id) {
+                                 created_ids.push_back(id);
+                                 pipeline.Queue(src, dest, id);
+                                 return true;
+                             });
+    if (result != InstallResult::Success && result != InstallResult::OverwriteExisting) {
+        pipeline.Clear();
+        RemoveNCAs(created_ids);
+    } else if (!pipeline.Run()) {
+        RemoveNCAs(created_ids);
+        result = InstallResult::ErrorCopyFailed;
+    }
+    Refresh();
+    return result;
+}
+
+InstallResult RegisteredCache::InstallNSP(const NSP& nsp, bool overwrite_if_exists,
+                                          const NcaCopyFunction& copy) {
     const auto ncas = nsp.GetNCAsCollapsed();
     const auto meta_iter = std::find_if(ncas.begin(), ncas.end(), [](const auto& nca) {
         return nca->GetType() == NCAContentType::Meta;
@@ -627,7 +736,7 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
             nca->GetTitleId() != title_id) {
             // Create fake cnmt for patch to multiprogram application
             const auto sub_nca_result =
-                InstallEntry(*nca, cnmt.GetHeader(), record, overwrite_if_exists, copy);
+                InstallNCAWithMeta(*nca, cnmt.GetHeader(), record, overwrite_if_exists, copy);
             if (sub_nca_result != InstallResult::Success) {
                 return sub_nca_result;
             }
@@ -639,7 +748,6 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
         }
     }
 
-    Refresh();
     if (result) {
         return InstallResult::OverwriteExisting;
     }
@@ -671,12 +779,20 @@ InstallResult RegisteredCache::InstallEntry(const NCA& nca, TitleType type,
     if (!RawInstallSuyuMeta(new_cnmt)) {
         return InstallResult::ErrorMetaFailed;
     }
-    return RawInstallNCA(nca, copy, overwrite_if_exists, c_rec.nca_id);
+    return RawInstallNCA(nca, WrapCopyFunction(copy), overwrite_if_exists, c_rec.nca_id);
 }
 
 InstallResult RegisteredCache::InstallEntry(const NCA& nca, const CNMTHeader& base_header,
                                             const ContentRecord& base_record,
                                             bool overwrite_if_exists, const VfsCopyFunction& copy) {
+    return InstallNCAWithMeta(nca, base_header, base_record, overwrite_if_exists,
+                              WrapCopyFunction(copy));
+}
+
+InstallResult RegisteredCache::InstallNCAWithMeta(const NCA& nca, const CNMTHeader& base_header,
+                                                  const ContentRecord& base_record,
+                                                  bool overwrite_if_exists,
+                                                  const NcaCopyFunction& copy) {
     const CNMTHeader header{
         .title_id = nca.GetTitleId(),
         .title_version = base_header.title_version,
@@ -705,6 +821,10 @@ bool RegisteredCache::RemoveExistingEntry(u64 title_id) const {
     const auto delete_nca = [this](const NcaID& id) {
         const auto path = GetRelativePathFromNcaID(id, false, true, false);
 
+        if (index != nullptr) {
+            index->Erase(id);
+        }
+
         const bool isFile = dir->GetFileRelative(path) != nullptr;
         const bool isDir = dir->GetDirectoryRelative(path) != nullptr;
 
@@ -761,7 +881,7 @@ bool RegisteredCache::RemoveExistingEntry(u64 title_id) const {
     return removed_data;
 }
 
-InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFunction& copy,
+InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const NcaCopyFunction& copy,
                                              bool overwrite_if_exists,
                                              std::optional<NcaID> override_id) {
     const auto in = nca.GetBaseFile();
@@ -787,6 +907,10 @@ InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFuncti
         return InstallResult::ErrorAlreadyExists;
     }
 
+    if (index != nullptr) {
+        index->Erase(id);
+    }
+
     if (GetFileAtID(id) != nullptr) {
         LOG_WARNING(Loader, "Overwriting existing NCA...");
         VirtualDir c_dir;
@@ -798,8 +922,19 @@ InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFuncti
     if (out == nullptr) {
         return InstallResult::ErrorCopyFailed;
     }
-    return copy(in, out, VFS_RC_LARGE_COPY_BLOCK) ? InstallResult::Success
-                                                  : InstallResult::ErrorCopyFailed;
+    return copy(in, out, id) ? InstallResult::Success : InstallResult::ErrorCopyFailed;
+}
+
+void RegisteredCache::RemoveNCAs(std::span<const NcaID> ids) {
+    for (const NcaID& id : ids) {
+        if (index != nullptr) {
+            index->Erase(id);
+        }
+        const auto path = GetRelativePathFromNcaID(id, false, true, false);
+        if (const auto file = dir->GetFileRelative(path); file != nullptr) {
+            file->GetContainingDirectory()->DeleteFile(file->GetName());
+        }
+    }
 }
 
 bool RegisteredCache::RawInstallSuyuMeta(const CNMT& cnmt) {
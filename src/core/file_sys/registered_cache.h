@@ -6,6 +6,7 @@
 #include <array>
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <boost/container/flat_map.hpp>
@@ -26,7 +27,9 @@ enum class TitleType : u8;
 struct ContentRecord;
 struct CNMTHeader;
 struct MetaRecord;
+class InstallPipeline;
 class RegisteredCache;
+class RegisteredCacheIndex;
 
 using NcaID = std::array<u8, 0x10>;
 using ContentProviderParsingFunction = std::function<VirtualFile(const VirtualFile&, const NcaID&)>;
@@ -163,6 +166,10 @@ public:
     InstallResult InstallEntry(const NSP& nsp, bool overwrite_if_exists = false,
                                const VfsCopyFunction& copy = &VfsRawCopy);
 
+    // Same as above, but copies all the ncas concurrently through the pipeline.
+    InstallResult InstallEntry(const XCI& xci, bool overwrite_if_exists, InstallPipeline& pipeline);
+    InstallResult InstallEntry(const NSP& nsp, bool overwrite_if_exists, InstallPipeline& pipeline);
+
     // Due to the fact that we must use Meta-type NCAs to determine the existence of files, this
     // poses quite a challenge. Instead of creating a new meta NCA for this file, suyu will create a
     // dir inside the NAND called 'suyu_meta' and store the raw CNMT there.
@@ -178,6 +185,10 @@ public:
     bool RemoveExistingEntry(u64 title_id) const;
 
 private:
+    // Copies an nca to its file in the cache, given the NcaID it is installed as.
+    using NcaCopyFunction =
+        std::function<bool(const VirtualFile& src, const VirtualFile& dest, const NcaID& id)>;
+
     template <typename T>
     void IterateAllMetadata(std::vector<T>& out,
                             std::function<T(const CNMT&, const ContentRecord&)> proc,
@@ -186,10 +197,17 @@ private:
     void ProcessFiles(const std::vector<NcaID>& ids);
     void AccumulateSuyuMeta();
     std::optional<NcaID> GetNcaIDFromMetadata(u64 title_id, ContentRecordType type) const;
-    VirtualFile GetFileAtID(NcaID id) const;
+    VirtualFile GetFileAtID(NcaID id, std::string* out_path = nullptr) const;
+    bool IsIndexEntryCurrent(const std::string& path, u64 size, u64 modified) const;
     VirtualFile OpenFileOrDirectoryConcat(const VirtualDir& open_dir, std::string_view path) const;
-    InstallResult RawInstallNCA(const NCA& nca, const VfsCopyFunction& copy,
+    InstallResult InstallNSP(const NSP& nsp, bool overwrite_if_exists, const NcaCopyFunction& copy);
+    InstallResult InstallNCAWithMeta(const NCA& nca, const CNMTHeader& base_header,
+                                     const ContentRecord& base_record, bool overwrite_if_exists,
+                                     const NcaCopyFunction& copy);
+    InstallResult RawInstallNCA(const NCA& nca, const NcaCopyFunction& copy,
                                 bool overwrite_if_exists, std::optional<NcaID> override_id = {});
+    // Removes the ncas created by an install that failed, so they are not listed as installed.
+    void RemoveNCAs(std::span<const NcaID> ids);
     bool RawInstallSuyuMeta(const CNMT& cnmt);
 
     VirtualDir dir;
@@ -201,6 +219,9 @@ private:
     std::map<u64, CNMT> meta;
     // maps tid -> meta for CNMT in suyu_meta
     std::map<u64, CNMT> suyu_meta;
+
+    // parsed NCAs from previous refreshes, nullptr if the directory has no path on the host
+    std::unique_ptr<RegisteredCacheIndex> index;
 };
 
 enum class ContentProviderUnionSlot {
@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/registered_cache_index.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr u32 IndexMagic = Common::MakeMagic('S', 'R', 'C', 'I');
+constexpr u32 IndexVersion = 1;
+
+struct IndexHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le entry_count;
+    u64_le payload_size;
+    u64_le payload_hash;
+};
+static_assert(sizeof(IndexHeader) == 0x20, "IndexHeader has incorrect size.");
+
+struct EntryHeader {
+    RegisteredCacheIndex::NcaID nca_id;
+    u64_le size;
+    u64_le modified;
+    u64_le title_id;
+    u32_le path_size;
+    u32_le cnmt_size;
+    NCAContentType type;
+    INSERT_PADDING_BYTES(7);
+};
+static_assert(sizeof(EntryHeader) == 0x38, "EntryHeader has incorrect size.");
+
+u64 HashPayload(std::span<const u8> payload) {
+    return Common::CityHash64(reinterpret_cast<const char*>(payload.data()), payload.size());
+}
+
+} // Anonymous namespace
+
+RegisteredCacheIndex::RegisteredCacheIndex(std::filesystem::path path_) : path{std::move(path_)} {
+    Load();
+}
+
+std::filesystem::path RegisteredCacheIndex::GetIndexPath(std::string_view registered_dir_path) {
+    const u64 key = Common::CityHash64(registered_dir_path.data(), registered_dir_path.size());
+    return Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "registered" /
+           fmt::format("{:016X}.bin", key);
+}
+
+const RegisteredCacheIndex::Entry* RegisteredCacheIndex::Find(const NcaID& id) const {
+    const auto it = entries.find(id);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+void RegisteredCacheIndex::Insert(const NcaID& id, Entry entry) {
+    entries.insert_or_assign(id, std::move(entry));
+    is_dirty = true;
+}
+
+void RegisteredCacheIndex::Erase(const NcaID& id) {
+    if (entries.erase(id) != 0) {
+        is_dirty = true;
+        Save();
+    }
+}
+
+void RegisteredCacheIndex::Retain(std::span<const NcaID> ids) {
+    std::vector<NcaID> sorted_ids(ids.begin(), ids.end());
+    std::ranges::sort(sorted_ids);
+    is_dirty |= std::erase_if(entries, [&sorted_ids](const auto& entry) {
+                    return !std::ranges::binary_search(sorted_ids, entry.first);
+                }) != 0;
+}
+
+void RegisteredCacheIndex::Load() {
+    if (!Common::FS::Exists(path)) {
+        return;
+    }
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                                  Common::FS::FileType::BinaryFile};
+    IndexHeader header{};
+    if (!file.IsOpen() || !file.ReadObject(header)) {
+        return;
+    }
+    if (header.magic != IndexMagic || header.version != IndexVersion) {
+        LOG_INFO(Loader, "Discarding outdated registered cache index {}",
+                 Common::FS::PathToUTF8String(path));
+        return;
+    }
+
+    std::vector<u8> payload;
+    if (header.payload_size == file.GetSize() - sizeof(IndexHeader)) {
+        payload.resize(header.payload_size);
+    }
+    if (payload.size() != header.payload_size || file.ReadSpan<u8>(payload) != payload.size() ||
+        HashPayload(payload) != header.payload_hash) {
+        LOG_WARNING(Loader, "Discarding corrupted registered cache index {}",
+                    Common::FS::PathToUTF8String(path));
+        return;
+    }
+
+    std::size_t offset = 0;
+    for (u64 i = 0; i < header.entry_count; ++i) {
+        EntryHeader entry_header;
+        if (payload.size() - offset < sizeof(EntryHeader)) {
+            entries.clear();
+            return;
+        }
+        std::memcpy(&entry_header, payload.data() + offset, sizeof(EntryHeader));
+        offset += sizeof(EntryHeader);
+
+        if (payload.size() - offset < u64{entry_header.path_size} + entry_header.cnmt_size) {
+            entries.clear();
+            return;
+        }
+        Entry entry{
+            .path{reinterpret_cast<const char*>(payload.data() + offset), entry_header.path_size},
+            .size = entry_header.size,
+            .modified = entry_header.modified,
+            .type = entry_header.type,
+            .title_id = entry_header.title_id,
+            .cnmt{},
+        };
+        offset += entry_header.path_size;
+        entry.cnmt.assign(payload.begin() + offset,
+                          payload.begin() + offset + entry_header.cnmt_size);
+        offset += entry_header.cnmt_size;
+
+        entries.insert_or_assign(entry_header.nca_id, std::move(entry));
+    }
+}
+
+void RegisteredCacheIndex::Save() {
+    if (!is_dirty) {
+        return;
+    }
+
+    std::vector<u8> payload;
+    for (const auto& [id, entry] : entries) {
+        const EntryHeader entry_header{
+            .nca_id = id,
+            .size = entry.size,
+            .modified = entry.modified,
+            .title_id = entry.title_id,
+            .path_size = static_cast<u32>(entry.path.size()),
+            .cnmt_size = static_cast<u32>(entry.cnmt.size()),
+            .type = entry.type,
+        };
+        const auto* const header_bytes = reinterpret_cast<const u8*>(&entry_header);
+        payload.insert(payload.end(), header_bytes, header_bytes + sizeof(EntryHeader));
+        payload.insert(payload.end(), entry.path.begin(), entry.path.end());
+        payload.insert(payload.end(), entry.cnmt.begin(), entry.cnmt.end());
+    }
+    const IndexHeader header{
+        .magic = IndexMagic,
+        .version = IndexVersion,
+        .entry_count = entries.size(),
+        .payload_size = payload.size(),
+        .payload_hash = HashPayload(payload),
+    };
+
+    // Write a new index next to the old one and swap them, so the index on disk is always whole.
+    if (!Common::FS::CreateDirs(path.parent_path())) {
+        return;
+    }
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        const Common::FS::IOFile file{temp_path, Common::FS::FileAccessMode::Write,
+                                      Common::FS::FileType::BinaryFile};
+        if (!file.IsOpen() || !file.WriteObject(header) ||
+            file.WriteSpan<u8>(payload) != payload.size() || !file.Flush()) {
+            LOG_WARNING(Loader, "Failed to write registered cache index {}",
+                        Common::FS::PathToUTF8String(temp_path));
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        LOG_WARNING(Loader, "Failed to replace registered cache index {}: {}",
+                    Common::FS::PathToUTF8String(path), ec.message());
+        return;
+    }
+    is_dirty = false;
+}
+
+} // namespace FileSys
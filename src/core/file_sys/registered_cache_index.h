@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace FileSys {
+
+enum class NCAContentType : u8;
+
+/**
+ * On-disk index of the NCAs found in a RegisteredCache, with the results of parsing them.
+ *
+ * Entries are keyed by NcaID and remember the path, size and modification time of the NCA they
+ * were parsed from, so a refresh only parses the NCAs that were added or changed since.
+ */
+class RegisteredCacheIndex {
+public:
+    using NcaID = std::array<u8, 0x10>;
+
+    struct Entry {
+        std::string path; ///< Path of the NCA, relative to the registered directory.
+        u64 size;
+        u64 modified;
+        NCAContentType type;
+        u64 title_id;
+        std::vector<u8> cnmt; ///< Raw CNMT of meta NCAs, empty for other NCAs.
+    };
+
+    /// Loads the index stored at the path. A missing or invalid index is treated as empty.
+    explicit RegisteredCacheIndex(std::filesystem::path path);
+
+    /// Returns the path of the index of the registered directory at the given path.
+    static std::filesystem::path GetIndexPath(std::string_view registered_dir_path);
+
+    const Entry* Find(const NcaID& id) const;
+
+    void Insert(const NcaID& id, Entry entry);
+
+    /// Removes the entry of an NCA about to be replaced or removed, and saves the index.
+    void Erase(const NcaID& id);
+
+    /// Removes the entries of all NCAs not in ids.
+    void Retain(std::span<const NcaID> ids);
+
+    /// Writes the index to disk, if it changed since it was loaded or saved.
+    void Save();
+
+    std::size_t GetSize() const {
+        return entries.size();
+    }
+
+private:
+    void Load();
+
+    std::filesystem::path path;
+    std::map<NcaID, Entry> entries;
+    bool is_dirty{};
+};
+
+} // namespace FileSys
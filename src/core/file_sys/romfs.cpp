@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <memory>
+#include <span>
+#include <vector>
 
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -58,14 +60,27 @@ static_assert(sizeof(FileEntry) == 0x20, "FileEntry has incorrect size.");
 struct RomFSTraversalContext {
     RomFSHeader header;
     VirtualFile file;
-    std::vector<u8> directory_meta;
-    std::vector<u8> file_meta;
+    std::span<const u8> directory_meta;
+    std::span<const u8> file_meta;
+    std::vector<u8> directory_meta_storage;
+    std::vector<u8> file_meta_storage;
 };
 
+// Views the table in the file if it is held in memory, else reads it into the storage.
+std::span<const u8> ReadTable(const VirtualFile& file, const TableLocation& location,
+                              std::vector<u8>& storage) {
+    const auto view = file->GetView(location.size, location.offset);
+    if (view.size() == location.size) {
+        return view;
+    }
+    storage = file->ReadBytes(location.size, location.offset);
+    return storage;
+}
+
 template <typename EntryType, auto Member>
 std::pair<EntryType, std::string> GetEntry(const RomFSTraversalContext& ctx, size_t offset) {
     const size_t entry_end = offset + sizeof(EntryType);
-    const std::vector<u8>& vec = ctx.*Member;
+    const std::span<const u8> vec = ctx.*Member;
     const size_t size = vec.size();
     const u8* data = vec.data();
     EntryType entry{};
@@ -142,9 +157,8 @@ VirtualDir ExtractRomFS(VirtualFile file) {
     }
 
     ctx.file = file;
-    ctx.directory_meta =
-        file->ReadBytes(ctx.header.directory_meta.size, ctx.header.directory_meta.offset);
-    ctx.file_meta = file->ReadBytes(ctx.header.file_meta.size, ctx.header.file_meta.offset);
+    ctx.directory_meta = ReadTable(file, ctx.header.directory_meta, ctx.directory_meta_storage);
+    ctx.file_meta = ReadTable(file, ctx.header.file_meta, ctx.file_meta_storage);
 
     ProcessDirectory(ctx, 0, root_container);
 
@@ -164,4 +178,18 @@ VirtualFile CreateRomFS(VirtualDir dir, VirtualDir ext) {
     return ConcatenatedVfsFile::MakeConcatenatedFile(0, dir->GetName(), ctx.Build());
 }
 
+VirtualFile CreateLayeredRomFS(VirtualFile base, std::vector<VirtualDir> layers,
+                               std::vector<VirtualDir> ext_layers,
+                               const std::filesystem::path& cache_path) {
+    if (base == nullptr)
+        return nullptr;
+
+    RomFSBuildContext ctx{base, std::move(layers), std::move(ext_layers), cache_path};
+    auto concat = ctx.Build();
+    if (concat.empty())
+        return nullptr;
+
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, base->GetName(), std::move(concat));
+}
+
 } // namespace FileSys
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <filesystem>
+#include <vector>
+
 #include "core/file_sys/vfs/vfs.h"
 
 namespace FileSys {
@@ -15,4 +18,11 @@ VirtualDir ExtractRomFS(VirtualFile file);
 // Returns nullptr on failure
 VirtualFile CreateRomFS(VirtualDir dir, VirtualDir ext = nullptr);
 
+// Converts a RomFS binary blob with the layers and ext_layers on top into a RomFS binary, reusing
+// the layout cached at cache_path where the layers did not change
+// Returns nullptr on failure
+VirtualFile CreateLayeredRomFS(VirtualFile base, std::vector<VirtualDir> layers,
+                               std::vector<VirtualDir> ext_layers,
+                               const std::filesystem::path& cache_path);
+
 } // namespace FileSys
@@ -0,0 +1,282 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/romfs_build_cache.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr u32 CacheMagic = Common::MakeMagic('S', 'R', 'B', 'C');
+constexpr u32 CacheVersion = 1;
+
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le base_identity;
+    u32_le num_layers;
+    u32_le num_ext_layers;
+    u64_le payload_size;
+    u64_le payload_hash;
+};
+static_assert(sizeof(CacheHeader) == 0x28, "CacheHeader has incorrect size.");
+
+struct FileHeader {
+    u64_le size;
+    u64_le offset;
+    u64_le source_offset;
+    u64_le source_size;
+    u32_le source_layer;
+    u32_le ips_layer;
+    u32_le path_size;
+    INSERT_PADDING_BYTES(4);
+};
+static_assert(sizeof(FileHeader) == 0x30, "FileHeader has incorrect size.");
+
+u64 HashPayload(std::span<const u8> payload) {
+    return Common::CityHash64(reinterpret_cast<const char*>(payload.data()), payload.size());
+}
+
+class PayloadWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto* const bytes = reinterpret_cast<const u8*>(&value);
+        payload.insert(payload.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteBytes(std::span<const u8> bytes) {
+        Write(u64_le{bytes.size()});
+        payload.insert(payload.end(), bytes.begin(), bytes.end());
+    }
+
+    void WriteString(std::string_view string) {
+        Write(u32_le{static_cast<u32>(string.size())});
+        payload.insert(payload.end(), string.begin(), string.end());
+    }
+
+    std::vector<u8> payload;
+};
+
+class PayloadReader {
+public:
+    explicit PayloadReader(std::span<const u8> payload_) : payload{payload_} {}
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (payload.size() - offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, payload.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool ReadBytes(std::vector<u8>& bytes) {
+        u64_le size;
+        if (!Read(size) || payload.size() - offset < size) {
+            return false;
+        }
+        bytes.assign(payload.begin() + offset, payload.begin() + offset + size);
+        offset += size;
+        return true;
+    }
+
+    bool ReadString(std::string& string, std::size_t size) {
+        if (payload.size() - offset < size) {
+            return false;
+        }
+        string.assign(reinterpret_cast<const char*>(payload.data() + offset), size);
+        offset += size;
+        return true;
+    }
+
+    bool ReadString(std::string& string) {
+        u32_le size;
+        return Read(size) && ReadString(string, size);
+    }
+
+    bool IsAtEnd() const {
+        return offset == payload.size();
+    }
+
+private:
+    std::span<const u8> payload;
+    std::size_t offset{};
+};
+
+} // Anonymous namespace
+
+std::filesystem::path RomFSBuildCache::GetCachePath(u64 title_id, ContentRecordType type) {
+    return Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "layeredfs" /
+           fmt::format("{:016X}_{:02X}.bin", title_id, static_cast<u8>(type));
+}
+
+std::optional<RomFSBuildCache> RomFSBuildCache::Load(const std::filesystem::path& path) {
+    if (!Common::FS::Exists(path)) {
+        return std::nullopt;
+    }
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                                  Common::FS::FileType::BinaryFile};
+    CacheHeader header{};
+    if (!file.IsOpen() || !file.ReadObject(header)) {
+        return std::nullopt;
+    }
+    if (header.magic != CacheMagic || header.version != CacheVersion) {
+        LOG_INFO(Loader, "Discarding outdated LayeredFS cache {}",
+                 Common::FS::PathToUTF8String(path));
+        return std::nullopt;
+    }
+
+    std::vector<u8> payload;
+    if (header.payload_size == file.GetSize() - sizeof(CacheHeader)) {
+        payload.resize(header.payload_size);
+    }
+    if (payload.size() != header.payload_size || file.ReadSpan<u8>(payload) != payload.size() ||
+        HashPayload(payload) != header.payload_hash) {
+        LOG_WARNING(Loader, "Discarding corrupted LayeredFS cache {}",
+                    Common::FS::PathToUTF8String(path));
+        return std::nullopt;
+    }
+
+    RomFSBuildCache cache{
+        .base_identity = header.base_identity,
+        .num_layers = header.num_layers,
+        .num_ext_layers = header.num_ext_layers,
+    };
+    PayloadReader reader{payload};
+    const auto read_payload = [&] {
+        u32_le num_subtrees;
+        if (!reader.Read(num_subtrees)) {
+            return false;
+        }
+        for (u32 i = 0; i < num_subtrees; ++i) {
+            std::string name;
+            u64_le fingerprint;
+            if (!reader.ReadString(name) || !reader.Read(fingerprint)) {
+                return false;
+            }
+            cache.subtrees.insert_or_assign(std::move(name), fingerprint);
+        }
+
+        u32_le num_directories;
+        if (!reader.Read(num_directories)) {
+            return false;
+        }
+        for (u32 i = 0; i < num_directories; ++i) {
+            if (!reader.ReadString(cache.directories.emplace_back())) {
+                return false;
+            }
+        }
+
+        u32_le num_files;
+        if (!reader.Read(num_files)) {
+            return false;
+        }
+        for (u32 i = 0; i < num_files; ++i) {
+            FileHeader file_header;
+            std::string file_path;
+            if (!reader.Read(file_header) || !reader.ReadString(file_path, file_header.path_size)) {
+                return false;
+            }
+            cache.files.push_back({
+                .path = std::move(file_path),
+                .size = file_header.size,
+                .offset = file_header.offset,
+                .source_offset = file_header.source_offset,
+                .source_size = file_header.source_size,
+                .source_layer = file_header.source_layer,
+                .ips_layer = file_header.ips_layer,
+            });
+        }
+
+        return reader.ReadBytes(cache.header) && reader.ReadBytes(cache.metadata) &&
+               reader.IsAtEnd();
+    };
+    if (!read_payload()) {
+        LOG_WARNING(Loader, "Discarding malformed LayeredFS cache {}",
+                    Common::FS::PathToUTF8String(path));
+        return std::nullopt;
+    }
+    return cache;
+}
+
+void RomFSBuildCache::Save(const std::filesystem::path& path) const {
+    PayloadWriter writer;
+    writer.Write(u32_le{static_cast<u32>(subtrees.size())});
+    for (const auto& [name, fingerprint] : subtrees) {
+        writer.WriteString(name);
+        writer.Write(u64_le{fingerprint});
+    }
+    writer.Write(u32_le{static_cast<u32>(directories.size())});
+    for (const std::string& directory : directories) {
+        writer.WriteString(directory);
+    }
+    writer.Write(u32_le{static_cast<u32>(files.size())});
+    for (const File& file : files) {
+        writer.Write(FileHeader{
+            .size = file.size,
+            .offset = file.offset,
+            .source_offset = file.source_offset,
+            .source_size = file.source_size,
+            .source_layer = file.source_layer,
+            .ips_layer = file.ips_layer,
+            .path_size = static_cast<u32>(file.path.size()),
+        });
+        writer.payload.insert(writer.payload.end(), file.path.begin(), file.path.end());
+    }
+    writer.WriteBytes(header);
+    writer.WriteBytes(metadata);
+
+    const CacheHeader cache_header{
+        .magic = CacheMagic,
+        .version = CacheVersion,
+        .base_identity = base_identity,
+        .num_layers = num_layers,
+        .num_ext_layers = num_ext_layers,
+        .payload_size = writer.payload.size(),
+        .payload_hash = HashPayload(writer.payload),
+    };
+
+    // Write a new cache next to the old one and swap them, so the cache on disk is always whole.
+    if (!Common::FS::CreateDirs(path.parent_path())) {
+        return;
+    }
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        const Common::FS::IOFile file{temp_path, Common::FS::FileAccessMode::Write,
+                                      Common::FS::FileType::BinaryFile};
+        if (!file.IsOpen() || !file.WriteObject(cache_header) ||
+            file.WriteSpan<u8>(writer.payload) != writer.payload.size() || !file.Flush()) {
+            LOG_WARNING(Loader, "Failed to write LayeredFS cache {}",
+                        Common::FS::PathToUTF8String(temp_path));
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        LOG_WARNING(Loader, "Failed to replace LayeredFS cache {}: {}",
+                    Common::FS::PathToUTF8String(path), ec.message());
+    }
+}
+
+} // namespace FileSys
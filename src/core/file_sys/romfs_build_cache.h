@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace FileSys {
+
+enum class ContentRecordType : u8;
+
+/**
+ * On-disk cache of the layout of a RomFS built with LayeredFS: its directories and files, where
+ * the data of every file comes from, and the finished metadata tables and hash buckets.
+ *
+ * The layout is keyed by the identity of the base RomFS, and by a fingerprint of the mods below
+ * each top level entry of the RomFS, so a change to the mods only invalidates the top level
+ * subtrees it touches.
+ */
+struct RomFSBuildCache {
+    /// Layer index of files without an IPS patch.
+    static constexpr u32 NoLayer = 0xFFFFFFFF;
+
+    struct File {
+        std::string path; ///< Path of the file in the RomFS.
+        u64 size;
+        u64 offset;        ///< Offset of the file in the file partition of the RomFS.
+        u64 source_offset; ///< Offset of the file in the base RomFS, for files taken from it.
+        u64 source_size;   ///< Size of the file before its IPS patch.
+        u32 source_layer;  ///< Mod layer the file comes from, or the number of layers for the base.
+        u32 ips_layer;     ///< Ext layer holding the IPS patch of the file, or NoLayer.
+    };
+
+    /// Returns the path of the cache of the RomFS of the given title and content type.
+    static std::filesystem::path GetCachePath(u64 title_id, ContentRecordType type);
+
+    /// Loads the cache stored at the path. Returns nullopt if it is missing or invalid.
+    static std::optional<RomFSBuildCache> Load(const std::filesystem::path& path);
+
+    /// Writes the cache to the path, replacing the previous one.
+    void Save(const std::filesystem::path& path) const;
+
+    u64 base_identity{};
+    u32 num_layers{};
+    u32 num_ext_layers{};
+    /// Fingerprints of the mods below every top level entry, with "" for the files at the root.
+    std::map<std::string, u64> subtrees;
+    std::vector<std::string> directories; ///< Paths of all directories but the root, sorted.
+    std::vector<File> files;              ///< All files, sorted by path.
+    std::vector<u8> header;               ///< Header of the RomFS.
+    std::vector<u8> metadata;             ///< Hash buckets and tables of the RomFS.
+};
+
+} // namespace FileSys
@@ -162,6 +162,10 @@ std::string VfsFile::GetExtension() const {
 
 VfsDirectory::~VfsDirectory() = default;
 
+std::span<const u8> VfsFile::GetView(std::size_t length, std::size_t offset) const {
+    return {};
+}
+
 std::optional<u8> VfsFile::ReadByte(std::size_t offset) const {
     u8 out{};
     const std::size_t size = Read(&out, sizeof(u8), offset);
@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -110,6 +111,16 @@ public:
     // into file. Returns number of bytes successfully written.
     virtual std::size_t Write(const u8* data, std::size_t length, std::size_t offset = 0) = 0;
 
+    // Reads data.size() bytes into data starting at offset into file. Returns number of bytes
+    // successfully read.
+    std::size_t ReadSpan(std::span<u8> data, std::size_t offset = 0) const {
+        return Read(data.data(), data.size(), offset);
+    }
+    // Returns a view of up to length bytes starting at offset into file, if the file holds them in
+    // host memory, or an empty span otherwise. The view stays valid until the file is destroyed,
+    // written to or resized.
+    virtual std::span<const u8> GetView(std::size_t length, std::size_t offset = 0) const;
+
     // Reads exactly one byte at the offset provided, returning std::nullopt on error.
     virtual std::optional<u8> ReadByte(std::size_t offset = 0) const;
     // Reads size bytes starting at offset in file into a vector.
@@ -47,6 +47,7 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    std::span<const u8> GetView(std::size_t length, std::size_t offset) const override;
     bool Rename(std::string_view new_name) override;
 
 private:
@@ -51,6 +51,13 @@ std::size_t OffsetVfsFile::Read(u8* data, std::size_t length, std::size_t r_offs
     return file->Read(data, TrimToFit(length, r_offset), offset + r_offset);
 }
 
+std::span<const u8> OffsetVfsFile::GetView(std::size_t length, std::size_t r_offset) const {
+    if (r_offset >= size) {
+        return {};
+    }
+    return file->GetView(TrimToFit(length, r_offset), offset + r_offset);
+}
+
 std::size_t OffsetVfsFile::Write(const u8* data, std::size_t length, std::size_t r_offset) {
     return file->Write(data, TrimToFit(length, r_offset), offset + r_offset);
 }
@@ -90,6 +97,10 @@ std::size_t OffsetVfsFile::GetOffset() const {
     return offset;
 }
 
+VirtualFile OffsetVfsFile::GetBaseFile() const {
+    return file;
+}
+
 std::size_t OffsetVfsFile::TrimToFit(std::size_t r_size, std::size_t r_offset) const {
     return std::clamp(r_size, std::size_t{0}, size - r_offset);
 }
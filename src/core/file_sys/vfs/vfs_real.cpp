@@ -3,13 +3,18 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <iterator>
 #include <utility>
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/fs/file.h"
 #include "common/fs/fs.h"
+#include "common/fs/mapped_file.h"
 #include "common/fs/path_util.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
 #include "core/file_sys/vfs/vfs.h"
 #include "core/file_sys/vfs/vfs_real.h"
 
@@ -28,10 +33,31 @@ namespace FileSys {
 
 namespace FS = Common::FS;
 
+using namespace Common::Literals;
+
 namespace {
 
 constexpr size_t MaxOpenFiles = 512;
 
+// Read-only files at least this large are mapped when map_real_files is enabled, as long as fewer
+// than MaxMappedFiles are.
+constexpr u64 MinMappedFileSize = 16_MiB;
+constexpr size_t MaxMappedFiles = 64;
+
+// Reads smaller than a block go through the block cache of their file. Blocks read ahead of
+// sequential reads double in size up to MaxReadAheadSize.
+constexpr size_t CacheBlockSize = 64_KiB;
+constexpr size_t MaxReadAheadSize = 1_MiB;
+constexpr size_t NumCacheBlocks = 4;
+
+// Incremented after every write to a host file made through any RealVfsFile, so files can tell
+// that what they cached or mapped may have changed through another file of the same path.
+std::atomic<u64> host_write_generation{};
+
+void NotifyHostWrite() {
+    host_write_generation.fetch_add(1, std::memory_order_release);
+}
+
 constexpr FS::FileAccessMode ModeFlagsToFileAccessMode(OpenMode mode) {
     switch (mode) {
     case OpenMode::Read:
@@ -49,7 +75,18 @@ constexpr FS::FileAccessMode ModeFlagsToFileAccessMode(OpenMode mode) {
 } // Anonymous namespace
 
 RealVfsFilesystem::RealVfsFilesystem() : VfsFilesystem(nullptr) {}
-RealVfsFilesystem::~RealVfsFilesystem() = default;
+
+RealVfsFilesystem::~RealVfsFilesystem() {
+    const auto stats = GetStatistics();
+    if (stats.reads == 0) {
+        return;
+    }
+    LOG_DEBUG(Service_FS,
+              "{} reads: {} mapped, {} cached, {} host reads of {} bytes ({} read ahead) in {} ms",
+              stats.reads, stats.mapped_reads, stats.cache_hits, stats.host_reads,
+              stats.host_read_bytes, stats.read_ahead_bytes,
+              std::chrono::duration_cast<std::chrono::milliseconds>(stats.host_read_time).count());
+}
 
 std::string RealVfsFilesystem::GetName() const {
     return "Real";
@@ -121,6 +158,7 @@ VirtualFile RealVfsFilesystem::CreateFile(std::string_view path_, OpenMode perms
         }
 
         temp.Close();
+        NotifyHostWrite();
 
         return OpenFile(path, perms);
     }
@@ -148,6 +186,7 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
     if (!FS::RenameFile(old_path, new_path)) {
         return nullptr;
     }
+    NotifyHostWrite();
     return OpenFile(new_path, OpenMode::ReadWrite);
 }
 
@@ -233,6 +272,25 @@ void RealVfsFilesystem::DropReference(std::unique_ptr<FileReference>&& reference
     }
 }
 
+void RealVfsFilesystem::RecordHostRead(std::size_t size, std::chrono::nanoseconds duration) {
+    num_host_reads.fetch_add(1, std::memory_order_relaxed);
+    host_read_bytes.fetch_add(size, std::memory_order_relaxed);
+    host_read_time_ns.fetch_add(static_cast<u64>(duration.count()), std::memory_order_relaxed);
+}
+
+RealVfsFilesystem::Statistics RealVfsFilesystem::GetStatistics() const {
+    const auto host_read_time = host_read_time_ns.load(std::memory_order_relaxed);
+    return {
+        .reads = num_reads.load(std::memory_order_relaxed),
+        .mapped_reads = num_mapped_reads.load(std::memory_order_relaxed),
+        .cache_hits = num_cache_hits.load(std::memory_order_relaxed),
+        .host_reads = num_host_reads.load(std::memory_order_relaxed),
+        .host_read_bytes = host_read_bytes.load(std::memory_order_relaxed),
+        .read_ahead_bytes = read_ahead_bytes.load(std::memory_order_relaxed),
+        .host_read_time = std::chrono::nanoseconds{host_read_time},
+    };
+}
+
 void RealVfsFilesystem::EvictSingleReferenceLocked() {
     if (num_open_files < MaxOpenFiles || open_references.empty()) {
         return;
@@ -276,6 +334,10 @@ RealVfsFile::RealVfsFile(RealVfsFilesystem& base_, std::unique_ptr<FileReference
       path_components(FS::SplitPathComponentsCopy(path_)), size(size_), perms(perms_) {}
 
 RealVfsFile::~RealVfsFile() {
+    if (mapping) {
+        mapping.reset();
+        base.num_mapped_files.fetch_sub(1, std::memory_order_relaxed);
+    }
     base.DropReference(std::move(reference));
 }
 
@@ -299,7 +361,11 @@ std::size_t RealVfsFile::GetSize() const {
 bool RealVfsFile::Resize(std::size_t new_size) {
     size.reset();
     auto lk = base.RefreshReference(path, perms, *reference);
-    return reference->file ? reference->file->SetSize(new_size) : false;
+    if (!reference->file || !reference->file->SetSize(new_size)) {
+        return false;
+    }
+    NotifyHostWrite();
+    return true;
 }
 
 VirtualDir RealVfsFile::GetContainingDirectory() const {
@@ -315,11 +381,156 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
-    auto lk = base.RefreshReference(path, perms, *reference);
-    if (!reference->file || !reference->file->Seek(static_cast<s64>(offset))) {
-        return 0;
+    base.num_reads.fetch_add(1, std::memory_order_relaxed);
+
+    if (IsMappingValid()) {
+        // Mapped reads need neither the file handle nor the lock of the filesystem.
+        base.num_mapped_reads.fetch_add(1, std::memory_order_relaxed);
+        if (offset >= mapping->GetSize()) {
+            return 0;
+        }
+        const auto read_size = std::min<std::size_t>(length, mapping->GetSize() - offset);
+        std::memcpy(data, mapping->Data() + offset, read_size);
+        return read_size;
+    }
+
+    if (length < CacheBlockSize && !IsWritable() &&
+        Settings::values.real_file_read_ahead.GetValue()) {
+        return ReadCached(data, length, offset);
+    }
+    return ReadHost(data, length, offset);
+}
+
+std::span<const u8> RealVfsFile::GetView(std::size_t length, std::size_t offset) const {
+    if (!IsMappingValid() || offset >= mapping->GetSize()) {
+        return {};
+    }
+    return {mapping->Data() + offset, std::min<std::size_t>(length, mapping->GetSize() - offset)};
+}
+
+void RealVfsFile::MapIfLarge() const {
+#ifndef ANDROID
+    if (IsWritable() || !Settings::values.map_real_files.GetValue() ||
+        GetSize() < MinMappedFileSize) {
+        return;
+    }
+    if (base.num_mapped_files.fetch_add(1, std::memory_order_relaxed) >= MaxMappedFiles) {
+        base.num_mapped_files.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+    mapping_generation.store(host_write_generation.load(std::memory_order_acquire),
+                             std::memory_order_relaxed);
+    auto new_mapping = std::make_unique<FS::MappedFile>();
+    if (!new_mapping->Open(path, FS::FileAccessMode::Read)) {
+        base.num_mapped_files.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+    mapping = std::move(new_mapping);
+#endif
+}
+
+bool RealVfsFile::IsMappingValid() const {
+    std::call_once(map_once, [this] { MapIfLarge(); });
+    if (!mapping || mapping_stale.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    const u64 generation = host_write_generation.load(std::memory_order_acquire);
+    if (mapping_generation.load(std::memory_order_relaxed) == generation) {
+        return true;
+    }
+
+    // A file was written since the last check, it may have been this one through another handle.
+    // Reading pages of the mapping past the end of a truncated file raises SIGBUS, so stop using
+    // the mapping for good if the file no longer covers it. It is kept until the file is closed,
+    // as other threads may still be reading from it.
+    std::size_t host_size = 0;
+    {
+        auto lk = base.RefreshReference(path, perms, *reference);
+        host_size = reference->file ? reference->file->GetSize() : 0;
+    }
+    if (host_size < mapping->GetSize()) {
+        LOG_WARNING(Service_FS, "Mapped file {} was truncated, reading it from the host", path);
+        mapping_stale.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    mapping_generation.store(generation, std::memory_order_relaxed);
+    return true;
+}
+
+std::size_t RealVfsFile::ReadCached(u8* data, std::size_t length, std::size_t offset) const {
+    std::scoped_lock lk{cache_mutex};
+
+    // Drop the blocks if any file was written since they were read, as it may have been this one.
+    const u64 generation = host_write_generation.load(std::memory_order_acquire);
+    if (cache_generation != generation) {
+        cache_blocks.clear();
+        cache_generation = generation;
+    }
+
+    // Read further ahead while the reads are sequential, and start over after a seek.
+    const bool is_sequential = offset == next_read_offset;
+    read_ahead_size = is_sequential ? std::min(read_ahead_size * 2, MaxReadAheadSize)
+                                    : CacheBlockSize;
+    next_read_offset = offset + length;
+
+    bool is_hit = true;
+    std::size_t total_read = 0;
+    while (total_read < length) {
+        const u64 cur_offset = offset + total_read;
+        auto block = std::ranges::find_if(cache_blocks, [cur_offset](const CacheBlock& b) {
+            return cur_offset >= b.offset && cur_offset < b.offset + b.data.size();
+        });
+
+        if (block == cache_blocks.end()) {
+            is_hit = false;
+            if (cache_blocks.size() < NumCacheBlocks) {
+                block = cache_blocks.emplace(cache_blocks.end());
+            } else {
+                block = std::ranges::min_element(cache_blocks, {}, &CacheBlock::last_use);
+            }
+
+            block->offset =
+                is_sequential ? cur_offset : Common::AlignDown(cur_offset, CacheBlockSize);
+            block->data.resize(read_ahead_size);
+            block->data.resize(ReadHost(block->data.data(), block->data.size(), block->offset));
+
+            const u64 block_end = block->offset + block->data.size();
+            if (block_end <= cur_offset) {
+                // The file ends before the read.
+                block->data.clear();
+                break;
+            }
+            if (block_end > offset + length) {
+                base.read_ahead_bytes.fetch_add(block_end - (offset + length),
+                                                std::memory_order_relaxed);
+            }
+        }
+
+        block->last_use = ++cache_use_counter;
+        const auto block_offset = static_cast<std::size_t>(cur_offset - block->offset);
+        const auto copy_size = std::min(length - total_read, block->data.size() - block_offset);
+        std::memcpy(data + total_read, block->data.data() + block_offset, copy_size);
+        total_read += copy_size;
+    }
+
+    if (is_hit) {
+        base.num_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return total_read;
+}
+
+std::size_t RealVfsFile::ReadHost(u8* data, std::size_t length, std::size_t offset) const {
+    const auto start_time = std::chrono::steady_clock::now();
+    std::size_t read_size = 0;
+    {
+        auto lk = base.RefreshReference(path, perms, *reference);
+        if (!reference->file || !reference->file->Seek(static_cast<s64>(offset))) {
+            return 0;
+        }
+        read_size = reference->file->ReadSpan(std::span{data, length});
     }
-    return reference->file->ReadSpan(std::span{data, length});
+    base.RecordHostRead(read_size, std::chrono::steady_clock::now() - start_time);
+    return read_size;
 }
 
 std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
@@ -328,7 +539,11 @@ std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t o
     if (!reference->file || !reference->file->Seek(static_cast<s64>(offset))) {
         return 0;
     }
-    return reference->file->WriteSpan(std::span{data, length});
+    const auto write_size = reference->file->WriteSpan(std::span{data, length});
+    // Other files of the same path read from the host once notified, so the write must reach it.
+    reference->file->Flush();
+    NotifyHostWrite();
+    return write_size;
 }
 
 bool RealVfsFile::Rename(std::string_view name) {
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <limits>
 #include <map>
 #include <mutex>
 #include <optional>
@@ -13,7 +16,8 @@
 
 namespace Common::FS {
 class IOFile;
-}
+class MappedFile;
+} // namespace Common::FS
 
 namespace FileSys {
 
@@ -26,6 +30,16 @@ class RealVfsDirectory;
 
 class RealVfsFilesystem : public VfsFilesystem {
 public:
+    struct Statistics {
+        u64 reads;            ///< Reads of files opened through the filesystem.
+        u64 mapped_reads;     ///< Reads served from the mapping of their file.
+        u64 cache_hits;       ///< Reads served from the block cache of their file.
+        u64 host_reads;       ///< Reads issued to the host file system.
+        u64 host_read_bytes;  ///< Bytes read from the host file system.
+        u64 read_ahead_bytes; ///< Bytes read from the host past the end of the read needing them.
+        std::chrono::nanoseconds host_read_time;
+    };
+
     RealVfsFilesystem();
     ~RealVfsFilesystem() override;
 
@@ -45,6 +59,8 @@ public:
     VirtualDir MoveDirectory(std::string_view old_path, std::string_view new_path) override;
     bool DeleteDirectory(std::string_view path) override;
 
+    Statistics GetStatistics() const;
+
 private:
     using ReferenceListType = Common::IntrusiveListBaseTraits<FileReference>::ListType;
     std::map<std::string, std::weak_ptr<VfsFile>, std::less<>> cache;
@@ -52,12 +68,22 @@ private:
     ReferenceListType closed_references;
     std::mutex list_lock;
     size_t num_open_files{};
+    std::atomic<size_t> num_mapped_files{};
+
+    std::atomic<u64> num_reads{};
+    std::atomic<u64> num_mapped_reads{};
+    std::atomic<u64> num_cache_hits{};
+    std::atomic<u64> num_host_reads{};
+    std::atomic<u64> host_read_bytes{};
+    std::atomic<u64> read_ahead_bytes{};
+    std::atomic<u64> host_read_time_ns{};
 
 private:
     friend class RealVfsFile;
     std::unique_lock<std::mutex> RefreshReference(const std::string& path, OpenMode perms,
                                                   FileReference& reference);
     void DropReference(std::unique_ptr<FileReference>&& reference);
+    void RecordHostRead(std::size_t size, std::chrono::nanoseconds duration);
 
 private:
     friend class RealVfsDirectory;
@@ -72,6 +98,9 @@ private:
 };
 
 // An implementation of VfsFile that represents a file on the user's computer.
+// Large read-only files can be read through a mapping, and small reads of other read-only files
+// are served from a few cached blocks, read ahead of sequential reads. Both are checked against
+// writes made through other RealVfsFiles, but not against changes made outside of the emulator.
 class RealVfsFile : public VfsFile {
     friend class RealVfsDirectory;
     friend class RealVfsFilesystem;
@@ -87,6 +116,7 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    std::span<const u8> GetView(std::size_t length, std::size_t offset) const override;
     bool Rename(std::string_view name) override;
 
 private:
@@ -94,6 +124,17 @@ private:
                 const std::string& path, OpenMode perms = OpenMode::Read,
                 std::optional<u64> size = {}, std::optional<std::string> parent_path = {});
 
+    struct CacheBlock {
+        std::vector<u8> data;
+        u64 offset{};
+        u64 last_use{};
+    };
+
+    void MapIfLarge() const;
+    bool IsMappingValid() const;
+    std::size_t ReadCached(u8* data, std::size_t length, std::size_t offset) const;
+    std::size_t ReadHost(u8* data, std::size_t length, std::size_t offset) const;
+
     RealVfsFilesystem& base;
     std::unique_ptr<FileReference> reference;
     std::string path;
@@ -101,6 +142,18 @@ private:
     std::vector<std::string> path_components;
     std::optional<u64> size;
     OpenMode perms;
+
+    mutable std::once_flag map_once;
+    mutable std::unique_ptr<Common::FS::MappedFile> mapping;
+    mutable std::atomic<u64> mapping_generation{};
+    mutable std::atomic<bool> mapping_stale{};
+
+    mutable std::mutex cache_mutex;
+    mutable std::vector<CacheBlock> cache_blocks;
+    mutable u64 cache_generation{};
+    mutable u64 cache_use_counter{};
+    mutable u64 next_read_offset{std::numeric_limits<u64>::max()};
+    mutable std::size_t read_ahead_size{};
 };
 
 // An implementation of VfsDirectory that represents a directory on the user's computer.
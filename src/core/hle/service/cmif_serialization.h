@@ -120,6 +120,13 @@ consteval bool ConstIfReference() {
     return ((!std::is_reference_v<Ts> || std::is_const_v<std::remove_reference_t<Ts>>) && ... && true);
 }
 
+// Byte buffers mapped from the guest can be written in place instead of through a scratch buffer.
+template <typename T>
+constexpr bool IsInPlaceOutBuffer = false;
+
+template <typename T, int A>
+constexpr bool IsInPlaceOutBuffer<Buffer<T, A>> = (A & BufferAttr_In) == 0 && (A & BufferAttr_HipcMapAlias) != 0 && (A & BufferAttr_HipcAutoSelect) == 0 && std::is_same_v<T, u8>;
+
 struct RequestLayout {
     u32 copy_handle_count;
     u32 move_handle_count;
@@ -338,8 +345,18 @@ void ReadInArgument(bool is_domain, CallArguments& args, const u8* raw_data, HLE
         } else if constexpr (ArgumentTraits<ArgType>::Type == ArgumentType::OutBuffer) {
             using ElementType = typename ArgType::Type;
 
-            // Set up scratch buffer.
+            // Byte buffers mapped from the guest are written in place when they are contiguous.
             auto& buffer = temp[OutBufferIndex];
+            if constexpr (IsInPlaceOutBuffer<ArgType>) {
+                if (const auto guest_buffer = ctx.GetWriteBufferBSpan(OutBufferIndex); !guest_buffer.empty()) {
+                    buffer.resize_destructive(0);
+                    std::get<ArgIndex>(args) = guest_buffer;
+
+                    return ReadInArgument<MethodArguments, CallArguments, PrevAlign, DataOffset, HandleIndex, InBufferIndex, OutBufferIndex + 1, RawDataFinished, ArgIndex + 1>(is_domain, args, raw_data, ctx, temp);
+                }
+            }
+
+            // Set up scratch buffer.
             if (ctx.CanWriteBuffer(OutBufferIndex)) {
                 buffer.resize_destructive(ctx.GetWriteBufferSize(OutBufferIndex));
             } else {
@@ -415,6 +432,13 @@ void WriteOutArgument(bool is_domain, CallArguments& args, u8* raw_data, HLERequ
             auto& buffer = temp[OutBufferIndex];
             const size_t size = buffer.size();
 
+            if constexpr (IsInPlaceOutBuffer<ArgType>) {
+                // The buffer was written in place.
+                if (size == 0 && !std::get<ArgIndex>(args).empty()) {
+                    ctx.CommitWriteBufferBSpan(std::get<ArgIndex>(args).size(), OutBufferIndex);
+                }
+            }
+
             if (size > 0 && ctx.CanWriteBuffer(OutBufferIndex)) {
                 if constexpr (ArgType::Attr & BufferAttr_HipcAutoSelect) {
                     ctx.WriteBuffer(buffer.data(), size, OutBufferIndex);
@@ -433,6 +433,37 @@ std::size_t HLERequestContext::WriteBufferB(const void* buffer, std::size_t size
     return size;
 }
 
+std::span<u8> HLERequestContext::GetWriteBufferBSpan(std::size_t buffer_index) const {
+    if (buffer_index >= BufferDescriptorB().size()) {
+        return {};
+    }
+
+    const auto& descriptor{BufferDescriptorB()[buffer_index]};
+    if (descriptor.Size() == 0) {
+        return {};
+    }
+    u8* const host_ptr{memory.GetSpan(descriptor.Address(), descriptor.Size())};
+    if (host_ptr == nullptr) {
+        return {};
+    }
+
+    // Invalidate the buffer in the rasterizer before it is written, as WriteBlock does.
+    if (R_FAILED(memory.StoreDataCache(descriptor.Address(), descriptor.Size()))) {
+        return {};
+    }
+    return {host_ptr, descriptor.Size()};
+}
+
+void HLERequestContext::CommitWriteBufferBSpan(std::size_t size, std::size_t buffer_index) const {
+    if (buffer_index >= BufferDescriptorB().size() || size == 0) {
+        return;
+    }
+
+    // The range was mapped when the span was returned, so storing it cannot fail.
+    const auto& descriptor{BufferDescriptorB()[buffer_index]};
+    R_ASSERT(memory.StoreDataCache(descriptor.Address(), std::min(size, descriptor.Size())));
+}
+
 std::size_t HLERequestContext::WriteBufferC(const void* buffer, std::size_t size,
                                             std::size_t buffer_index) const {
     if (buffer_index >= BufferDescriptorC().size() || size == 0) {
@@ -277,6 +277,17 @@ public:
     std::size_t WriteBufferB(const void* buffer, std::size_t size,
                              std::size_t buffer_index = 0) const;
 
+    /**
+     * Returns the guest memory of buffer B, if it is contiguous in host memory, so it can be
+     * written in place. Otherwise, returns an empty span. The buffer is invalidated in the
+     * rasterizer before it is returned, and the writes must be committed with
+     * CommitWriteBufferBSpan.
+     */
+    [[nodiscard]] std::span<u8> GetWriteBufferBSpan(std::size_t buffer_index = 0) const;
+
+    /// Notifies the rasterizer of the first size bytes written in place to buffer B
+    void CommitWriteBufferBSpan(std::size_t size, std::size_t buffer_index = 0) const;
+
     /// Helper function to write buffer C
     std::size_t WriteBufferC(const void* buffer, std::size_t size,
                              std::size_t buffer_index = 0) const;
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2018 yuzu Emulator Project & 2024 suyu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 #include <vector>
@@ -11,7 +12,9 @@
 #include "common/lz4_compression.h"
 #include "common/settings.h"
 #include "common/swap.h"
+#include "common/task_scheduler.h"
 #include "core/core.h"
+#include "core/crypto/sha256_engine.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/hle/kernel/code_set.h"
 #include "core/hle/kernel/k_page_table.h"
@@ -48,6 +51,50 @@ std::vector<u8> DecompressSegment(const std::vector<u8>& compressed_data,
     return uncompressed_data;
 }
 
+/// Decompresses a segment read into the image and verifies its hash.
+void DecodeSegment(NSOImage& image, size_t segment_num, bool verify_hash,
+                   const std::string& name) {
+    const NSOHeader& header = image.header;
+    std::vector<u8>& data = image.segments[segment_num];
+    if (header.IsSegmentCompressed(segment_num)) {
+        data = DecompressSegment(data, header.segments[segment_num]);
+    }
+
+    if (verify_hash && header.IsSegmentHashChecked(segment_num)) {
+        const size_t size = std::min<size_t>(data.size(), header.segments[segment_num].size);
+        if (Core::Crypto::Sha256::Compute(std::span{data}.first(size)) !=
+            header.segment_hashes[segment_num]) {
+            LOG_ERROR(Loader, "Hash mismatch in segment {} of module {}", segment_num, name);
+        }
+    }
+}
+
+/// Reads the header and segments of an NSO file, and queues decoding the segments.
+bool ReadImage(NSOImage& image, const FileSys::VfsFile& nso_file, Common::TaskQueue& queue,
+               bool verify_hashes) {
+    if (nso_file.GetSize() < sizeof(NSOHeader)) {
+        return false;
+    }
+
+    if (sizeof(NSOHeader) != nso_file.ReadObject(&image.header)) {
+        return false;
+    }
+
+    if (image.header.magic != Common::MakeMagic('N', 'S', 'O', '0')) {
+        return false;
+    }
+
+    // Files are read on this thread, only the segments are decoded concurrently.
+    for (size_t i = 0; i < image.segments.size(); ++i) {
+        image.segments[i] = nso_file.ReadBytes(image.header.segments_compressed_size[i],
+                                               image.header.segments[i].offset);
+        queue.QueueWork([&image, i, verify_hashes, name = nso_file.GetName()] {
+            DecodeSegment(image, i, verify_hashes, name);
+        });
+    }
+    return true;
+}
+
 constexpr u32 PageAlignSize(u32 size) {
     return static_cast<u32>((size + Core::Memory::SUYU_PAGEMASK) & ~Core::Memory::SUYU_PAGEMASK);
 }
@@ -58,6 +105,11 @@ bool NSOHeader::IsSegmentCompressed(size_t segment_num) const {
     return ((flags >> segment_num) & 1) != 0;
 }
 
+bool NSOHeader::IsSegmentHashChecked(size_t segment_num) const {
+    ASSERT_MSG(segment_num < 3, "Invalid segment {}", segment_num);
+    return ((flags >> (segment_num + 3)) & 1) != 0;
+}
+
 AppLoader_NSO::AppLoader_NSO(FileSys::VirtualFile file_) : AppLoader(std::move(file_)) {}
 
 FileType AppLoader_NSO::IdentifyType(const FileSys::VirtualFile& in_file) {
@@ -79,18 +131,31 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::
                                                std::optional<FileSys::PatchManager> pm,
                                                std::vector<Core::NCE::Patcher>* patches,
                                                s32 patch_index) {
-    if (nso_file.GetSize() < sizeof(NSOHeader)) {
-        return std::nullopt;
+    NSOImage image{};
+    {
+        Common::TaskQueue queue{Common::TaskPriority::FrameCritical,
+                                Common::TaskScheduler::Instance().NumWorkers()};
+        const bool is_valid = ReadImage(image, nso_file, queue,
+                                        Settings::values.verify_content_integrity.GetValue());
+        queue.WaitForRequests();
+        if (!is_valid) {
+            return std::nullopt;
+        }
     }
 
-    NSOHeader nso_header{};
-    if (sizeof(NSOHeader) != nso_file.ReadObject(&nso_header)) {
-        return std::nullopt;
-    }
+    return LoadModule(process, system, image, nso_file.GetName(), load_base,
+                      should_pass_arguments, load_into_process, std::move(pm), patches,
+                      patch_index);
+}
 
-    if (nso_header.magic != Common::MakeMagic('N', 'S', 'O', '0')) {
-        return std::nullopt;
-    }
+std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::System& system,
+                                               const NSOImage& image, const std::string& name,
+                                               VAddr load_base, bool should_pass_arguments,
+                                               bool load_into_process,
+                                               std::optional<FileSys::PatchManager> pm,
+                                               std::vector<Core::NCE::Patcher>* patches,
+                                               s32 patch_index) {
+    const NSOHeader& nso_header = image.header;
 
     // Allocate some space at the beginning if we are patching in PreText mode.
     const size_t module_start = [&]() -> size_t {
@@ -109,11 +174,7 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::
     Kernel::CodeSet codeset;
     Kernel::PhysicalMemory program_image;
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
-        std::vector<u8> data = nso_file.ReadBytes(nso_header.segments_compressed_size[i],
-                                                  nso_header.segments[i].offset);
-        if (nso_header.IsSegmentCompressed(i)) {
-            data = DecompressSegment(data, nso_header.segments[i]);
-        }
+        const std::vector<u8>& data = image.segments[i];
         program_image.resize(module_start + nso_header.segments[i].location +
                              static_cast<u32>(data.size()));
         std::memcpy(program_image.data() + module_start + nso_header.segments[i].location,
@@ -147,7 +208,6 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::
     }
 
     // Apply patches if necessary
-    const auto name = nso_file.GetName();
     if (pm && (pm->HasNSOPatch(nso_header.build_id, name) || Settings::values.dump_nso)) {
         std::span<u8> patchable_section(program_image.data() + module_start,
                                         program_image.size() - module_start);
@@ -227,6 +287,26 @@ AppLoader_NSO::LoadResult AppLoader_NSO::Load(Kernel::KProcess& process, Core::S
                                                   Core::Memory::DEFAULT_STACK_SIZE}};
 }
 
+std::vector<std::optional<NSOImage>> AppLoader_NSO::ReadImages(
+    std::span<const FileSys::VirtualFile> files) {
+    std::vector<std::optional<NSOImage>> images(files.size());
+    const bool verify_hashes = Settings::values.verify_content_integrity.GetValue();
+
+    Common::TaskQueue queue{Common::TaskPriority::FrameCritical,
+                            Common::TaskScheduler::Instance().NumWorkers()};
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (files[i] == nullptr) {
+            continue;
+        }
+        if (!ReadImage(images[i].emplace(), *files[i], queue, verify_hashes)) {
+            images[i].reset();
+        }
+    }
+    queue.WaitForRequests();
+
+    return images;
+}
+
 ResultStatus AppLoader_NSO::ReadNSOModules(Modules& out_modules) {
     out_modules = this->modules;
     return ResultStatus::Success;
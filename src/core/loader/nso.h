@@ -5,7 +5,10 @@
 
 #include <array>
 #include <optional>
+#include <span>
+#include <string>
 #include <type_traits>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/file_sys/patch_manager.h"
@@ -58,6 +61,7 @@ struct NSOHeader {
     std::array<SHA256Hash, 3> segment_hashes;
 
     bool IsSegmentCompressed(size_t segment_num) const;
+    bool IsSegmentHashChecked(size_t segment_num) const;
 };
 static_assert(sizeof(NSOHeader) == 0x100, "NSOHeader has incorrect size.");
 static_assert(std::is_trivially_copyable_v<NSOHeader>, "NSOHeader must be trivially copyable.");
@@ -71,6 +75,12 @@ struct NSOArgumentHeader {
 };
 static_assert(sizeof(NSOArgumentHeader) == 0x20, "NSOArgumentHeader has incorrect size.");
 
+/// Header and decompressed segments of an NSO file, ready to be laid out and mapped.
+struct NSOImage {
+    NSOHeader header;
+    std::array<std::vector<u8>, 3> segments;
+};
+
 /// Loads an NSO file
 class AppLoader_NSO final : public AppLoader {
 public:
@@ -96,6 +106,26 @@ public:
                                            std::vector<Core::NCE::Patcher>* patches = nullptr,
                                            s32 patch_index = -1);
 
+    static std::optional<VAddr> LoadModule(Kernel::KProcess& process, Core::System& system,
+                                           const NSOImage& image, const std::string& name,
+                                           VAddr load_base, bool should_pass_arguments,
+                                           bool load_into_process,
+                                           std::optional<FileSys::PatchManager> pm = {},
+                                           std::vector<Core::NCE::Patcher>* patches = nullptr,
+                                           s32 patch_index = -1);
+
+    /**
+     * Reads NSO files and decompresses their segments, those of all files concurrently. The
+     * segments are verified against the hashes in their headers if content integrity
+     * verification is enabled.
+     *
+     * @param files The files to read, may contain null entries.
+     *
+     * @return The image of each file, or std::nullopt for null entries and invalid files.
+     */
+    static std::vector<std::optional<NSOImage>> ReadImages(
+        std::span<const FileSys::VirtualFile> files);
+
     LoadResult Load(Kernel::KProcess& process, Core::System& system) override;
 
     ResultStatus ReadNSOModules(Modules& out_modules) override;
@@ -1,12 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2018 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <optional>
 #include <vector>
 
 #include "common/common_types.h"
 #include "core/core.h"
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/content_archive.h"
+#include "core/file_sys/content_verifier.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
@@ -93,31 +95,25 @@ ResultStatus AppLoader_XCI::VerifyIntegrity(std::function<bool(size_t, size_t)>
     // Get list of all NCAs.
     const auto ncas = secure_partition->GetNCAsCollapsed();
 
-    size_t total_size = 0;
-    size_t processed_size = 0;
-
-    // Loop over NCAs, collecting the total size to verify.
+    // Verify all NCAs concurrently, stopping at the first one that fails.
+    std::optional<ResultStatus> failure;
+    FileSys::ContentVerifier verifier{
+        [&](size_t total_size, size_t processed_size) {
+            return failure.has_value() || !progress_callback(processed_size, total_size);
+        },
+        [&](const FileSys::VirtualFile&, ResultStatus status) {
+            if (status != ResultStatus::Success && !failure) {
+                failure = status;
+            }
+        }};
     for (const auto& nca : ncas) {
-        total_size += nca->GetBaseFile()->GetSize();
+        verifier.Queue(nca->GetBaseFile());
     }
 
-    // Loop over NCAs again, verifying each.
-    for (const auto& nca : ncas) {
-        AppLoader_NCA loader_nca(nca->GetBaseFile());
-
-        const auto NcaProgressCallback = [&](size_t nca_processed_size, size_t nca_total_size) {
-            return progress_callback(processed_size + nca_processed_size, total_size);
-        };
-
-        const auto verification_result = loader_nca.VerifyIntegrity(NcaProgressCallback);
-        if (verification_result != ResultStatus::Success) {
-            return verification_result;
-        }
-
-        processed_size += nca->GetBaseFile()->GetSize();
+    if (!verifier.Run() && !failure) {
+        return ResultStatus::ErrorIntegrityVerificationFailed;
     }
-
-    return ResultStatus::Success;
+    return failure.value_or(ResultStatus::Success);
 }
 
 ResultStatus AppLoader_XCI::ReadRomFS(FileSys::VirtualFile& out_file) {
@@ -63,6 +63,11 @@ struct Memory::Impl {
 #endif
     }
 
+    void SetCurrentPageTable(Common::PageTable& page_table) {
+        current_page_table = &page_table;
+        current_page_table->fastmem_arena = nullptr;
+    }
+
     void MapMemoryRegion(Common::PageTable& page_table, Common::ProcessAddress base, u64 size,
                          Common::PhysicalAddress target, Common::MemoryPermission perms,
                          bool separate_heap) {
@@ -257,8 +262,12 @@ struct Memory::Impl {
         }
 
         while (remaining_size) {
+            // Handle every run of pages backed by contiguous memory in a single step, so large
+            // blocks are copied at once instead of page by page.
+            const std::size_t max_pages = ((page_offset + remaining_size - 1) >> SUYU_PAGEBITS) + 1;
+            const std::size_t num_pages = page_table.GetContiguousPageCount(page_index, max_pages);
             const std::size_t copy_amount =
-                std::min(static_cast<std::size_t>(SUYU_PAGESIZE) - page_offset, remaining_size);
+                std::min((num_pages << SUYU_PAGEBITS) - page_offset, remaining_size);
             const auto current_vaddr =
                 static_cast<u64>((page_index << SUYU_PAGEBITS) + page_offset);
 
@@ -289,7 +298,7 @@ struct Memory::Impl {
                 UNREACHABLE();
             }
 
-            page_index++;
+            page_index += num_pages;
             page_offset = 0;
             increment(copy_amount);
             remaining_size -= copy_amount;
@@ -799,27 +808,59 @@ struct Memory::Impl {
         return true;
     }
 
+    /**
+     * Calls func with the ranges of device memory backing a block of rasterizer cached memory.
+     * Pages that follow each other in device memory are merged, so the rasterizer is only called
+     * once for a block that is contiguous on both sides.
+     */
+    template <typename Func>
+    void ForEachDeviceRange(VAddr v_address, size_t size, Common::ScratchBuffer<u32>& scratch,
+                            Func&& func) {
+        DAddr range_begin{};
+        DAddr range_end{};
+        const VAddr end_address = v_address + size;
+        while (v_address < end_address) {
+            const VAddr page_end =
+                std::min((v_address & ~SUYU_PAGEMASK) + SUYU_PAGESIZE, end_address);
+            const size_t chunk_size = page_end - v_address;
+            const auto* p = GetPointerImpl(
+                v_address, []() {}, []() {});
+            gpu_device_memory->ApplyOpOnPointer(p, scratch, [&](DAddr address) {
+                if (range_end != range_begin && range_end == address) {
+                    range_end += chunk_size;
+                    return;
+                }
+                if (range_end != range_begin) {
+                    func(range_begin, range_end - range_begin);
+                }
+                range_begin = address;
+                range_end = address + chunk_size;
+            });
+            v_address = page_end;
+        }
+        if (range_end != range_begin) {
+            func(range_begin, range_end - range_begin);
+        }
+    }
+
     void HandleRasterizerDownload(VAddr v_address, size_t size) {
-        const auto* p = GetPointerImpl(
-            v_address, []() {}, []() {});
         if (!gpu_device_memory) [[unlikely]] {
             gpu_device_memory = &system.Host1x().MemoryManager();
         }
         const size_t core = system.GetCurrentHostThreadID();
         auto& current_area = rasterizer_read_areas[core];
-        gpu_device_memory->ApplyOpOnPointer(p, scratch_buffers[core], [&](DAddr address) {
-            const DAddr end_address = address + size;
-            if (current_area.start_address <= address && end_address <= current_area.end_address)
-                [[likely]] {
-                return;
-            }
-            current_area = system.GPU().OnCPURead(address, size);
-        });
+        ForEachDeviceRange(
+            v_address, size, scratch_buffers[core], [&](DAddr address, size_t range_size) {
+                const DAddr end_address = address + range_size;
+                if (current_area.start_address <= address &&
+                    end_address <= current_area.end_address) [[likely]] {
+                    return;
+                }
+                current_area = system.GPU().OnCPURead(address, range_size);
+            });
     }
 
     void HandleRasterizerWrite(VAddr v_address, size_t size) {
-        const auto* p = GetPointerImpl(
-            v_address, []() {}, []() {});
         constexpr size_t sys_core = Core::Hardware::NUM_CPU_CORES - 1;
         const size_t core = std::min(system.GetCurrentHostThreadID(),
                                      sys_core); // any other calls threads go to syscore.
@@ -835,19 +876,30 @@ struct Memory::Impl {
                 sys_core_guard.unlock();
             }
         };
-        gpu_device_memory->ApplyOpOnPointer(p, scratch_buffers[core], [&](DAddr address) {
-            auto& current_area = rasterizer_write_areas[core];
-            PAddr subaddress = address >> SUYU_PAGEBITS;
-            bool do_collection = current_area.last_address == subaddress;
-            if (!do_collection) [[unlikely]] {
-                do_collection = system.GPU().OnCPUWrite(address, size);
-                if (!do_collection) {
-                    return;
+        ForEachDeviceRange(
+            v_address, size, scratch_buffers[core], [&](DAddr address, size_t range_size) {
+                auto& current_area = rasterizer_write_areas[core];
+                const DAddr end_address = address + range_size;
+                const PAddr subaddress = address >> SUYU_PAGEBITS;
+                const bool single_page = ((end_address - 1) >> SUYU_PAGEBITS) == subaddress;
+                bool do_collection = single_page && current_area.last_address == subaddress;
+                if (!do_collection) [[unlikely]] {
+                    do_collection = system.GPU().OnCPUWrite(address, range_size);
+                    if (!do_collection) {
+                        return;
+                    }
+                    if (single_page) {
+                        current_area.last_address = subaddress;
+                    }
                 }
-                current_area.last_address = subaddress;
-            }
-            gpu_dirty_managers[core].Collect(address, size);
-        });
+                // The dirty managers track memory one page at a time.
+                while (address < end_address) {
+                    const DAddr page_end =
+                        std::min((address & ~SUYU_PAGEMASK) + SUYU_PAGESIZE, end_address);
+                    gpu_dirty_managers[core].Collect(address, page_end - address);
+                    address = page_end;
+                }
+            });
     }
 
     struct GPUDirtyState {
@@ -907,6 +959,10 @@ void Memory::SetCurrentPageTable(Kernel::KProcess& process) {
     impl->SetCurrentPageTable(process);
 }
 
+void Memory::SetCurrentPageTable(Common::PageTable& page_table) {
+    impl->SetCurrentPageTable(page_table);
+}
+
 void Memory::MapMemoryRegion(Common::PageTable& page_table, Common::ProcessAddress base, u64 size,
                              Common::PhysicalAddress target, Common::MemoryPermission perms,
                              bool separate_heap) {
@@ -75,6 +75,7 @@ void PerfStats::EndSystemFrame() {
 
 void PerfStats::EndGameFrame() {
     game_frames.fetch_add(1, std::memory_order_relaxed);
+    total_game_frames.fetch_add(1, std::memory_order_relaxed);
 }
 
 double PerfStats::GetMeanFrametime() const {
@@ -125,6 +126,63 @@ double PerfStats::GetLastFrameTimeScale() const {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
+PerfStats::FrametimeHistogram PerfStats::GetFrametimeHistogram() const {
+    std::scoped_lock lock{object_mutex};
+
+    FrametimeHistogram histogram{};
+    if (current_index <= IgnoreFrames) {
+        return histogram;
+    }
+    for (std::size_t i = IgnoreFrames; i < current_index; ++i) {
+        const auto bucket = std::ranges::lower_bound(FrametimeHistogramBounds, perf_history[i]);
+        ++histogram[std::distance(FrametimeHistogramBounds.begin(), bucket)];
+    }
+    return histogram;
+}
+
+u64 PerfStats::GetTotalGameFrames() const {
+    return total_game_frames.load(std::memory_order_relaxed);
+}
+
+void PerfStats::AddCoreTime(std::size_t core, Clock::duration duration) {
+    core_time[core].fetch_add(duration.count(), std::memory_order_relaxed);
+}
+
+void PerfStats::AddGpuThreadTime(Clock::duration duration) {
+    gpu_thread_time.fetch_add(duration.count(), std::memory_order_relaxed);
+}
+
+void PerfStats::AddGpuQueueSample(Clock::duration latency, u64 depth) {
+    // The GPU thread is the only writer, the maximums do not need a compare-exchange loop
+    gpu_queue_commands.fetch_add(1, std::memory_order_relaxed);
+    gpu_queue_latency.fetch_add(latency.count(), std::memory_order_relaxed);
+    gpu_queue_depth.fetch_add(depth, std::memory_order_relaxed);
+    if (latency.count() > gpu_queue_max_latency.load(std::memory_order_relaxed)) {
+        gpu_queue_max_latency.store(latency.count(), std::memory_order_relaxed);
+    }
+    if (depth > gpu_queue_max_depth.load(std::memory_order_relaxed)) {
+        gpu_queue_max_depth.store(depth, std::memory_order_relaxed);
+    }
+}
+
+PerfStats::Clock::duration PerfStats::GetCoreTime(std::size_t core) const {
+    return Clock::duration{core_time[core].load(std::memory_order_relaxed)};
+}
+
+PerfStats::Clock::duration PerfStats::GetGpuThreadTime() const {
+    return Clock::duration{gpu_thread_time.load(std::memory_order_relaxed)};
+}
+
+GpuQueueStats PerfStats::GetGpuQueueStats() const {
+    return GpuQueueStats{
+        .commands = gpu_queue_commands.load(std::memory_order_relaxed),
+        .latency = Clock::duration{gpu_queue_latency.load(std::memory_order_relaxed)},
+        .max_latency = Clock::duration{gpu_queue_max_latency.load(std::memory_order_relaxed)},
+        .depth = gpu_queue_depth.load(std::memory_order_relaxed),
+        .max_depth = gpu_queue_max_depth.load(std::memory_order_relaxed),
+    };
+}
+
 void SpeedLimiter::DoSpeedLimiting(microseconds current_system_time_us) {
     if (Settings::values.use_multi_core.GetValue() ||
         !Settings::values.use_speed_limit.GetValue()) {
@@ -9,9 +9,24 @@
 #include <cstddef>
 #include <mutex>
 #include "common/common_types.h"
+#include "core/hardware_properties.h"
 
 namespace Core {
 
+/// Statistics of the commands handed to the GPU thread.
+struct GpuQueueStats {
+    /// Number of commands consumed by the GPU thread
+    u64 commands;
+    /// Cumulative walltime between the submission and the consumption of the commands
+    std::chrono::steady_clock::duration latency;
+    /// Longest walltime between the submission and the consumption of a command
+    std::chrono::steady_clock::duration max_latency;
+    /// Cumulative number of commands queued when a command was consumed, including itself
+    u64 depth;
+    /// Largest number of commands queued when a command was consumed
+    u64 max_depth;
+};
+
 struct PerfStatsResults {
     /// System FPS (LCD VBlanks) in Hz
     double system_fps;
@@ -51,6 +66,45 @@ public:
      */
     double GetLastFrameTimeScale() const;
 
+    /// Upper bounds, in milliseconds, of the frametime histogram buckets. The last bucket holds
+    /// every frame slower than the last bound.
+    static constexpr std::array<double, 10> FrametimeHistogramBounds{
+        4.0, 8.0, 12.0, 16.7, 20.0, 25.0, 33.4, 50.0, 66.7, 100.0,
+    };
+    using FrametimeHistogram = std::array<u32, FrametimeHistogramBounds.size() + 1>;
+
+    /**
+     * Returns the number of frames in the performance history falling into each bucket of
+     * FrametimeHistogramBounds.
+     */
+    FrametimeHistogram GetFrametimeHistogram() const;
+
+    /// Returns the number of game frames presented since the counters were created, this is
+    /// not affected by GetAndResetStats.
+    u64 GetTotalGameFrames() const;
+
+    /// Accounts walltime spent executing guest code on the given emulated CPU core.
+    void AddCoreTime(std::size_t core, Clock::duration duration);
+
+    /// Accounts walltime spent processing commands on the GPU thread.
+    void AddGpuThreadTime(Clock::duration duration);
+
+    /**
+     * Accounts a command consumed by the GPU thread, with the walltime it spent in the command
+     * queue and the number of queued commands, including itself. Must only be called from the GPU
+     * thread.
+     */
+    void AddGpuQueueSample(Clock::duration latency, u64 depth);
+
+    /// Returns the walltime spent executing guest code on the given emulated CPU core.
+    Clock::duration GetCoreTime(std::size_t core) const;
+
+    /// Returns the walltime spent processing commands on the GPU thread.
+    Clock::duration GetGpuThreadTime() const;
+
+    /// Returns the statistics of the commands handed to the GPU thread.
+    GpuQueueStats GetGpuQueueStats() const;
+
 private:
     mutable std::mutex object_mutex;
 
@@ -73,6 +127,19 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     std::atomic<u32> game_frames = 0;
+    /// Number of game frames since the counters were created
+    std::atomic<u64> total_game_frames = 0;
+
+    /// Walltime, in clock ticks, spent in guest code by each emulated CPU core
+    std::array<std::atomic<Clock::rep>, Hardware::NUM_CPU_CORES> core_time{};
+    /// Walltime, in clock ticks, spent processing commands on the GPU thread
+    std::atomic<Clock::rep> gpu_thread_time = 0;
+    /// Commands consumed by the GPU thread, and their queue latency in clock ticks and depth
+    std::atomic<u64> gpu_queue_commands = 0;
+    std::atomic<Clock::rep> gpu_queue_latency = 0;
+    std::atomic<Clock::rep> gpu_queue_max_latency = 0;
+    std::atomic<u64> gpu_queue_depth = 0;
+    std::atomic<u64> gpu_queue_max_depth = 0;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
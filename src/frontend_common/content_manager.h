@@ -3,13 +3,18 @@
 
 #pragma once
 
+#include <filesystem>
+
 #include <boost/algorithm/string.hpp>
 #include "common/common_types.h"
 #include "common/literals.h"
+#include "common/settings.h"
 #include "core/core.h"
 #include "core/file_sys/common_funcs.h"
 #include "core/file_sys/content_archive.h"
+#include "core/file_sys/content_verifier.h"
 #include "core/file_sys/fs_filesystem.h"
+#include "core/file_sys/install_pipeline.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
@@ -127,36 +132,21 @@ inline bool RemoveMod(const Service::FileSystem::FileSystemController& fs_contro
  * \param system Reference to the system instance
  * \param vfs Reference to the VfsFilesystem instance in Core::System
  * \param filename Path to the NSP file
- * \param callback Callback to report the progress of the installation. The first size_t
- * parameter is the total size of the virtual file and the second is the current progress. If you
- * return true to the callback, it will cancel the installation as soon as possible.
+ * \param callback Callback to report the progress of the installation, called on the calling
+ * thread. The parameters are the total size of the NCAs in the NSP, the size installed so far and
+ * the current install speed in bytes per second. If you return true to the callback, it will
+ * cancel the installation as soon as possible.
  * \return [InstallResult] representing how the installation finished
  */
 inline InstallResult InstallNSP(Core::System& system, FileSys::VfsFilesystem& vfs,
                                 const std::string& filename,
-                                const std::function<bool(size_t, size_t)>& callback) {
-    const auto copy = [callback](const FileSys::VirtualFile& src, const FileSys::VirtualFile& dest,
-                                 std::size_t block_size) {
-        if (src == nullptr || dest == nullptr) {
-            return false;
-        }
-        if (!dest->Resize(src->GetSize())) {
-            return false;
-        }
-
-        using namespace Common::Literals;
-        std::vector<u8> buffer(1_MiB);
-
-        for (std::size_t i = 0; i < src->GetSize(); i += buffer.size()) {
-            if (callback(src->GetSize(), i)) {
-                dest->Resize(0);
-                return false;
-            }
-            const auto read = src->Read(buffer.data(), buffer.size(), i);
-            dest->Write(buffer.data(), read, i);
-        }
-        return true;
-    };
+                                const std::function<bool(size_t, size_t, size_t)>& callback) {
+    FileSys::InstallPipeline pipeline{
+        [&callback](const FileSys::InstallProgress& progress) {
+            return callback(progress.total_size, progress.installed_size,
+                            progress.bytes_per_second);
+        },
+        Settings::values.verify_content_integrity.GetValue()};
 
     std::shared_ptr<FileSys::NSP> nsp;
     FileSys::VirtualFile file = vfs.OpenFile(filename, FileSys::OpenMode::Read);
@@ -173,7 +163,7 @@ inline InstallResult InstallNSP(Core::System& system, FileSys::VfsFilesystem& vf
         return InstallResult::Failure;
     }
     const auto res =
-        system.GetFileSystemController().GetUserNANDContents()->InstallEntry(*nsp, true, copy);
+        system.GetFileSystemController().GetUserNANDContents()->InstallEntry(*nsp, true, pipeline);
     switch (res) {
     case FileSys::InstallResult::Success:
         return InstallResult::Success;
@@ -244,6 +234,23 @@ inline InstallResult InstallNCA(FileSys::VfsFilesystem& vfs, const std::string&
     }
 }
 
+/**
+ * \brief Returns the path of the record of an interrupted VerifyInstalledContents
+ * \param firmware_only Whether the verification only scanned system nand NCAs (firmware)
+ */
+inline std::filesystem::path GetVerificationRecordPath(bool firmware_only) {
+    return FileSys::ContentVerificationRecord::GetRecordPath(firmware_only ? "firmware"
+                                                                           : "installed_contents");
+}
+
+/**
+ * \brief Returns whether a cancelled VerifyInstalledContents can be resumed
+ * \param firmware_only Whether the verification only scanned system nand NCAs (firmware)
+ */
+inline bool CanResumeVerification(bool firmware_only = false) {
+    return !FileSys::ContentVerificationRecord{GetVerificationRecordPath(firmware_only)}.IsEmpty();
+}
+
 /**
  * \brief Verifies the installed contents for a given ManualContentProvider
  * \param system Reference to the system instance
@@ -252,11 +259,14 @@ inline InstallResult InstallNCA(FileSys::VfsFilesystem& vfs, const std::string&
  * parameter is the total size of the installed contents and the second is the current progress. If
  * you return true to the callback, it will cancel the installation as soon as possible.
  * \param firmware_only Set to true to only scan system nand NCAs (firmware), post firmware install.
+ * \param resume Set to true to skip the NCAs a cancelled verification already found intact.
+ * \param failed_callback Callback receiving each entry that failed to verify as soon as it does.
  * \return A list of entries that failed to install. Returns an empty vector if successful.
  */
 inline std::vector<std::string> VerifyInstalledContents(
     Core::System& system, FileSys::ManualContentProvider& provider,
-    const std::function<bool(size_t, size_t)>& callback, bool firmware_only = false) {
+    const std::function<bool(size_t, size_t)>& callback, bool firmware_only = false,
+    bool resume = false, const std::function<void(const std::string&)>& failed_callback = {}) {
     // Get content registries.
     auto bis_contents = system.GetFileSystemController().GetSystemNANDContents();
     auto user_contents = system.GetFileSystemController().GetUserNANDContents();
@@ -269,68 +279,59 @@ inline std::vector<std::string> VerifyInstalledContents(
         content_providers.push_back(user_contents);
     }
 
-    // Get associated NCA files.
-    std::vector<FileSys::VirtualFile> nca_files;
-
-    // Get all installed IDs.
-    size_t total_size = 0;
-    for (auto nca_provider : content_providers) {
-        const auto entries = nca_provider->ListEntriesFilter();
-
-        for (const auto& entry : entries) {
-            auto nca_file = nca_provider->GetEntryRaw(entry.title_id, entry.type);
-            if (!nca_file) {
-                continue;
-            }
-
-            total_size += nca_file->GetSize();
-            nca_files.push_back(std::move(nca_file));
-        }
+    // NCAs a cancelled verification found intact are remembered, so it can be resumed.
+    FileSys::ContentVerificationRecord record{GetVerificationRecordPath(firmware_only)};
+    if (!resume) {
+        record.Clear();
     }
 
     // Declare a list of file names which failed to verify.
     std::vector<std::string> failed;
 
-    size_t processed_size = 0;
-    bool cancelled = false;
-    auto nca_callback = [&](size_t nca_processed, size_t nca_total) {
-        cancelled = callback(total_size, processed_size + nca_processed);
-        return !cancelled;
-    };
+    const auto result_callback = [&](const FileSys::VirtualFile& nca_file,
+                                     Loader::ResultStatus status) {
+        if (status == Loader::ResultStatus::Success) {
+            return;
+        }
 
-    // Using the NCA loader, determine if all NCAs are valid.
-    for (auto& nca_file : nca_files) {
-        Loader::AppLoader_NCA nca_loader(nca_file);
+        FileSys::NCA nca(nca_file);
+        const auto title_id = nca.GetTitleId();
+        std::string title_name = "unknown";
+
+        const auto control = provider.GetEntry(FileSys::GetBaseTitleID(title_id),
+                                               FileSys::ContentRecordType::Control);
+        if (control && control->GetStatus() == Loader::ResultStatus::Success) {
+            const FileSys::PatchManager pm{title_id, system.GetFileSystemController(), provider};
+            const auto [nacp, logo] = pm.ParseControlNCA(*control);
+            if (nacp) {
+                title_name = nacp->GetApplicationName();
+            }
+        }
 
-        auto status = nca_loader.VerifyIntegrity(nca_callback);
-        if (cancelled) {
-            break;
+        if (title_id > 0) {
+            failed.push_back(
+                fmt::format("{} ({:016X}) ({})", nca_file->GetName(), title_id, title_name));
+        } else {
+            failed.push_back(fmt::format("{} (unknown)", nca_file->GetName()));
         }
-        if (status != Loader::ResultStatus::Success) {
-            FileSys::NCA nca(nca_file);
-            const auto title_id = nca.GetTitleId();
-            std::string title_name = "unknown";
-
-            const auto control = provider.GetEntry(FileSys::GetBaseTitleID(title_id),
-                                                   FileSys::ContentRecordType::Control);
-            if (control && control->GetStatus() == Loader::ResultStatus::Success) {
-                const FileSys::PatchManager pm{title_id, system.GetFileSystemController(),
-                                               provider};
-                const auto [nacp, logo] = pm.ParseControlNCA(*control);
-                if (nacp) {
-                    title_name = nacp->GetApplicationName();
-                }
-            }
+        if (failed_callback) {
+            failed_callback(failed.back());
+        }
+    };
 
-            if (title_id > 0) {
-                failed.push_back(
-                    fmt::format("{} ({:016X}) ({})", nca_file->GetName(), title_id, title_name));
-            } else {
-                failed.push_back(fmt::format("{} (unknown)", nca_file->GetName()));
-            }
+    // Determine if all NCAs are valid, verifying them concurrently.
+    FileSys::ContentVerifier verifier{callback, result_callback, &record};
+    for (auto nca_provider : content_providers) {
+        const auto entries = nca_provider->ListEntriesFilter();
+
+        for (const auto& entry : entries) {
+            verifier.Queue(nca_provider->GetEntryRaw(entry.title_id, entry.type));
         }
+    }
 
-        processed_size += nca_file->GetSize();
+    if (verifier.Run()) {
+        // The verification is complete, the next one starts over.
+        record.Clear();
     }
     return failed;
 }
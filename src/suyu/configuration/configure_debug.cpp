@@ -115,6 +115,7 @@ void ConfigureDebug::ApplyConfiguration() {
     Common::Log::Filter filter;
     filter.ParseFilterString(Settings::values.log_filter.GetValue());
     Common::Log::SetGlobalFilter(filter);
+    Common::Log::SetDeferredFormattingEnabled(Settings::values.log_deferred_formatting.GetValue());
 }
 
 void ConfigureDebug::changeEvent(QEvent* event) {
@@ -95,14 +95,7 @@ void ConfigurePerGameAddons::ApplyConfiguration() {
             disabled_addons.push_back(item.front()->text().toStdString());
     }
 
-    auto current = Settings::values.disabled_addons[title_id];
     std::sort(disabled_addons.begin(), disabled_addons.end());
-    std::sort(current.begin(), current.end());
-    if (disabled_addons != current) {
-        Common::FS::RemoveFile(Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) /
-                               "game_list" / fmt::format("{:016X}.pv.txt", title_id));
-    }
-
     Settings::values.disabled_addons[title_id] = disabled_addons;
 }
 
@@ -168,10 +161,6 @@ void ConfigurePerGameAddons::ReloadList() {
     list_items.clear();
     selected_patch = std::nullopt;
 
-    // Remove the cache to ensure we'll recreate it
-    Common::FS::RemoveFile(Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "game_list" /
-                           fmt::format("{:016X}.pv.txt", title_id));
-
     // Reload stuff
     UISettings::values.is_game_list_reload_pending.exchange(true);
     UISettings::values.is_game_list_reload_pending.notify_all();
@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+#include <system_error>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+#include "common/common_funcs.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "core/file_sys/nca_metadata.h"
+#include "core/loader/loader.h"
+#include "suyu/game_list_metadata.h"
+
+namespace {
+
+constexpr quint32 DatabaseMagic = Common::MakeMagic('S', 'G', 'L', 'M');
+constexpr quint32 DatabaseVersion = 3;
+
+QString ToQString(const std::filesystem::path& path) {
+    return QString::fromStdString(Common::FS::PathToUTF8String(path));
+}
+
+/// Returns true for the icon, name and add-ons files the game list cached per title ID.
+bool IsLegacyCacheFile(std::string_view name) {
+    constexpr std::size_t TitleIdLength = 16;
+    if (name.size() <= TitleIdLength || name[TitleIdLength] != '.' ||
+        !std::all_of(name.begin(), name.begin() + TitleIdLength,
+                     [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; })) {
+        return false;
+    }
+    const std::string_view extension = name.substr(TitleIdLength);
+    return extension == ".jpeg" || extension == ".appname.txt" || extension == ".pv.txt";
+}
+
+QDataStream& operator<<(QDataStream& stream, const GameFileRange& range) {
+    return stream << static_cast<quint64>(range.offset) << static_cast<quint64>(range.size)
+                  << QString::fromStdString(range.name);
+}
+
+QDataStream& operator>>(QDataStream& stream, GameFileRange& range) {
+    quint64 offset{};
+    quint64 size{};
+    QString name;
+    stream >> offset >> size >> name;
+    range = {.offset = offset, .size = size, .name = name.toStdString()};
+    return stream;
+}
+
+} // Anonymous namespace
+
+std::optional<GameFileIdentity> GameFileIdentity::Get(const std::string& path) {
+    const std::filesystem::path fs_path{Common::FS::ToU8String(path)};
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(fs_path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto modified = std::filesystem::last_write_time(fs_path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return GameFileIdentity{
+        .size = size,
+        .modified = static_cast<s64>(modified.time_since_epoch().count()),
+    };
+}
+
+GameListMetadata::GameListMetadata()
+    : path{Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "game_list" /
+           "metadata.bin"} {
+    Load();
+}
+
+std::optional<std::vector<GameMetadata>> GameListMetadata::FindFile(
+    const std::string& file_path, const GameFileIdentity& identity) {
+    std::scoped_lock lock{mutex};
+    const auto it = files.find(file_path);
+    if (it == files.end() || it->second.identity != identity || !it->second.programs) {
+        return std::nullopt;
+    }
+    used_files.insert(file_path);
+    return it->second.programs;
+}
+
+void GameListMetadata::InsertFile(const std::string& file_path, const GameFileIdentity& identity,
+                                  std::vector<GameMetadata> programs) {
+    std::scoped_lock lock{mutex};
+    GetEntryLocked(file_path, identity).programs = std::move(programs);
+}
+
+std::optional<GameFileContents> GameListMetadata::FindContents(const std::string& file_path,
+                                                               const GameFileIdentity& identity) {
+    std::scoped_lock lock{mutex};
+    const auto it = files.find(file_path);
+    if (it == files.end() || it->second.identity != identity || !it->second.contents) {
+        return std::nullopt;
+    }
+    used_files.insert(file_path);
+    return it->second.contents;
+}
+
+void GameListMetadata::InsertContents(const std::string& file_path,
+                                      const GameFileIdentity& identity,
+                                      GameFileContents contents) {
+    std::scoped_lock lock{mutex};
+    GetEntryLocked(file_path, identity).contents = std::move(contents);
+}
+
+GameListMetadata::FileEntry& GameListMetadata::GetEntryLocked(const std::string& file_path,
+                                                              const GameFileIdentity& identity) {
+    used_files.insert(file_path);
+    FileEntry& entry = files[file_path];
+    if (entry.identity != identity) {
+        entry = FileEntry{.identity = identity, .programs{}, .contents{}};
+    }
+    return entry;
+}
+
+void GameListMetadata::Load() {
+    QFile file{ToQString(path)};
+    if (!file.open(QFile::ReadOnly)) {
+        RemoveLegacyFiles();
+        return;
+    }
+
+    QDataStream stream{&file};
+    stream.setVersion(QDataStream::Qt_5_15);
+
+    quint32 magic{};
+    quint32 version{};
+    stream >> magic >> version;
+    if (magic != DatabaseMagic || version != DatabaseVersion) {
+        LOG_INFO(Frontend, "Discarding outdated game list metadata");
+        RemoveLegacyFiles();
+        return;
+    }
+
+    quint32 num_files{};
+    stream >> num_files;
+    for (quint32 i = 0; i < num_files && stream.status() == QDataStream::Ok; ++i) {
+        QString file_path;
+        quint64 size{};
+        qint64 modified{};
+        bool has_programs{};
+        quint32 num_programs{};
+        stream >> file_path >> size >> modified >> has_programs >> num_programs;
+
+        FileEntry entry{.identity{size, modified}, .programs{}, .contents{}};
+        if (has_programs) {
+            entry.programs.emplace();
+        }
+        for (quint32 j = 0; j < num_programs && stream.status() == QDataStream::Ok; ++j) {
+            quint64 program_id{};
+            qint32 file_type{};
+            QString name;
+            QString program_version;
+            QByteArray icon;
+            QString add_ons;
+            quint64 add_ons_fingerprint{};
+            stream >> program_id >> file_type >> name >> program_version >> icon >> add_ons >>
+                add_ons_fingerprint;
+            if (entry.programs) {
+                entry.programs->push_back({
+                    .program_id = program_id,
+                    .file_type = static_cast<Loader::FileType>(file_type),
+                    .name = name.toStdString(),
+                    .version = program_version.toStdString(),
+                    .icon{icon.begin(), icon.end()},
+                    .add_ons = std::move(add_ons),
+                    .add_ons_fingerprint = add_ons_fingerprint,
+                });
+            }
+        }
+
+        bool has_contents{};
+        quint32 num_contents{};
+        stream >> has_contents >> num_contents;
+        GameFileContents contents;
+        for (quint32 j = 0; j < num_contents && stream.status() == QDataStream::Ok; ++j) {
+            quint8 title_type{};
+            quint8 record_type{};
+            quint64 title_id{};
+            GameFileRange range;
+            stream >> title_type >> record_type >> title_id >> range;
+            contents.contents.push_back({
+                .title_type = static_cast<FileSys::TitleType>(title_type),
+                .record_type = static_cast<FileSys::ContentRecordType>(record_type),
+                .title_id = title_id,
+                .range = std::move(range),
+            });
+        }
+        quint32 num_tickets{};
+        stream >> num_tickets;
+        for (quint32 j = 0; j < num_tickets && stream.status() == QDataStream::Ok; ++j) {
+            stream >> contents.tickets.emplace_back();
+        }
+        if (has_contents) {
+            entry.contents = std::move(contents);
+        }
+        files.insert_or_assign(file_path.toStdString(), std::move(entry));
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        LOG_WARNING(Frontend, "Discarding corrupted game list metadata");
+        files.clear();
+    }
+}
+
+void GameListMetadata::RemoveLegacyFiles() const {
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator{path.parent_path(), ec}) {
+        if (entry.is_regular_file(ec) &&
+            IsLegacyCacheFile(Common::FS::PathToUTF8String(entry.path().filename()))) {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+}
+
+void GameListMetadata::Save() {
+    std::scoped_lock lock{mutex};
+    std::erase_if(files, [this](const auto& entry) { return !used_files.contains(entry.first); });
+
+    if (!Common::FS::CreateParentDirs(path)) {
+        return;
+    }
+
+    // Written to a temporary file first, the database on disk is always whole.
+    QSaveFile file{ToQString(path)};
+    if (!file.open(QFile::WriteOnly)) {
+        LOG_ERROR(Frontend, "Failed to open game list metadata for writing");
+        return;
+    }
+
+    QDataStream stream{&file};
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << DatabaseMagic << DatabaseVersion;
+
+    stream << static_cast<quint32>(files.size());
+    for (const auto& [file_path, entry] : files) {
+        const std::vector<GameMetadata> no_programs;
+        const auto& programs = entry.programs ? *entry.programs : no_programs;
+        stream << QString::fromStdString(file_path) << static_cast<quint64>(entry.identity.size)
+               << static_cast<qint64>(entry.identity.modified) << entry.programs.has_value()
+               << static_cast<quint32>(programs.size());
+        for (const GameMetadata& program : programs) {
+            stream << static_cast<quint64>(program.program_id)
+                   << static_cast<qint32>(program.file_type)
+                   << QString::fromStdString(program.name)
+                   << QString::fromStdString(program.version)
+                   << QByteArray(reinterpret_cast<const char*>(program.icon.data()),
+                                 static_cast<qsizetype>(program.icon.size()))
+                   << program.add_ons << static_cast<quint64>(program.add_ons_fingerprint);
+        }
+
+        const GameFileContents no_contents;
+        const auto& contents = entry.contents ? *entry.contents : no_contents;
+        stream << entry.contents.has_value() << static_cast<quint32>(contents.contents.size());
+        for (const GameContent& content : contents.contents) {
+            stream << static_cast<quint8>(content.title_type)
+                   << static_cast<quint8>(content.record_type)
+                   << static_cast<quint64>(content.title_id) << content.range;
+        }
+        stream << static_cast<quint32>(contents.tickets.size());
+        for (const GameFileRange& ticket : contents.tickets) {
+            stream << ticket;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        LOG_ERROR(Frontend, "Failed to write game list metadata");
+    }
+}
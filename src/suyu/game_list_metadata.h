@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+#include "common/common_types.h"
+
+namespace FileSys {
+enum class ContentRecordType : u8;
+enum class TitleType : u8;
+} // namespace FileSys
+
+namespace Loader {
+enum class FileType;
+}
+
+/// Size and modification time of a file on the host, telling whether it changed.
+struct GameFileIdentity {
+    u64 size;
+    s64 modified;
+
+    bool operator==(const GameFileIdentity&) const = default;
+
+    /// Returns the identity of the file at the path, or std::nullopt if it cannot be determined.
+    static std::optional<GameFileIdentity> Get(const std::string& path);
+};
+
+/// Metadata of a program shown in the game list.
+struct GameMetadata {
+    u64 program_id;
+    Loader::FileType file_type;
+    std::string name;
+    std::string version; ///< Display version from the control data, empty if it has none.
+    std::vector<u8> icon;
+    QString add_ons;         ///< Updates, DLC and mods applied to the program, with their versions.
+    u64 add_ons_fingerprint; ///< Fingerprint of everything add_ons was computed from.
+};
+
+/// Range of a game file holding one of the files packed in it.
+struct GameFileRange {
+    u64 offset;
+    u64 size;
+    std::string name;
+};
+
+/// Content packed in a game file, added to the manual content provider.
+struct GameContent {
+    FileSys::TitleType title_type;
+    FileSys::ContentRecordType record_type;
+    u64 title_id;
+    GameFileRange range;
+};
+
+/// Contents and tickets of a game file, to fill the content provider without parsing it.
+struct GameFileContents {
+    std::vector<GameContent> contents;
+    std::vector<GameFileRange> tickets;
+};
+
+/**
+ * Database of the metadata shown in the game list, so populating it again only parses the files
+ * that changed since.
+ *
+ * Programs and contents are stored per file and are valid as long as the file keeps its size and
+ * modification time. The add-ons of a program also depend on other files, so they are only valid
+ * as long as their fingerprint matches. All methods are thread-safe.
+ *
+ * The database starts with its format version. Databases of another version are discarded, along
+ * with the files the game list cached per title ID before it had a database.
+ */
+class GameListMetadata {
+public:
+    /// Loads the database from the game list cache. A missing or invalid database is empty.
+    GameListMetadata();
+
+    /// Returns the programs of the file, if they are known for its current identity.
+    std::optional<std::vector<GameMetadata>> FindFile(const std::string& path,
+                                                      const GameFileIdentity& identity);
+
+    void InsertFile(const std::string& path, const GameFileIdentity& identity,
+                    std::vector<GameMetadata> programs);
+
+    /// Returns the contents of the file, if they are known for its current identity.
+    std::optional<GameFileContents> FindContents(const std::string& path,
+                                                 const GameFileIdentity& identity);
+
+    void InsertContents(const std::string& path, const GameFileIdentity& identity,
+                        GameFileContents contents);
+
+    /// Writes the database, without the files that were neither found nor inserted since loading.
+    void Save();
+
+private:
+    struct FileEntry {
+        GameFileIdentity identity;
+        std::optional<std::vector<GameMetadata>> programs;
+        std::optional<GameFileContents> contents;
+    };
+
+    /// Returns the entry of the file, emptied if it was stored for another identity.
+    FileEntry& GetEntryLocked(const std::string& path, const GameFileIdentity& identity);
+
+    void Load();
+
+    /// Removes the files the game list cached per title ID before it had a database.
+    void RemoveLegacyFiles() const;
+
+    std::filesystem::path path;
+
+    std::mutex mutex;
+    std::map<std::string, FileEntry> files;
+    std::set<std::string> used_files;
+};
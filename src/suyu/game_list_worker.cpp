@@ -1,20 +1,31 @@
 // SPDX-FileCopyrightText: Copyright 2018 yuzu Emulator Project & 2024 suyu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <utility>
 #include <vector>
 
 #include <QDir>
-#include <QFile>
 #include <QFileInfo>
 #include <QSettings>
 
+#include "common/cityhash.h"
 #include "common/fs/fs.h"
 #include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
 #include "core/core.h"
+#include "core/crypto/key_manager.h"
 #include "core/file_sys/card_image.h"
+#include "core/file_sys/common_funcs.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/fs_filesystem.h"
@@ -22,6 +33,7 @@
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/submission_package.h"
+#include "core/file_sys/vfs/vfs_offset.h"
 #include "core/loader/loader.h"
 #include "suyu/compatibility_list.h"
 #include "suyu/game_list.h"
@@ -31,132 +43,142 @@
 
 namespace {
 
-QString GetGameListCachedObject(const std::string& filename, const std::string& ext,
-                                const std::function<QString()>& generator) {
-    if (!UISettings::values.cache_game_list || filename == "0000000000000000") {
-        return generator();
-    }
-
-    const auto path =
-        Common::FS::PathToUTF8String(Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) /
-                                     "game_list" / fmt::format("{}.{}", filename, ext));
-
-    void(Common::FS::CreateParentDirs(path));
-
-    if (!Common::FS::Exists(path)) {
-        const auto str = generator();
+bool HasSupportedFileExtension(const std::string& file_name) {
+    const QFileInfo file = QFileInfo(QString::fromStdString(file_name));
+    return GameList::supported_file_extensions.contains(file.suffix(), Qt::CaseInsensitive);
+}
 
-        QFile file{QString::fromStdString(path)};
-        if (file.open(QFile::WriteOnly)) {
-            file.write(str.toUtf8());
-        }
+bool IsExtractedNCAMain(const std::string& file_name) {
+    return QFileInfo(QString::fromStdString(file_name)).fileName() == QStringLiteral("main");
+}
 
-        return str;
-    }
+QString FormatGameName(const std::string& physical_name) {
+    const QString physical_name_as_qstring = QString::fromStdString(physical_name);
+    const QFileInfo file_info(physical_name_as_qstring);
 
-    QFile file{QString::fromStdString(path)};
-    if (file.open(QFile::ReadOnly)) {
-        return QString::fromUtf8(file.readAll());
+    if (IsExtractedNCAMain(physical_name)) {
+        return file_info.dir().path();
     }
 
-    return generator();
+    return physical_name_as_qstring;
 }
 
-std::pair<std::vector<u8>, std::string> GetGameListCachedObject(
-    const std::string& filename, const std::string& ext,
-    const std::function<std::pair<std::vector<u8>, std::string>()>& generator) {
-    if (!UISettings::values.cache_game_list || filename == "0000000000000000") {
-        return generator();
+/// Content to add to the manual content provider.
+struct ProviderEntry {
+    FileSys::TitleType title_type;
+    FileSys::ContentRecordType record_type;
+    u64 title_id;
+    FileSys::VirtualFile file;
+};
+
+/// Returns the range of the host file a file packed in it reads, if it reads a single range.
+std::optional<GameFileRange> GetRangeInFile(FileSys::VirtualFile packed_file,
+                                            const FileSys::VirtualFile& host_file) {
+    GameFileRange range{
+        .offset = 0,
+        .size = packed_file->GetSize(),
+        .name = packed_file->GetName(),
+    };
+    while (packed_file != host_file) {
+        const auto offset_file = std::dynamic_pointer_cast<FileSys::OffsetVfsFile>(packed_file);
+        if (offset_file == nullptr) {
+            return std::nullopt;
+        }
+        range.offset += offset_file->GetOffset();
+        packed_file = offset_file->GetBaseFile();
     }
+    return range;
+}
 
-    const auto game_list_dir =
-        Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "game_list";
-    const auto jpeg_name = fmt::format("{}.jpeg", filename);
-    const auto app_name = fmt::format("{}.appname.txt", filename);
-
-    const auto path1 = Common::FS::PathToUTF8String(game_list_dir / jpeg_name);
-    const auto path2 = Common::FS::PathToUTF8String(game_list_dir / app_name);
-
-    void(Common::FS::CreateParentDirs(path1));
-
-    if (!Common::FS::Exists(path1) || !Common::FS::Exists(path2)) {
-        const auto [icon, nacp] = generator();
+FileSys::VirtualFile OpenRange(const FileSys::VirtualFile& host_file, const GameFileRange& range) {
+    return std::make_shared<FileSys::OffsetVfsFile>(host_file, range.size, range.offset,
+                                                    range.name);
+}
 
-        QFile file1{QString::fromStdString(path1)};
-        if (!file1.open(QFile::WriteOnly)) {
-            LOG_ERROR(Frontend, "Failed to open cache file.");
-            return generator();
+/// Adds the contents of a file taken from the metadata, loading its tickets as parsing it would.
+void AddCachedContents(const FileSys::VirtualFile& file, const GameFileContents& contents,
+                       std::vector<ProviderEntry>& entries) {
+    auto& keys = Core::Crypto::KeyManager::Instance();
+    for (const GameFileRange& ticket : contents.tickets) {
+        if (!keys.AddTicket(Core::Crypto::Ticket::Read(OpenRange(file, ticket)))) {
+            LOG_WARNING(Frontend, "Could not load ticket {}", ticket.name);
         }
+    }
+    for (const GameContent& content : contents.contents) {
+        entries.push_back({content.title_type, content.record_type, content.title_id,
+                           OpenRange(file, content.range)});
+    }
+}
 
-        if (!file1.resize(icon.size())) {
-            LOG_ERROR(Frontend, "Failed to resize cache file to necessary size.");
-            return generator();
+/**
+ * Reads the contents of a game file to add to the manual content provider. They are taken from the
+ * metadata database when the file did not change, otherwise the file is parsed.
+ */
+std::vector<ProviderEntry> ReadProviderEntries(const FileSys::VirtualFile& file,
+                                               const std::string& path,
+                                               const std::optional<GameFileIdentity>& identity,
+                                               GameListMetadata* metadata) {
+    std::vector<ProviderEntry> entries;
+    const bool use_metadata = metadata != nullptr && identity.has_value();
+    if (use_metadata) {
+        if (const auto contents = metadata->FindContents(path, *identity)) {
+            AddCachedContents(file, *contents, entries);
+            return entries;
         }
+    }
 
-        if (file1.write(reinterpret_cast<const char*>(icon.data()), icon.size()) !=
-            s64(icon.size())) {
-            LOG_ERROR(Frontend, "Failed to write data to cache file.");
-            return generator();
+    GameFileContents contents;
+    bool is_cacheable = use_metadata;
+    const auto add_entry = [&](FileSys::TitleType title_type,
+                               FileSys::ContentRecordType record_type, u64 title_id,
+                               FileSys::VirtualFile entry_file) {
+        if (auto range = GetRangeInFile(entry_file, file)) {
+            contents.contents.push_back({title_type, record_type, title_id, *range});
+        } else {
+            is_cacheable = false;
         }
+        entries.push_back({title_type, record_type, title_id, std::move(entry_file)});
+    };
 
-        QFile file2{QString::fromStdString(path2)};
-        if (file2.open(QFile::WriteOnly)) {
-            file2.write(nacp.data(), nacp.size());
+    const auto file_type = Loader::IdentifyFile(file);
+    if (file_type == Loader::FileType::NCA) {
+        const FileSys::NCA nca{file};
+        if (nca.GetStatus() == Loader::ResultStatus::Success) {
+            add_entry(FileSys::TitleType::Application,
+                      FileSys::GetCRTypeFromNCAType(nca.GetType()), nca.GetTitleId(), file);
+        }
+    } else if (file_type == Loader::FileType::XCI || file_type == Loader::FileType::NSP) {
+        const auto nsp = file_type == Loader::FileType::NSP
+                             ? std::make_shared<FileSys::NSP>(file)
+                             : FileSys::XCI{file}.GetSecurePartitionNSP();
+        if (nsp == nullptr) {
+            return entries;
+        }
+        for (const auto& title : nsp->GetNCAs()) {
+            for (const auto& entry : title.second) {
+                add_entry(entry.first.first, entry.first.second, title.first,
+                          entry.second->GetBaseFile());
+            }
+        }
+        // Parsing the package loaded its tickets, which have to be loaded again when it is taken
+        // from the metadata.
+        for (const auto& nsp_file : nsp->GetFiles()) {
+            if (nsp_file == nullptr || nsp_file->GetExtension() != "tik") {
+                continue;
+            }
+            if (auto range = GetRangeInFile(nsp_file, file)) {
+                contents.tickets.push_back(std::move(*range));
+            } else {
+                is_cacheable = false;
+            }
         }
-
-        return std::make_pair(icon, nacp);
-    }
-
-    QFile file1(QString::fromStdString(path1));
-    QFile file2(QString::fromStdString(path2));
-
-    if (!file1.open(QFile::ReadOnly)) {
-        LOG_ERROR(Frontend, "Failed to open cache file for reading.");
-        return generator();
-    }
-
-    if (!file2.open(QFile::ReadOnly)) {
-        LOG_ERROR(Frontend, "Failed to open cache file for reading.");
-        return generator();
     }
 
-    std::vector<u8> vec(file1.size());
-    if (file1.read(reinterpret_cast<char*>(vec.data()), vec.size()) !=
-        static_cast<s64>(vec.size())) {
-        return generator();
+    // Files without contents are parsed again, they may become readable with new keys.
+    if (is_cacheable && !entries.empty()) {
+        metadata->InsertContents(path, *identity, std::move(contents));
     }
-
-    const auto data = file2.readAll();
-    return std::make_pair(vec, data.toStdString());
-}
-
-void GetMetadataFromControlNCA(const FileSys::PatchManager& patch_manager, const FileSys::NCA& nca,
-                               std::vector<u8>& icon, std::string& name) {
-    std::tie(icon, name) = GetGameListCachedObject(
-        fmt::format("{:016X}", patch_manager.GetTitleID()), {}, [&patch_manager, &nca] {
-            const auto [nacp, icon_f] = patch_manager.ParseControlNCA(nca);
-            return std::make_pair(icon_f->ReadAllBytes(), nacp->GetApplicationName());
-        });
-}
-
-bool HasSupportedFileExtension(const std::string& file_name) {
-    const QFileInfo file = QFileInfo(QString::fromStdString(file_name));
-    return GameList::supported_file_extensions.contains(file.suffix(), Qt::CaseInsensitive);
-}
-
-bool IsExtractedNCAMain(const std::string& file_name) {
-    return QFileInfo(QString::fromStdString(file_name)).fileName() == QStringLiteral("main");
-}
-
-QString FormatGameName(const std::string& physical_name) {
-    const QString physical_name_as_qstring = QString::fromStdString(physical_name);
-    const QFileInfo file_info(physical_name_as_qstring);
-
-    if (IsExtractedNCAMain(physical_name)) {
-        return file_info.dir().path();
-    }
-
-    return physical_name_as_qstring;
+    return entries;
 }
 
 QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
@@ -191,13 +213,143 @@ QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
     return out;
 }
 
-QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::string& name,
-                                        const std::size_t size, const std::vector<u8>& icon,
-                                        Loader::AppLoader& loader, u64 program_id,
+QString ReadAddOns(Core::System& system, Loader::AppLoader& loader, u64 program_id) {
+    const FileSys::PatchManager patch{program_id, system.GetFileSystemController(),
+                                      system.GetContentProvider()};
+    return FormatPatchNameVersions(patch, loader, loader.IsRomFSUpdatable());
+}
+
+GameMetadata ReadProgram(Core::System& system, Loader::AppLoader& loader, u64 program_id) {
+    GameMetadata program{
+        .program_id = program_id,
+        .file_type = loader.GetFileType(),
+        .name = " ",
+        .version{},
+        .icon{},
+        .add_ons = ReadAddOns(system, loader, program_id),
+        .add_ons_fingerprint = 0,
+    };
+    [[maybe_unused]] const auto res1 = loader.ReadIcon(program.icon);
+    [[maybe_unused]] const auto res3 = loader.ReadTitle(program.name);
+    FileSys::NACP nacp;
+    if (loader.ReadControlData(nacp) == Loader::ResultStatus::Success) {
+        program.version = nacp.GetVersionString();
+    }
+    return program;
+}
+
+/// Reads the programs of a file found in a game directory.
+std::vector<GameMetadata> ReadGameFilePrograms(Core::System& system,
+                                               const FileSys::VirtualFile& file) {
+    auto loader = Loader::GetLoader(system, file);
+    if (!loader) {
+        return {};
+    }
+
+    const auto file_type = loader->GetFileType();
+    if (file_type == Loader::FileType::Unknown || file_type == Loader::FileType::Error) {
+        return {};
+    }
+
+    u64 program_id = 0;
+    const auto res2 = loader->ReadProgramId(program_id);
+
+    std::vector<u64> program_ids;
+    loader->ReadProgramIds(program_ids);
+
+    if (res2 != Loader::ResultStatus::Success || program_ids.size() <= 1 ||
+        (file_type != Loader::FileType::XCI && file_type != Loader::FileType::NSP)) {
+        return {ReadProgram(system, *loader, program_id)};
+    }
+
+    std::vector<GameMetadata> programs;
+    for (const auto id : program_ids) {
+        loader = Loader::GetLoader(system, file, id);
+        if (loader) {
+            programs.push_back(ReadProgram(system, *loader, id));
+        }
+    }
+    return programs;
+}
+
+/// Reads the program of an installed title.
+std::vector<GameMetadata> ReadInstalledPrograms(Core::System& system, u64 title_id,
+                                                const FileSys::VirtualFile& file) {
+    const auto loader = Loader::GetLoader(system, file);
+    if (!loader) {
+        return {};
+    }
+
+    u64 program_id = 0;
+    if (loader->ReadProgramId(program_id) != Loader::ResultStatus::Success) {
+        return {};
+    }
+
+    GameMetadata program{
+        .program_id = program_id,
+        .file_type = loader->GetFileType(),
+        .name{},
+        .version{},
+        .icon{},
+        .add_ons = ReadAddOns(system, *loader, program_id),
+        .add_ons_fingerprint = 0,
+    };
+
+    const auto control = system.GetContentProviderUnion().GetEntry(
+        title_id, FileSys::ContentRecordType::Control);
+    if (control != nullptr) {
+        const FileSys::PatchManager patch{program_id, system.GetFileSystemController(),
+                                          system.GetContentProvider()};
+        const auto [nacp, icon_file] = patch.ParseControlNCA(*control);
+        if (nacp != nullptr) {
+            program.name = nacp->GetApplicationName();
+            program.version = nacp->GetVersionString();
+        }
+        if (icon_file != nullptr) {
+            program.icon = icon_file->ReadAllBytes();
+        }
+    }
+    return {program};
+}
+
+u64 HashData(std::span<const u64> data) {
+    return Common::CityHash64(reinterpret_cast<const char*>(data.data()), data.size_bytes());
+}
+
+u64 HashString(std::string_view str) {
+    return Common::CityHash64(str.data(), str.size());
+}
+
+/// Adds the modification times of a directory and of the directories up to depth levels below it.
+void AppendDirectoryTimes(std::vector<u64>& data, const std::filesystem::path& path, int depth) {
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return;
+    }
+    data.push_back(static_cast<u64>(modified.time_since_epoch().count()));
+    if (depth == 0) {
+        return;
+    }
+
+    std::vector<std::filesystem::path> subdirs;
+    for (const auto& entry : std::filesystem::directory_iterator{path, ec}) {
+        if (entry.is_directory(ec)) {
+            subdirs.push_back(entry.path());
+        }
+    }
+    std::sort(subdirs.begin(), subdirs.end());
+    for (const auto& subdir : subdirs) {
+        data.push_back(HashString(Common::FS::PathToUTF8String(subdir)));
+        AppendDirectoryTimes(data, subdir, depth - 1);
+    }
+}
+
+QList<QStandardItem*> MakeGameListEntry(const std::string& path, const GameMetadata& program,
+                                        std::size_t size,
                                         const CompatibilityList& compatibility_list,
-                                        const PlayTime::PlayTimeManager& play_time_manager,
-                                        const FileSys::PatchManager& patch) {
-    const auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
+                                        const PlayTime::PlayTimeManager& play_time_manager) {
+    const auto it = FindMatchingCompatibilityEntry(compatibility_list, program.program_id);
 
     // The game list uses this as compatibility number for untested games
     QString compatibility{QStringLiteral("99")};
@@ -205,23 +357,20 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
         compatibility = it->second.first;
     }
 
-    const auto file_type = loader.GetFileType();
-    const auto file_type_string = QString::fromStdString(Loader::GetFileTypeString(file_type));
+    const auto file_type_string =
+        QString::fromStdString(Loader::GetFileTypeString(program.file_type));
 
     QList<QStandardItem*> list{
-        new GameListItemPath(FormatGameName(path), icon, QString::fromStdString(name),
-                             file_type_string, program_id),
+        new GameListItemPath(FormatGameName(path), program.icon,
+                             QString::fromStdString(program.name), file_type_string,
+                             program.program_id),
         new GameListItemCompat(compatibility),
         new GameListItem(file_type_string),
         new GameListItemSize(size),
-        new GameListItemPlayTime(play_time_manager.GetPlayTime(program_id)),
+        new GameListItemPlayTime(play_time_manager.GetPlayTime(program.program_id)),
     };
 
-    const auto patch_versions = GetGameListCachedObject(
-        fmt::format("{:016X}", patch.GetTitleID()), "pv.txt", [&patch, &loader] {
-            return FormatPatchNameVersions(patch, loader, loader.IsRomFSUpdatable());
-        });
-    list.insert(2, new GameListItem(patch_versions));
+    list.insert(2, new GameListItem(program.add_ons));
 
     return list;
 }
@@ -302,41 +451,30 @@ void GameListWorker::AddTitlesToGameList(GameListDir* parent_dir) {
     }
 
     for (const auto& [slot, game] : installed_games) {
+        if (stop_requested) {
+            break;
+        }
         if (slot == ContentProviderUnionSlot::FrontendManual) {
             continue;
         }
 
         const auto file = cache.GetEntryUnparsed(game.title_id, game.type);
-        std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(system, file);
-        if (!loader) {
-            continue;
-        }
-
-        std::vector<u8> icon;
-        std::string name;
-        u64 program_id = 0;
-        const auto result = loader->ReadProgramId(program_id);
-
-        if (result != Loader::ResultStatus::Success) {
+        if (file == nullptr) {
             continue;
         }
-
-        const PatchManager patch{program_id, system.GetFileSystemController(),
-                                 system.GetContentProvider()};
-        const auto control = cache.GetEntry(game.title_id, ContentRecordType::Control);
-        if (control != nullptr) {
-            GetMetadataFromControlNCA(patch, *control, icon, name);
-        }
-
-        auto entry = MakeGameListEntry(file->GetFullPath(), name, file->GetSize(), icon, *loader,
-                                       program_id, compatibility_list, play_time_manager, patch);
-        RecordEvent([=](GameList* game_list) { game_list->AddEntry(entry, parent_dir); });
+        AddProgramsToGameList(
+            file, file->GetFullPath(),
+            [this, title_id = game.title_id](const VirtualFile& title_file) {
+                return ReadInstalledPrograms(system, title_id, title_file);
+            },
+            parent_dir);
     }
 }
 
-void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_path, bool deep_scan,
-                                    GameListDir* parent_dir) {
-    const auto callback = [this, target, parent_dir](const std::filesystem::path& path) -> bool {
+std::vector<GameListWorker::GameFile> GameListWorker::CollectGameFiles(const std::string& dir_path,
+                                                                       bool deep_scan) {
+    std::vector<GameFile> files;
+    const auto callback = [this, &files](const std::filesystem::path& path) -> bool {
         if (stop_requested) {
             // Breaks the callback loop.
             return false;
@@ -347,88 +485,7 @@ void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_pa
 
         if (!is_dir &&
             (HasSupportedFileExtension(physical_name) || IsExtractedNCAMain(physical_name))) {
-            const auto file = vfs->OpenFile(physical_name, FileSys::OpenMode::Read);
-            if (!file) {
-                return true;
-            }
-
-            auto loader = Loader::GetLoader(system, file);
-            if (!loader) {
-                return true;
-            }
-
-            const auto file_type = loader->GetFileType();
-            if (file_type == Loader::FileType::Unknown || file_type == Loader::FileType::Error) {
-                return true;
-            }
-
-            u64 program_id = 0;
-            const auto res2 = loader->ReadProgramId(program_id);
-
-            if (target == ScanTarget::FillManualContentProvider) {
-                if (res2 == Loader::ResultStatus::Success && file_type == Loader::FileType::NCA) {
-                    provider->AddEntry(FileSys::TitleType::Application,
-                                       FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()),
-                                       program_id, file);
-                } else if (res2 == Loader::ResultStatus::Success &&
-                           (file_type == Loader::FileType::XCI ||
-                            file_type == Loader::FileType::NSP)) {
-                    const auto nsp = file_type == Loader::FileType::NSP
-                                         ? std::make_shared<FileSys::NSP>(file)
-                                         : FileSys::XCI{file}.GetSecurePartitionNSP();
-                    for (const auto& title : nsp->GetNCAs()) {
-                        for (const auto& entry : title.second) {
-                            provider->AddEntry(entry.first.first, entry.first.second, title.first,
-                                               entry.second->GetBaseFile());
-                        }
-                    }
-                }
-            } else {
-                std::vector<u64> program_ids;
-                loader->ReadProgramIds(program_ids);
-
-                if (res2 == Loader::ResultStatus::Success && program_ids.size() > 1 &&
-                    (file_type == Loader::FileType::XCI || file_type == Loader::FileType::NSP)) {
-                    for (const auto id : program_ids) {
-                        loader = Loader::GetLoader(system, file, id);
-                        if (!loader) {
-                            continue;
-                        }
-
-                        std::vector<u8> icon;
-                        [[maybe_unused]] const auto res1 = loader->ReadIcon(icon);
-
-                        std::string name = " ";
-                        [[maybe_unused]] const auto res3 = loader->ReadTitle(name);
-
-                        const FileSys::PatchManager patch{id, system.GetFileSystemController(),
-                                                          system.GetContentProvider()};
-
-                        auto entry = MakeGameListEntry(
-                            physical_name, name, Common::FS::GetSize(physical_name), icon, *loader,
-                            id, compatibility_list, play_time_manager, patch);
-
-                        RecordEvent(
-                            [=](GameList* game_list) { game_list->AddEntry(entry, parent_dir); });
-                    }
-                } else {
-                    std::vector<u8> icon;
-                    [[maybe_unused]] const auto res1 = loader->ReadIcon(icon);
-
-                    std::string name = " ";
-                    [[maybe_unused]] const auto res3 = loader->ReadTitle(name);
-
-                    const FileSys::PatchManager patch{program_id, system.GetFileSystemController(),
-                                                      system.GetContentProvider()};
-
-                    auto entry = MakeGameListEntry(
-                        physical_name, name, Common::FS::GetSize(physical_name), icon, *loader,
-                        program_id, compatibility_list, play_time_manager, patch);
-
-                    RecordEvent(
-                        [=](GameList* game_list) { game_list->AddEntry(entry, parent_dir); });
-                }
-            }
+            files.push_back({physical_name, GameFileIdentity::Get(physical_name)});
         } else if (is_dir) {
             watch_list.append(QString::fromStdString(physical_name));
         }
@@ -442,21 +499,176 @@ void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_pa
     } else {
         Common::FS::IterateDirEntries(dir_path, callback, Common::FS::DirEntryFilter::File);
     }
+    return files;
+}
+
+void GameListWorker::FillManualContentProvider(std::span<const std::vector<GameFile>> dir_files) {
+    for (const auto& game_files : dir_files) {
+        for (const GameFile& game_file : game_files) {
+            if (stop_requested) {
+                return;
+            }
+            const auto file = vfs->OpenFile(game_file.path, FileSys::OpenMode::Read);
+            if (!file) {
+                continue;
+            }
+            const auto& identity = game_file.identity;
+            const std::array<u64, 3> source{HashString(game_file.path),
+                                            identity ? identity->size : 0,
+                                            identity ? static_cast<u64>(identity->modified) : 0};
+            for (const ProviderEntry& entry :
+                 ReadProviderEntries(file, game_file.path, identity, metadata.get())) {
+                provider->AddEntry(entry.title_type, entry.record_type, entry.title_id,
+                                   entry.file);
+                title_sources.emplace(FileSys::GetBaseTitleID(entry.title_id), HashData(source));
+            }
+        }
+    }
+}
+
+void GameListWorker::PopulateGameList(std::span<const GameFile> files, GameListDir* parent_dir) {
+    for (const GameFile& game_file : files) {
+        if (stop_requested) {
+            break;
+        }
+        const auto file = vfs->OpenFile(game_file.path, FileSys::OpenMode::Read);
+        if (!file) {
+            continue;
+        }
+        AddProgramsToGameList(
+            file, game_file.path,
+            [this](const FileSys::VirtualFile& scanned_file) {
+                return ReadGameFilePrograms(system, scanned_file);
+            },
+            parent_dir);
+    }
+}
+
+void GameListWorker::AddProgramsToGameList(const FileSys::VirtualFile& file,
+                                           const std::string& path,
+                                           const ProgramReader& read_programs,
+                                           GameListDir* parent_dir) {
+    const auto identity =
+        metadata != nullptr && !path.empty() ? GameFileIdentity::Get(path) : std::nullopt;
+    auto cached_programs =
+        identity ? metadata->FindFile(path, *identity) : std::nullopt;
+
+    std::vector<GameMetadata> programs;
+    bool is_modified = false;
+    if (cached_programs) {
+        programs = std::move(*cached_programs);
+
+        // Only the add-ons whose sources changed have to be read again.
+        for (GameMetadata& program : programs) {
+            const u64 fingerprint = GetAddOnsFingerprint(program.program_id);
+            if (program.add_ons_fingerprint == fingerprint) {
+                continue;
+            }
+            const auto loader = programs.size() > 1
+                                    ? Loader::GetLoader(system, file, program.program_id)
+                                    : Loader::GetLoader(system, file);
+            if (!loader) {
+                continue;
+            }
+            program.add_ons = ReadAddOns(system, *loader, program.program_id);
+            program.add_ons_fingerprint = fingerprint;
+            is_modified = true;
+        }
+    } else {
+        programs = read_programs(file);
+        for (GameMetadata& program : programs) {
+            program.add_ons_fingerprint = GetAddOnsFingerprint(program.program_id);
+        }
+        // Files without programs are parsed again, they may become readable with new keys.
+        is_modified = !programs.empty();
+    }
+
+    if (identity && is_modified) {
+        metadata->InsertFile(path, *identity, programs);
+    }
+
+    const auto size = identity ? identity->size : file->GetSize();
+    for (const GameMetadata& program : programs) {
+        auto entry =
+            MakeGameListEntry(path, program, size, compatibility_list, play_time_manager);
+        RecordEvent([=](GameList* game_list) { game_list->AddEntry(entry, parent_dir); });
+    }
+}
+
+u64 GameListWorker::GetAddOnsFingerprint(u64 program_id) const {
+    std::vector<u64> data{program_id};
+
+    const auto [begin, end] = title_sources.equal_range(FileSys::GetBaseTitleID(program_id));
+    for (auto it = begin; it != end; ++it) {
+        data.push_back(it->second);
+    }
+
+    const auto disabled = Settings::values.disabled_addons.find(program_id);
+    if (disabled != Settings::values.disabled_addons.end()) {
+        for (const auto& name : disabled->second) {
+            data.push_back(HashString(name));
+        }
+    }
+
+    // Mods are directories below these, each with the directories of the files it replaces.
+    const auto title_dir = fmt::format("{:016X}", program_id);
+    AppendDirectoryTimes(data, Common::FS::GetSuyuPath(Common::FS::SuyuPath::LoadDir) / title_dir,
+                         2);
+    AppendDirectoryTimes(data,
+                         Common::FS::GetSuyuPath(Common::FS::SuyuPath::SDMCDir) / "atmosphere" /
+                             "contents" / title_dir,
+                         2);
+
+    return HashData(data);
 }
 
 void GameListWorker::run() {
     watch_list.clear();
     provider->ClearAllEntries();
+    title_sources.clear();
+
+    metadata.reset();
+    if (UISettings::values.cache_game_list) {
+        metadata = std::make_unique<GameListMetadata>();
+    }
 
     const auto DirEntryReady = [&](GameListDir* game_list_dir) {
         RecordEvent([=](GameList* game_list) { game_list->AddDirEntry(game_list_dir); });
     };
 
-    for (UISettings::GameDir& game_dir : game_dirs) {
+    const auto IsInstalledContentDir = [](const UISettings::GameDir& game_dir) {
+        return game_dir.path == std::string("SDMC") || game_dir.path == std::string("UserNAND") ||
+               game_dir.path == std::string("SysNAND");
+    };
+
+    // Every game directory is scanned before populating any, so the add-ons of a game include
+    // the updates and DLC of all directories.
+    std::vector<std::vector<GameFile>> dir_files(game_dirs.size());
+    for (qsizetype i = 0; i < game_dirs.size() && !stop_requested; ++i) {
+        const UISettings::GameDir& game_dir = game_dirs[i];
+        if (!IsInstalledContentDir(game_dir)) {
+            watch_list.append(QString::fromStdString(game_dir.path));
+            dir_files[i] = CollectGameFiles(game_dir.path, game_dir.deep_scan);
+        }
+    }
+    FillManualContentProvider(dir_files);
+
+    for (const auto& [slot, entry] : system.GetContentProviderUnion().ListEntriesFilterOrigin()) {
+        if (slot == FileSys::ContentProviderUnionSlot::FrontendManual) {
+            continue;
+        }
+        const auto version = system.GetContentProviderUnion().GetEntryVersion(entry.title_id);
+        const std::array<u64, 4> source{static_cast<u64>(slot), entry.title_id,
+                                        static_cast<u64>(entry.type), version.value_or(0)};
+        title_sources.emplace(FileSys::GetBaseTitleID(entry.title_id), HashData(source));
+    }
+
+    for (qsizetype i = 0; i < game_dirs.size(); ++i) {
         if (stop_requested) {
             break;
         }
 
+        UISettings::GameDir& game_dir = game_dirs[i];
         if (game_dir.path == std::string("SDMC")) {
             auto* const game_list_dir = new GameListDir(game_dir, GameListItemType::SdmcDir);
             DirEntryReady(game_list_dir);
@@ -470,16 +682,17 @@ void GameListWorker::run() {
             DirEntryReady(game_list_dir);
             AddTitlesToGameList(game_list_dir);
         } else {
-            watch_list.append(QString::fromStdString(game_dir.path));
             auto* const game_list_dir = new GameListDir(game_dir);
             DirEntryReady(game_list_dir);
-            ScanFileSystem(ScanTarget::FillManualContentProvider, game_dir.path, game_dir.deep_scan,
-                           game_list_dir);
-            ScanFileSystem(ScanTarget::PopulateGameList, game_dir.path, game_dir.deep_scan,
-                           game_list_dir);
+            PopulateGameList(dir_files[i], game_list_dir);
         }
     }
 
+    // An interrupted scan has not seen all files, saving it would drop the others.
+    if (metadata != nullptr && !stop_requested) {
+        metadata->Save();
+    }
+
     RecordEvent([this](GameList* game_list) { game_list->DonePopulating(watch_list); });
     processing_completed.Set();
 }
@@ -5,8 +5,12 @@
 
 #include <atomic>
 #include <deque>
+#include <map>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include <QList>
 #include <QObject>
@@ -15,6 +19,7 @@
 
 #include "common/thread.h"
 #include "suyu/compatibility_list.h"
+#include "suyu/game_list_metadata.h"
 #include "suyu/play_time_manager.h"
 
 namespace Core {
@@ -26,6 +31,7 @@ class QStandardItem;
 
 namespace FileSys {
 class NCA;
+class VfsFile;
 class VfsFilesystem;
 } // namespace FileSys
 
@@ -66,15 +72,36 @@ private:
     void RecordEvent(F&& func);
 
 private:
+    /// File found in a game directory, with its identity if it could be determined.
+    struct GameFile {
+        std::string path;
+        std::optional<GameFileIdentity> identity;
+    };
+
+    using ProgramReader =
+        std::function<std::vector<GameMetadata>(const std::shared_ptr<FileSys::VfsFile>&)>;
+
     void AddTitlesToGameList(GameListDir* parent_dir);
 
-    enum class ScanTarget {
-        FillManualContentProvider,
-        PopulateGameList,
-    };
+    /// Returns the files in the directory the game list can show, watching its subdirectories.
+    std::vector<GameFile> CollectGameFiles(const std::string& dir_path, bool deep_scan);
+
+    /// Adds the contents of the files to the manual content provider.
+    void FillManualContentProvider(std::span<const std::vector<GameFile>> dir_files);
 
-    void ScanFileSystem(ScanTarget target, const std::string& dir_path, bool deep_scan,
-                        GameListDir* parent_dir);
+    /// Adds the programs in the files to the game list.
+    void PopulateGameList(std::span<const GameFile> files, GameListDir* parent_dir);
+
+    /**
+     * Adds the programs in a file to the game list. They are taken from the metadata database when
+     * the file did not change, otherwise read_programs parses them from the file.
+     */
+    void AddProgramsToGameList(const std::shared_ptr<FileSys::VfsFile>& file,
+                               const std::string& path, const ProgramReader& read_programs,
+                               GameListDir* parent_dir);
+
+    /// Returns a fingerprint of everything the add-ons of the program are computed from.
+    u64 GetAddOnsFingerprint(u64 program_id) const;
 
     std::shared_ptr<FileSys::VfsFilesystem> vfs;
     FileSys::ManualContentProvider* provider;
@@ -84,6 +111,10 @@ private:
 
     QStringList watch_list;
 
+    std::unique_ptr<GameListMetadata> metadata;
+    /// Hashes of the installed contents and game files providing titles, by base title ID.
+    std::multimap<u64, u64> title_sources;
+
     std::mutex lock;
     std::condition_variable cv;
     std::deque<std::function<void(GameList*)>> queued_events;
@@ -3102,12 +3102,21 @@ void GMainWindow::OnMenuInstallToNAND() {
         ContentManager::InstallResult result;
 
         if (file.endsWith(QStringLiteral("nsp"), Qt::CaseInsensitive)) {
-            const auto progress_callback = [this](size_t size, size_t progress) {
-                emit UpdateInstallProgress();
-                if (install_progress->wasCanceled()) {
-                    return true;
+            const auto progress_callback = [this, file_name = QFileInfo(file).fileName(),
+                                            reported_blocks = size_t{0}](
+                                               size_t, size_t progress,
+                                               size_t bytes_per_second) mutable {
+                // The progress dialog counts in blocks of CopyBufferSize.
+                for (; reported_blocks < progress / CopyBufferSize; ++reported_blocks) {
+                    emit UpdateInstallProgress();
                 }
-                return false;
+                const auto label = tr("Installing file \"%1\"... (%2 MB/s)")
+                                       .arg(file_name)
+                                       .arg(static_cast<double>(bytes_per_second) / 1'000'000.0,
+                                            0, 'f', 1);
+                QMetaObject::invokeMethod(install_progress,
+                                          [this, label] { install_progress->setLabelText(label); });
+                return install_progress->wasCanceled();
             };
             future = QtConcurrent::run([this, &file, progress_callback] {
                 return ContentManager::InstallNSP(*system, *vfs, file.toStdString(),
@@ -3951,6 +3960,15 @@ void GMainWindow::OnOpenSuyuFolder() {
 }
 
 void GMainWindow::OnVerifyInstalledContents() {
+    // Offer to skip what a cancelled verification already checked.
+    bool resume = false;
+    if (ContentManager::CanResumeVerification()) {
+        resume = QMessageBox::question(this, tr("Resume verification?"),
+                                       tr("A previous verification was cancelled. Do you want to "
+                                          "resume it, skipping the files it already verified?")) ==
+                 QMessageBox::Yes;
+    }
+
     // Initialize a progress dialog.
     QProgressDialog progress(tr("Verifying integrity..."), tr("Cancel"), 0, 100, this);
     progress.setWindowModality(Qt::WindowModal);
@@ -3964,8 +3982,8 @@ void GMainWindow::OnVerifyInstalledContents() {
         return progress.wasCanceled();
     };
 
-    const std::vector<std::string> result =
-        ContentManager::VerifyInstalledContents(*system, *provider, QtProgressCallback);
+    const std::vector<std::string> result = ContentManager::VerifyInstalledContents(
+        *system, *provider, QtProgressCallback, false, resume);
     progress.close();
 
     if (result.empty()) {
@@ -0,0 +1,172 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+
+#include <fmt/format.h>
+
+#include "common/scm_rev.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/device_memory.h"
+#include "suyu_cmd/benchmark.h"
+#include "video_core/gpu.h"
+#include "video_core/shader_notify.h"
+
+namespace {
+
+double ToSeconds(Core::PerfStats::Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+double ToSeconds(std::chrono::microseconds duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+void AppendEscaped(std::string& out, std::string_view str) {
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            out += c;
+        }
+    }
+}
+
+} // Anonymous namespace
+
+std::optional<BenchmarkLimit> ParseBenchmarkLimit(std::string_view str) {
+    const bool is_time = str.ends_with('s');
+    if (is_time) {
+        str.remove_suffix(1);
+    }
+    u64 value{};
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} || ptr != str.data() + str.size() || value == 0) {
+        return std::nullopt;
+    }
+    if (is_time) {
+        return BenchmarkLimit{.guest_time = std::chrono::seconds{value}};
+    }
+    return BenchmarkLimit{.frames = value};
+}
+
+Benchmark::Benchmark(Core::System& system_, BenchmarkLimit limit_)
+    : system{system_}, limit{limit_} {}
+
+void Benchmark::Start() {
+    begin = ReadCounters();
+}
+
+bool Benchmark::IsFinished() const {
+    if (limit.frames &&
+        system.GetPerfStats().GetTotalGameFrames() - begin.game_frames >= *limit.frames) {
+        return true;
+    }
+    if (limit.guest_time &&
+        system.CoreTiming().GetGlobalTimeUs() - begin.guest_time >= *limit.guest_time) {
+        return true;
+    }
+    return false;
+}
+
+void Benchmark::Stop() {
+    end = ReadCounters();
+}
+
+Benchmark::Counters Benchmark::ReadCounters() const {
+    const auto& perf_stats = system.GetPerfStats();
+    const auto& shader_notify = system.GPU().ShaderNotify();
+    Counters counters{
+        .wall_time = Core::PerfStats::Clock::now(),
+        .guest_time = system.CoreTiming().GetGlobalTimeUs(),
+        .game_frames = perf_stats.GetTotalGameFrames(),
+        .shaders_queued = shader_notify.ShadersQueued(),
+        .shaders_completed = shader_notify.ShadersCompleted(),
+        .core_time = {},
+        .gpu_thread_time = perf_stats.GetGpuThreadTime(),
+        .gpu_queue = perf_stats.GetGpuQueueStats(),
+    };
+    for (size_t core = 0; core < counters.core_time.size(); ++core) {
+        counters.core_time[core] = perf_stats.GetCoreTime(core);
+    }
+    return counters;
+}
+
+std::string Benchmark::Report() const {
+    const auto& perf_stats = system.GetPerfStats();
+    const double wall_time = ToSeconds(end.wall_time - begin.wall_time);
+    const double guest_time = ToSeconds(end.guest_time - begin.guest_time);
+    const u64 frames = end.game_frames - begin.game_frames;
+
+    std::string out;
+    auto it = std::back_inserter(out);
+    out += "{\n  \"version\": \"";
+    AppendEscaped(out, Common::g_scm_desc);
+    fmt::format_to(it, "\",\n  \"title_id\": \"{:016X}\",\n",
+                   system.GetApplicationProcessProgramID());
+    fmt::format_to(it, "  \"renderer\": \"{}\",\n",
+                   Settings::CanonicalizeEnum(Settings::values.renderer_backend.GetValue()));
+    fmt::format_to(it, "  \"multicore\": {},\n", system.IsMulticore());
+    fmt::format_to(it, "  \"frames\": {},\n", frames);
+    fmt::format_to(it, "  \"wall_time_s\": {:.6f},\n", wall_time);
+    fmt::format_to(it, "  \"guest_time_s\": {:.6f},\n", guest_time);
+    fmt::format_to(it, "  \"emulation_speed\": {:.6f},\n",
+                   wall_time > 0.0 ? guest_time / wall_time : 0.0);
+    fmt::format_to(it, "  \"average_fps\": {:.3f},\n",
+                   wall_time > 0.0 ? static_cast<double>(frames) / wall_time : 0.0);
+
+    // The histogram covers every system frame since boot, except the first few.
+    fmt::format_to(it, "  \"frametime_ms\": {{\n    \"mean\": {:.3f},\n    \"histogram\": [\n",
+                   perf_stats.GetMeanFrametime());
+    const auto histogram = perf_stats.GetFrametimeHistogram();
+    const auto& bounds = Core::PerfStats::FrametimeHistogramBounds;
+    for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+        const char* const separator = bucket + 1 < histogram.size() ? "," : "";
+        if (bucket < bounds.size()) {
+            fmt::format_to(it, "      {{\"max\": {:.1f}, \"count\": {}}}{}\n", bounds[bucket],
+                           histogram[bucket], separator);
+        } else {
+            fmt::format_to(it, "      {{\"max\": null, \"count\": {}}}{}\n", histogram[bucket],
+                           separator);
+        }
+    }
+    out += "    ]\n  },\n";
+
+    fmt::format_to(it, "  \"shaders\": {{\"queued\": {}, \"completed\": {}}},\n",
+                   end.shaders_queued - begin.shaders_queued,
+                   end.shaders_completed - begin.shaders_completed);
+
+    out += "  \"cpu_core_time_s\": [";
+    for (size_t core = 0; core < end.core_time.size(); ++core) {
+        fmt::format_to(it, "{}{:.6f}", core == 0 ? "" : ", ",
+                       ToSeconds(end.core_time[core] - begin.core_time[core]));
+    }
+    fmt::format_to(it, "],\n  \"gpu_thread_time_s\": {:.6f},\n",
+                   ToSeconds(end.gpu_thread_time - begin.gpu_thread_time));
+
+    // The maximums cover every command since boot.
+    const u64 gpu_commands = end.gpu_queue.commands - begin.gpu_queue.commands;
+    const double gpu_latency_us =
+        ToSeconds(end.gpu_queue.latency - begin.gpu_queue.latency) * 1'000'000.0;
+    const double gpu_depth = static_cast<double>(end.gpu_queue.depth - begin.gpu_queue.depth);
+    const double gpu_divisor = static_cast<double>(std::max<u64>(gpu_commands, 1));
+    fmt::format_to(it,
+                   "  \"gpu_queue\": {{\"commands\": {}, \"mean_latency_us\": {:.3f}, "
+                   "\"max_latency_us\": {:.3f}, \"mean_depth\": {:.3f}, \"max_depth\": {}}},\n",
+                   gpu_commands, gpu_latency_us / gpu_divisor,
+                   ToSeconds(end.gpu_queue.max_latency) * 1'000'000.0, gpu_depth / gpu_divisor,
+                   end.gpu_queue.max_depth);
+
+    // Huge page usage at the end of the run.
+    const auto huge_pages = system.DeviceMemory().buffer.GetHugePageStats();
+    fmt::format_to(it,
+                   "  \"huge_pages\": {{\"backing_bytes\": {}, \"mapped_bytes\": {}, "
+                   "\"eligible_bytes\": {}}}\n}}\n",
+                   huge_pages.backing_bytes, huge_pages.mapped_bytes, huge_pages.eligible_bytes);
+    return out;
+}
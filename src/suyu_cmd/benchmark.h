@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "common/common_types.h"
+#include "core/hardware_properties.h"
+#include "core/perf_stats.h"
+
+namespace Core {
+class System;
+}
+
+/// Condition ending a benchmark run.
+struct BenchmarkLimit {
+    /// Number of game frames to present, if the run is limited by frames.
+    std::optional<u64> frames;
+    /// Amount of emulated time to run for, if the run is limited by guest time.
+    std::optional<std::chrono::microseconds> guest_time;
+};
+
+/**
+ * Parses a benchmark limit, either a number of frames ("600") or a number of guest seconds with an
+ * "s" suffix ("30s").
+ */
+std::optional<BenchmarkLimit> ParseBenchmarkLimit(std::string_view str);
+
+/**
+ * Measures a headless run of the loaded title until a BenchmarkLimit is reached, and produces a
+ * machine-readable JSON report from the performance counters of the system.
+ */
+class Benchmark {
+public:
+    explicit Benchmark(Core::System& system_, BenchmarkLimit limit_);
+
+    /// Takes the baseline of all counters, called once emulation is running.
+    void Start();
+
+    /// Returns true when the limit of the run has been reached.
+    [[nodiscard]] bool IsFinished() const;
+
+    /// Takes the final value of all counters. Emulation should be paused before calling this.
+    void Stop();
+
+    /// Returns the report of the run as a JSON object.
+    [[nodiscard]] std::string Report() const;
+
+private:
+    struct Counters {
+        Core::PerfStats::Clock::time_point wall_time;
+        std::chrono::microseconds guest_time;
+        u64 game_frames;
+        int shaders_queued;
+        int shaders_completed;
+        std::array<Core::PerfStats::Clock::duration, Core::Hardware::NUM_CPU_CORES> core_time;
+        Core::PerfStats::Clock::duration gpu_thread_time;
+        Core::GpuQueueStats gpu_queue;
+    };
+
+    [[nodiscard]] Counters ReadCounters() const;
+
+    Core::System& system;
+    const BenchmarkLimit limit;
+
+    Counters begin{};
+    Counters end{};
+};
@@ -150,11 +150,15 @@ void EmuWindow_SDL2::Fullscreen() {
     }
 }
 
-void EmuWindow_SDL2::WaitEvent() {
+void EmuWindow_SDL2::WaitEvent(int timeout_ms) {
     // Called on main thread
     SDL_Event event;
 
-    if (!SDL_WaitEvent(&event)) {
+    if (!SDL_WaitEventTimeout(&event, timeout_ms)) {
+        if (timeout_ms >= 0) {
+            // Timed out without any event to handle.
+            return;
+        }
         const char* error = SDL_GetError();
         if (!error || strcmp(error, "") == 0) {
             // https://github.com/libsdl-org/SDL/issues/5780
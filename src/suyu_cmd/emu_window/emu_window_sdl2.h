@@ -30,8 +30,8 @@ public:
     /// Returns if window is shown (not minimized)
     bool IsShown() const override;
 
-    /// Wait for the next event on the main thread.
-    void WaitEvent();
+    /// Wait for the next event on the main thread, or at most timeout_ms when it is not negative.
+    void WaitEvent(int timeout_ms = -1);
 
     // Sets the window icon from suyu.bmp
     void SetWindowIcon();
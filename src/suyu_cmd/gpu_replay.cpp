@@ -0,0 +1,250 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "common/detached_tasks.h"
+#include "common/fs/file.h"
+#include "common/logging/backend.h"
+#include "common/logging/log.h"
+#include "common/nvidia_flags.h"
+#include "common/scm_rev.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "input_common/main.h"
+#include "sdl_config.h"
+#include "suyu_cmd/emu_window/emu_window_sdl2.h"
+#include "suyu_cmd/emu_window/emu_window_sdl2_gl.h"
+#include "suyu_cmd/emu_window/emu_window_sdl2_null.h"
+#include "suyu_cmd/emu_window/emu_window_sdl2_vk.h"
+#include "video_core/engines/engine_interface.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_trace.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Tegra::Trace::Player;
+
+void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <trace>\n"
+                 "Replays a GPU trace recorded with dump_gpu_trace as fast as possible\n"
+                 "-c, --config          Load the specified configuration file\n"
+                 "-h, --help            Display this help and exit\n"
+                 "-n, --iterations      Replay the trace the given number of times\n"
+                 "-r, --report          Write the replay report to the given file\n"
+                 "-v, --version         Output version information and exit\n";
+}
+
+void PrintVersion() {
+    std::cout << "suyu-gpu-replay " << Common::g_scm_branch << " " << Common::g_scm_desc
+              << std::endl;
+}
+
+double ToSeconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+double PerSecond(u64 count, double seconds) {
+    return seconds > 0.0 ? static_cast<double>(count) / seconds : 0.0;
+}
+
+std::string Report(const Player::Statistics& stats, u64 iterations) {
+    using Tegra::Engines::EngineTypes;
+    const auto index = [](EngineTypes type) { return static_cast<std::size_t>(type); };
+    const std::array<std::pair<std::size_t, std::string_view>, 6> engines{{
+        {index(EngineTypes::Maxwell3D), "maxwell_3d"},
+        {index(EngineTypes::Fermi2D), "fermi_2d"},
+        {index(EngineTypes::KeplerCompute), "kepler_compute"},
+        {index(EngineTypes::MaxwellDMA), "maxwell_dma"},
+        {index(EngineTypes::KeplerMemory), "kepler_memory"},
+        {Player::PullerIndex, "puller"},
+    }};
+
+    u64 methods = 0;
+    for (const u64 engine_methods : stats.engines.methods) {
+        methods += engine_methods;
+    }
+    const double wall_time = ToSeconds(stats.wall_time);
+
+    std::string out;
+    auto it = std::back_inserter(out);
+    out += "{\n";
+    fmt::format_to(it, "  \"iterations\": {},\n", iterations);
+    fmt::format_to(it, "  \"renderer\": \"{}\",\n",
+                   Settings::CanonicalizeEnum(Settings::values.renderer_backend.GetValue()));
+    fmt::format_to(it, "  \"submissions\": {},\n", stats.submissions);
+    fmt::format_to(it, "  \"command_lists\": {},\n", stats.command_lists);
+    fmt::format_to(it, "  \"pages\": {},\n", stats.pages);
+    fmt::format_to(it, "  \"draws\": {},\n", stats.draws);
+    fmt::format_to(it, "  \"methods\": {},\n", methods);
+    fmt::format_to(it, "  \"state_methods\": {},\n", stats.engines.state_methods);
+    fmt::format_to(it, "  \"wall_time_s\": {:.6f},\n", wall_time);
+    fmt::format_to(it, "  \"draws_per_s\": {:.3f},\n", PerSecond(stats.draws, wall_time));
+    fmt::format_to(it, "  \"methods_per_s\": {:.3f},\n", PerSecond(methods, wall_time));
+    out += "  \"engines\": {\n";
+    for (std::size_t i = 0; i < engines.size(); ++i) {
+        const auto [engine, name] = engines[i];
+        fmt::format_to(it, "    \"{}\": {{\"methods\": {}, \"time_s\": {:.6f}}}{}\n", name,
+                       stats.engines.methods[engine], ToSeconds(stats.engines.time[engine]),
+                       i + 1 < engines.size() ? "," : "");
+    }
+    out += "  }\n}\n";
+    return out;
+}
+
+} // Anonymous namespace
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Common::Log::Initialize();
+    Common::Log::SetColorConsoleBackendEnabled(true);
+    Common::Log::Start();
+    Common::DetachedTasks detached_tasks;
+
+    std::string trace_path;
+    std::optional<std::string> config_path;
+    std::optional<std::string> report_path;
+    u64 iterations = 1;
+
+    int option_index = 0;
+    static struct option long_options[] = {
+        // clang-format off
+        {"config", required_argument, 0, 'c'},
+        {"help", no_argument, 0, 'h'},
+        {"iterations", required_argument, 0, 'n'},
+        {"report", required_argument, 0, 'r'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+        // clang-format on
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "c:hn:r:v", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'c':
+                config_path = optarg;
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'n': {
+                const auto [ptr, ec] =
+                    std::from_chars(optarg, optarg + std::strlen(optarg), iterations);
+                if (ec != std::errc{} || *ptr != '\0' || iterations == 0) {
+                    std::cout << "Wrong format for option --iterations\n";
+                    PrintHelp(argv[0]);
+                    return 0;
+                }
+                break;
+            }
+            case 'r':
+                report_path = optarg;
+                break;
+            case 'v':
+                PrintVersion();
+                return 0;
+            }
+        } else {
+            trace_path = argv[optind];
+            optind++;
+        }
+    }
+
+    if (trace_path.empty()) {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    SdlConfig config{config_path};
+
+    Common::Log::Filter filter;
+    filter.ParseFilterString(Settings::values.log_filter.GetValue());
+    Common::Log::SetGlobalFilter(filter);
+
+    // Commands are replayed on the thread submitting them, so their time is measured there, and
+    // the replay is not recorded again.
+    Settings::values.use_asynchronous_gpu_emulation.SetValue(false);
+    Settings::values.dump_gpu_trace.SetValue(false);
+
+    Common::ConfigureNvidiaEnvironmentFlags();
+
+    if (!Tegra::Trace::Reader{trace_path}.IsOpen()) {
+        LOG_CRITICAL(Frontend, "Failed to open GPU trace {}", trace_path);
+        return -1;
+    }
+
+    Core::System system{};
+    system.Initialize();
+
+    InputCommon::InputSubsystem input_subsystem{};
+
+    system.ApplySettings();
+
+    std::unique_ptr<EmuWindow_SDL2> emu_window;
+    switch (Settings::values.renderer_backend.GetValue()) {
+    case Settings::RendererBackend::OpenGL:
+        emu_window = std::make_unique<EmuWindow_SDL2_GL>(&input_subsystem, system, false);
+        break;
+    case Settings::RendererBackend::Vulkan:
+        emu_window = std::make_unique<EmuWindow_SDL2_VK>(&input_subsystem, system, false);
+        break;
+    case Settings::RendererBackend::Null:
+        emu_window = std::make_unique<EmuWindow_SDL2_Null>(&input_subsystem, system, false);
+        break;
+    }
+
+    if (system.SetupForGPUReplay(*emu_window) != Core::SystemResultStatus::Success) {
+        LOG_CRITICAL(Frontend, "Failed to set up the GPU for the replay");
+        return -1;
+    }
+    system.GPU().Start();
+
+    int result = 0;
+    {
+        Player player{system};
+        for (u64 iteration = 0; iteration < iterations; ++iteration) {
+            Tegra::Trace::Reader reader{trace_path};
+            if (!player.Play(reader)) {
+                LOG_ERROR(Frontend, "GPU trace {} is malformed, the replay stopped early",
+                          trace_path);
+                result = -1;
+                break;
+            }
+        }
+
+        const std::string report = Report(player.GetStatistics(), iterations);
+        if (report_path.has_value()) {
+            Common::FS::IOFile file{*report_path, Common::FS::FileAccessMode::Write,
+                                    Common::FS::FileType::TextFile};
+            if (file.WriteString(report) != report.size()) {
+                LOG_ERROR(Frontend, "Failed to write the replay report to {}", *report_path);
+            }
+        } else {
+            std::cout << report;
+        }
+    }
+    system.ShutdownMainProcess();
+
+    detached_tasks.WaitForAllTasks();
+    return result;
+}
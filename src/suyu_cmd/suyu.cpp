@@ -11,9 +11,11 @@
 #include <fmt/ostream.h>
 
 #include "common/detached_tasks.h"
+#include "common/fs/file.h"
 #include "common/logging/backend.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/microprofile_trace.h"
 #include "common/nvidia_flags.h"
 #include "common/scm_rev.h"
 #include "common/scope_exit.h"
@@ -34,6 +36,7 @@
 #include "input_common/main.h"
 #include "network/network.h"
 #include "sdl_config.h"
+#include "suyu_cmd/benchmark.h"
 #include "suyu_cmd/emu_window/emu_window_sdl2.h"
 #include "suyu_cmd/emu_window/emu_window_sdl2_gl.h"
 #include "suyu_cmd/emu_window/emu_window_sdl2_null.h"
@@ -78,6 +81,8 @@ static void PrintHelp(const char* argv0) {
                  "-m, --multiplayer=nick:password@address:port"
                  " Nickname, password, address and port for multiplayer\n"
                  "-p, --program         Pass following string as arguments to executable\n"
+                 "-r, --report          Write the benchmark report to the given file\n"
+                 "-t, --trace           Write a Chrome trace of profiling scopes to a file\n"
                  "-u, --user            Select a specific user profile from 0 to 7\n"
                  "-v, --version         Output version information and exit\n";
 }
@@ -211,6 +216,9 @@ int main(int argc, char** argv) {
     std::optional<std::string> config_path;
     std::string program_args;
     std::optional<int> selected_user;
+    std::optional<std::string> trace_path;
+    std::optional<BenchmarkLimit> benchmark_limit;
+    std::optional<std::string> report_path;
 
     bool use_multiplayer = false;
     bool fullscreen = false;
@@ -221,12 +229,15 @@ int main(int argc, char** argv) {
 
     static struct option long_options[] = {
         // clang-format off
+        {"benchmark", required_argument, 0, 'b'},
         {"config", required_argument, 0, 'c'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"game", required_argument, 0, 'g'},
         {"multiplayer", required_argument, 0, 'm'},
         {"program", optional_argument, 0, 'p'},
+        {"report", required_argument, 0, 'r'},
+        {"trace", required_argument, 0, 't'},
         {"user", required_argument, 0, 'u'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
@@ -234,9 +245,17 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:fhvp::c:u:", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "b:g:fhvp::c:r:t:u:", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
+            case 'b':
+                benchmark_limit = ParseBenchmarkLimit(optarg);
+                if (!benchmark_limit) {
+                    std::cout << "Wrong format for option --benchmark\n";
+                    PrintHelp(argv[0]);
+                    return 0;
+                }
+                break;
             case 'c':
                 config_path = optarg;
                 break;
@@ -289,6 +308,12 @@ int main(int argc, char** argv) {
                 program_args = argv[optind];
                 ++optind;
                 break;
+            case 'r':
+                report_path = optarg;
+                break;
+            case 't':
+                trace_path = optarg;
+                break;
             case 'u':
                 selected_user = atoi(optarg);
                 break;
@@ -313,6 +338,7 @@ int main(int argc, char** argv) {
     Common::Log::Filter filter;
     filter.ParseFilterString(Settings::values.log_filter.GetValue());
     Common::Log::SetGlobalFilter(filter);
+    Common::Log::SetDeferredFormattingEnabled(Settings::values.log_deferred_formatting.GetValue());
 
     if (!program_args.empty()) {
         Settings::values.program_args = program_args;
@@ -322,15 +348,25 @@ int main(int argc, char** argv) {
         Settings::values.current_user = std::clamp(*selected_user, 0, 7);
     }
 
+    if (benchmark_limit.has_value()) {
+        // Measure how fast the title can run, not how well it keeps up with the console.
+        Settings::values.use_speed_limit.SetValue(false);
+    }
+
 #ifdef _WIN32
     LocalFree(argv_w);
 #endif
 
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT {
+        Common::MicroProfileTrace::Stop();
         MicroProfileShutdown();
     };
 
+    if (trace_path.has_value()) {
+        Common::MicroProfileTrace::Start(*trace_path);
+    }
+
     Common::ConfigureNvidiaEnvironmentFlags();
 
     if (filepath.empty()) {
@@ -439,15 +475,41 @@ int main(int argc, char** argv) {
     Common::Linux::StartGamemode();
 #endif
 
+    std::optional<Benchmark> benchmark;
+    if (benchmark_limit.has_value()) {
+        benchmark.emplace(system, *benchmark_limit);
+        benchmark->Start();
+    }
+
     void(system.Run());
     if (system.DebuggerEnabled()) {
         system.InitializeDebugger();
     }
-    while (emu_window->IsOpen()) {
-        emu_window->WaitEvent();
+    if (benchmark.has_value()) {
+        while (emu_window->IsOpen() && !benchmark->IsFinished()) {
+            emu_window->WaitEvent(10);
+        }
+    } else {
+        while (emu_window->IsOpen()) {
+            emu_window->WaitEvent();
+        }
     }
     system.DetachDebugger();
     void(system.Pause());
+
+    if (benchmark.has_value()) {
+        benchmark->Stop();
+        const std::string report = benchmark->Report();
+        if (report_path.has_value()) {
+            Common::FS::IOFile file{*report_path, Common::FS::FileAccessMode::Write,
+                                    Common::FS::FileType::TextFile};
+            if (file.WriteString(report) != report.size()) {
+                LOG_ERROR(Frontend, "Failed to write the benchmark report to {}", *report_path);
+            }
+        } else {
+            std::cout << report;
+        }
+    }
     system.ShutdownMainProcess();
 
 #ifdef __unix__
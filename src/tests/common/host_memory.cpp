@@ -184,3 +184,44 @@ TEST_CASE("HostMemory: Partial sparse middle unmap and check bindings", "[common
     REQUIRE(ptr[0x0000] == 19);
     REQUIRE(ptr[0x3fff] == 12);
 }
+
+TEST_CASE("HostMemory: Huge page mirror map", "[common]") {
+    HostMemory mem(BACKING_SIZE, VIRTUAL_SIZE, true);
+    mem.Map(0x400000, 0x200000, 0x400000, PERMS, HEAP);
+    mem.Map(0x1000000, 0x200000, 0x200000, PERMS, HEAP);
+
+    volatile u8* const mirror_a = mem.VirtualBasePointer() + 0x400000;
+    volatile u8* const mirror_b = mem.VirtualBasePointer() + 0x1000000;
+    mirror_a[0x1234] = 56;
+    REQUIRE(mirror_b[0x1234] == 56);
+    REQUIRE(mem.GetHugePageStats().eligible_bytes == 0x600000);
+}
+
+TEST_CASE("HostMemory: Huge page split", "[common]") {
+    HostMemory mem(BACKING_SIZE, VIRTUAL_SIZE, true);
+    mem.Map(0x400000, 0x200000, 0x600000, PERMS, HEAP);
+    REQUIRE(mem.GetHugePageStats().eligible_bytes == 0x600000);
+
+    // Remapping a page in the middle splits the huge page holding it.
+    mem.Map(0x601000, 0x10000, 0x1000, PERMS, HEAP);
+    REQUIRE(mem.GetHugePageStats().eligible_bytes == 0x400000);
+
+    // Protecting whole huge pages keeps them, partial ones are split.
+    mem.Protect(0x800000, 0x200000, Common::MemoryPermission::Read);
+    REQUIRE(mem.GetHugePageStats().eligible_bytes == 0x400000);
+    mem.Protect(0x400000, 0x1000, Common::MemoryPermission::Read);
+    REQUIRE(mem.GetHugePageStats().eligible_bytes == 0x200000);
+
+    mem.Unmap(0x800000, 0x1000, HEAP);
+    REQUIRE(mem.GetHugePageStats().eligible_bytes == 0);
+}
+
+TEST_CASE("HostMemory: Huge page misaligned map", "[common]") {
+    HostMemory mem(BACKING_SIZE, VIRTUAL_SIZE, true);
+    mem.Map(0x400000, 0x201000, 0x400000, PERMS, HEAP);
+
+    volatile u8* const data = mem.VirtualBasePointer() + 0x400000;
+    data[0x3fffff] = 91;
+    REQUIRE(data[0x3fffff] == 91);
+    REQUIRE(mem.GetHugePageStats().eligible_bytes == 0);
+}
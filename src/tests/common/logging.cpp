@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/bounded_threadsafe_queue.h"
+#include "common/logging/deferred.h"
+#include "common/logging/log_entry.h"
+#include "common/logging/log_ring.h"
+#include "common/polyfill_thread.h"
+
+namespace Common::Log {
+namespace {
+
+enum class TestEnum : u16 {
+    Value = 7,
+};
+
+/// Serializes the arguments into a buffer and formats them back, as the backend thread would.
+template <typename... Args>
+std::string RoundTrip(fmt::format_string<Args...> format, const Args&... args) {
+    std::vector<u8> buffer(Detail::DeferredArgsSize(args...));
+    Detail::EncodeDeferredArgs(buffer.data(), args...);
+    return Detail::FormatDeferred<Args...>(format, buffer.data());
+}
+
+template <std::size_t Capacity, typename... Args>
+bool PushDeferred(LogRing<Capacity>& ring, fmt::format_string<Args...> format,
+                  const Args&... args) {
+    const fmt::string_view format_view = format;
+    const std::size_t args_size = Detail::DeferredArgsSize(args...);
+    u8* const data = ring.Reserve(sizeof(Detail::DeferredRecord) + args_size);
+    if (data == nullptr) {
+        return false;
+    }
+    const Detail::DeferredRecord record{
+        .time = std::chrono::steady_clock::now(),
+        .filename = __FILE__,
+        .function = __func__,
+        .format_data = format_view.data(),
+        .format_size = format_view.size(),
+        .formatter = &Detail::FormatDeferred<Args...>,
+        .line_num = __LINE__,
+        .log_class = Class::Log,
+        .log_level = Level::Debug,
+    };
+    std::memcpy(data, &record, sizeof(record));
+    Detail::EncodeDeferredArgs(data + sizeof(record), args...);
+    ring.Commit();
+    return true;
+}
+
+std::string FormatRecord(const u8* data) {
+    Detail::DeferredRecord record;
+    std::memcpy(&record, data, sizeof(record));
+    return record.formatter({record.format_data, record.format_size}, data + sizeof(record));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Log[DeferredArgs]", "[common]") {
+    const std::string str = "string";
+    const char array[] = "array";
+    const char* null_str = nullptr;
+
+    REQUIRE(RoundTrip("{} {} {}", 1, -2LL, 3.5) == fmt::format("{} {} {}", 1, -2LL, 3.5));
+    REQUIRE(RoundTrip("{:08X} {}", u32{0xBEEF}, true) == "0000BEEF true");
+    REQUIRE(RoundTrip("{} {} {} {}", str, std::string_view{"view"}, array, "literal") ==
+            "string view array literal");
+    REQUIRE(RoundTrip("{}", null_str) == "(null)");
+    REQUIRE(RoundTrip("{}", TestEnum::Value) == "7");
+    REQUIRE(RoundTrip("no arguments") == "no arguments");
+
+    STATIC_REQUIRE(Detail::CanDefer<int, std::string, const char*, TestEnum, const void*>);
+    STATIC_REQUIRE(!Detail::CanDefer<int, std::vector<int>>);
+}
+
+TEST_CASE("Log[DeferredLargeRecord]", "[common]") {
+    // Messages too large for the ring are left to eager formatting instead of being dropped.
+    const std::string large(Detail::MaxDeferredArgsSize, 'x');
+    REQUIRE(!Detail::DeferredLogMessage(Class::Log, Level::Info, __FILE__, __LINE__, __func__,
+                                        "{}", large));
+
+    LogRing<Detail::DeferredRingSize> ring;
+    const std::string largest(Detail::MaxDeferredArgsSize - sizeof(u32), 'x');
+    REQUIRE(PushDeferred(ring, "{}", largest));
+}
+
+TEST_CASE("LogRing[Wraparound]", "[common]") {
+    LogRing<1024> ring;
+    std::size_t pushed = 0;
+    std::size_t popped = 0;
+
+    // Push records of varying sizes so that the write position wraps around at different offsets.
+    for (std::size_t i = 0; i < 1000; ++i) {
+        const std::string payload(i % 40, 'x');
+        REQUIRE(PushDeferred(ring, "{} {}", i, payload));
+        ++pushed;
+        ring.Drain([&](const u8* data, std::size_t) {
+            const std::string expected =
+                fmt::format("{} {}", popped, std::string(popped % 40, 'x'));
+            REQUIRE(FormatRecord(data) == expected);
+            ++popped;
+        });
+    }
+    REQUIRE(popped == pushed);
+    REQUIRE(ring.Empty());
+    REQUIRE(ring.TakeDroppedCount() == 0);
+}
+
+TEST_CASE("LogRing[Overflow]", "[common]") {
+    LogRing<1024> ring;
+    std::size_t pushed = 0;
+    while (PushDeferred(ring, "{}", pushed)) {
+        ++pushed;
+    }
+    REQUIRE(pushed > 0);
+    REQUIRE(!PushDeferred(ring, "{}", pushed));
+    REQUIRE(ring.TakeDroppedCount() == 2);
+    REQUIRE(ring.TakeDroppedCount() == 0);
+
+    std::size_t popped = 0;
+    REQUIRE(ring.Drain([&](const u8*, std::size_t) { ++popped; }) == pushed);
+    REQUIRE(popped == pushed);
+    REQUIRE(PushDeferred(ring, "{}", pushed));
+}
+
+// Compares the cost paid by the logging thread per call site. Hidden by default; run with
+// `tests "[logging-benchmark]"`.
+TEST_CASE("Log[CallSiteBenchmark]", "[.][logging-benchmark]") {
+    constexpr std::size_t id = 0x1234;
+    const std::string name = "nvhost-ctrl-gpu";
+
+    BENCHMARK_ADVANCED("Eager formatting")(Catch::Benchmark::Chronometer meter) {
+        MPSCQueue<Entry> queue;
+        std::jthread consumer([&queue](std::stop_token stop_token) {
+            Entry entry;
+            while (!stop_token.stop_requested()) {
+                queue.PopWait(entry, stop_token);
+            }
+        });
+        meter.measure([&] {
+            queue.EmplaceWait(Entry{
+                .timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()),
+                .log_class = Class::Service_NVDRV,
+                .log_level = Level::Debug,
+                .filename = __FILE__,
+                .line_num = __LINE__,
+                .function = __func__,
+                .message = fmt::format("called, id=0x{:X} name={} size={}", id, name, 0x80),
+            });
+        });
+    };
+
+    BENCHMARK_ADVANCED("Deferred formatting")(Catch::Benchmark::Chronometer meter) {
+        auto ring = std::make_unique<LogRing<256 * 1024>>();
+        std::jthread consumer([&ring](std::stop_token stop_token) {
+            while (!stop_token.stop_requested()) {
+                ring->Drain([](const u8* data, std::size_t) { (void)FormatRecord(data); });
+            }
+        });
+        meter.measure([&] {
+            return PushDeferred(*ring, "called, id=0x{:X} name={} size={}", id, name, 0x80);
+        });
+    };
+}
+
+} // namespace Common::Log
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <span>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/fs/mapped_file.h"
+
+namespace Common::FS {
+
+namespace {
+
+struct TemporaryPath {
+    TemporaryPath() {
+        std::filesystem::remove(path);
+    }
+    ~TemporaryPath() {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path{std::filesystem::temp_directory_path() /
+                               "suyu_mapped_file_test.bin"};
+};
+
+constexpr std::array<u8, 4> Data{0x12, 0x34, 0x56, 0x78};
+
+bool IsZero(std::span<const u8> data) {
+    return std::ranges::all_of(data, [](u8 value) { return value == 0; });
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MappedFile: Missing files are created for writing only", "[common]") {
+    TemporaryPath temp;
+    MappedFile file;
+    REQUIRE(!file.Open(temp.path, FileAccessMode::Read));
+    REQUIRE(!file.IsOpen());
+    REQUIRE(!std::filesystem::exists(temp.path));
+
+    REQUIRE(file.Open(temp.path, FileAccessMode::ReadWrite, 0x3000));
+    REQUIRE(file.GetSize() == 0x3000);
+    REQUIRE(std::filesystem::file_size(temp.path) == 0x3000);
+    REQUIRE(IsZero({file.Data(), file.GetSize()}));
+
+    // Writes are visible through the mapping, and must fit in it.
+    REQUIRE(file.Write(0x1FFE, Data));
+    REQUIRE(std::ranges::equal(std::span{file.Data() + 0x1FFE, Data.size()}, Data));
+    REQUIRE(!file.Write(0x2FFE, Data));
+    REQUIRE(file.Flush());
+}
+
+TEST_CASE("MappedFile: Reopened files keep their contents", "[common]") {
+    TemporaryPath temp;
+    {
+        MappedFile file;
+        REQUIRE(file.Open(temp.path, FileAccessMode::ReadWrite, 0x2000));
+        REQUIRE(file.Write(0x100, Data));
+    }
+
+    MappedFile file;
+    REQUIRE(file.Open(temp.path, FileAccessMode::Read));
+    REQUIRE(file.GetSize() == 0x2000);
+    REQUIRE(std::ranges::equal(std::span{file.Data() + 0x100, Data.size()}, Data));
+    REQUIRE(!file.Write(0, Data));
+
+    REQUIRE(file.Open(temp.path, FileAccessMode::ReadWrite, 0x2000));
+    REQUIRE(std::ranges::equal(std::span{file.Data() + 0x100, Data.size()}, Data));
+}
+
+TEST_CASE("MappedFile: Truncated files are mapped at their new size", "[common]") {
+    TemporaryPath temp;
+    {
+        MappedFile file;
+        REQUIRE(file.Open(temp.path, FileAccessMode::ReadWrite, 0x2000));
+        REQUIRE(file.Write(0x100, Data));
+        REQUIRE(file.Write(0x1800, Data));
+    }
+    std::filesystem::resize_file(temp.path, 0x1000);
+
+    MappedFile file;
+    REQUIRE(file.Open(temp.path, FileAccessMode::Read));
+    REQUIRE(file.GetSize() == 0x1000);
+    REQUIRE(std::ranges::equal(std::span{file.Data() + 0x100, Data.size()}, Data));
+
+    // Extending the file again reads the truncated part as zeroes.
+    REQUIRE(file.Open(temp.path, FileAccessMode::ReadWrite, 0x2000));
+    REQUIRE(std::ranges::equal(std::span{file.Data() + 0x100, Data.size()}, Data));
+    REQUIRE(IsZero({file.Data() + 0x1000, 0x1000}));
+
+    std::filesystem::resize_file(temp.path, 0);
+    REQUIRE(!file.Open(temp.path, FileAccessMode::Read));
+}
+
+} // namespace Common::FS
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "common/page_table.h"
+
+namespace Common {
+
+namespace {
+
+constexpr std::size_t PageBits = 12;
+constexpr std::size_t PageSize = 1ULL << PageBits;
+constexpr std::size_t AddressSpaceBits = 32;
+
+/// Maps pages of the table to host memory the same way Core::Memory does.
+void MapPages(PageTable& page_table, u64 vaddr, u8* host, std::size_t size, u64 backing,
+              PageType type) {
+    for (u64 page = vaddr >> PageBits; page < (vaddr + size) >> PageBits; ++page) {
+        const u64 page_vaddr = page << PageBits;
+        const uintptr_t pointer =
+            type == PageType::Memory ? reinterpret_cast<uintptr_t>(host) - page_vaddr : 0;
+        page_table.pointers[page].Store(pointer, type);
+        page_table.backing_addr[page] = backing - page_vaddr;
+        host += PageSize;
+        backing += PageSize;
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PageTable: Contiguous page count", "[common]") {
+    PageTable page_table;
+    page_table.Resize(AddressSpaceBits, PageBits);
+    std::vector<u8> host(PageSize * 16);
+
+    // Two mappings next to each other in guest memory, but swapped in host memory.
+    MapPages(page_table, 0x10000, host.data() + PageSize * 8, PageSize * 4, 0x8000,
+             PageType::Memory);
+    MapPages(page_table, 0x14000, host.data(), PageSize * 8, 0x0, PageType::Memory);
+
+    REQUIRE(page_table.GetContiguousPageCount(0x10, 16) == 4);
+    REQUIRE(page_table.GetContiguousPageCount(0x11, 16) == 3);
+    REQUIRE(page_table.GetContiguousPageCount(0x14, 16) == 8);
+    REQUIRE(page_table.GetContiguousPageCount(0x14, 5) == 5);
+    REQUIRE(page_table.GetContiguousPageCount(0x1c, 1) == 1);
+
+    // A page of a different type ends the run, even when its backing memory follows.
+    page_table.pointers[0x16].Store(0, PageType::RasterizerCachedMemory);
+    REQUIRE(page_table.GetContiguousPageCount(0x14, 16) == 2);
+    REQUIRE(page_table.GetContiguousPageCount(0x16, 16) == 1);
+    REQUIRE(page_table.GetContiguousPageCount(0x17, 16) == 5);
+
+    // Unmapped pages form runs of their own.
+    REQUIRE(page_table.GetContiguousPageCount(0x20, 16) == 16);
+}
+
+} // namespace Common
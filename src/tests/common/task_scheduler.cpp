@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/task_scheduler.h"
+#include "common/thread.h"
+
+namespace Common {
+
+TEST_CASE("TaskQueue[Completion]", "[common]") {
+    TaskScheduler scheduler{4};
+    TaskQueue queue{TaskPriority::ShaderCompile, 3, scheduler};
+
+    std::atomic<size_t> sum{};
+    for (size_t i = 1; i <= 1000; ++i) {
+        queue.QueueWork([&sum, i] { sum += i; });
+    }
+    queue.WaitForRequests();
+    REQUIRE(sum == 1000 * 1001 / 2);
+}
+
+TEST_CASE("TaskQueue[SerialOrder]", "[common]") {
+    TaskScheduler scheduler{4};
+    TaskQueue queue{TaskPriority::BackgroundIO, 1, scheduler};
+
+    std::vector<size_t> order;
+    std::atomic<size_t> concurrent{};
+    bool overlapped = false;
+    for (size_t i = 0; i < 500; ++i) {
+        queue.QueueWork([&, i] {
+            if (++concurrent > 1) {
+                overlapped = true;
+            }
+            order.push_back(i);
+            --concurrent;
+        });
+    }
+    queue.WaitForRequests();
+
+    REQUIRE(!overlapped);
+    REQUIRE(order.size() == 500);
+    for (size_t i = 0; i < order.size(); ++i) {
+        REQUIRE(order[i] == i);
+    }
+}
+
+TEST_CASE("TaskQueue[Nested]", "[common]") {
+    // Every worker blocks on an inner queue; waiters must run the inner tasks themselves.
+    TaskScheduler scheduler{2};
+    TaskQueue outer{TaskPriority::TextureTranscode, 2, scheduler};
+    TaskQueue inner{TaskPriority::FrameCritical, 2, scheduler};
+
+    std::atomic<size_t> count{};
+    for (size_t i = 0; i < 8; ++i) {
+        outer.QueueWork([&] {
+            for (size_t j = 0; j < 16; ++j) {
+                inner.QueueWork([&] { ++count; });
+            }
+            inner.WaitForRequests();
+        });
+    }
+    outer.WaitForRequests();
+    REQUIRE(count == 8 * 16);
+}
+
+TEST_CASE("TaskQueue[Priority]", "[common]") {
+    TaskScheduler scheduler{1};
+    TaskQueue background{TaskPriority::BackgroundIO, 1, scheduler};
+    TaskQueue critical{TaskPriority::FrameCritical, 1, scheduler};
+
+    // Keep the only worker busy until both queues have work pending.
+    Common::Event started;
+    Common::Event release;
+    Common::Event done;
+    std::mutex mutex;
+    std::vector<TaskPriority> order;
+    background.QueueWork([&] {
+        started.Set();
+        release.Wait();
+    });
+    for (size_t i = 0; i < 4; ++i) {
+        background.QueueWork([&, i] {
+            std::scoped_lock lock{mutex};
+            order.push_back(TaskPriority::BackgroundIO);
+            if (i == 3) {
+                done.Set();
+            }
+        });
+    }
+    started.Wait();
+    critical.QueueWork([&] {
+        std::scoped_lock lock{mutex};
+        order.push_back(TaskPriority::FrameCritical);
+    });
+    // Don't wait through the queues, the waiting thread would run their tasks itself.
+    release.Set();
+    done.Wait();
+    critical.WaitForRequests();
+    background.WaitForRequests();
+
+    REQUIRE(order.size() == 5);
+    REQUIRE(order.front() == TaskPriority::FrameCritical);
+}
+
+TEST_CASE("TaskQueue[Stop]", "[common]") {
+    TaskScheduler scheduler{2};
+    TaskQueue queue{TaskPriority::ShaderCompile, 1, scheduler};
+
+    std::stop_source stop_source;
+    std::atomic<size_t> count{};
+    queue.QueueWork([&] { stop_source.request_stop(); });
+    for (size_t i = 0; i < 100; ++i) {
+        queue.QueueWork([&] { ++count; });
+    }
+    queue.WaitForRequests(stop_source.get_token());
+    REQUIRE(count < 100);
+}
+
+} // namespace Common
@@ -4,12 +4,15 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <chrono>
 #include <cstdlib>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -139,3 +142,114 @@ TEST_CASE("CoreTiming[BasicOrderNoPausing]", "[core]") {
     printf("HostTimer No Pausing Timer Time: %.3f %.6f\n", timer_time / 1000.f,
            timer_time / 1000000.f);
 }
+
+TEST_CASE("CoreTiming[ScheduleStress]", "[core]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+
+    core_timing.SyncPause(true);
+    core_timing.SyncPause(false);
+
+    constexpr std::size_t events_per_thread = 10000;
+    for (const std::size_t num_threads : {4U, 8U}) {
+        std::atomic<std::size_t> kept_fired{};
+        std::atomic<std::size_t> cancelled_fired{};
+        const auto count_kept = [&](s64, std::chrono::nanoseconds) {
+            ++kept_fired;
+            return std::optional<std::chrono::nanoseconds>{};
+        };
+        const auto count_cancelled = [&](s64, std::chrono::nanoseconds) {
+            ++cancelled_fired;
+            return std::optional<std::chrono::nanoseconds>{};
+        };
+
+        // Event types must outlive their scheduled events, so create them up front.
+        std::vector<std::shared_ptr<Core::Timing::EventType>> kept_events;
+        std::vector<std::shared_ptr<Core::Timing::EventType>> cancelled_events;
+        for (std::size_t i = 0; i < num_threads; i++) {
+            kept_events.push_back(Core::Timing::CreateEvent("kept", count_kept));
+            cancelled_events.push_back(Core::Timing::CreateEvent("cancelled", count_cancelled));
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::jthread> threads;
+            for (std::size_t t = 0; t < num_threads; t++) {
+                threads.emplace_back([&, t] {
+                    for (std::size_t i = 0; i < events_per_thread; i++) {
+                        const auto delay = std::chrono::microseconds{static_cast<s64>(i % 1000)};
+                        core_timing.ScheduleEvent(delay, kept_events[t]);
+                        core_timing.ScheduleEvent(std::chrono::seconds{10}, cancelled_events[t]);
+                        core_timing.UnscheduleEvent(cancelled_events[t],
+                                                    Core::Timing::UnscheduleEventType::NoWait);
+                    }
+                });
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const std::size_t expected = num_threads * events_per_thread;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+        while (kept_fired < expected && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        REQUIRE(kept_fired == expected);
+        REQUIRE(cancelled_fired == 0);
+
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        const double operations = static_cast<double>(expected * 3);
+        printf("HostTimer Schedule Stress %zu threads: %.3f Mops/s\n", num_threads,
+               operations / seconds / 1000000.0);
+    }
+}
+
+#ifdef SUYU_CORE_TIMING_WHEEL
+TEST_CASE("TimerWheel: Cancelled events are removed", "[core]") {
+    Core::Timing::TimerWheel wheel;
+    const auto kept = Core::Timing::CreateEvent("kept", HostCallbackTemplate<0>);
+    const auto cancelled = Core::Timing::CreateEvent("cancelled", HostCallbackTemplate<1>);
+
+    // Events in the ready queue, in several levels of the wheel and in the overflow list.
+    for (const s64 time : {s64{0}, s64{5'000}, s64{2'000'000}, s64{3'000'000'000}, s64{1} << 50}) {
+        wheel.Push(time, cancelled, 0);
+    }
+    wheel.Push(1'000'000, kept, 0);
+    wheel.Advance(0);
+    wheel.Cancel(*cancelled);
+
+    // Events pushed after the cancellation are kept.
+    wheel.Push(4'000'000, cancelled, 0);
+    wheel.Advance(0);
+    const auto next_time = wheel.NextTime();
+    REQUIRE(next_time.has_value());
+    REQUIRE(*next_time <= 1'000'000);
+
+    wheel.Advance(5'000'000);
+    const auto first = wheel.PopDue(5'000'000);
+    REQUIRE(first != nullptr);
+    REQUIRE(first->type.lock() == kept);
+    const auto second = wheel.PopDue(5'000'000);
+    REQUIRE(second != nullptr);
+    REQUIRE(second->type.lock() == cancelled);
+    REQUIRE(second->time == 4'000'000);
+    REQUIRE(wheel.PopDue(5'000'000) == nullptr);
+    REQUIRE(wheel.Empty());
+    REQUIRE(!wheel.NextTime());
+}
+
+TEST_CASE("CoreTiming[UnscheduledEventsAreNotPending]", "[core]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+    const auto event = Core::Timing::CreateEvent("callbackA", HostCallbackTemplate<0>);
+    core_timing.SyncPause(false);
+
+    core_timing.ScheduleEvent(std::chrono::seconds{10}, event);
+    core_timing.UnscheduleEvent(event);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (core_timing.HasPendingEvents() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    REQUIRE(!core_timing.HasPendingEvents());
+}
+#endif
@@ -0,0 +1,214 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/literals.h"
+#include "core/crypto/aes_engine.h"
+#include "core/crypto/aes_util.h"
+#include "core/crypto/key_manager.h"
+
+namespace Core::Crypto {
+
+namespace {
+
+using namespace Common::Literals;
+
+constexpr std::array<AesBackend, 4> AllBackends{AesBackend::Software, AesBackend::AesNi,
+                                                AesBackend::Vaes, AesBackend::ArmCrypto};
+
+template <std::size_t Size>
+std::array<u8, Size> FromHex(const char* hex) {
+    std::array<u8, Size> bytes{};
+    for (std::size_t i = 0; i < Size; ++i) {
+        unsigned int value{};
+        std::sscanf(hex + i * 2, "%2x", &value);
+        bytes[i] = static_cast<u8>(value);
+    }
+    return bytes;
+}
+
+std::vector<u8> RandomData(std::size_t size) {
+    std::mt19937 rng{size};
+    std::vector<u8> data(size);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+double GigabytesPerSecond(std::size_t size, std::chrono::steady_clock::duration duration) {
+    return static_cast<double>(size) / std::chrono::duration<double>(duration).count() / 1e9;
+}
+
+template <typename Func>
+std::chrono::steady_clock::duration Measure(Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::steady_clock::now() - start;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AesEngine: CTR known answer", "[core]") {
+    // NIST SP 800-38A F.5.1
+    const auto key = FromHex<0x10>("2b7e151628aed2a6abf7158809cf4f3c");
+    const auto counter = FromHex<0x10>("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    const auto plaintext = FromHex<0x40>("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac"
+                                         "45af8e5130c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17"
+                                         "ad2b417be66c3710");
+    const auto ciphertext = FromHex<0x40>("874d6191b620e3261bef6864990db6ce9806f66b7970fdff861718"
+                                          "7bb9fffdff5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe"
+                                          "03d1792170a0f3009cee");
+
+    for (const AesBackend backend : AllBackends) {
+        if (!IsAesBackendSupported(backend)) {
+            continue;
+        }
+        const AesCtrEngine engine{key, backend};
+        std::array<u8, 0x40> out{};
+        engine.Transcode(plaintext.data(), out.data(), out.size(), counter);
+        REQUIRE(out == ciphertext);
+
+        // A partial last block.
+        std::array<u8, 0x25> partial{};
+        engine.Transcode(plaintext.data(), partial.data(), partial.size(), counter);
+        REQUIRE(std::memcmp(partial.data(), ciphertext.data(), partial.size()) == 0);
+    }
+}
+
+TEST_CASE("AesEngine: XTS known answer", "[core]") {
+    // IEEE 1619-2007 vectors 1 and 2
+    const auto key_1 = FromHex<0x20>("00000000000000000000000000000000"
+                                     "00000000000000000000000000000000");
+    const auto tweak_1 = FromHex<0x10>("00000000000000000000000000000000");
+    const auto ciphertext_1 = FromHex<0x20>("917cf69ebd68b2ec9b9fe9a3eadda692"
+                                            "cd43d2f59598ed858c02c2652fbf922e");
+    const auto key_2 = FromHex<0x20>("11111111111111111111111111111111"
+                                     "22222222222222222222222222222222");
+    const auto tweak_2 = FromHex<0x10>("33333333330000000000000000000000");
+    const auto ciphertext_2 = FromHex<0x20>("c454185e6a16936e39334038acef838b"
+                                            "fb186fff7480adc4289382ecd6d394f0");
+
+    for (const AesBackend backend : AllBackends) {
+        if (!IsAesBackendSupported(backend)) {
+            continue;
+        }
+        std::array<u8, 0x20> out{};
+        AesXtsEngine{key_1, backend}.Decrypt(ciphertext_1.data(), out.data(), out.size(),
+                                             out.size(), tweak_1);
+        REQUIRE(out == std::array<u8, 0x20>{});
+
+        AesXtsEngine{key_2, backend}.Decrypt(ciphertext_2.data(), out.data(), out.size(),
+                                             out.size(), tweak_2);
+        std::array<u8, 0x20> expected;
+        expected.fill(0x44);
+        REQUIRE(out == expected);
+    }
+}
+
+TEST_CASE("AesEngine: Backends match mbedtls", "[core]") {
+    const auto key = FromHex<0x20>("000102030405060708090a0b0c0d0e0f"
+                                   "f0e0d0c0b0a090807060504030201000");
+    const Key128 ctr_key = [&] {
+        Key128 result;
+        std::memcpy(result.data(), key.data(), result.size());
+        return result;
+    }();
+    // The counter wraps around its lower half during the request.
+    const auto counter = FromHex<0x10>("0123456789abcdeffffffffffffffff0");
+    const auto tweak = FromHex<0x10>("00000000000000000000000000000ff0");
+
+    // Big enough to be split across workers, with a partial block at the end.
+    const std::vector<u8> data = RandomData(4_MiB + 0x4000 + 7);
+
+    std::vector<u8> ctr_expected(data.size());
+    AESCipher<Key128> ctr_cipher{ctr_key, Mode::CTR};
+    ctr_cipher.SetIV(counter);
+    ctr_cipher.Transcode(data.data(), data.size(), ctr_expected.data(), Op::Decrypt);
+
+    for (const std::size_t sector_size : {std::size_t{0x200}, std::size_t{0x4000}}) {
+        const std::size_t xts_size = data.size() / sector_size * sector_size;
+        std::vector<u8> xts_expected(xts_size);
+        AESCipher<Key256> xts_cipher{key, Mode::XTS};
+        std::vector<u8> sector_tweak(tweak.begin(), tweak.end());
+        for (std::size_t offset = 0; offset < xts_size; offset += sector_size) {
+            xts_cipher.SetIV(sector_tweak);
+            xts_cipher.Transcode(data.data() + offset, sector_size, xts_expected.data() + offset,
+                                 Op::Decrypt);
+            for (std::size_t i = sector_tweak.size(); i-- > 0 && ++sector_tweak[i] == 0;) {
+            }
+        }
+
+        for (const AesBackend backend : AllBackends) {
+            if (!IsAesBackendSupported(backend)) {
+                continue;
+            }
+            std::vector<u8> out(xts_size);
+            AesXtsEngine{key, backend}.Decrypt(data.data(), out.data(), xts_size, sector_size,
+                                               tweak);
+            REQUIRE(out == xts_expected);
+        }
+    }
+
+    for (const AesBackend backend : AllBackends) {
+        if (!IsAesBackendSupported(backend)) {
+            continue;
+        }
+        std::vector<u8> out(data);
+        AesCtrEngine{ctr_key, backend}.Transcode(out.data(), out.data(), out.size(), counter);
+        REQUIRE(out == ctr_expected);
+    }
+}
+
+TEST_CASE("AesEngine: Throughput", "[core]") {
+    constexpr std::size_t DataSize = 16_MiB;
+    constexpr std::size_t SectorSize = 0x4000;
+    Key256 key;
+    Key128 ctr_key;
+    for (std::size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<u8>(i);
+    }
+    std::memcpy(ctr_key.data(), key.data(), ctr_key.size());
+    const std::array<u8, 0x10> iv{};
+    std::vector<u8> data = RandomData(DataSize);
+
+    // The path used before the engines: mbedtls through AESCipher, one sector at a time.
+    AESCipher<Key128> ctr_cipher{ctr_key, Mode::CTR};
+    const auto ctr_mbedtls = Measure([&] {
+        ctr_cipher.SetIV(iv);
+        ctr_cipher.Transcode(data.data(), data.size(), data.data(), Op::Decrypt);
+    });
+    AESCipher<Key256> xts_cipher{key, Mode::XTS};
+    const auto xts_mbedtls = Measure([&] {
+        xts_cipher.XTSTranscode(data.data(), data.size(), data.data(), 0, SectorSize,
+                                Op::Decrypt);
+    });
+    std::printf("AES mbedtls: CTR %.2f GB/s, XTS %.2f GB/s\n",
+                GigabytesPerSecond(DataSize, ctr_mbedtls),
+                GigabytesPerSecond(DataSize, xts_mbedtls));
+
+    for (const AesBackend backend : AllBackends) {
+        if (!IsAesBackendSupported(backend)) {
+            continue;
+        }
+        const AesCtrEngine ctr_engine{ctr_key, backend};
+        const AesXtsEngine xts_engine{key, backend};
+        const auto ctr = Measure(
+            [&] { ctr_engine.Transcode(data.data(), data.data(), data.size(), iv); });
+        const auto xts = Measure([&] {
+            xts_engine.Decrypt(data.data(), data.data(), data.size(), SectorSize, iv);
+        });
+        std::printf("AES %s engine: CTR %.2f GB/s, XTS %.2f GB/s\n",
+                    GetAesBackendName(backend).data(), GigabytesPerSecond(DataSize, ctr),
+                    GigabytesPerSecond(DataSize, xts));
+    }
+}
+
+} // namespace Core::Crypto
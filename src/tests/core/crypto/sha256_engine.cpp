@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <mbedtls/sha256.h>
+
+#include "common/literals.h"
+#include "core/crypto/sha256_engine.h"
+
+namespace Core::Crypto {
+
+namespace {
+
+using namespace Common::Literals;
+
+SHA256Hash FromHex(const char* hex) {
+    SHA256Hash bytes{};
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        unsigned int value{};
+        std::sscanf(hex + i * 2, "%2x", &value);
+        bytes[i] = static_cast<u8>(value);
+    }
+    return bytes;
+}
+
+std::span<const u8> AsBytes(std::string_view text) {
+    return {reinterpret_cast<const u8*>(text.data()), text.size()};
+}
+
+std::vector<u8> PatternData(std::size_t size) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(i * 7 + i / 251);
+    }
+    return data;
+}
+
+double GigabytesPerSecond(std::size_t size, std::chrono::steady_clock::duration duration) {
+    return static_cast<double>(size) / std::chrono::duration<double>(duration).count() / 1e9;
+}
+
+template <typename Func>
+std::chrono::steady_clock::duration Measure(Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::steady_clock::now() - start;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Sha256Engine: Known answers", "[core]") {
+    // FIPS 180-2 appendix B
+    REQUIRE(Sha256::Compute(AsBytes("abc")) ==
+            FromHex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    REQUIRE(Sha256::Compute(AsBytes("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) ==
+            FromHex("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+    REQUIRE(Sha256::Compute({}) ==
+            FromHex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+
+    const std::vector<u8> million_a(1000000, 'a');
+    REQUIRE(Sha256::Compute(million_a) ==
+            FromHex("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+}
+
+TEST_CASE("Sha256Engine: Incremental updates", "[core]") {
+    const std::vector<u8> data = PatternData(1_MiB + 13);
+    const auto expected =
+        FromHex("4ed3759da0e6daa95cedff0f3eeb7d4abc69f84a0e682b5e5b13e4f7be69c96a");
+    REQUIRE(Sha256::Compute(data) == expected);
+
+    // Chunks that do not line up with the block size exercise the partial block buffer.
+    for (const std::size_t chunk_size : {std::size_t{1}, std::size_t{55}, std::size_t{64},
+                                         std::size_t{100}, std::size_t{0x4001}}) {
+        Sha256 sha;
+        for (std::size_t offset = 0; offset < data.size(); offset += chunk_size) {
+            sha.Update(std::span{data}.subspan(offset, std::min(chunk_size, data.size() - offset)));
+        }
+        REQUIRE(sha.Finalize() == expected);
+    }
+}
+
+TEST_CASE("Sha256Engine: Throughput", "[core]") {
+    constexpr std::size_t DataSize = 64_MiB;
+    const std::vector<u8> data = PatternData(DataSize);
+
+    // The path used before the engine.
+    SHA256Hash mbedtls_hash;
+    const auto mbedtls = Measure([&] {
+        mbedtls_sha256_ret(data.data(), data.size(), mbedtls_hash.data(), 0);
+    });
+
+    SHA256Hash engine_hash;
+    const auto engine = Measure([&] { engine_hash = Sha256::Compute(data); });
+    REQUIRE(engine_hash == mbedtls_hash);
+
+    std::printf("SHA-256 mbedtls: %.2f GB/s, %s engine: %.2f GB/s\n",
+                GigabytesPerSecond(DataSize, mbedtls), GetSha256BackendName().data(),
+                GigabytesPerSecond(DataSize, engine));
+}
+
+} // namespace Core::Crypto
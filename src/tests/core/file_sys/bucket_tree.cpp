@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_sys/fssystem/fssystem_bucket_tree.h"
+#include "core/file_sys/fssystem/fssystem_indirect_storage.h"
+#include "core/file_sys/vfs/vfs_static.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+/// Patch table of an IndirectStorage, with only the L1 node.
+struct SyntheticTable {
+    std::vector<IndirectStorage::Entry> entries;
+    s64 end_offset;
+    VirtualFile node_storage;
+    VirtualFile entry_storage;
+};
+
+/// Builds a table of patch fragments of 16 bytes to 64 KiB, each in a random storage.
+SyntheticTable BuildTable(s32 entry_count) {
+    constexpr size_t NodeSize = IndirectStorage::NodeSize;
+    constexpr s32 EntriesPerSet = static_cast<s32>(
+        (NodeSize - sizeof(BucketTree::NodeHeader)) / sizeof(IndirectStorage::Entry));
+
+    SyntheticTable table;
+    std::mt19937 rng{static_cast<u32>(entry_count)};
+    s64 offset = 0;
+    for (s32 i = 0; i < entry_count; ++i) {
+        IndirectStorage::Entry entry{};
+        entry.SetVirtualOffset(offset);
+        entry.SetPhysicalOffset(offset);
+        entry.storage_index = static_cast<s32>(rng() % IndirectStorage::StorageCount);
+        table.entries.push_back(entry);
+        offset += 0x10 * static_cast<s64>(1 + rng() % 0x1000);
+    }
+    table.end_offset = offset;
+
+    const s32 entry_set_count = (entry_count + EntriesPerSet - 1) / EntriesPerSet;
+    REQUIRE(static_cast<size_t>(entry_set_count) <=
+            (NodeSize - sizeof(BucketTree::NodeHeader)) / sizeof(s64));
+
+    std::vector<u8> nodes(NodeSize);
+    std::vector<u8> entry_sets(static_cast<size_t>(entry_set_count) * NodeSize);
+    const auto end_of_set = [&](s32 set) {
+        const auto next = static_cast<size_t>(set + 1) * EntriesPerSet;
+        return next < table.entries.size() ? table.entries[next].GetVirtualOffset()
+                                           : table.end_offset;
+    };
+
+    const BucketTree::NodeHeader l1_header{0, entry_set_count, table.end_offset};
+    std::memcpy(nodes.data(), &l1_header, sizeof(l1_header));
+    for (s32 set = 0; set < entry_set_count; ++set) {
+        const s32 first = set * EntriesPerSet;
+        const s32 count = std::min(EntriesPerSet, entry_count - first);
+        const s64 start = table.entries[first].GetVirtualOffset();
+        std::memcpy(nodes.data() + sizeof(l1_header) + set * sizeof(s64), &start, sizeof(start));
+
+        u8* const set_data = entry_sets.data() + static_cast<size_t>(set) * NodeSize;
+        const BucketTree::NodeHeader header{set, count, end_of_set(set)};
+        std::memcpy(set_data, &header, sizeof(header));
+        std::memcpy(set_data + sizeof(header), table.entries.data() + first,
+                    count * sizeof(IndirectStorage::Entry));
+    }
+
+    table.node_storage = std::make_shared<VectorVfsFile>(std::move(nodes));
+    table.entry_storage = std::make_shared<VectorVfsFile>(std::move(entry_sets));
+    return table;
+}
+
+class TestIndirectStorage : public IndirectStorage {
+public:
+    using IndirectStorage::GetEntryTable;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("BucketTree: Lookup index finds the same entries", "[core]") {
+    const SyntheticTable table = BuildTable(20000);
+    std::vector<s64> starts;
+    for (const auto& entry : table.entries) {
+        starts.push_back(entry.GetVirtualOffset());
+    }
+
+    BucketTree indexed;
+    BucketTree searched;
+    REQUIRE(indexed.Initialize(table.node_storage, table.entry_storage, IndirectStorage::NodeSize,
+                               sizeof(IndirectStorage::Entry), 20000) == ResultSuccess);
+    REQUIRE(searched.Initialize(table.node_storage, table.entry_storage, IndirectStorage::NodeSize,
+                                sizeof(IndirectStorage::Entry), 20000) == ResultSuccess);
+    searched.SetLookupIndexEnabled(false);
+
+    std::mt19937_64 rng{42};
+    for (int i = 0; i < 20000; ++i) {
+        // Test entry boundaries as well as random addresses.
+        const s64 address = i % 2 == 0 ? starts[rng() % starts.size()]
+                                       : static_cast<s64>(rng() % table.end_offset);
+        const auto expected = std::upper_bound(starts.begin(), starts.end(), address) - 1;
+
+        BucketTree::Visitor indexed_visitor;
+        BucketTree::Visitor searched_visitor;
+        REQUIRE(indexed.Find(&indexed_visitor, address) == ResultSuccess);
+        REQUIRE(searched.Find(&searched_visitor, address) == ResultSuccess);
+        REQUIRE(indexed_visitor.Get<IndirectStorage::Entry>()->GetVirtualOffset() == *expected);
+        REQUIRE(searched_visitor.Get<IndirectStorage::Entry>()->GetVirtualOffset() == *expected);
+
+        // Moving on works from an entry found in the index.
+        if (indexed_visitor.CanMoveNext()) {
+            REQUIRE(indexed_visitor.MoveNext() == ResultSuccess);
+            REQUIRE(indexed_visitor.Get<IndirectStorage::Entry>()->GetVirtualOffset() ==
+                    *(expected + 1));
+        }
+    }
+
+    BucketTree::Visitor visitor;
+    REQUIRE(indexed.Find(&visitor, table.end_offset) != ResultSuccess);
+}
+
+// Hidden by default; run with `tests "[benchmark]"`.
+TEST_CASE("BucketTree: Random 4 KiB reads through an IndirectStorage", "[.][benchmark]") {
+    constexpr s32 EntryCount = 500000;
+    constexpr size_t ReadSize = 4_KiB;
+
+    const SyntheticTable table = BuildTable(EntryCount);
+    std::vector<u8> buffer(ReadSize);
+
+    for (const bool use_index : {false, true}) {
+        TestIndirectStorage storage;
+        REQUIRE(storage.Initialize(table.node_storage, table.entry_storage, EntryCount) ==
+                ResultSuccess);
+        storage.GetEntryTable().SetLookupIndexEnabled(use_index);
+        for (s32 i = 0; i < IndirectStorage::StorageCount; ++i) {
+            storage.SetStorage(i, std::make_shared<StaticVfsFile>(
+                                      static_cast<u8>(i), static_cast<size_t>(table.end_offset)));
+        }
+
+        std::mt19937_64 rng{7};
+        BENCHMARK(use_index ? "Lookup index" : "Node search") {
+            const auto offset = rng() % (static_cast<u64>(table.end_offset) - ReadSize);
+            return storage.Read(buffer.data(), ReadSize, offset);
+        };
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,267 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/file_sys/fssystem/fssystem_bucket_tree.h"
+#include "core/file_sys/fssystem/fssystem_compressed_block_cache.h"
+#include "core/file_sys/fssystem/fssystem_compressed_storage.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr s32 BlockCount = 64;
+constexpr s64 BlockSize = 16_KiB;
+constexpr s32 PhysicalBlockSize = 0x10;
+
+std::atomic<size_t> decompressed_blocks;
+
+CompressedBlockCache::Block MakeBlock(size_t size, u8 value) {
+    return std::make_shared<const std::vector<u8>>(size, value);
+}
+
+/// Fills the block with the first byte of its compressed data.
+Result FillDecompress(void* dst, size_t dst_size, const void* src, size_t src_size) {
+    std::memset(dst, *static_cast<const u8*>(src), dst_size);
+    decompressed_blocks.fetch_add(1, std::memory_order_relaxed);
+    R_SUCCEED();
+}
+
+DecompressorFunction GetFillDecompressor(CompressionType type) {
+    return type == CompressionType::Lz4 ? FillDecompress : nullptr;
+}
+
+/// Compression table of BlockCount blocks whose compressed data follow each other.
+struct SyntheticTable {
+    VirtualFile node_storage;
+    VirtualFile entry_storage;
+};
+
+SyntheticTable BuildTable() {
+    constexpr size_t NodeSize = CompressedStorage::NodeSize;
+    constexpr s64 EndOffset = BlockCount * BlockSize;
+
+    std::vector<u8> nodes(NodeSize);
+    const BucketTree::NodeHeader l1_header{0, 1, EndOffset};
+    const s64 start = 0;
+    std::memcpy(nodes.data(), &l1_header, sizeof(l1_header));
+    std::memcpy(nodes.data() + sizeof(l1_header), &start, sizeof(start));
+
+    std::vector<u8> entries(NodeSize);
+    const BucketTree::NodeHeader header{0, BlockCount, EndOffset};
+    std::memcpy(entries.data(), &header, sizeof(header));
+    for (s32 i = 0; i < BlockCount; ++i) {
+        const CompressedStorage::Entry entry{
+            .virt_offset = i * BlockSize,
+            .phys_offset = i * PhysicalBlockSize,
+            .compression_type = CompressionType::Lz4,
+            .phys_size = PhysicalBlockSize,
+        };
+        std::memcpy(entries.data() + sizeof(header) + i * sizeof(entry), &entry, sizeof(entry));
+    }
+    return {std::make_shared<VectorVfsFile>(std::move(nodes)),
+            std::make_shared<VectorVfsFile>(std::move(entries))};
+}
+
+/// Compressed data decompressing block i to bytes of value (salt + i).
+VirtualFile BuildData(u8 salt) {
+    std::vector<u8> data(BlockCount * PhysicalBlockSize);
+    for (s32 i = 0; i < BlockCount; ++i) {
+        std::fill_n(data.begin() + i * PhysicalBlockSize, PhysicalBlockSize,
+                    static_cast<u8>(salt + i));
+    }
+    return std::make_shared<VectorVfsFile>(std::move(data));
+}
+
+std::unique_ptr<CompressedStorage> OpenStorage(const SyntheticTable& table, VirtualFile data,
+                                               u64 cache_key) {
+    auto storage = std::make_unique<CompressedStorage>();
+    REQUIRE(storage->Initialize(std::move(data), table.node_storage, table.entry_storage,
+                                BlockCount, 64_KiB, 640_KiB, GetFillDecompressor, 16_KiB, 16_KiB,
+                                32, cache_key) == ResultSuccess);
+    return storage;
+}
+
+/// In-memory file whose reads stop at readable_size, as if the rest failed to read.
+class ShortFile : public VectorVfsFile {
+public:
+    ShortFile(std::vector<u8> data, size_t readable_size_)
+        : VectorVfsFile{std::move(data)}, readable_size{readable_size_} {}
+
+    size_t Read(u8* data, size_t length, size_t offset) const override {
+        if (offset + length <= readable_size) {
+            return VectorVfsFile::Read(data, length, offset);
+        }
+        short_read = true;
+        return offset < readable_size ? VectorVfsFile::Read(data, readable_size - offset, offset)
+                                      : 0;
+    }
+
+    const size_t readable_size;
+    mutable std::atomic<bool> short_read{};
+};
+
+bool ReadMatches(const CompressedStorage& storage, u8 salt) {
+    std::vector<u8> buffer(BlockSize);
+    for (s32 i = 0; i < BlockCount; ++i) {
+        if (storage.Read(buffer.data(), buffer.size(), i * BlockSize) != buffer.size() ||
+            std::ranges::count(buffer, static_cast<u8>(salt + i)) != BlockSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("CompressedBlockCache: Hits and misses", "[core]") {
+    CompressedBlockCache cache{0x10000};
+    REQUIRE(cache.Find(1, 0) == nullptr);
+
+    cache.Insert(1, 0, MakeBlock(0x1000, 0xAA));
+    const auto block = cache.Find(1, 0);
+    REQUIRE(block != nullptr);
+    REQUIRE(block->size() == 0x1000);
+    REQUIRE((*block)[0] == 0xAA);
+
+    // Blocks of other storages do not alias.
+    REQUIRE(cache.Find(2, 0) == nullptr);
+    REQUIRE(!cache.Contains(2, 0));
+
+    const auto stats = cache.GetStatistics();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 2);
+}
+
+TEST_CASE("CompressedBlockCache: Least recently used eviction", "[core]") {
+    CompressedBlockCache cache{0x3000};
+    cache.Insert(1, 0x0000, MakeBlock(0x1000, 0));
+    cache.Insert(1, 0x1000, MakeBlock(0x1000, 1));
+    cache.Insert(1, 0x2000, MakeBlock(0x1000, 2));
+
+    // Using the first block makes the second one the least recently used.
+    REQUIRE(cache.Find(1, 0x0000) != nullptr);
+    cache.Insert(1, 0x3000, MakeBlock(0x1000, 3));
+    REQUIRE(cache.Contains(1, 0x0000));
+    REQUIRE(!cache.Contains(1, 0x1000));
+    REQUIRE(cache.Contains(1, 0x2000));
+    REQUIRE(cache.Contains(1, 0x3000));
+
+    // Shrinking the cache evicts down to the new capacity.
+    cache.SetCapacity(0x1000);
+    REQUIRE(!cache.Contains(1, 0x2000));
+    REQUIRE(cache.Contains(1, 0x3000));
+
+    // Blocks larger than the whole cache are not kept.
+    cache.Insert(1, 0x4000, MakeBlock(0x2000, 4));
+    REQUIRE(!cache.Contains(1, 0x4000));
+    REQUIRE(cache.Contains(1, 0x3000));
+}
+
+TEST_CASE("CompressedStorage: Reopened contents are read from the block cache", "[core]") {
+    const bool read_ahead = Settings::values.compressed_storage_read_ahead.GetValue();
+    Settings::values.compressed_storage_read_ahead.SetValue(false);
+    SCOPE_EXIT {
+        Settings::values.compressed_storage_read_ahead.SetValue(read_ahead);
+    };
+    REQUIRE(CompressedBlockCache::Instance().IsEnabled());
+
+    // Same compression table for different contents, as in an update changing only data.
+    const SyntheticTable table = BuildTable();
+    constexpr u64 FirstKey = 0x1111'0000'0000'0001;
+    constexpr u64 SecondKey = 0x1111'0000'0000'0002;
+
+    const size_t decompressed_before = decompressed_blocks.load();
+    REQUIRE(ReadMatches(*OpenStorage(table, BuildData(0), FirstKey), 0));
+    REQUIRE(decompressed_blocks.load() - decompressed_before == BlockCount);
+
+    // Opening the same contents again hits every block.
+    const auto hits_before = CompressedBlockCache::Instance().GetStatistics().hits;
+    REQUIRE(ReadMatches(*OpenStorage(table, BuildData(0), FirstKey), 0));
+    REQUIRE(decompressed_blocks.load() - decompressed_before == BlockCount);
+    REQUIRE(CompressedBlockCache::Instance().GetStatistics().hits - hits_before == BlockCount);
+
+    // Other contents do not alias, even with the same table and size.
+    REQUIRE(ReadMatches(*OpenStorage(table, BuildData(0x80), SecondKey), 0x80));
+    REQUIRE(decompressed_blocks.load() - decompressed_before == 2 * BlockCount);
+
+    // Storages without a key are not cached.
+    REQUIRE(ReadMatches(*OpenStorage(table, BuildData(0x40), 0), 0x40));
+    REQUIRE(ReadMatches(*OpenStorage(table, BuildData(0x40), 0), 0x40));
+    REQUIRE(decompressed_blocks.load() - decompressed_before == 4 * BlockCount);
+}
+
+TEST_CASE("CompressedStorage: Sequential reads decompress ahead", "[core]") {
+    const bool read_ahead = Settings::values.compressed_storage_read_ahead.GetValue();
+    Settings::values.compressed_storage_read_ahead.SetValue(true);
+    SCOPE_EXIT {
+        Settings::values.compressed_storage_read_ahead.SetValue(read_ahead);
+    };
+    REQUIRE(CompressedBlockCache::Instance().IsEnabled());
+
+    constexpr u64 Key = 0x2222'0000'0000'0001;
+    auto& cache = CompressedBlockCache::Instance();
+    const auto storage = OpenStorage(BuildTable(), BuildData(0x10), Key);
+    const auto read_ahead_before = cache.GetStatistics().read_ahead_blocks;
+
+    // Reading the first block queues the decompression of the following ones.
+    std::vector<u8> buffer(BlockSize);
+    REQUIRE(storage->Read(buffer.data(), buffer.size(), 0) == buffer.size());
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (!cache.Contains(Key, (BlockCount - 1) * BlockSize) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    REQUIRE(cache.Contains(Key, (BlockCount - 1) * BlockSize));
+    REQUIRE(cache.GetStatistics().read_ahead_blocks - read_ahead_before == BlockCount - 1);
+
+    // The rest of the storage is served from the cache.
+    const size_t decompressed_before = decompressed_blocks.load();
+    REQUIRE(ReadMatches(*storage, 0x10));
+    REQUIRE(decompressed_blocks.load() == decompressed_before);
+}
+
+TEST_CASE("CompressedStorage: Short reads are not decompressed ahead", "[core]") {
+    const bool read_ahead = Settings::values.compressed_storage_read_ahead.GetValue();
+    Settings::values.compressed_storage_read_ahead.SetValue(true);
+    SCOPE_EXIT {
+        Settings::values.compressed_storage_read_ahead.SetValue(read_ahead);
+    };
+    REQUIRE(CompressedBlockCache::Instance().IsEnabled());
+
+    // The compressed data of the second half of the blocks fails to read.
+    constexpr u64 Key = 0x3333'0000'0000'0001;
+    constexpr s32 ReadableBlocks = BlockCount / 2;
+    std::vector<u8> data(BlockCount * PhysicalBlockSize, 0x20);
+    const auto data_file =
+        std::make_shared<ShortFile>(std::move(data), ReadableBlocks * PhysicalBlockSize);
+    auto storage = OpenStorage(BuildTable(), data_file, Key);
+
+    std::vector<u8> buffer(BlockSize);
+    REQUIRE(storage->Read(buffer.data(), buffer.size(), 0) == buffer.size());
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (!data_file->short_read && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    REQUIRE(data_file->short_read);
+
+    // Releasing the storage waits for the decompression running ahead.
+    storage.reset();
+    auto& cache = CompressedBlockCache::Instance();
+    for (s32 i = ReadableBlocks; i < BlockCount; ++i) {
+        REQUIRE(!cache.Contains(Key, i * BlockSize));
+    }
+}
+
+} // namespace FileSys
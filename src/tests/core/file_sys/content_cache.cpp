@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_sys/content_cache.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr std::size_t FileSize = 4 * ContentCacheFile::BlockSize + 0x1234;
+
+/// In-memory file counting the bytes read from it.
+class CountingFile : public VectorVfsFile {
+public:
+    using VectorVfsFile::VectorVfsFile;
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        bytes_read += length;
+        return VectorVfsFile::Read(data, length, offset);
+    }
+
+    mutable std::atomic<std::size_t> bytes_read{};
+};
+
+struct CacheFixture {
+    CacheFixture() : data(FileSize) {
+        std::mt19937 rng{FileSize};
+        std::ranges::generate(data, [&rng] { return static_cast<u8>(rng()); });
+        source = std::make_shared<CountingFile>(data, "romfs");
+        Remove();
+    }
+    ~CacheFixture() {
+        Remove();
+    }
+
+    void Remove() const {
+        std::filesystem::remove(data_path);
+        std::filesystem::remove(bitmap_path);
+    }
+
+    std::shared_ptr<ContentCacheFile> Open() const {
+        auto file = ContentCacheFile::Open(source, data_path, bitmap_path);
+        REQUIRE(file != nullptr);
+        return file;
+    }
+
+    /// Reads the whole file and returns the number of bytes read from the source meanwhile.
+    std::size_t ReadAll(const VirtualFile& file) const {
+        const std::size_t bytes_read = source->bytes_read;
+        REQUIRE(file->ReadAllBytes() == data);
+        return source->bytes_read - bytes_read;
+    }
+
+    std::vector<u8> data;
+    std::shared_ptr<CountingFile> source;
+    std::filesystem::path data_path{std::filesystem::temp_directory_path() /
+                                    "suyu_content_cache_test.bin"};
+    std::filesystem::path bitmap_path{std::filesystem::temp_directory_path() /
+                                      "suyu_content_cache_test.map"};
+};
+
+} // Anonymous namespace
+
+TEST_CASE_METHOD(CacheFixture, "ContentCacheFile: Reopened files are served from the copy",
+                 "[core]") {
+    REQUIRE(ReadAll(Open()) == FileSize);
+
+    const auto file = Open();
+    REQUIRE(ReadAll(file) == 0);
+    REQUIRE(file->GetView(0x100, FileSize - 0x80).size() == 0x80);
+}
+
+TEST_CASE_METHOD(CacheFixture, "ContentCacheFile: Bitmaps of missing copies are discarded",
+                 "[core]") {
+    REQUIRE(ReadAll(Open()) == FileSize);
+    std::filesystem::remove(data_path);
+
+    REQUIRE(ReadAll(Open()) == FileSize);
+    REQUIRE(ReadAll(Open()) == 0);
+}
+
+TEST_CASE_METHOD(CacheFixture, "ContentCacheFile: Bitmaps of truncated copies are discarded",
+                 "[core]") {
+    REQUIRE(ReadAll(Open()) == FileSize);
+    std::filesystem::resize_file(data_path, ContentCacheFile::BlockSize);
+
+    REQUIRE(ReadAll(Open()) == FileSize);
+    REQUIRE(ReadAll(Open()) == 0);
+}
+
+TEST_CASE_METHOD(CacheFixture, "ContentCacheFile: Partially filled copies are completed",
+                 "[core]") {
+    {
+        const auto file = Open();
+        std::vector<u8> buffer(0x10);
+        REQUIRE(file->Read(buffer.data(), buffer.size(), 2 * ContentCacheFile::BlockSize) ==
+                buffer.size());
+        REQUIRE(source->bytes_read == ContentCacheFile::BlockSize);
+    }
+    REQUIRE(ReadAll(Open()) == FileSize - ContentCacheFile::BlockSize);
+    REQUIRE(ReadAll(Open()) == 0);
+}
+
+} // namespace FileSys
@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/hex_util.h"
+#include "core/crypto/sha256_engine.h"
+#include "core/file_sys/content_verifier.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+namespace {
+
+/// Returns an NCA named after the hash of its contents, as installed NCAs are.
+VirtualFile MakeNCA(std::size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> data(size);
+    std::ranges::generate(data, [&rng] { return static_cast<u8>(rng()); });
+
+    const auto hash = Core::Crypto::Sha256::Compute(data);
+    std::array<u8, 0x10> id;
+    std::copy_n(hash.begin(), id.size(), id.begin());
+    return std::make_shared<VectorVfsFile>(std::move(data),
+                                           Common::HexToString(id, false) + ".nca");
+}
+
+struct TemporaryPath {
+    TemporaryPath()
+        : path{std::filesystem::temp_directory_path() / "suyu_content_verifier_test.bin"} {
+        std::filesystem::remove(path);
+    }
+    ~TemporaryPath() {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("ContentVerifier: Verifies NCAs concurrently", "[core]") {
+    std::vector<VirtualFile> ncas;
+    std::size_t total_size = 0;
+    for (u32 i = 0; i < 8; ++i) {
+        const std::size_t size = i * ContentVerifier::BlockSize / 3 + i;
+        ncas.push_back(MakeNCA(size, i));
+        total_size += size;
+    }
+    auto corrupted = MakeNCA(ContentVerifier::BlockSize + 5, 100);
+    const u8 byte = *corrupted->ReadByte(ContentVerifier::BlockSize) ^ 1;
+    corrupted->WriteObject(byte, ContentVerifier::BlockSize);
+    const auto unnamed = std::make_shared<VectorVfsFile>(std::vector<u8>(16), "data.nca");
+
+    std::size_t last_processed = 0;
+    std::map<std::string, Loader::ResultStatus> results;
+    ContentVerifier verifier{
+        [&](std::size_t total, std::size_t processed) {
+            REQUIRE(total == total_size + corrupted->GetSize() + unnamed->GetSize());
+            REQUIRE(processed >= last_processed);
+            last_processed = processed;
+            return false;
+        },
+        [&results](const VirtualFile& file, Loader::ResultStatus status) {
+            REQUIRE(results.emplace(file->GetName(), status).second);
+        }};
+    for (const VirtualFile& nca : ncas) {
+        verifier.Queue(nca);
+    }
+    verifier.Queue(corrupted);
+    verifier.Queue(unnamed);
+
+    REQUIRE(verifier.Run());
+    REQUIRE(results.size() == ncas.size() + 2);
+    for (const VirtualFile& nca : ncas) {
+        REQUIRE(results.at(nca->GetName()) == Loader::ResultStatus::Success);
+    }
+    REQUIRE(results.at(corrupted->GetName()) ==
+            Loader::ResultStatus::ErrorIntegrityVerificationFailed);
+    REQUIRE(results.at(unnamed->GetName()) ==
+            Loader::ResultStatus::ErrorIntegrityVerificationNotImplemented);
+}
+
+TEST_CASE("ContentVerifier: Verification can be cancelled", "[core]") {
+    ContentVerifier verifier{[](std::size_t, std::size_t) { return true; }};
+    for (u32 i = 0; i < 4; ++i) {
+        verifier.Queue(MakeNCA(ContentVerifier::BlockSize * 4, i));
+    }
+    REQUIRE(!verifier.Run());
+}
+
+TEST_CASE("ContentVerifier: Verified NCAs are skipped when resuming", "[core]") {
+    const TemporaryPath temp;
+    const auto verified = MakeNCA(0x1000, 1);
+    const auto unverified = MakeNCA(0x1000, 2);
+    {
+        ContentVerificationRecord record{temp.path};
+        ContentVerifier verifier{{}, {}, &record};
+        verifier.Queue(verified);
+        REQUIRE(verifier.Run());
+    }
+
+    // The contents of files found in the record are not read again.
+    const u8 byte = *verified->ReadByte(0) ^ 1;
+    verified->WriteObject(byte, 0);
+
+    ContentVerificationRecord record{temp.path};
+    REQUIRE(record.Contains(*verified));
+    REQUIRE(!record.Contains(*unverified));
+
+    std::map<std::string, Loader::ResultStatus> results;
+    ContentVerifier verifier{{},
+                             [&results](const VirtualFile& file, Loader::ResultStatus status) {
+                                 results.emplace(file->GetName(), status);
+                             },
+                             &record};
+    verifier.Queue(verified);
+    verifier.Queue(unverified);
+    REQUIRE(verifier.Run());
+    REQUIRE(results.at(verified->GetName()) == Loader::ResultStatus::Success);
+    REQUIRE(results.at(unverified->GetName()) == Loader::ResultStatus::Success);
+    REQUIRE(record.Contains(*unverified));
+
+    // Changing the size of a file invalidates its record.
+    verified->WriteObject(byte, verified->GetSize());
+    REQUIRE(!record.Contains(*verified));
+
+    record.Clear();
+    REQUIRE(record.IsEmpty());
+    REQUIRE(!std::filesystem::exists(temp.path));
+}
+
+} // namespace FileSys
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/crypto/sha256_engine.h"
+#include "core/file_sys/install_pipeline.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+std::vector<u8> MakeData(std::size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> data(size);
+    std::ranges::generate(data, [&rng] { return static_cast<u8>(rng()); });
+    return data;
+}
+
+NcaID GetNcaID(const std::vector<u8>& data) {
+    const auto hash = Core::Crypto::Sha256::Compute(data);
+    NcaID id;
+    std::copy_n(hash.begin(), id.size(), id.begin());
+    return id;
+}
+
+/// File whose writes fail past the given offset.
+class FailingFile : public VectorVfsFile {
+public:
+    explicit FailingFile(std::size_t fail_offset_) : fail_offset{fail_offset_} {}
+
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override {
+        return offset < fail_offset ? VectorVfsFile::Write(data, length, offset) : 0;
+    }
+
+private:
+    std::size_t fail_offset;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("InstallPipeline: Copies and verifies files concurrently", "[core]") {
+    const std::vector<std::size_t> sizes{
+        0, 1, InstallPipeline::BlockSize, InstallPipeline::BlockSize * 5 / 2 + 123, 3_MiB,
+    };
+
+    InstallProgress last_progress{};
+    InstallPipeline pipeline{[&last_progress](const InstallProgress& progress) {
+                                 last_progress = progress;
+                                 return false;
+                             },
+                             true};
+
+    std::vector<std::vector<u8>> datas;
+    std::vector<VirtualFile> dests;
+    std::size_t total_size = 0;
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        auto data = MakeData(sizes[i], static_cast<u32>(i));
+        const auto id = GetNcaID(data);
+        auto dest = std::make_shared<VectorVfsFile>();
+        pipeline.Queue(std::make_shared<VectorVfsFile>(data), dest, id);
+        datas.push_back(std::move(data));
+        dests.push_back(std::move(dest));
+        total_size += sizes[i];
+    }
+
+    REQUIRE(pipeline.Run());
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        REQUIRE(dests[i]->ReadAllBytes() == datas[i]);
+    }
+    REQUIRE(last_progress.total_size == total_size);
+    REQUIRE(last_progress.installed_size == total_size);
+}
+
+TEST_CASE("InstallPipeline: Corrupted files are not installed", "[core]") {
+    const auto data = MakeData(InstallPipeline::BlockSize + 1, 7);
+    auto id = GetNcaID(data);
+    id[0] ^= 1;
+
+    InstallPipeline pipeline{{}, true};
+    const auto good_dest = std::make_shared<VectorVfsFile>();
+    const auto bad_dest = std::make_shared<VectorVfsFile>();
+    pipeline.Queue(std::make_shared<VectorVfsFile>(data), good_dest, GetNcaID(data));
+    pipeline.Queue(std::make_shared<VectorVfsFile>(data), bad_dest, id);
+
+    REQUIRE(!pipeline.Run());
+    REQUIRE(good_dest->ReadAllBytes() == data);
+    REQUIRE(bad_dest->GetSize() == 0);
+
+    // Without verification, the NcaID is not checked.
+    InstallPipeline unverified_pipeline;
+    unverified_pipeline.Queue(std::make_shared<VectorVfsFile>(data), bad_dest, id);
+    REQUIRE(unverified_pipeline.Run());
+    REQUIRE(bad_dest->ReadAllBytes() == data);
+}
+
+TEST_CASE("InstallPipeline: Installs can be cancelled", "[core]") {
+    InstallPipeline pipeline{[](const InstallProgress&) { return true; }};
+    pipeline.Queue(std::make_shared<VectorVfsFile>(MakeData(1_MiB, 3)),
+                   std::make_shared<VectorVfsFile>());
+    REQUIRE(!pipeline.Run());
+}
+
+TEST_CASE("InstallPipeline: Failed writes are not counted as installed", "[core]") {
+    InstallProgress last_progress{};
+    InstallPipeline pipeline{[&last_progress](const InstallProgress& progress) {
+        last_progress = progress;
+        return false;
+    }};
+    const auto dest = std::make_shared<FailingFile>(InstallPipeline::BlockSize);
+    pipeline.Queue(std::make_shared<VectorVfsFile>(MakeData(InstallPipeline::BlockSize * 3, 5)),
+                   dest);
+
+    REQUIRE(!pipeline.Run());
+    REQUIRE(dest->GetSize() == 0);
+    REQUIRE(last_progress.installed_size == InstallPipeline::BlockSize);
+}
+
+TEST_CASE("InstallPipeline: Cleared files are not copied", "[core]") {
+    InstallPipeline pipeline;
+    const auto dest = std::make_shared<VectorVfsFile>();
+    pipeline.Queue(std::make_shared<VectorVfsFile>(MakeData(1_MiB, 9)), dest);
+    pipeline.Clear();
+
+    REQUIRE(pipeline.Run());
+    REQUIRE(dest->GetSize() == 0);
+}
+
+} // namespace FileSys
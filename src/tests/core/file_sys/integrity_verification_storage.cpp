@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/crypto/sha256_engine.h"
+#include "core/file_sys/fssystem/fssystem_integrity_verification_storage.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr size_t BlockSize = 0x4000;
+constexpr size_t BlockCount = 16;
+constexpr size_t TamperedBlock = 9;
+constexpr size_t HashSize = IntegrityVerificationStorage::HashSize;
+
+/// Data storage of BlockCount blocks, and the storage of the hashes of its blocks.
+struct VerifiedData {
+    VerifiedData() : data(BlockSize * BlockCount) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<u8>(i * 7 + i / BlockSize);
+        }
+        std::vector<u8> hashes(BlockCount * HashSize);
+        for (size_t block = 0; block < BlockCount; ++block) {
+            const auto hash =
+                Core::Crypto::Sha256::Compute({data.data() + block * BlockSize, BlockSize});
+            std::memcpy(hashes.data() + block * hash.size(), hash.data(), hash.size());
+        }
+        hash_storage = std::make_shared<VectorVfsFile>(std::move(hashes));
+    }
+
+    std::vector<u8> data;
+    VirtualFile hash_storage;
+};
+
+/// Reads the first block, which queues the verification of the following ones.
+void ReadFirstBlock(const IntegrityVerificationStorage& storage, std::mutex& read_mutex,
+                    std::span<const u8> expected) {
+    std::vector<u8> buffer(BlockSize);
+    std::scoped_lock lock{read_mutex};
+    REQUIRE(storage.Read(buffer.data(), buffer.size(), 0) == buffer.size());
+    REQUIRE(std::memcmp(buffer.data(), expected.data(), BlockSize) == 0);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("IntegrityVerificationStorage: Verification ahead reports tampered blocks", "[core]") {
+    const bool verify = Settings::values.verify_content_integrity.GetValue();
+    const bool verify_ahead = Settings::values.integrity_verify_ahead.GetValue();
+    Settings::values.verify_content_integrity.SetValue(true);
+    Settings::values.integrity_verify_ahead.SetValue(true);
+    SCOPE_EXIT {
+        Settings::values.verify_content_integrity.SetValue(verify);
+        Settings::values.integrity_verify_ahead.SetValue(verify_ahead);
+    };
+    VerifiedData verified;
+    std::vector<u8> tampered = verified.data;
+    tampered[TamperedBlock * BlockSize + 0x123] ^= 0xFF;
+
+    std::mutex read_mutex;
+    IntegrityVerificationStorage storage;
+    storage.Initialize(verified.hash_storage, std::make_shared<VectorVfsFile>(tampered),
+                       BlockSize, HashSize, true,
+                       std::addressof(read_mutex));
+
+    ReadFirstBlock(storage, read_mutex, tampered);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (!storage.HasDetectedCorruption() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    REQUIRE(storage.HasDetectedCorruption());
+}
+
+TEST_CASE("IntegrityVerificationStorage: Intact data verifies", "[core]") {
+    const bool verify = Settings::values.verify_content_integrity.GetValue();
+    const bool verify_ahead = Settings::values.integrity_verify_ahead.GetValue();
+    Settings::values.verify_content_integrity.SetValue(true);
+    Settings::values.integrity_verify_ahead.SetValue(true);
+    SCOPE_EXIT {
+        Settings::values.verify_content_integrity.SetValue(verify);
+        Settings::values.integrity_verify_ahead.SetValue(verify_ahead);
+    };
+    VerifiedData verified;
+
+    std::mutex read_mutex;
+    IntegrityVerificationStorage storage;
+    storage.Initialize(verified.hash_storage, std::make_shared<VectorVfsFile>(verified.data),
+                       BlockSize, HashSize, true,
+                       std::addressof(read_mutex));
+
+    ReadFirstBlock(storage, read_mutex, verified.data);
+    std::vector<u8> buffer(BlockSize * BlockCount);
+    {
+        std::scoped_lock lock{read_mutex};
+        REQUIRE(storage.Read(buffer.data(), buffer.size(), 0) == buffer.size());
+    }
+    REQUIRE(buffer == verified.data);
+
+    // Finalizing waits for the verification running ahead.
+    storage.Finalize();
+    REQUIRE(!storage.HasDetectedCorruption());
+}
+
+} // namespace FileSys
@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <span>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/fs/file.h"
+#include "common/fs/path_util.h"
+#include "common/literals.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/file_sys/vfs/vfs_real.h"
+
+namespace FileSys {
+
+namespace {
+
+using namespace Common::Literals;
+
+struct TemporaryFile {
+    explicit TemporaryFile(std::size_t size)
+        : path{std::filesystem::temp_directory_path() / "suyu_real_vfs_file_test.bin"},
+          data(size) {
+        std::mt19937 rng{size};
+        std::ranges::generate(data, [&rng] { return static_cast<u8>(rng()); });
+
+        const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write,
+                                      Common::FS::FileType::BinaryFile};
+        REQUIRE(file.WriteSpan<u8>(data) == data.size());
+    }
+    ~TemporaryFile() {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+    std::vector<u8> data;
+};
+
+/// Reads the file in the given pieces and checks them against the data written to it.
+void CheckReads(const VirtualFile& file, std::span<const u8> expected, std::size_t piece_size,
+                std::size_t stride) {
+    std::vector<u8> buffer(piece_size);
+    for (std::size_t offset = 0; offset < expected.size(); offset += stride) {
+        const auto read_size = std::min(piece_size, expected.size() - offset);
+        REQUIRE(file->Read(buffer.data(), piece_size, offset) == read_size);
+        REQUIRE(std::ranges::equal(std::span{buffer}.first(read_size),
+                                   expected.subspan(offset, read_size)));
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RealVfsFile: Small reads are served from read-ahead blocks", "[core]") {
+    const bool map_real_files = Settings::values.map_real_files.GetValue();
+    const bool read_ahead = Settings::values.real_file_read_ahead.GetValue();
+    SCOPE_EXIT {
+        Settings::values.map_real_files.SetValue(map_real_files);
+        Settings::values.real_file_read_ahead.SetValue(read_ahead);
+    };
+    Settings::values.map_real_files.SetValue(false);
+    Settings::values.real_file_read_ahead.SetValue(true);
+
+    const TemporaryFile temp{3_MiB + 123};
+    RealVfsFilesystem filesystem;
+    const auto file = filesystem.OpenFile(Common::FS::PathToUTF8String(temp.path));
+    REQUIRE(file != nullptr);
+
+    CheckReads(file, temp.data, 0x200, 0x200);
+    const auto sequential = filesystem.GetStatistics();
+    REQUIRE(sequential.reads == (temp.data.size() + 0x1FF) / 0x200);
+    REQUIRE(sequential.host_reads < 16);
+    REQUIRE(sequential.cache_hits + sequential.host_reads == sequential.reads);
+    REQUIRE(sequential.read_ahead_bytes > 0);
+
+    // Scattered reads reuse the blocks around them.
+    CheckReads(file, temp.data, 0x20, 0x1003);
+    const auto scattered = filesystem.GetStatistics();
+    REQUIRE(scattered.cache_hits > sequential.cache_hits);
+
+    // Large reads and reads past the end of the file bypass the cache.
+    CheckReads(file, temp.data, 1_MiB, 1_MiB - 1);
+    u8 byte{};
+    REQUIRE(file->Read(&byte, 1, temp.data.size()) == 0);
+}
+
+TEST_CASE("RealVfsFile: Large files are read through a mapping", "[core]") {
+    const bool map_real_files = Settings::values.map_real_files.GetValue();
+    SCOPE_EXIT {
+        Settings::values.map_real_files.SetValue(map_real_files);
+    };
+    Settings::values.map_real_files.SetValue(true);
+
+    const TemporaryFile temp{16_MiB + 5};
+    RealVfsFilesystem filesystem;
+    const auto file = filesystem.OpenFile(Common::FS::PathToUTF8String(temp.path));
+    REQUIRE(file != nullptr);
+
+    CheckReads(file, temp.data, 0x100, 0x10001);
+    CheckReads(file, temp.data, 4_MiB, 4_MiB);
+    const auto stats = filesystem.GetStatistics();
+    REQUIRE(stats.mapped_reads == stats.reads);
+    REQUIRE(stats.host_reads == 0);
+
+    // The mapping is also handed out as a view.
+    const auto view = file->GetView(0x1000, temp.data.size() - 0x10);
+    REQUIRE(std::ranges::equal(view, std::span{temp.data}.last(0x10)));
+}
+
+TEST_CASE("RealVfsFile: Writes through another handle invalidate cached blocks", "[core]") {
+    const bool read_ahead = Settings::values.real_file_read_ahead.GetValue();
+    SCOPE_EXIT {
+        Settings::values.real_file_read_ahead.SetValue(read_ahead);
+    };
+    Settings::values.real_file_read_ahead.SetValue(true);
+
+    TemporaryFile temp{256_KiB};
+    const auto path = Common::FS::PathToUTF8String(temp.path);
+    RealVfsFilesystem reader_filesystem;
+    RealVfsFilesystem writer_filesystem;
+    const auto reader = reader_filesystem.OpenFile(path);
+    REQUIRE(reader != nullptr);
+    CheckReads(reader, temp.data, 0x200, 0x200);
+
+    const auto writer = writer_filesystem.OpenFile(path, OpenMode::ReadWrite);
+    REQUIRE(writer != nullptr);
+    std::ranges::fill(std::span{temp.data}.subspan(0x1000, 0x3000), u8{0xAB});
+    REQUIRE(writer->Write(temp.data.data() + 0x1000, 0x3000, 0x1000) == 0x3000);
+    CheckReads(reader, temp.data, 0x200, 0x200);
+
+    temp.data.resize(0x2100);
+    REQUIRE(writer->Resize(temp.data.size()));
+    CheckReads(reader, temp.data, 0x200, 0x200);
+    u8 byte{};
+    REQUIRE(reader->Read(&byte, 1, temp.data.size()) == 0);
+}
+
+TEST_CASE("RealVfsFile: Mappings of truncated files are not read", "[core]") {
+    const bool map_real_files = Settings::values.map_real_files.GetValue();
+    SCOPE_EXIT {
+        Settings::values.map_real_files.SetValue(map_real_files);
+    };
+    Settings::values.map_real_files.SetValue(true);
+
+    TemporaryFile temp{16_MiB + 5};
+    const auto path = Common::FS::PathToUTF8String(temp.path);
+    RealVfsFilesystem reader_filesystem;
+    RealVfsFilesystem writer_filesystem;
+    const auto reader = reader_filesystem.OpenFile(path);
+    REQUIRE(reader != nullptr);
+    CheckReads(reader, temp.data, 0x100, 1_MiB);
+    REQUIRE(reader_filesystem.GetStatistics().mapped_reads > 0);
+
+    // Writes that keep the file size still go through the mapping, and are seen through it.
+    const auto writer = writer_filesystem.OpenFile(path, OpenMode::ReadWrite);
+    REQUIRE(writer != nullptr);
+    temp.data[0x10] = static_cast<u8>(~temp.data[0x10]);
+    REQUIRE(writer->Write(&temp.data[0x10], 1, 0x10) == 1);
+    CheckReads(reader, temp.data, 0x100, 1_MiB);
+    REQUIRE(reader_filesystem.GetStatistics().host_reads == 0);
+
+    // Reading the mapping past the new end of the file would raise SIGBUS.
+    temp.data.resize(1_MiB);
+    REQUIRE(writer->Resize(temp.data.size()));
+    CheckReads(reader, temp.data, 0x100, 0x10000);
+    u8 byte{};
+    REQUIRE(reader->Read(&byte, 1, 8_MiB) == 0);
+    REQUIRE(reader->GetView(0x10, 0).empty());
+    REQUIRE(reader_filesystem.GetStatistics().host_reads > 0);
+}
+
+} // namespace FileSys
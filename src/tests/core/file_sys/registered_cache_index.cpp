@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_sys/content_archive.h"
+#include "core/file_sys/registered_cache_index.h"
+
+namespace FileSys {
+
+namespace {
+
+RegisteredCacheIndex::NcaID MakeID(u8 value) {
+    RegisteredCacheIndex::NcaID id{};
+    id.fill(value);
+    return id;
+}
+
+RegisteredCacheIndex::Entry MakeEntry(u64 title_id, bool is_meta) {
+    return {
+        .path = "/00000012/" + std::to_string(title_id) + ".nca",
+        .size = 0x1000 + title_id,
+        .modified = 1700000000 + title_id,
+        .type = is_meta ? NCAContentType::Meta : NCAContentType::Program,
+        .title_id = title_id,
+        .cnmt = is_meta ? std::vector<u8>(0x78, static_cast<u8>(title_id)) : std::vector<u8>{},
+    };
+}
+
+void RequireSameEntry(const RegisteredCacheIndex::Entry* entry,
+                      const RegisteredCacheIndex::Entry& expected) {
+    REQUIRE(entry != nullptr);
+    REQUIRE(entry->path == expected.path);
+    REQUIRE(entry->size == expected.size);
+    REQUIRE(entry->modified == expected.modified);
+    REQUIRE(entry->type == expected.type);
+    REQUIRE(entry->title_id == expected.title_id);
+    REQUIRE(entry->cnmt == expected.cnmt);
+}
+
+struct TemporaryPath {
+    TemporaryPath()
+        : path{std::filesystem::temp_directory_path() / "suyu_registered_cache_index_test.bin"} {
+        std::filesystem::remove(path);
+    }
+    ~TemporaryPath() {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("RegisteredCacheIndex: Entries persist across loads", "[core]") {
+    const TemporaryPath temp;
+    {
+        RegisteredCacheIndex index{temp.path};
+        REQUIRE(index.GetSize() == 0);
+        index.Insert(MakeID(1), MakeEntry(1, true));
+        index.Insert(MakeID(2), MakeEntry(2, false));
+        index.Insert(MakeID(3), MakeEntry(3, true));
+        index.Save();
+    }
+
+    RegisteredCacheIndex index{temp.path};
+    REQUIRE(index.GetSize() == 3);
+    RequireSameEntry(index.Find(MakeID(1)), MakeEntry(1, true));
+    RequireSameEntry(index.Find(MakeID(2)), MakeEntry(2, false));
+    RequireSameEntry(index.Find(MakeID(3)), MakeEntry(3, true));
+    REQUIRE(index.Find(MakeID(4)) == nullptr);
+
+    // NCAs that disappeared are dropped, removed NCAs are dropped right away.
+    const std::array present{MakeID(1), MakeID(3)};
+    index.Retain(present);
+    index.Save();
+    index.Erase(MakeID(3));
+
+    const RegisteredCacheIndex reloaded{temp.path};
+    REQUIRE(reloaded.GetSize() == 1);
+    RequireSameEntry(reloaded.Find(MakeID(1)), MakeEntry(1, true));
+}
+
+TEST_CASE("RegisteredCacheIndex: Corrupted indices are discarded", "[core]") {
+    const TemporaryPath temp;
+    {
+        RegisteredCacheIndex index{temp.path};
+        index.Insert(MakeID(1), MakeEntry(1, true));
+        index.Save();
+    }
+
+    SECTION("Modified payload") {
+        std::fstream file{temp.path, std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(0x40);
+        file.put('X');
+    }
+    SECTION("Truncated file") {
+        std::filesystem::resize_file(temp.path, std::filesystem::file_size(temp.path) - 1);
+    }
+
+    const RegisteredCacheIndex index{temp.path};
+    REQUIRE(index.GetSize() == 0);
+}
+
+} // namespace FileSys
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/romfs_build_cache.h"
+#include "core/file_sys/vfs/vfs_layered.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+VirtualFile MakeFile(std::string name, std::size_t size, u8 fill) {
+    return std::make_shared<VectorVfsFile>(std::vector<u8>(size, fill), std::move(name));
+}
+
+std::shared_ptr<VectorVfsDirectory> MakeDir(std::string name, std::vector<VirtualFile> files,
+                                            std::vector<VirtualDir> subdirs = {}) {
+    return std::make_shared<VectorVfsDirectory>(std::move(files), std::move(subdirs),
+                                                std::move(name));
+}
+
+/// Returns the RomFS the layers build without the cache, as they were built before it.
+std::vector<u8> BuildUncached(const VirtualFile& base, std::vector<VirtualDir> layers,
+                              std::vector<VirtualDir> ext_layers) {
+    layers.push_back(ExtractRomFS(base));
+    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
+    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(ext_layers));
+    const auto romfs = CreateRomFS(std::move(layered), std::move(layered_ext));
+    return romfs->ReadAllBytes();
+}
+
+struct TemporaryPath {
+    TemporaryPath()
+        : path{std::filesystem::temp_directory_path() / "suyu_romfs_build_cache_test.bin"} {
+        std::filesystem::remove(path);
+    }
+    ~TemporaryPath() {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("RomFSBuildCache: Cached builds match uncached builds", "[core]") {
+    const TemporaryPath temp;
+    const auto base = CreateRomFS(MakeDir(
+        "", {MakeFile("main.bin", 0x123, 1)},
+        {MakeDir("data", {MakeFile("a.bin", 0x40, 2), MakeFile("b.bin", 0x1001, 3)},
+                 {MakeDir("nested", {MakeFile("c.bin", 0x10, 4)})}),
+         MakeDir("sound", {MakeFile("bgm.bin", 0x2000, 5)}),
+         MakeDir("text", {MakeFile("en.txt", 0x33, 6)})}));
+    REQUIRE(base != nullptr);
+
+    const auto mod_data = MakeDir("data", {MakeFile("a.bin", 0x80, 7)});
+    const auto mod = MakeDir("romfs", {}, {mod_data});
+    const auto ext = MakeDir("romfs_ext", {MakeFile("text.stub", 0, 0)});
+    const auto build = [&] {
+        const auto romfs = CreateLayeredRomFS(base, {mod}, {ext}, temp.path);
+        REQUIRE(romfs != nullptr);
+        return romfs->ReadAllBytes();
+    };
+
+    // The first build lays out the whole RomFS and caches the layout.
+    const auto expected = BuildUncached(base, {mod}, {ext});
+    REQUIRE(build() == expected);
+    REQUIRE(std::filesystem::exists(temp.path));
+
+    // The layout of an unchanged set of layers is reused as is.
+    const auto cache = RomFSBuildCache::Load(temp.path);
+    REQUIRE(cache.has_value());
+    REQUIRE(cache->files.size() == 5);
+    REQUIRE(build() == expected);
+
+    // Changing the mods below a top level directory only rebuilds that directory.
+    mod_data->AddFile(MakeFile("d.bin", 0x20, 8));
+    mod->AddDirectory(MakeDir("sound", {MakeFile("bgm.bin", 0x10, 9)}));
+    REQUIRE(build() == BuildUncached(base, {mod}, {ext}));
+    REQUIRE(build() == BuildUncached(base, {mod}, {ext}));
+
+    // Removing the stub brings back the directory it hid.
+    REQUIRE(ext->DeleteFile("text.stub"));
+    REQUIRE(build() == BuildUncached(base, {mod}, {ext}));
+}
+
+TEST_CASE("RomFSBuildCache: Stale caches are discarded", "[core]") {
+    const TemporaryPath temp;
+    const auto mod = MakeDir("romfs", {MakeFile("main.bin", 0x10, 1)});
+
+    const auto first =
+        CreateRomFS(MakeDir("", {}, {MakeDir("data", {MakeFile("a.bin", 0x40, 1)})}));
+    REQUIRE(first != nullptr);
+    REQUIRE(CreateLayeredRomFS(first, {mod}, {}, temp.path) != nullptr);
+
+    // A different base RomFS does not reuse the layout of the previous one.
+    const auto second = CreateRomFS(
+        MakeDir("", {}, {MakeDir("data", {MakeFile("a.bin", 0x40, 2), MakeFile("b", 1, 3)})}));
+    const auto romfs = CreateLayeredRomFS(second, {mod}, {}, temp.path);
+    REQUIRE(romfs != nullptr);
+    REQUIRE(romfs->ReadAllBytes() == BuildUncached(second, {mod}, {}));
+
+    // Files whose sources changed size are laid out again.
+    const auto resized = MakeFile("main.bin", 0x20, 1);
+    REQUIRE(mod->DeleteFile("main.bin"));
+    mod->AddFile(resized);
+    REQUIRE(CreateLayeredRomFS(second, {mod}, {}, temp.path)->ReadAllBytes() ==
+            BuildUncached(second, {mod}, {}));
+
+    // A corrupted cache is rebuilt.
+    std::filesystem::resize_file(temp.path, std::filesystem::file_size(temp.path) - 1);
+    REQUIRE(!RomFSBuildCache::Load(temp.path).has_value());
+    REQUIRE(CreateLayeredRomFS(second, {mod}, {}, temp.path)->ReadAllBytes() ==
+            BuildUncached(second, {mod}, {}));
+}
+
+} // namespace FileSys
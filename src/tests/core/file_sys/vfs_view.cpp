@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs/vfs_concat.h"
+#include "core/file_sys/vfs/vfs_offset.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+std::vector<u8> MakeData(std::size_t size, u8 first) {
+    std::vector<u8> data(size);
+    std::iota(data.begin(), data.end(), first);
+    return data;
+}
+
+/// Checks that the view of the range holds the bytes Read returns for it.
+void CheckView(const VirtualFile& file, std::size_t length, std::size_t offset) {
+    const auto view = file->GetView(length, offset);
+    REQUIRE(!view.empty());
+    REQUIRE(std::ranges::equal(view, file->ReadBytes(length, offset)));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("VfsFile: In-memory files are viewed through their wrappers", "[core]") {
+    const auto first = std::make_shared<VectorVfsFile>(MakeData(0x100, 0), "first");
+    const auto second = std::make_shared<VectorVfsFile>(MakeData(0x80, 0x40), "second");
+
+    CheckView(first, 0x100, 0);
+    CheckView(first, 0x200, 0x10);
+    REQUIRE(first->GetView(1, 0x100).empty());
+
+    const VirtualFile offset = std::make_shared<OffsetVfsFile>(first, 0x40, 0x20);
+    CheckView(offset, 0x40, 0);
+    CheckView(offset, 0x100, 0x30);
+    REQUIRE(offset->GetView(0x100, 0x30).size() == 0x10);
+    REQUIRE(offset->GetView(1, 0x40).empty());
+
+    const auto concat = ConcatenatedVfsFile::MakeConcatenatedFile("concat", {first, second});
+    REQUIRE(concat != nullptr);
+    CheckView(concat, 0x100, 0);
+    CheckView(concat, 0x40, 0x120);
+    CheckView(concat, 0x100, 0x140);
+    REQUIRE(concat->GetView(0x20, 0xF0).empty());
+
+    // Reads into spans match reads into pointers.
+    std::vector<u8> buffer(0x30);
+    REQUIRE(concat->ReadSpan(buffer, 0xF0) == buffer.size());
+    REQUIRE(buffer == concat->ReadBytes(0x30, 0xF0));
+}
+
+TEST_CASE("VfsFile: Files outside of memory have no view", "[core]") {
+    const auto data = std::make_shared<VectorVfsFile>(MakeData(0x40, 0), "data");
+
+    // The filler between the files of a concatenation is generated, not stored.
+    const auto concat = ConcatenatedVfsFile::MakeConcatenatedFile(
+        0xFF, "concat", {{0, data}, {0x100, data}});
+    REQUIRE(concat != nullptr);
+    CheckView(concat, 0x40, 0);
+    CheckView(concat, 0x40, 0x100);
+    REQUIRE(concat->GetView(0x10, 0x80).empty());
+
+    // RomFS metadata is extracted the same way from views and copies.
+    const auto romfs = CreateRomFS(std::make_shared<VectorVfsDirectory>(
+        std::vector<VirtualFile>{data}, std::vector<VirtualDir>{}, ""));
+    REQUIRE(romfs != nullptr);
+    const auto copied = std::make_shared<VectorVfsFile>(romfs->ReadAllBytes(), "romfs");
+    for (const VirtualFile& file : {romfs, VirtualFile{copied}}) {
+        const auto extracted = ExtractRomFS(file);
+        REQUIRE(extracted != nullptr);
+        const auto extracted_data = extracted->GetFile("data");
+        REQUIRE(extracted_data != nullptr);
+        REQUIRE(extracted_data->ReadAllBytes() == data->ReadAllBytes());
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/host_memory.h"
+#include "common/page_table.h"
+#include "core/core.h"
+#include "core/device_memory.h"
+#include "core/memory.h"
+
+namespace {
+using Core::Memory::SUYU_PAGEBITS;
+using Core::Memory::SUYU_PAGESIZE;
+
+constexpr std::size_t AddressSpaceBits = 32;
+constexpr u64 PageBase = 0x10000;
+
+/// Memory accessed through a page table that does not belong to a process.
+class MemoryFixture {
+public:
+    MemoryFixture() {
+        system.Initialize();
+        page_table.Resize(AddressSpaceBits, SUYU_PAGEBITS);
+        memory.SetCurrentPageTable(page_table);
+    }
+
+    /// Maps pages of guest memory to the given page of DRAM.
+    void Map(u64 vaddr, u64 num_pages, u64 dram_page) {
+        memory.MapMemoryRegion(page_table, vaddr, num_pages * SUYU_PAGESIZE,
+                               Core::DramMemoryMap::Base + dram_page * SUYU_PAGESIZE,
+                               Common::MemoryPermission::ReadWrite, false);
+    }
+
+    u8* DramPointer(u64 dram_page) {
+        return system.DeviceMemory().GetPointer<u8>(Core::DramMemoryMap::Base +
+                                                    dram_page * SUYU_PAGESIZE);
+    }
+
+    Core::System system;
+    Common::PageTable page_table;
+    Core::Memory::Memory memory{system};
+};
+} // Anonymous namespace
+
+TEST_CASE_METHOD(MemoryFixture, "Memory: Block access across mappings", "[core]") {
+    // Contiguous in guest memory, but the first two mappings are swapped in DRAM and the last one
+    // follows the first mapping in DRAM.
+    Map(PageBase, 4, 8);
+    Map(PageBase + 4 * SUYU_PAGESIZE, 8, 0);
+    Map(PageBase + 12 * SUYU_PAGESIZE, 4, 12);
+
+    // Start and end in the middle of a page, like guest buffers do.
+    const u64 vaddr = PageBase + SUYU_PAGESIZE / 2;
+    std::vector<u8> data(15 * SUYU_PAGESIZE);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 7 + i / SUYU_PAGESIZE);
+    }
+    REQUIRE(memory.WriteBlock(vaddr, data.data(), data.size()));
+
+    std::vector<u8> result(data.size());
+    REQUIRE(memory.ReadBlock(vaddr, result.data(), result.size()));
+    REQUIRE(result == data);
+
+    // Every mapping has been written to its own DRAM pages.
+    const std::size_t offset = SUYU_PAGESIZE / 2;
+    REQUIRE(std::memcmp(DramPointer(8) + offset, data.data(), 4 * SUYU_PAGESIZE - offset) == 0);
+    REQUIRE(std::memcmp(DramPointer(0), data.data() + 4 * SUYU_PAGESIZE - offset,
+                        8 * SUYU_PAGESIZE) == 0);
+    REQUIRE(std::memcmp(DramPointer(12), data.data() + 12 * SUYU_PAGESIZE - offset,
+                        3 * SUYU_PAGESIZE + offset) == 0);
+}
+
+TEST_CASE_METHOD(MemoryFixture, "Memory: Block access of unmapped pages", "[core]") {
+    Map(PageBase, 2, 0);
+    std::memset(DramPointer(0), 0xAB, 2 * SUYU_PAGESIZE);
+
+    // The mapped part is read and the unmapped part reads as zeroes.
+    std::vector<u8> result(4 * SUYU_PAGESIZE, 0xFF);
+    REQUIRE(!memory.ReadBlock(PageBase + SUYU_PAGESIZE, result.data(), result.size()));
+    std::vector<u8> expected(result.size(), 0);
+    std::memset(expected.data(), 0xAB, SUYU_PAGESIZE);
+    REQUIRE(result == expected);
+
+    const std::vector<u8> data(2 * SUYU_PAGESIZE, 0xCD);
+    REQUIRE(!memory.WriteBlock(PageBase + SUYU_PAGESIZE, data.data(), data.size()));
+    REQUIRE(DramPointer(1)[SUYU_PAGESIZE - 1] == 0xCD);
+}
+
+// Hidden by default; run with `tests "[benchmark]"`.
+TEST_CASE_METHOD(MemoryFixture, "Memory: Block read throughput", "[.][benchmark]") {
+    constexpr u64 NumPages = 2048;
+    Map(PageBase, NumPages, 0);
+
+    for (const std::size_t size : {4ULL << 10, 64ULL << 10, 4ULL << 20}) {
+        std::vector<u8> dest(size);
+        BENCHMARK("ReadBlock " + std::to_string(size >> 10) + " KiB") {
+            return memory.ReadBlock(PageBase + SUYU_PAGESIZE / 2, dest.data(), dest.size());
+        };
+    }
+}
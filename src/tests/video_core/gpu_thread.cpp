@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <variant>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/gpu_thread.h"
+
+using VideoCommon::GPUThread::CommandDataContainer;
+using VideoCommon::GPUThread::CommandRing;
+using VideoCommon::GPUThread::SubmitListCommand;
+
+TEST_CASE("GPUThread: Command ring hands commands over in order", "[video_core]") {
+    constexpr u64 NUM_COMMANDS = CommandRing::Capacity * 8;
+    const auto ring = std::make_unique<CommandRing>();
+
+    std::stop_source stop_source;
+    bool all_pushed = true;
+    std::jthread producer([&ring, &stop_source, &all_pushed] {
+        for (u64 fence = 1; fence <= NUM_COMMANDS; ++fence) {
+            CommandDataContainer* const slot = ring->BeginPush(stop_source.get_token());
+            if (!slot) {
+                all_pushed = false;
+                return;
+            }
+            slot->data = SubmitListCommand(static_cast<s32>(fence % 4));
+            slot->entries.command_lists.assign(fence % 3, Tegra::CommandListHeader{fence});
+            slot->fence = fence;
+            ring->EndPush();
+        }
+    });
+
+    bool in_order = true;
+    for (u64 fence = 1; fence <= NUM_COMMANDS; ++fence) {
+        CommandDataContainer* const command = ring->Front(stop_source.get_token());
+        REQUIRE(command != nullptr);
+        const auto* const submit_list = std::get_if<SubmitListCommand>(&command->data);
+        in_order &= submit_list && submit_list->channel == static_cast<s32>(fence % 4) &&
+                    command->fence == fence && command->entries.command_lists.size() == fence % 3;
+        ring->Pop();
+    }
+    producer.join();
+
+    REQUIRE(all_pushed);
+    REQUIRE(in_order);
+    REQUIRE(ring->Size() == 0);
+}
+
+TEST_CASE("GPUThread: Command ring stops waiting when a stop is requested", "[video_core]") {
+    const auto ring = std::make_unique<CommandRing>();
+    std::stop_source stop_source;
+
+    std::jthread stopper([&stop_source] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        stop_source.request_stop();
+    });
+    REQUIRE(ring->Front(stop_source.get_token()) == nullptr);
+}
+
+TEST_CASE("GPUThread: Producers of a full command ring stop waiting on a stop", "[video_core]") {
+    const auto ring = std::make_unique<CommandRing>();
+    std::stop_source stop_source;
+    for (std::size_t i = 0; i < CommandRing::Capacity; ++i) {
+        REQUIRE(ring->BeginPush(stop_source.get_token()) != nullptr);
+        ring->EndPush();
+    }
+
+    std::jthread stopper([&stop_source] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        stop_source.request_stop();
+    });
+    REQUIRE(ring->BeginPush(stop_source.get_token()) == nullptr);
+    REQUIRE(ring->Size() == CommandRing::Capacity);
+}
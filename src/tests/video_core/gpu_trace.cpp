@@ -0,0 +1,244 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "common/page_table.h"
+#include "core/core.h"
+#include "core/device_memory.h"
+#include "core/memory.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/gpu_trace.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+#include "video_core/pte_kind.h"
+
+namespace Tegra::Trace {
+
+namespace {
+
+constexpr std::size_t AddressSpaceBits = 32;
+constexpr VAddr PageBase = 0x10000;
+constexpr GPUVAddr GpuBase = 0x100000;
+constexpr s32 ChannelId = 3;
+constexpr u64 ProgramId = 0x0100000000010000;
+
+constexpr u32 Magic = Common::MakeMagic('S', 'G', 'P', 'T');
+constexpr u32 Version = 1;
+
+/// Two pages of guest memory mapped in the address space of a channel, at GpuBase.
+class TraceFixture {
+public:
+    TraceFixture() {
+        system.Initialize();
+        page_table.Resize(AddressSpaceBits, Core::Memory::SUYU_PAGEBITS);
+        memory.SetCurrentPageTable(page_table);
+        memory.MapMemoryRegion(page_table, PageBase, 2 * PageSize, Core::DramMemoryMap::Base,
+                               Common::MemoryPermission::ReadWrite, false);
+
+        auto& device_memory = host1x.MemoryManager();
+        asid = device_memory.RegisterProcess(&memory);
+        const DAddr device_addr = device_memory.Allocate(2 * PageSize);
+        device_memory.Map(device_addr, PageBase, 2 * PageSize, asid);
+
+        channel.program_id = ProgramId;
+        channel.memory_manager = std::make_shared<MemoryManager>(system, device_memory);
+        channel.memory_manager->Map(GpuBase, device_addr, 2 * PageSize, PTEKind::PITCH, false);
+
+        for (u64 page = 0; page < 2; ++page) {
+            std::fill_n(DramPointer(page), PageSize, static_cast<u8>(0x10 + page));
+        }
+    }
+
+    ~TraceFixture() {
+        host1x.MemoryManager().UnregisterProcess(asid);
+        std::filesystem::remove(path);
+    }
+
+    u8* DramPointer(u64 page) {
+        return system.DeviceMemory().GetPointer<u8>(Core::DramMemoryMap::Base + page * PageSize);
+    }
+
+    std::vector<u8> PageContents(u64 page) {
+        return std::vector<u8>(DramPointer(page), DramPointer(page) + PageSize);
+    }
+
+    /// Returns a submission of a command list crossing from the first page to the second one.
+    static CommandList CrossingSubmission() {
+        CommandList entries(1);
+        entries.command_lists[0].addr.Assign(GpuBase + PageSize - 0x10);
+        entries.command_lists[0].size.Assign(8);
+        return entries;
+    }
+
+    Core::System system;
+    Tegra::Host1x::Host1x host1x{system};
+    Common::PageTable page_table;
+    Core::Memory::Memory memory{system};
+    Core::Asid asid{};
+    Control::ChannelState channel{ChannelId};
+    std::filesystem::path path{std::filesystem::temp_directory_path() / "suyu_gpu_trace_test.sgt"};
+};
+
+template <typename T>
+T NextRecord(Reader& reader) {
+    std::optional<Record> record = reader.ReadRecord();
+    REQUIRE(record.has_value());
+    REQUIRE(std::holds_alternative<T>(*record));
+    return std::get<T>(std::move(*record));
+}
+
+void RequireMemoryRecord(Reader& reader, GPUVAddr gpu_addr, std::span<const u8> data) {
+    const auto record = NextRecord<MemoryRecord>(reader);
+    REQUIRE(record.address_space == 0);
+    REQUIRE(record.gpu_addr == gpu_addr);
+    REQUIRE(std::ranges::equal(record.data, data));
+}
+
+void RequireSubmitRecord(Reader& reader, const CommandList& entries) {
+    const auto record = NextRecord<SubmitRecord>(reader);
+    REQUIRE(record.channel == ChannelId);
+    REQUIRE(std::ranges::equal(
+        record.entries.command_lists, entries.command_lists,
+        [](const auto& lhs, const auto& rhs) { return lhs.raw == rhs.raw; }));
+    REQUIRE(std::ranges::equal(
+        record.entries.prefetch_command_list, entries.prefetch_command_list,
+        [](const auto& lhs, const auto& rhs) { return lhs.argument == rhs.argument; }));
+}
+
+/// Writes a file made of the given words, to build malformed traces.
+void WriteWords(const std::filesystem::path& path, std::initializer_list<u32> words) {
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write,
+                                  Common::FS::FileType::BinaryFile};
+    REQUIRE(file.WriteSpan(std::span{words.begin(), words.size()}) == words.size());
+}
+
+/// Returns true if the trace opens and its first record is rejected, closing the reader.
+bool RejectsFirstRecord(const std::filesystem::path& path) {
+    Reader reader{path};
+    return reader.IsOpen() && !reader.ReadRecord() && !reader.IsOpen();
+}
+
+} // Anonymous namespace
+
+TEST_CASE_METHOD(TraceFixture, "GPU trace: Recorded records are read back", "[video_core]") {
+    const CommandList crossing = CrossingSubmission();
+    CommandList prefetch;
+    prefetch.prefetch_command_list.resize(2);
+    prefetch.prefetch_command_list[0].argument = 0x20018000;
+    prefetch.prefetch_command_list[1].argument = 0x12345678;
+
+    const std::vector<u8> first_page = PageContents(0);
+    const std::vector<u8> second_page = PageContents(1);
+    {
+        Recorder recorder{path};
+        REQUIRE(recorder.IsOpen());
+        recorder.RecordChannel(channel);
+        recorder.RecordSubmission(ChannelId, crossing);
+        // Pages that did not change since they were recorded are not recorded again.
+        recorder.RecordSubmission(ChannelId, crossing);
+        DramPointer(1)[0x20] = 0xFF;
+        recorder.RecordSubmission(ChannelId, crossing);
+        recorder.RecordSubmission(ChannelId, prefetch);
+        // Submissions to channels that were not recorded are dropped.
+        recorder.RecordSubmission(ChannelId + 1, crossing);
+    }
+
+    Reader reader{path};
+    REQUIRE(reader.IsOpen());
+
+    const auto channel_record = NextRecord<ChannelRecord>(reader);
+    REQUIRE(channel_record.channel == ChannelId);
+    REQUIRE(channel_record.address_space == 0);
+    REQUIRE(channel_record.program_id == ProgramId);
+
+    RequireMemoryRecord(reader, GpuBase, first_page);
+    RequireMemoryRecord(reader, GpuBase + PageSize, second_page);
+    RequireSubmitRecord(reader, crossing);
+    RequireSubmitRecord(reader, crossing);
+    RequireMemoryRecord(reader, GpuBase + PageSize, PageContents(1));
+    RequireSubmitRecord(reader, crossing);
+    RequireSubmitRecord(reader, prefetch);
+
+    REQUIRE(!reader.ReadRecord());
+    REQUIRE(reader.IsOpen());
+}
+
+TEST_CASE_METHOD(TraceFixture, "GPU trace: Truncated traces are rejected", "[video_core]") {
+    {
+        Recorder recorder{path};
+        recorder.RecordChannel(channel);
+        recorder.RecordSubmission(ChannelId, CrossingSubmission());
+    }
+    const u64 size = std::filesystem::file_size(path);
+
+    // Cut in the payload of the submission, then in the header of the first page.
+    constexpr u64 ChannelRecordEnd = 8 + 8 + 0x10;
+    for (const u64 truncated_size : {size - 1, ChannelRecordEnd + 4}) {
+        std::filesystem::resize_file(path, truncated_size);
+        Reader reader{path};
+        REQUIRE(reader.IsOpen());
+        REQUIRE(reader.ReadRecord().has_value());
+        while (reader.ReadRecord()) {
+        }
+        REQUIRE(!reader.IsOpen());
+    }
+
+    // A trace cut at the end of a record reads as a shorter trace.
+    std::filesystem::resize_file(path, ChannelRecordEnd);
+    Reader reader{path};
+    REQUIRE(NextRecord<ChannelRecord>(reader).channel == ChannelId);
+    REQUIRE(!reader.ReadRecord());
+    REQUIRE(reader.IsOpen());
+}
+
+TEST_CASE_METHOD(TraceFixture, "GPU trace: Malformed traces are rejected", "[video_core]") {
+    WriteWords(path, {Magic + 1, Version});
+    REQUIRE(!Reader{path}.IsOpen());
+
+    WriteWords(path, {Magic, Version + 1});
+    REQUIRE(!Reader{path}.IsOpen());
+
+    WriteWords(path, {Magic});
+    REQUIRE(!Reader{path}.IsOpen());
+
+    // Unknown record type
+    WriteWords(path, {Magic, Version, 3, 4, 0});
+    REQUIRE(RejectsFirstRecord(path));
+
+    // Channel record of the wrong size
+    WriteWords(path, {Magic, Version, 0, 12, ChannelId, 0, 0});
+    REQUIRE(RejectsFirstRecord(path));
+
+    // Memory record without the contents of the page
+    WriteWords(path, {Magic, Version, 1, 0x10, 0, 0, GpuBase, 0});
+    REQUIRE(RejectsFirstRecord(path));
+
+    // Submit records whose counts do not match their size
+    WriteWords(path, {Magic, Version, 2, 0x10, ChannelId, 1, 0, 0});
+    REQUIRE(RejectsFirstRecord(path));
+    WriteWords(path, {Magic, Version, 2, 0x18, ChannelId, 0, 1, 0, 0, 0});
+    REQUIRE(RejectsFirstRecord(path));
+
+    // The same submit record with matching counts is read
+    WriteWords(path, {Magic, Version, 2, 0x18, ChannelId, 1, 0, 0, 0x1000, 0x100});
+    Reader reader{path};
+    const auto record = NextRecord<SubmitRecord>(reader);
+    REQUIRE(record.entries.command_lists.size() == 1);
+    REQUIRE(record.entries.command_lists[0].raw == 0x100'0000'1000ULL);
+    REQUIRE(record.entries.prefetch_command_list.empty());
+}
+
+} // namespace Tegra::Trace
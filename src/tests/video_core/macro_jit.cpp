@@ -0,0 +1,359 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#if defined(ARCHITECTURE_x86_64) || (defined(ARCHITECTURE_arm64) && defined(SUYU_ARM64_MACRO_JIT))
+
+#include <array>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/core.h"
+#include "core/device_memory.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/host1x/gpu_device_memory_manager.h"
+#include "video_core/macro/macro.h"
+#include "video_core/macro/macro_interpreter.h"
+#include "video_core/memory_manager.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/macro/macro_jit_x64.h"
+#else
+#include "video_core/macro/macro_jit_arm64.h"
+#endif
+
+namespace {
+using Tegra::Engines::Maxwell3D;
+using Tegra::Macro::ALUOperation;
+using Tegra::Macro::BranchCondition;
+using Tegra::Macro::Opcode;
+using Tegra::Macro::Operation;
+using Tegra::Macro::ResultOperation;
+
+#ifdef ARCHITECTURE_x86_64
+using MacroJIT = Tegra::MacroJITx64;
+#else
+using MacroJIT = Tegra::MacroJITArm64;
+#endif
+
+// Macros are uploaded to this method of the engines under test.
+constexpr u32 MACRO_METHOD = 0;
+// Consecutive state registers the macros read from and send to.
+constexpr u32 WINDOW_SIZE = 64;
+
+u32 AddImmediate(ResultOperation result, u32 dst, u32 src_a, s32 immediate) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::AddImmediate);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(immediate);
+    return opcode.raw;
+}
+
+u32 Alu(ALUOperation operation, ResultOperation result, u32 dst, u32 src_a, u32 src_b) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::ALU);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.src_b.Assign(src_b);
+    opcode.alu_operation.Assign(operation);
+    return opcode.raw;
+}
+
+u32 Bitfield(Operation operation, ResultOperation result, u32 dst, u32 src_a, u32 src_b,
+             u32 src_bit, u32 size, u32 dst_bit) {
+    Opcode opcode{};
+    opcode.operation.Assign(operation);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.src_b.Assign(src_b);
+    opcode.bf_src_bit.Assign(src_bit);
+    opcode.bf_size.Assign(size);
+    opcode.bf_dst_bit.Assign(dst_bit);
+    return opcode.raw;
+}
+
+u32 Read(ResultOperation result, u32 dst, s32 method) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::Read);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.immediate.Assign(method);
+    return opcode.raw;
+}
+
+u32 Branch(BranchCondition condition, bool annul, u32 src_a, s32 offset) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::Branch);
+    opcode.branch_condition.Assign(condition);
+    opcode.branch_annul.Assign(annul ? 1 : 0);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(offset);
+    return opcode.raw;
+}
+
+u32 Exit(u32 raw) {
+    Opcode opcode{raw};
+    opcode.is_exit.Assign(1);
+    return opcode.raw;
+}
+
+/// Sets the method address to the given method, incrementing it by one after every send.
+u32 SetMethod(u32 method) {
+    return AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0,
+                        static_cast<s32>(method | (1U << 12)));
+}
+
+u32 Send(u32 reg) {
+    return AddImmediate(ResultOperation::MoveAndSend, 0, reg, 0);
+}
+
+u32 Nop() {
+    return AddImmediate(ResultOperation::Move, 0, 0, 0);
+}
+
+class MacroJITFixture {
+public:
+    MacroJITFixture()
+        : device_memory_manager{device_memory}, memory_manager{system, device_memory_manager, 32} {
+        const auto probe = std::make_unique<Maxwell3D>(system, memory_manager);
+        for (u32 method = 0x100; method + WINDOW_SIZE <= Maxwell3D::Regs::NUM_REGS; ++method) {
+            u32 size = 0;
+            while (size < WINDOW_SIZE && !probe->execution_mask[method + size]) {
+                ++size;
+            }
+            if (size == WINDOW_SIZE) {
+                window = method;
+                return;
+            }
+        }
+        FAIL("No state registers to run macros on");
+    }
+
+    /// Runs the macro on a new engine with the given backend and returns its registers.
+    template <typename Backend>
+    std::vector<u32> Run(const std::vector<u32>& code, const std::vector<u32>& parameters) {
+        const auto maxwell3d = std::make_unique<Maxwell3D>(system, memory_manager);
+        for (u32 i = 0; i < WINDOW_SIZE; ++i) {
+            maxwell3d->regs.reg_array[window + i] = 0x9E3779B9U * (i + 1);
+        }
+        Backend backend{*maxwell3d};
+        for (const u32 word : code) {
+            backend.AddCode(MACRO_METHOD, word);
+        }
+        backend.Execute(MACRO_METHOD, parameters);
+        return {maxwell3d->regs.reg_array.begin(), maxwell3d->regs.reg_array.end()};
+    }
+
+    /// Runs the macro on the interpreter and the JIT, and checks both leave the same registers.
+    std::vector<u32> RunBoth(const std::vector<u32>& code, const std::vector<u32>& parameters) {
+        const std::vector<u32> expected = Run<Tegra::MacroInterpreter>(code, parameters);
+        const std::vector<u32> result = Run<MacroJIT>(code, parameters);
+        REQUIRE(result == expected);
+        return result;
+    }
+
+    u32 window{};
+
+private:
+    Core::System system;
+    Core::DeviceMemory device_memory;
+    Tegra::MaxwellDeviceMemoryManager device_memory_manager;
+    Tegra::MemoryManager memory_manager;
+};
+} // Anonymous namespace
+
+TEST_CASE_METHOD(MacroJITFixture, "MacroJIT: ALU operations", "[video_core]") {
+    std::vector<u32> code{
+        SetMethod(window),
+        AddImmediate(ResultOperation::IgnoreAndFetch, 2, 0, 0),
+    };
+    for (const auto operation :
+         {ALUOperation::Add, ALUOperation::AddWithCarry, ALUOperation::Subtract,
+          ALUOperation::SubtractWithBorrow, ALUOperation::Xor, ALUOperation::Or,
+          ALUOperation::And, ALUOperation::AndNot, ALUOperation::Nand}) {
+        code.push_back(Alu(operation, ResultOperation::MoveAndSend, 0, 1, 2));
+        // Send the carry left by the operation
+        code.push_back(Alu(ALUOperation::AddWithCarry, ResultOperation::MoveAndSend, 0, 0, 0));
+    }
+    code.push_back(Exit(Nop()));
+    code.push_back(Nop());
+
+    constexpr std::array<std::pair<u32, u32>, 5> operands{{
+        {0xFFFFFFFF, 1},
+        {0, 1},
+        {5, 5},
+        {0x80000000, 0x80000000},
+        {1, 0xFFFFFFFF},
+    }};
+    for (const auto& [a, b] : operands) {
+        const std::vector<u32> regs = RunBoth(code, {a, b});
+        REQUIRE(regs[window] == a + b);
+        REQUIRE(regs[window + 1] == (a + b < a ? 1U : 0U));
+    }
+}
+
+TEST_CASE_METHOD(MacroJITFixture, "MacroJIT: Bitfield operations", "[video_core]") {
+    // Source bit, size and destination bit, including fields crossing the top of the register
+    constexpr std::array<std::array<u32, 3>, 7> fields{{
+        {0, 8, 0},
+        {4, 12, 16},
+        {28, 8, 0},
+        {0, 31, 4},
+        {24, 0, 8},
+        {31, 31, 31},
+        {0, 1, 31},
+    }};
+    std::vector<u32> code{
+        SetMethod(window),
+        AddImmediate(ResultOperation::IgnoreAndFetch, 2, 0, 0),
+        AddImmediate(ResultOperation::Move, 3, 0, 7),
+    };
+    for (const auto& [src_bit, size, dst_bit] : fields) {
+        code.push_back(Bitfield(Operation::ExtractInsert, ResultOperation::MoveAndSend, 0, 1, 2,
+                                src_bit, size, dst_bit));
+        code.push_back(Bitfield(Operation::ExtractShiftLeftImmediate,
+                                ResultOperation::MoveAndSend, 0, 3, 2, src_bit, size, dst_bit));
+        code.push_back(Bitfield(Operation::ExtractShiftLeftRegister,
+                                ResultOperation::MoveAndSend, 0, 3, 2, src_bit, size, dst_bit));
+    }
+    code.push_back(Exit(Nop()));
+    code.push_back(Nop());
+
+    const std::vector<u32> regs = RunBoth(code, {0x12345678, 0xDEADBEEF});
+    REQUIRE(regs[window] == 0x123456EF);
+}
+
+TEST_CASE_METHOD(MacroJITFixture, "MacroJIT: Loop with delay slot", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(ResultOperation::Move, 2, 0, 0),
+        AddImmediate(ResultOperation::Move, 4, 0, 0),
+        // Loop: sum the parameters, counting the delay slots run on the way
+        AddImmediate(ResultOperation::IgnoreAndFetch, 3, 0, 0),
+        Alu(ALUOperation::Add, ResultOperation::Move, 2, 2, 3),
+        AddImmediate(ResultOperation::Move, 1, 1, -1),
+        Branch(BranchCondition::NotZero, false, 1, -3),
+        AddImmediate(ResultOperation::Move, 4, 4, 1),
+        SetMethod(window),
+        Send(2),
+        Exit(Send(4)),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 0x55),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 0x66),
+    };
+
+    const std::vector<u32> regs = RunBoth(code, {4, 10, 20, 30, 40});
+    REQUIRE(regs[window] == 100);
+    REQUIRE(regs[window + 1] == 4);
+    REQUIRE(regs[window + 2] == 0x55);
+    REQUIRE(regs[window + 3] != 0x66);
+}
+
+TEST_CASE_METHOD(MacroJITFixture, "MacroJIT: Annulled branch", "[video_core]") {
+    const std::vector<u32> code{
+        SetMethod(window),
+        Branch(BranchCondition::Zero, true, 1, 3),
+        Exit(AddImmediate(ResultOperation::MoveAndSend, 0, 0, 1)),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 2),
+        Exit(AddImmediate(ResultOperation::MoveAndSend, 0, 0, 3)),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 4),
+    };
+
+    std::vector<u32> regs = RunBoth(code, {0});
+    REQUIRE(regs[window] == 3);
+    REQUIRE(regs[window + 1] == 4);
+
+    regs = RunBoth(code, {1});
+    REQUIRE(regs[window] == 1);
+    REQUIRE(regs[window + 1] == 2);
+}
+
+TEST_CASE_METHOD(MacroJITFixture, "MacroJIT: Read registers", "[video_core]") {
+    const std::vector<u32> code{
+        SetMethod(window + WINDOW_SIZE / 2),
+        Read(ResultOperation::MoveAndSend, 0, static_cast<s32>(window)),
+        Read(ResultOperation::Move, 5, static_cast<s32>(window + 3)),
+        Exit(Send(5)),
+        Nop(),
+    };
+
+    const std::vector<u32> regs = RunBoth(code, {0});
+    REQUIRE(regs[window + WINDOW_SIZE / 2] == regs[window]);
+    REQUIRE(regs[window + WINDOW_SIZE / 2 + 1] == regs[window + 3]);
+}
+
+TEST_CASE_METHOD(MacroJITFixture, "MacroJIT: Random programs", "[video_core]") {
+    constexpr size_t NUM_PROGRAMS = 200;
+    constexpr size_t NUM_INSTRUCTIONS = 32;
+    constexpr std::array alu_operations{
+        ALUOperation::Add, ALUOperation::AddWithCarry, ALUOperation::Subtract,
+        ALUOperation::SubtractWithBorrow, ALUOperation::Xor, ALUOperation::Or,
+        ALUOperation::And, ALUOperation::AndNot, ALUOperation::Nand,
+    };
+    // Operations that don't change the method address, so sends stay within the window.
+    constexpr std::array result_operations{
+        ResultOperation::IgnoreAndFetch,
+        ResultOperation::Move,
+        ResultOperation::FetchAndSend,
+        ResultOperation::MoveAndSend,
+    };
+
+    std::mt19937 rng{0x5EED};
+    const auto random = [&rng](u32 max) { return static_cast<u32>(rng() % (max + 1)); };
+
+    std::vector<u32> parameters(NUM_INSTRUCTIONS + 1);
+    for (size_t program = 0; program < NUM_PROGRAMS; ++program) {
+        for (u32& parameter : parameters) {
+            parameter = static_cast<u32>(rng());
+        }
+
+        std::vector<u32> code{SetMethod(window)};
+        for (size_t i = 0; i < NUM_INSTRUCTIONS; ++i) {
+            const ResultOperation result = result_operations[random(result_operations.size() - 1)];
+            const u32 dst = random(7);
+            switch (random(5)) {
+            case 0:
+                code.push_back(Alu(alu_operations[random(alu_operations.size() - 1)], result, dst,
+                                   random(7), random(7)));
+                break;
+            case 1:
+                code.push_back(AddImmediate(result, dst, random(7),
+                                            static_cast<s32>(random(0x3FFFF)) - 0x20000));
+                break;
+            case 2:
+                code.push_back(Bitfield(Operation::ExtractInsert, result, dst, random(7), random(7),
+                                        random(31), random(31), random(31)));
+                break;
+            case 3:
+            case 4:
+                // Shifts by registers are kept within the width of the register
+                code.push_back(AddImmediate(ResultOperation::Move, 7, 0, random(31)));
+                code.push_back(Bitfield(random(1) ? Operation::ExtractShiftLeftImmediate
+                                                  : Operation::ExtractShiftLeftRegister,
+                                        result, dst, 7, random(6), random(31), random(31),
+                                        random(31)));
+                break;
+            case 5:
+                code.push_back(
+                    Read(result, dst, static_cast<s32>(window + random(WINDOW_SIZE - 1))));
+                break;
+            }
+        }
+        for (u32 reg = 1; reg < 8; ++reg) {
+            code.push_back(Send(reg));
+        }
+        code.push_back(Alu(ALUOperation::AddWithCarry, ResultOperation::MoveAndSend, 0, 0, 0));
+        code.push_back(Exit(Nop()));
+        code.push_back(Nop());
+
+        RunBoth(code, parameters);
+    }
+}
+
+#endif
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/macro/macro_profiler.h"
+
+namespace {
+using namespace std::chrono_literals;
+using Tegra::MacroProfiler;
+
+MacroProfiler::Sample MakeSample(std::initializer_list<u32> methods,
+                                 std::chrono::nanoseconds side_effect_time = 0ns) {
+    MacroProfiler::Sample sample;
+    for (const u32 method : methods) {
+        sample.Record(method);
+    }
+    sample.side_effect_time = side_effect_time;
+    return sample;
+}
+} // Anonymous namespace
+
+TEST_CASE("MacroProfiler: Entries are merged by hash", "[video_core]") {
+    MacroProfiler profiler;
+    profiler.Record(0x1234, 16, false, 3, MakeSample({0x100, 0x101}), 10us);
+    profiler.Record(0x1234, 16, false, 5, MakeSample({0x101, 0x102, 0x103}), 20us);
+    profiler.Record(0x5678, 8, true, 1, MakeSample({}), 100us);
+
+    const std::vector<MacroProfiler::Entry> entries = profiler.GetEntries();
+    REQUIRE(entries.size() == 2);
+    REQUIRE(entries[0].hash == 0x5678);
+
+    const MacroProfiler::Entry& entry = entries[1];
+    REQUIRE(entry.hash == 0x1234);
+    REQUIRE(entry.code_size == 16);
+    REQUIRE(entry.invocations == 2);
+    REQUIRE(entry.parameters == 8);
+    REQUIRE(entry.methods == 5);
+    REQUIRE(entry.time == 30us);
+    REQUIRE(entry.written.count() == 4);
+    REQUIRE(entry.written[0x103]);
+
+    profiler.Reset();
+    REQUIRE(profiler.GetEntries().empty());
+}
+
+TEST_CASE("MacroProfiler: HLE candidates", "[video_core]") {
+    MacroProfiler profiler;
+    // Mostly spent drawing, little to save
+    profiler.Record(0xAAAA, 32, false, 4, MakeSample({0x35e}, 90us), 100us);
+    // Already implemented in HLE
+    profiler.Record(0xBBBB, 32, true, 4, MakeSample({}), 200us);
+    // Only writes state, everything can be saved
+    profiler.Record(0xCCCC, 32, false, 4, MakeSample({0x200, 0x201, 0x202}), 50us);
+
+    REQUIRE(profiler.GetEntries()[0].PotentialSavings() == 0ns);
+    REQUIRE(profiler.GetEntries()[1].PotentialSavings() == 10us);
+    REQUIRE(profiler.GetEntries()[2].PotentialSavings() == 50us);
+
+    const std::string report = profiler.GetReport();
+    const auto candidates = report.find("HLE candidates");
+    REQUIRE(candidates != std::string::npos);
+    const auto first = report.find("000000000000cccc", candidates);
+    const auto second = report.find("000000000000aaaa", candidates);
+    REQUIRE(first != std::string::npos);
+    REQUIRE(second != std::string::npos);
+    REQUIRE(first < second);
+    REQUIRE(report.find("000000000000bbbb", candidates) == std::string::npos);
+    REQUIRE(report.find("writes 0x200-0x202") != std::string::npos);
+}
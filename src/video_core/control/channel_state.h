@@ -35,6 +35,7 @@ namespace Control {
 
 struct ChannelState {
     explicit ChannelState(s32 bind_id);
+    ~ChannelState();
     ChannelState(const ChannelState& state) = delete;
     ChannelState& operator=(const ChannelState&) = delete;
     ChannelState(ChannelState&& other) noexcept = default;
@@ -37,23 +37,26 @@ void DmaPusher::DispatchCalls() {
             break;
         }
     }
+    if (statistics_enabled) [[unlikely]] {
+        SwitchTimedEngine(NoTimedEngine);
+    }
     gpu.FlushCommands();
     gpu.OnCommandListEnd();
 }
 
 bool DmaPusher::Step() {
-    if (!ib_enable || dma_pushbuffer.empty()) {
+    if (!ib_enable || dma_pushbuffer_front == dma_pushbuffer_end) {
         // pushbuffer empty and IB empty or nonexistent - nothing to do
         return false;
     }
 
-    CommandList& command_list{dma_pushbuffer.front()};
+    CommandList& command_list{dma_pushbuffer[dma_pushbuffer_front]};
 
     ASSERT_OR_EXECUTE(
         command_list.command_lists.size() || command_list.prefetch_command_list.size(), {
             // Somehow the command_list is empty, in order to avoid a crash
             // We ignore it and assume its size is 0.
-            dma_pushbuffer.pop();
+            PopCommandList();
             dma_pushbuffer_subindex = 0;
             return true;
         });
@@ -61,7 +64,7 @@ bool DmaPusher::Step() {
     if (command_list.prefetch_command_list.size()) {
         // Prefetched command list from nvdrv, used for things like synchronization
         ProcessCommands(command_list.prefetch_command_list);
-        dma_pushbuffer.pop();
+        PopCommandList();
     } else {
         const CommandListHeader command_list_header{
             command_list.command_lists[dma_pushbuffer_subindex++]};
@@ -69,7 +72,7 @@ bool DmaPusher::Step() {
 
         if (dma_pushbuffer_subindex >= command_list.command_lists.size()) {
             // We've gone through the current list, remove it from the queue
-            dma_pushbuffer.pop();
+            PopCommandList();
             dma_pushbuffer_subindex = 0;
         }
 
@@ -116,6 +119,17 @@ bool DmaPusher::Step() {
     return true;
 }
 
+void DmaPusher::PopCommandList() {
+    // Keep the buffers of the list, they are handed back by the next Push
+    CommandList& command_list{dma_pushbuffer[dma_pushbuffer_front]};
+    command_list.command_lists.clear();
+    command_list.prefetch_command_list.clear();
+    if (++dma_pushbuffer_front == dma_pushbuffer_end) {
+        dma_pushbuffer_front = 0;
+        dma_pushbuffer_end = 0;
+    }
+}
+
 void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands) {
     for (std::size_t index = 0; index < commands.size();) {
         const CommandHeader& command_header = commands[index];
@@ -132,6 +146,19 @@ void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands) {
                 index += max_write;
                 continue;
             } else {
+                if (!dma_increment_once && dma_state.method_count > 1) {
+                    // Runs of registers without side effects are written at once.
+                    const u32 max_methods = static_cast<u32>(
+                        std::min<std::size_t>(dma_state.method_count, commands.size() - index));
+                    const u32 num_state_methods = CountStateMethods(max_methods);
+                    if (num_state_methods > 1) {
+                        CallStateMethods(&command_header.argument, num_state_methods);
+                        dma_state.method += num_state_methods;
+                        dma_state.method_count -= num_state_methods;
+                        index += num_state_methods;
+                        continue;
+                    }
+                }
                 dma_state.is_last_call = dma_state.method_count <= 1;
                 CallMethod(command_header.argument);
             }
@@ -187,6 +214,41 @@ void DmaPusher::SetState(const CommandHeader& command_header) {
 }
 
 void DmaPusher::CallMethod(u32 argument) const {
+    if (statistics_enabled) [[unlikely]] {
+        RecordMethods(1);
+    }
+    CallMethodImpl(argument);
+}
+
+void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
+    if (statistics_enabled) [[unlikely]] {
+        RecordMethods(num_methods);
+    }
+    CallMultiMethodImpl(base_start, num_methods);
+}
+
+void DmaPusher::CallStateMethods(const u32* base_start, u32 num_methods) const {
+    if (statistics_enabled) [[unlikely]] {
+        RecordMethods(num_methods);
+        statistics.state_methods += num_methods;
+    }
+    auto subchannel = subchannels[dma_state.subchannel];
+    subchannel->CallStateMethods(dma_state.method, base_start, num_methods);
+}
+
+u32 DmaPusher::CountStateMethods(u32 max_methods) const {
+    if (dma_state.method < non_puller_methods) {
+        return 0;
+    }
+    const auto& execution_mask = subchannels[dma_state.subchannel]->execution_mask;
+    u32 num_methods = 0;
+    while (num_methods < max_methods && !execution_mask[dma_state.method + num_methods]) {
+        ++num_methods;
+    }
+    return num_methods;
+}
+
+void DmaPusher::CallMethodImpl(u32 argument) const {
     if (dma_state.method < non_puller_methods) {
         puller.CallPullerMethod(Engines::Puller::MethodCall{
             dma_state.method,
@@ -206,7 +268,7 @@ void DmaPusher::CallMethod(u32 argument) const {
     }
 }
 
-void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
+void DmaPusher::CallMultiMethodImpl(const u32* base_start, u32 num_methods) const {
     if (dma_state.method < non_puller_methods) {
         puller.CallMultiMethod(dma_state.method, dma_state.subchannel, base_start, num_methods,
                                dma_state.method_count);
@@ -219,6 +281,25 @@ void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
     }
 }
 
+void DmaPusher::RecordMethods(u32 num_methods) const {
+    const std::size_t index = dma_state.method < non_puller_methods
+                                  ? PullerStatisticsIndex
+                                  : static_cast<std::size_t>(subchannel_type[dma_state.subchannel]);
+    statistics.methods[index] += num_methods;
+    if (index != timed_engine) {
+        SwitchTimedEngine(index);
+    }
+}
+
+void DmaPusher::SwitchTimedEngine(std::size_t index) const {
+    const auto now = std::chrono::steady_clock::now();
+    if (timed_engine != NoTimedEngine) {
+        statistics.time[timed_engine] += now - timed_engine_start;
+    }
+    timed_engine = index;
+    timed_engine_start = now;
+}
+
 void DmaPusher::BindRasterizer(VideoCore::RasterizerInterface* rasterizer) {
     puller.BindRasterizer(rasterizer);
 }
@@ -4,10 +4,10 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <span>
 #include <vector>
 #include <boost/container/small_vector.hpp>
-#include <queue>
 
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -120,12 +120,30 @@ struct CommandList final {
  */
 class DmaPusher final {
 public:
+    /// Index of the puller in the statistics, after the engine types.
+    static constexpr std::size_t PullerStatisticsIndex =
+        static_cast<std::size_t>(Engines::EngineTypes::KeplerMemory) + 1;
+
+    /// Methods called on every engine and the time spent in them, while statistics are enabled.
+    struct Statistics {
+        std::array<u64, PullerStatisticsIndex + 1> methods{};
+        std::array<std::chrono::nanoseconds, PullerStatisticsIndex + 1> time{};
+        u64 state_methods{}; ///< Methods written in bursts of state registers.
+    };
+
     explicit DmaPusher(Core::System& system_, GPU& gpu_, MemoryManager& memory_manager_,
                        Control::ChannelState& channel_state_);
     ~DmaPusher();
 
+    /// Queues a command list. The buffers of a previously processed list are handed back through
+    /// entries, so that the caller can reuse them.
     void Push(CommandList&& entries) {
-        dma_pushbuffer.push(std::move(entries));
+        if (dma_pushbuffer_end == dma_pushbuffer.size()) {
+            dma_pushbuffer.emplace_back();
+        }
+        CommandList& command_list{dma_pushbuffer[dma_pushbuffer_end++]};
+        command_list.command_lists.swap(entries.command_lists);
+        command_list.prefetch_command_list.swap(entries.prefetch_command_list);
     }
 
     void DispatchCalls();
@@ -138,22 +156,49 @@ public:
 
     void BindRasterizer(VideoCore::RasterizerInterface* rasterizer);
 
+    /// Enables gathering statistics. Time is measured between engine switches, so it includes
+    /// the decoding of the commands sent to the engine.
+    void SetStatisticsEnabled(bool enabled) {
+        statistics_enabled = enabled;
+        timed_engine = NoTimedEngine;
+    }
+
+    [[nodiscard]] const Statistics& GetStatistics() const {
+        return statistics;
+    }
+
 private:
     static constexpr u32 non_puller_methods = 0x40;
     static constexpr u32 max_subchannels = 8;
     bool Step();
+    void PopCommandList();
     void ProcessCommands(std::span<const CommandHeader> commands);
 
     void SetState(const CommandHeader& command_header);
 
     void CallMethod(u32 argument) const;
     void CallMultiMethod(const u32* base_start, u32 num_methods) const;
+    void CallStateMethods(const u32* base_start, u32 num_methods) const;
+    void CallMethodImpl(u32 argument) const;
+    void CallMultiMethodImpl(const u32* base_start, u32 num_methods) const;
+
+    /// Returns how many of the next incrementing methods only write state, up to max_methods.
+    u32 CountStateMethods(u32 max_methods) const;
+
+    /// Counts the methods about to be called, and starts timing their engine if it is not the
+    /// engine being timed already.
+    void RecordMethods(u32 num_methods) const;
+
+    /// Adds the time elapsed since the timed engine was switched to, and times the given engine.
+    void SwitchTimedEngine(std::size_t index) const;
 
     Common::ScratchBuffer<CommandHeader>
         command_headers; ///< Buffer for list of commands fetched at once
 
-    std::queue<CommandList> dma_pushbuffer; ///< Queue of command lists to be processed
-    std::size_t dma_pushbuffer_subindex{};  ///< Index within a command list within the pushbuffer
+    std::vector<CommandList> dma_pushbuffer; ///< Command lists, reused once processed
+    std::size_t dma_pushbuffer_front{};      ///< Index of the first command list to be processed
+    std::size_t dma_pushbuffer_end{};        ///< Index past the last command list to be processed
+    std::size_t dma_pushbuffer_subindex{};   ///< Index within a command list within the pushbuffer
 
     struct DmaState {
         u32 method;            ///< Current method
@@ -174,6 +219,13 @@ private:
     std::array<Engines::EngineInterface*, max_subchannels> subchannels{};
     std::array<Engines::EngineTypes, max_subchannels> subchannel_type;
 
+    static constexpr std::size_t NoTimedEngine = PullerStatisticsIndex + 1;
+
+    bool statistics_enabled{};
+    mutable Statistics statistics;
+    mutable std::size_t timed_engine{NoTimedEngine}; ///< Engine the time is being added to
+    mutable std::chrono::steady_clock::time_point timed_engine_start;
+
     GPU& gpu;
     Core::System& system;
     MemoryManager& memory_manager;
@@ -265,6 +265,7 @@ void DrawManager::ProcessDraw(bool draw_indexed, u32 instance_count) {
               draw_indexed ? draw_state.index_buffer.count : draw_state.vertex_buffer.count);
 
     UpdateTopology();
+    ++num_draws;
 
     if (maxwell3d->ShouldExecute()) {
         maxwell3d->rasterizer->Draw(draw_indexed, instance_count);
@@ -279,6 +280,7 @@ void DrawManager::ProcessDrawIndirect() {
         indirect_state.buffer_size, indirect_state.max_draw_counts);
 
     UpdateTopology();
+    ++num_draws;
 
     if (maxwell3d->ShouldExecute()) {
         maxwell3d->rasterizer->DrawIndirect();
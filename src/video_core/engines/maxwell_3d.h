@@ -21,6 +21,7 @@
 #include "video_core/engines/engine_upload.h"
 #include "video_core/gpu.h"
 #include "video_core/macro/macro.h"
+#include "video_core/macro/macro_profiler.h"
 #include "video_core/textures/texture.h"
 
 namespace Core {
@@ -3078,6 +3079,9 @@ public:
     void CallMultiMethod(u32 method, const u32* base_start, u32 amount,
                          u32 methods_pending) override;
 
+    /// Write values to consecutive registers without side effects, starting at method.
+    void CallStateMethods(u32 method, const u32* base_start, u32 amount) override;
+
     bool ShouldExecute() const {
         return execute_on;
     }
@@ -3102,6 +3106,14 @@ public:
     std::unique_ptr<DrawManager> draw_manager;
     friend class DrawManager;
 
+    /// Methods emitted by the macro being profiled, if any.
+    MacroProfiler::Sample* macro_sample{};
+
+    /// Profiles the macros executed by this engine in the given profiler.
+    void SetMacroProfiler(MacroProfiler* profiler) {
+        macro_engine->SetProfiler(profiler);
+    }
+
     GPUVAddr GetMacroAddress(size_t index) const {
         return macro_addresses[index];
     }
@@ -3140,6 +3152,9 @@ private:
 
     void ProcessDirtyRegisters(u32 method, u32 argument);
 
+    /// Stores the values of consecutive registers and flags the changed ones dirty.
+    void ProcessDirtyRegisterRange(u32 method, const u32* values, u32 amount);
+
     void ConsumeSinkImpl() override;
 
     void ProcessMethodCall(u32 method, u32 argument, u32 nonshadow_argument, bool is_last_call);
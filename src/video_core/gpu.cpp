@@ -7,6 +7,7 @@
 #include <condition_variable>
 #include <list>
 #include <memory>
+#include <optional>
 
 #include "common/assert.h"
 #include "common/microprofile.h"
@@ -28,8 +29,10 @@
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
 #include "video_core/gpu_thread.h"
+#include "video_core/gpu_trace.h"
 #include "video_core/host1x/host1x.h"
 #include "video_core/host1x/syncpoint_manager.h"
+#include "video_core/macro/macro_profiler.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_base.h"
 #include "video_core/shader_notify.h"
@@ -39,10 +42,15 @@ namespace Tegra {
 struct GPU::Impl {
     explicit Impl(GPU& gpu_, Core::System& system_, bool is_async_, bool use_nvdec_)
         : gpu{gpu_}, system{system_}, host1x{system.Host1x()}, use_nvdec{use_nvdec_},
-          shader_notify{std::make_unique<VideoCore::ShaderNotify>()}, is_async{is_async_},
+          shader_notify{std::make_unique<VideoCore::ShaderNotify>()},
+          macro_profiler{std::make_unique<Tegra::MacroProfiler>()}, is_async{is_async_},
           gpu_thread{system_, is_async_}, scheduler{std::make_unique<Control::Scheduler>(gpu)} {}
 
-    ~Impl() = default;
+    ~Impl() {
+        if (profiled_program_id) {
+            macro_profiler->Dump(*profiled_program_id);
+        }
+    }
 
     std::shared_ptr<Control::ChannelState> CreateChannel(s32 channel_id) {
         auto channel_state = std::make_shared<Tegra::Control::ChannelState>(channel_id);
@@ -71,6 +79,17 @@ struct GPU::Impl {
         to_init.Init(system, gpu, program_id);
         to_init.BindRasterizer(rasterizer);
         rasterizer->InitializeChannel(to_init);
+        if (Settings::values.profile_macros.GetValue()) {
+            to_init.maxwell_3d->SetMacroProfiler(macro_profiler.get());
+            profiled_program_id = program_id;
+        }
+        if (Settings::values.dump_gpu_trace.GetValue()) {
+            if (!trace_recorder) {
+                trace_recorder =
+                    std::make_unique<Trace::Recorder>(Trace::GetTracePath(program_id));
+            }
+            trace_recorder->RecordChannel(to_init);
+        }
     }
 
     void InitAddressSpace(Tegra::MemoryManager& memory_manager) {
@@ -196,6 +215,16 @@ struct GPU::Impl {
         return *shader_notify;
     }
 
+    /// Returns a reference to the macro profiler.
+    [[nodiscard]] Tegra::MacroProfiler& MacroProfiler() {
+        return *macro_profiler;
+    }
+
+    /// Returns a const reference to the macro profiler.
+    [[nodiscard]] const Tegra::MacroProfiler& MacroProfiler() const {
+        return *macro_profiler;
+    }
+
     [[nodiscard]] u64 GetTicks() const {
         u64 gpu_tick = system.CoreTiming().GetGPUTicks();
 
@@ -247,6 +276,9 @@ struct GPU::Impl {
 
     /// Push GPU command entries to be processed
     void PushGPUEntries(s32 channel, Tegra::CommandList&& entries) {
+        if (trace_recorder) {
+            trace_recorder->RecordSubmission(channel, entries);
+        }
         gpu_thread.SubmitList(channel, std::move(entries));
     }
 
@@ -345,6 +377,10 @@ struct GPU::Impl {
     s32 new_channel_id{1};
     /// Shader build notifier
     std::unique_ptr<VideoCore::ShaderNotify> shader_notify;
+    /// Profile of the macros executed by the channels, while profile_macros is enabled
+    std::unique_ptr<Tegra::MacroProfiler> macro_profiler;
+    /// Program whose macros are profiled, the profile is dumped for it at shutdown
+    std::optional<u64> profiled_program_id;
     /// When true, we are about to shut down emulation session, so terminate outstanding tasks
     std::atomic_bool shutting_down{};
 
@@ -373,6 +409,8 @@ struct GPU::Impl {
     Tegra::Control::ChannelState* current_channel;
     s32 bound_channel{-1};
 
+    std::unique_ptr<Trace::Recorder> trace_recorder;
+
     std::deque<size_t> free_swap_counters;
     std::deque<size_t> request_swap_counters;
     std::mutex request_swap_mutex;
@@ -486,6 +524,14 @@ const VideoCore::ShaderNotify& GPU::ShaderNotify() const {
     return impl->ShaderNotify();
 }
 
+Tegra::MacroProfiler& GPU::MacroProfiler() {
+    return impl->MacroProfiler();
+}
+
+const Tegra::MacroProfiler& GPU::MacroProfiler() const {
+    return impl->MacroProfiler();
+}
+
 void GPU::RequestComposite(std::vector<Tegra::FramebufferConfig>&& layers,
                            std::vector<Service::Nvidia::NvFence>&& fences) {
     impl->RequestComposite(std::move(layers), std::move(fences));
@@ -23,6 +23,7 @@ class ShaderNotify;
 
 namespace Tegra {
 class DmaPusher;
+class MacroProfiler;
 struct CommandList;
 
 // TODO: Implement the commented ones
@@ -204,6 +205,12 @@ public:
     /// Returns a const reference to the shader notifier.
     [[nodiscard]] const VideoCore::ShaderNotify& ShaderNotify() const;
 
+    /// Returns a reference to the macro profiler.
+    [[nodiscard]] Tegra::MacroProfiler& MacroProfiler();
+
+    /// Returns a const reference to the macro profiler.
+    [[nodiscard]] const Tegra::MacroProfiler& MacroProfiler() const;
+
     [[nodiscard]] u64 GetTicks() const;
 
     [[nodiscard]] bool IsAsync() const;
@@ -5,9 +5,11 @@
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
+#include "common/spin_lock.h"
 #include "common/thread.h"
 #include "core/core.h"
 #include "core/frontend/graphics_context.h"
+#include "core/perf_stats.h"
 #include "video_core/control/scheduler.h"
 #include "video_core/dma_pusher.h"
 #include "video_core/gpu.h"
@@ -17,6 +19,73 @@
 
 namespace VideoCommon::GPUThread {
 
+namespace {
+/// Number of times a side of the command ring polls for the other before parking.
+constexpr u32 SPIN_COUNT = 256;
+
+template <typename Pred>
+bool SpinWait(Pred&& pred) {
+    for (u32 spin = 0; spin < SPIN_COUNT; ++spin) {
+        if (pred()) {
+            return true;
+        }
+        Common::ThreadPause();
+    }
+    return pred();
+}
+} // Anonymous namespace
+
+// The indices and the parked flags are sequentially consistent: a side either sees the index
+// published by the other or the other sees it parked and notifies it. Notifying under park_mutex
+// closes the window between the check of the parked side and its wait.
+
+CommandDataContainer* CommandRing::BeginPush(std::stop_token stop_token) {
+    const std::size_t write = write_index.load(std::memory_order_relaxed);
+    const auto has_space = [this, write] { return write - read_index.load() < Capacity; };
+    if (!SpinWait(has_space)) {
+        std::unique_lock lock{park_mutex};
+        producer_parked.store(true);
+        Common::CondvarWait(producer_cv, lock, stop_token, has_space);
+        producer_parked.store(false, std::memory_order_relaxed);
+        if (!has_space()) {
+            // The consumer stopped, it will not free a slot anymore
+            return nullptr;
+        }
+    }
+    return &slots[write % Capacity];
+}
+
+void CommandRing::EndPush() {
+    write_index.fetch_add(1);
+    if (consumer_parked.load()) {
+        std::scoped_lock lock{park_mutex};
+        consumer_cv.notify_one();
+    }
+}
+
+CommandDataContainer* CommandRing::Front(std::stop_token stop_token) {
+    const std::size_t read = read_index.load(std::memory_order_relaxed);
+    const auto has_command = [this, read] { return write_index.load() != read; };
+    if (!SpinWait(has_command)) {
+        std::unique_lock lock{park_mutex};
+        consumer_parked.store(true);
+        Common::CondvarWait(consumer_cv, lock, stop_token, has_command);
+        consumer_parked.store(false, std::memory_order_relaxed);
+    }
+    if (stop_token.stop_requested()) {
+        return nullptr;
+    }
+    return &slots[read % Capacity];
+}
+
+void CommandRing::Pop() {
+    read_index.fetch_add(1);
+    if (producer_parked.load()) {
+        std::scoped_lock lock{park_mutex};
+        producer_cv.notify_one();
+    }
+}
+
 /// Runs the GPU thread
 static void RunThread(std::stop_token stop_token, Core::System& system,
                       VideoCore::RendererBase& renderer, Core::Frontend::GraphicsContext& context,
@@ -34,26 +103,32 @@ static void RunThread(std::stop_token stop_token, Core::System& system,
     auto current_context = context.Acquire();
     VideoCore::RasterizerInterface* const rasterizer = renderer.ReadRasterizer();
 
-    CommandDataContainer next;
+    auto& perf_stats = system.GetPerfStats();
 
     while (!stop_token.stop_requested()) {
-        state.queue.PopWait(next, stop_token);
-        if (stop_token.stop_requested()) {
+        CommandDataContainer* const next = state.queue.Front(stop_token);
+        if (!next) {
             break;
         }
-        if (auto* submit_list = std::get_if<SubmitListCommand>(&next.data)) {
-            scheduler.Push(submit_list->channel, std::move(submit_list->entries));
-        } else if (std::holds_alternative<GPUTickCommand>(next.data)) {
+        const auto start_time = Core::PerfStats::Clock::now();
+        perf_stats.AddGpuQueueSample(start_time - next->submit_time, state.queue.Size());
+        if (const auto* submit_list = std::get_if<SubmitListCommand>(&next->data)) {
+            scheduler.Push(submit_list->channel, std::move(next->entries));
+        } else if (std::holds_alternative<GPUTickCommand>(next->data)) {
             system.GPU().TickWork();
-        } else if (const auto* flush = std::get_if<FlushRegionCommand>(&next.data)) {
+        } else if (const auto* flush = std::get_if<FlushRegionCommand>(&next->data)) {
             rasterizer->FlushRegion(flush->addr, flush->size);
-        } else if (const auto* invalidate = std::get_if<InvalidateRegionCommand>(&next.data)) {
+        } else if (const auto* invalidate = std::get_if<InvalidateRegionCommand>(&next->data)) {
             rasterizer->OnCacheInvalidation(invalidate->addr, invalidate->size);
         } else {
             ASSERT(false);
         }
-        state.signaled_fence.store(next.fence);
-        if (next.block) {
+        perf_stats.AddGpuThreadTime(Core::PerfStats::Clock::now() - start_time);
+        const u64 fence = next->fence;
+        const bool block = next->block;
+        state.queue.Pop();
+        state.signaled_fence.store(fence);
+        if (block) {
             // We have to lock the write_lock to ensure that the condition_variable wait not get a
             // race between the check and the lock itself.
             std::scoped_lock lk{state.write_lock};
@@ -76,7 +151,7 @@ void ThreadManager::StartThread(VideoCore::RendererBase& renderer,
 }
 
 void ThreadManager::SubmitList(s32 channel, Tegra::CommandList&& entries) {
-    PushCommand(SubmitListCommand(channel, std::move(entries)));
+    PushCommand(SubmitListCommand(channel), false, &entries);
 }
 
 void ThreadManager::FlushRegion(DAddr addr, u64 size) {
@@ -107,7 +182,8 @@ void ThreadManager::FlushAndInvalidateRegion(DAddr addr, u64 size) {
     rasterizer->OnCacheInvalidation(addr, size);
 }
 
-u64 ThreadManager::PushCommand(CommandData&& command_data, bool block) {
+u64 ThreadManager::PushCommand(CommandData&& command_data, bool block,
+                               Tegra::CommandList* entries) {
     if (!is_async) {
         // In synchronous GPU mode, block the caller until the command has executed
         block = true;
@@ -115,7 +191,20 @@ u64 ThreadManager::PushCommand(CommandData&& command_data, bool block) {
 
     std::unique_lock lk(state.write_lock);
     const u64 fence{++state.last_fence};
-    state.queue.EmplaceWait(std::move(command_data), fence, block);
+    CommandDataContainer* const slot = state.queue.BeginPush(thread.get_stop_token());
+    if (!slot) {
+        return fence;
+    }
+    slot->data = std::move(command_data);
+    if (entries) {
+        // Lists that fit in the inline storage are copied into the slot, larger ones hand their
+        // buffers over
+        slot->entries = std::move(*entries);
+    }
+    slot->fence = fence;
+    slot->block = block;
+    slot->submit_time = Core::PerfStats::Clock::now();
+    state.queue.EndPush();
 
     if (block) {
         Common::CondvarWait(state.cv, lk, thread.get_stop_token(), [this, fence] {
@@ -3,15 +3,18 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
 #include <mutex>
 #include <optional>
 #include <thread>
 #include <variant>
 
-#include "common/bounded_threadsafe_queue.h"
 #include "common/polyfill_thread.h"
+#include "video_core/dma_pusher.h"
 #include "video_core/framebuffer_config.h"
 
 namespace Tegra {
@@ -35,13 +38,12 @@ class RendererBase;
 
 namespace VideoCommon::GPUThread {
 
-/// Command to signal to the GPU thread that a command list is ready for processing
+/// Command to signal to the GPU thread that a command list is ready for processing, the list is
+/// stored in the command slot
 struct SubmitListCommand final {
-    explicit SubmitListCommand(s32 channel_, Tegra::CommandList&& entries_)
-        : channel{channel_}, entries{std::move(entries_)} {}
+    explicit constexpr SubmitListCommand(s32 channel_) : channel{channel_} {}
 
     s32 channel;
-    Tegra::CommandList entries;
 };
 
 /// Command to signal to the GPU thread to flush a region
@@ -77,21 +79,63 @@ using CommandData =
                  FlushAndInvalidateRegionCommand, GPUTickCommand>;
 
 struct CommandDataContainer {
-    CommandDataContainer() = default;
-
-    explicit CommandDataContainer(CommandData&& data_, u64 next_fence_, bool block_)
-        : data{std::move(data_)}, fence{next_fence_}, block(block_) {}
-
     CommandData data;
+    /// Command list of a SubmitListCommand, moved in by the producer.
+    Tegra::CommandList entries;
     u64 fence{};
     bool block{};
+    /// Point when the command was pushed
+    std::chrono::steady_clock::time_point submit_time{};
+};
+
+/**
+ * Fixed-capacity ring of command slots between a single producer and the GPU thread. Commands are
+ * written in place by the producer and executed in place by the GPU thread, so handing a command
+ * over never allocates nor locks. A side waiting for the other spins for a short while before it
+ * parks on a condition variable.
+ */
+class CommandRing final {
+public:
+    static constexpr std::size_t Capacity = 0x400;
+
+    /// Waits for a free slot and returns it to be filled, or nullptr when a stop was requested.
+    /// Must only be called by the producer.
+    [[nodiscard]] CommandDataContainer* BeginPush(std::stop_token stop_token);
+
+    /// Hands the slot returned by BeginPush to the consumer.
+    void EndPush();
+
+    /// Waits for a command and returns its slot, or nullptr when a stop was requested. Must only be
+    /// called by the consumer.
+    [[nodiscard]] CommandDataContainer* Front(std::stop_token stop_token);
+
+    /// Releases the slot returned by Front to the producer.
+    void Pop();
+
+    /// Returns the number of commands pushed and not yet popped.
+    [[nodiscard]] std::size_t Size() const {
+        return write_index.load(std::memory_order_acquire) -
+               read_index.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(128) std::atomic_size_t read_index{};
+    alignas(128) std::atomic_size_t write_index{};
+
+    std::atomic_bool producer_parked{};
+    std::atomic_bool consumer_parked{};
+    std::mutex park_mutex;
+    std::condition_variable_any producer_cv;
+    std::condition_variable_any consumer_cv;
+
+    std::array<CommandDataContainer, Capacity> slots;
 };
 
 /// Struct used to synchronize the GPU thread
 struct SynchState final {
-    using CommandQueue = Common::MPSCQueue<CommandDataContainer>;
+    /// Serializes the producers of the command ring and the waits for blocking commands
     std::mutex write_lock;
-    CommandQueue queue;
+    CommandRing queue;
     u64 last_fence{};
     std::atomic<u64> signaled_fence{};
     std::condition_variable_any cv;
@@ -122,8 +166,10 @@ public:
     void TickGPU();
 
 private:
-    /// Pushes a command to be executed by the GPU thread
-    u64 PushCommand(CommandData&& command_data, bool block = false);
+    /// Pushes a command to be executed by the GPU thread, along with the command list of a
+    /// SubmitListCommand
+    u64 PushCommand(CommandData&& command_data, bool block = false,
+                    Tegra::CommandList* entries = nullptr);
 
     Core::System& system;
     const bool is_async;
@@ -0,0 +1,460 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+
+#include <fmt/format.h>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/core.h"
+#include "core/hle/kernel/k_memory_manager.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/memory.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/engines/draw_manager.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_trace.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+
+namespace Tegra::Trace {
+
+namespace {
+
+constexpr u32 TraceMagic = Common::MakeMagic('S', 'G', 'P', 'T');
+constexpr u32 TraceVersion = 1;
+
+/// Width of the address space the pages of replayed traces are mapped in.
+constexpr std::size_t ReplayAddressSpaceBits = 34;
+
+enum class RecordType : u32 {
+    Channel = 0,
+    Memory = 1,
+    Submit = 2,
+};
+
+struct TraceHeader {
+    u32_le magic;
+    u32_le version;
+};
+static_assert(sizeof(TraceHeader) == 0x8, "TraceHeader has incorrect size.");
+
+struct RecordHeader {
+    u32_le type;
+    u32_le size;
+};
+static_assert(sizeof(RecordHeader) == 0x8, "RecordHeader has incorrect size.");
+
+struct ChannelData {
+    s32_le channel;
+    u32_le address_space;
+    u64_le program_id;
+};
+static_assert(sizeof(ChannelData) == 0x10, "ChannelData has incorrect size.");
+
+struct MemoryData {
+    u32_le address_space;
+    INSERT_PADDING_BYTES(4);
+    u64_le gpu_addr;
+};
+static_assert(sizeof(MemoryData) == 0x10, "MemoryData has incorrect size.");
+
+struct SubmitData {
+    s32_le channel;
+    u32_le num_command_lists;
+    u32_le num_prefetch_commands;
+    INSERT_PADDING_BYTES(4);
+};
+static_assert(sizeof(SubmitData) == 0x10, "SubmitData has incorrect size.");
+
+template <typename T>
+void Append(std::vector<u8>& payload, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto* const bytes = reinterpret_cast<const u8*>(&value);
+    payload.insert(payload.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T Extract(std::span<const u8> payload, std::size_t offset) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    std::memcpy(&value, payload.data() + offset, sizeof(T));
+    return value;
+}
+
+/// Returns the key of a page of an address space, in maps of pages.
+u64 GetPageKey(u32 address_space, GPUVAddr gpu_addr) {
+    return (u64{address_space} << 48) | (gpu_addr >> PageBits);
+}
+
+} // Anonymous namespace
+
+std::filesystem::path GetTracePath(u64 program_id) {
+    return Common::FS::GetSuyuPath(Common::FS::SuyuPath::DumpDir) / "gpu_traces" /
+           fmt::format("{:016X}_{}.sgt", program_id, std::time(nullptr));
+}
+
+Recorder::Recorder(const std::filesystem::path& path) : page(PageSize) {
+    if (!Common::FS::CreateDirs(path.parent_path())) {
+        LOG_ERROR(HW_GPU, "Failed to create the GPU trace directory");
+        return;
+    }
+    file.Open(path, Common::FS::FileAccessMode::Write, Common::FS::FileType::BinaryFile);
+    const TraceHeader header{
+        .magic = TraceMagic,
+        .version = TraceVersion,
+    };
+    if (!file.IsOpen() || !file.WriteObject(header)) {
+        LOG_ERROR(HW_GPU, "Failed to create GPU trace {}", Common::FS::PathToUTF8String(path));
+        file.Close();
+        return;
+    }
+    LOG_INFO(HW_GPU, "Recording GPU trace {}", Common::FS::PathToUTF8String(path));
+}
+
+Recorder::~Recorder() {
+    if (file.IsOpen()) {
+        LOG_INFO(HW_GPU, "Recorded {} GPU trace records", num_records);
+    }
+}
+
+bool Recorder::IsOpen() const {
+    return file.IsOpen();
+}
+
+void Recorder::RecordChannel(const Control::ChannelState& channel) {
+    std::scoped_lock lk{mutex};
+    if (!file.IsOpen()) {
+        return;
+    }
+    const auto next_address_space = static_cast<u32>(address_spaces.size());
+    const u32 address_space =
+        address_spaces.try_emplace(channel.memory_manager->GetID(), next_address_space)
+            .first->second;
+    channels.insert_or_assign(channel.bind_id, Channel{
+                                                   .address_space = address_space,
+                                                   .memory_manager = channel.memory_manager,
+                                               });
+
+    payload.clear();
+    Append(payload, ChannelData{
+                        .channel = channel.bind_id,
+                        .address_space = address_space,
+                        .program_id = channel.program_id,
+                    });
+    WriteRecord(static_cast<u32>(RecordType::Channel), payload);
+}
+
+void Recorder::RecordSubmission(s32 channel, const CommandList& entries) {
+    std::scoped_lock lk{mutex};
+    if (!file.IsOpen()) {
+        return;
+    }
+    const auto it = channels.find(channel);
+    if (it == channels.end()) {
+        LOG_ERROR(HW_GPU, "Submission to unknown channel {} is not recorded", channel);
+        return;
+    }
+
+    // The pushbuffers are recorded as they are at submission, which is when the guest expects the
+    // GPU to be able to read them.
+    for (const CommandListHeader& header : entries.command_lists) {
+        const GPUVAddr start = header.addr;
+        const GPUVAddr end = start + header.size * sizeof(u32);
+        for (GPUVAddr page_addr = Common::AlignDown(start, PageSize); page_addr < end;
+             page_addr += PageSize) {
+            RecordPage(it->second, page_addr);
+        }
+    }
+
+    payload.clear();
+    Append(payload, SubmitData{
+                        .channel = channel,
+                        .num_command_lists = static_cast<u32>(entries.command_lists.size()),
+                        .num_prefetch_commands =
+                            static_cast<u32>(entries.prefetch_command_list.size()),
+                    });
+    for (const CommandListHeader& header : entries.command_lists) {
+        Append(payload, u64_le{header.raw});
+    }
+    for (const CommandHeader& command : entries.prefetch_command_list) {
+        Append(payload, u32_le{command.argument});
+    }
+    WriteRecord(static_cast<u32>(RecordType::Submit), payload);
+}
+
+void Recorder::RecordPage(const Channel& channel, GPUVAddr page_addr) {
+    channel.memory_manager->ReadBlockUnsafe(page_addr, page.data(), PageSize);
+    const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(page.data()), PageSize);
+    const auto [it, is_new] =
+        page_hashes.try_emplace(GetPageKey(channel.address_space, page_addr), hash);
+    if (!is_new) {
+        if (it->second == hash) {
+            return;
+        }
+        it->second = hash;
+    }
+
+    payload.clear();
+    Append(payload, MemoryData{
+                        .address_space = channel.address_space,
+                        .gpu_addr = page_addr,
+                    });
+    payload.insert(payload.end(), page.begin(), page.end());
+    WriteRecord(static_cast<u32>(RecordType::Memory), payload);
+}
+
+void Recorder::WriteRecord(u32 type, std::span<const u8> data) {
+    const RecordHeader header{
+        .type = type,
+        .size = static_cast<u32>(data.size()),
+    };
+    if (!file.WriteObject(header) || file.WriteSpan(data) != data.size()) {
+        LOG_ERROR(HW_GPU, "Failed to write GPU trace, recording stopped");
+        file.Close();
+        return;
+    }
+    ++num_records;
+}
+
+Reader::Reader(const std::filesystem::path& path)
+    : file{path, Common::FS::FileAccessMode::Read, Common::FS::FileType::BinaryFile} {
+    TraceHeader header{};
+    is_valid = file.IsOpen() && file.ReadObject(header) && header.magic == TraceMagic &&
+               header.version == TraceVersion;
+    if (is_valid) {
+        file_size = file.GetSize();
+    }
+}
+
+Reader::~Reader() = default;
+
+bool Reader::IsOpen() const {
+    return is_valid;
+}
+
+std::optional<Record> Reader::ReadRecord() {
+    if (!is_valid || static_cast<u64>(file.Tell()) == file_size) {
+        return std::nullopt;
+    }
+    RecordHeader header{};
+    if (!file.ReadObject(header)) {
+        LOG_ERROR(HW_GPU, "GPU trace is truncated");
+        is_valid = false;
+        return std::nullopt;
+    }
+    payload.resize(header.size);
+    if (file.ReadSpan<u8>(payload) != payload.size()) {
+        LOG_ERROR(HW_GPU, "GPU trace is truncated");
+        is_valid = false;
+        return std::nullopt;
+    }
+
+    switch (static_cast<RecordType>(static_cast<u32>(header.type))) {
+    case RecordType::Channel: {
+        if (payload.size() != sizeof(ChannelData)) {
+            break;
+        }
+        const auto data = Extract<ChannelData>(payload, 0);
+        return ChannelRecord{
+            .channel = data.channel,
+            .address_space = data.address_space,
+            .program_id = data.program_id,
+        };
+    }
+    case RecordType::Memory: {
+        if (payload.size() != sizeof(MemoryData) + PageSize) {
+            break;
+        }
+        const auto data = Extract<MemoryData>(payload, 0);
+        return MemoryRecord{
+            .address_space = data.address_space,
+            .gpu_addr = data.gpu_addr,
+            .data = std::vector<u8>(payload.begin() + sizeof(MemoryData), payload.end()),
+        };
+    }
+    case RecordType::Submit: {
+        if (payload.size() < sizeof(SubmitData)) {
+            break;
+        }
+        const auto data = Extract<SubmitData>(payload, 0);
+        const std::size_t num_command_lists = data.num_command_lists;
+        const std::size_t num_prefetch_commands = data.num_prefetch_commands;
+        if (payload.size() != sizeof(SubmitData) + num_command_lists * sizeof(u64) +
+                                  num_prefetch_commands * sizeof(u32)) {
+            break;
+        }
+        SubmitRecord record{
+            .channel = data.channel,
+            .entries = CommandList(num_command_lists),
+        };
+        std::size_t offset = sizeof(SubmitData);
+        for (CommandListHeader& command_list : record.entries.command_lists) {
+            command_list.raw = Extract<u64_le>(payload, offset);
+            offset += sizeof(u64);
+        }
+        record.entries.prefetch_command_list.resize(num_prefetch_commands);
+        for (CommandHeader& command : record.entries.prefetch_command_list) {
+            command.argument = Extract<u32_le>(payload, offset);
+            offset += sizeof(u32);
+        }
+        return record;
+    }
+    }
+
+    LOG_ERROR(HW_GPU, "GPU trace has a malformed record of type {}", header.type);
+    is_valid = false;
+    return std::nullopt;
+}
+
+Player::Player(Core::System& system_)
+    : system{system_}, memory{std::make_unique<Core::Memory::Memory>(system_)} {
+    ASSERT_MSG(!system.GPU().IsAsync(), "GPU traces are replayed with a synchronous GPU");
+
+    page_table.Resize(ReplayAddressSpaceBits, Core::Memory::SUYU_PAGEBITS);
+    memory->SetCurrentPageTable(page_table);
+    memory->SetGPUDirtyManagers(system.GetGPUDirtyMemoryManager());
+    asid = system.Host1x().MemoryManager().RegisterProcess(memory.get());
+}
+
+Player::~Player() {
+    system.Host1x().MemoryManager().UnregisterProcess(asid);
+    auto& kernel_memory = system.Kernel().MemoryManager();
+    for (const Common::PhysicalAddress physical_addr : physical_pages) {
+        kernel_memory.Close(physical_addr, 1);
+    }
+}
+
+bool Player::Play(Reader& reader) {
+    const auto start_time = std::chrono::steady_clock::now();
+    bool is_valid = true;
+    while (is_valid) {
+        auto record = reader.ReadRecord();
+        if (!record) {
+            break;
+        }
+        if (const auto* channel = std::get_if<ChannelRecord>(&*record)) {
+            is_valid = CreateChannel(*channel);
+        } else if (const auto* page = std::get_if<MemoryRecord>(&*record)) {
+            is_valid = WritePage(*page);
+        } else {
+            is_valid = Submit(std::move(std::get<SubmitRecord>(*record)));
+        }
+    }
+    wall_time += std::chrono::steady_clock::now() - start_time;
+    return is_valid && reader.IsOpen();
+}
+
+Player::Statistics Player::GetStatistics() const {
+    Statistics statistics{
+        .submissions = num_submissions,
+        .command_lists = num_command_lists,
+        .pages = physical_pages.size(),
+        .draws = 0,
+        .wall_time = wall_time,
+        .engines = {},
+    };
+    for (const auto& [id, channel] : channels) {
+        statistics.draws += channel->maxwell_3d->draw_manager->GetNumDraws();
+        const auto& engines = channel->dma_pusher->GetStatistics();
+        for (std::size_t index = 0; index < engines.methods.size(); ++index) {
+            statistics.engines.methods[index] += engines.methods[index];
+            statistics.engines.time[index] += engines.time[index];
+        }
+        statistics.engines.state_methods += engines.state_methods;
+    }
+    return statistics;
+}
+
+bool Player::CreateChannel(const ChannelRecord& record) {
+    auto& gpu = system.GPU();
+    auto& address_space = address_spaces[record.address_space];
+    if (!address_space) {
+        address_space = std::make_shared<MemoryManager>(system);
+        gpu.InitAddressSpace(*address_space);
+    }
+
+    // Channels of traces replayed again keep their state from the previous replay.
+    if (const auto it = channels.find(record.channel); it != channels.end()) {
+        if (it->second->memory_manager != address_space) {
+            LOG_ERROR(HW_GPU, "GPU trace moves channel {} to another address space",
+                      record.channel);
+            return false;
+        }
+        return true;
+    }
+
+    auto channel = gpu.AllocateChannel();
+    channel->memory_manager = address_space;
+    gpu.InitChannel(*channel, record.program_id);
+    channel->dma_pusher->SetStatisticsEnabled(true);
+    channels.emplace(record.channel, std::move(channel));
+    return true;
+}
+
+bool Player::WritePage(const MemoryRecord& record) {
+    const auto it = address_spaces.find(record.address_space);
+    if (it == address_spaces.end() || !Common::IsAligned(record.gpu_addr, PageSize)) {
+        LOG_ERROR(HW_GPU, "GPU trace has a page at {:#x} of unknown address space {}",
+                  record.gpu_addr, record.address_space);
+        return false;
+    }
+    MemoryManager& memory_manager = *it->second;
+    if (!mapped_pages.contains(GetPageKey(record.address_space, record.gpu_addr))) {
+        if (!MapPage(memory_manager, record.gpu_addr)) {
+            return false;
+        }
+        mapped_pages.insert(GetPageKey(record.address_space, record.gpu_addr));
+    }
+    memory_manager.WriteBlock(record.gpu_addr, record.data.data(), PageSize);
+    return true;
+}
+
+bool Player::MapPage(MemoryManager& memory_manager, GPUVAddr gpu_addr) {
+    using Kernel::KMemoryManager;
+    const Common::PhysicalAddress physical_addr =
+        system.Kernel().MemoryManager().AllocateAndOpenContinuous(
+            1, 1,
+            KMemoryManager::EncodeOption(KMemoryManager::Pool::Application,
+                                         KMemoryManager::Direction::FromFront));
+    if (physical_addr == 0) {
+        LOG_ERROR(HW_GPU, "Out of memory for the pages of the GPU trace");
+        return false;
+    }
+    physical_pages.push_back(physical_addr);
+
+    // Pages are laid out in the order they are first written, after an unmapped first page.
+    const VAddr virtual_addr = physical_pages.size() * PageSize;
+    memory->MapMemoryRegion(page_table, virtual_addr, PageSize, physical_addr,
+                            Common::MemoryPermission::ReadWrite, false);
+
+    auto& device_memory = system.Host1x().MemoryManager();
+    const DAddr device_addr = device_memory.Allocate(PageSize);
+    device_memory.Map(device_addr, virtual_addr, PageSize, asid);
+    memory_manager.Map(gpu_addr, device_addr, PageSize, PTEKind::PITCH, false);
+    return true;
+}
+
+bool Player::Submit(SubmitRecord&& record) {
+    const auto it = channels.find(record.channel);
+    if (it == channels.end()) {
+        LOG_ERROR(HW_GPU, "GPU trace submits to unknown channel {}", record.channel);
+        return false;
+    }
+    ++num_submissions;
+    num_command_lists += record.entries.command_lists.size();
+    system.GPU().PushGPUEntries(it->second->bind_id, std::move(record.entries));
+    return true;
+}
+
+} // namespace Tegra::Trace
@@ -0,0 +1,171 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "common/page_table.h"
+#include "core/device_memory_manager.h"
+#include "video_core/dma_pusher.h"
+
+namespace Core {
+class System;
+}
+
+namespace Tegra {
+
+namespace Control {
+struct ChannelState;
+}
+
+class MemoryManager;
+
+/**
+ * GPU traces hold the command lists submitted to the GPU channels, along with the contents of the
+ * GPU memory pages holding their pushbuffers, so the command stream can be replayed offline
+ * through the GPU front-end.
+ *
+ * A trace is a header followed by records: the creation of channels, the contents of pages that
+ * changed since they were last recorded, and submissions.
+ */
+namespace Trace {
+
+/// Size of the pages of GPU memory held in traces.
+constexpr u64 PageBits = 12;
+constexpr u64 PageSize = 1ULL << PageBits;
+
+struct ChannelRecord {
+    s32 channel;
+    u32 address_space; ///< Index of the address space of the channel in the trace.
+    u64 program_id;
+};
+
+struct MemoryRecord {
+    u32 address_space;
+    GPUVAddr gpu_addr;
+    std::vector<u8> data;
+};
+
+struct SubmitRecord {
+    s32 channel;
+    CommandList entries;
+};
+
+using Record = std::variant<ChannelRecord, MemoryRecord, SubmitRecord>;
+
+/// Returns the path of a new trace of the given title in the dump directory.
+std::filesystem::path GetTracePath(u64 program_id);
+
+/// Writes the command stream submitted to the GPU to a trace.
+class Recorder {
+public:
+    explicit Recorder(const std::filesystem::path& path);
+    ~Recorder();
+
+    [[nodiscard]] bool IsOpen() const;
+
+    /// Records the creation of a channel, on the address space of its memory manager.
+    void RecordChannel(const Control::ChannelState& channel);
+
+    /// Records the entries submitted to the channel, after the pages of their pushbuffers.
+    void RecordSubmission(s32 channel, const CommandList& entries);
+
+private:
+    struct Channel {
+        u32 address_space;
+        std::shared_ptr<MemoryManager> memory_manager;
+    };
+
+    void RecordPage(const Channel& channel, GPUVAddr page_addr);
+    void WriteRecord(u32 type, std::span<const u8> payload);
+
+    std::mutex mutex;
+    Common::FS::IOFile file;
+    std::unordered_map<s32, Channel> channels;
+    std::unordered_map<size_t, u32> address_spaces; ///< Memory manager ID to address space index.
+    std::unordered_map<u64, u64> page_hashes;       ///< Hashes of the recorded pages.
+    std::vector<u8> page;
+    std::vector<u8> payload;
+    u64 num_records{};
+};
+
+/// Reads the records of a trace in order.
+class Reader {
+public:
+    explicit Reader(const std::filesystem::path& path);
+    ~Reader();
+
+    /// Returns true if the file is a trace this version can read.
+    [[nodiscard]] bool IsOpen() const;
+
+    /// Returns the next record, or nullopt at the end of the trace or if it is malformed, in which
+    /// case the reader is no longer open.
+    [[nodiscard]] std::optional<Record> ReadRecord();
+
+private:
+    Common::FS::IOFile file;
+    u64 file_size{};
+    std::vector<u8> payload;
+    bool is_valid{};
+};
+
+/// Replays traces through the GPU of a system set up for replays, as fast as it can.
+class Player {
+public:
+    /// Index of the puller in the statistics of engines, after the engine types.
+    static constexpr size_t PullerIndex = DmaPusher::PullerStatisticsIndex;
+
+    struct Statistics {
+        u64 submissions;
+        u64 command_lists;
+        u64 pages;
+        u64 draws;
+        std::chrono::nanoseconds wall_time;
+        DmaPusher::Statistics engines;
+    };
+
+    explicit Player(Core::System& system);
+    ~Player();
+
+    /**
+     * Replays every record of the trace. Returns false if the trace is malformed.
+     * A trace can be replayed several times, continuing on the channels of the previous replays.
+     */
+    bool Play(Reader& reader);
+
+    [[nodiscard]] Statistics GetStatistics() const;
+
+private:
+    bool CreateChannel(const ChannelRecord& record);
+    bool WritePage(const MemoryRecord& record);
+    bool MapPage(MemoryManager& memory_manager, GPUVAddr gpu_addr);
+    bool Submit(SubmitRecord&& record);
+
+    Core::System& system;
+    Common::PageTable page_table;
+    std::unique_ptr<Core::Memory::Memory> memory;
+    Core::Asid asid;
+    std::unordered_map<u32, std::shared_ptr<MemoryManager>> address_spaces;
+    std::unordered_map<s32, std::shared_ptr<Control::ChannelState>> channels;
+    std::unordered_set<u64> mapped_pages; ///< Address space index and GPU page of mapped pages.
+    std::vector<Common::PhysicalAddress> physical_pages; ///< Kernel memory backing the pages.
+    u64 num_submissions{};
+    u64 num_command_lists{};
+    std::chrono::nanoseconds wall_time{};
+};
+
+} // namespace Trace
+
+} // namespace Tegra
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2020 yuzu Emulator Project & 2024 suyu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
 #include <cstring>
 #include <fstream>
 #include <optional>
@@ -18,9 +19,12 @@
 #include "video_core/macro/macro.h"
 #include "video_core/macro/macro_hle.h"
 #include "video_core/macro/macro_interpreter.h"
+#include "video_core/macro/macro_profiler.h"
 
 #ifdef ARCHITECTURE_x86_64
 #include "video_core/macro/macro_jit_x64.h"
+#elif defined(ARCHITECTURE_arm64) && defined(SUYU_ARM64_MACRO_JIT)
+#include "video_core/macro/macro_jit_arm64.h"
 #endif
 
 MICROPROFILE_DEFINE(MacroHLE, "GPU", "Execute macro HLE", MP_RGB(128, 192, 192));
@@ -69,6 +73,33 @@ void MacroEngine::ClearCode(u32 method) {
 }
 
 void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
+    if (profiler) [[unlikely]] {
+        ExecuteProfiled(method, parameters);
+        return;
+    }
+    ExecuteImpl(method, parameters);
+}
+
+void MacroEngine::ExecuteProfiled(u32 method, const std::vector<u32>& parameters) {
+    MacroProfiler::Sample sample;
+    maxwell3d.macro_sample = &sample;
+    const auto start_time = std::chrono::steady_clock::now();
+    ExecuteImpl(method, parameters);
+    const auto time = std::chrono::steady_clock::now() - start_time;
+    maxwell3d.macro_sample = nullptr;
+
+    const auto cache_info = macro_cache.find(method);
+    if (cache_info == macro_cache.end()) {
+        // The macro was never uploaded
+        return;
+    }
+    const auto code = uploaded_macro_code.find(method);
+    const std::size_t code_size = code != uploaded_macro_code.end() ? code->second.size() : 0;
+    profiler->Record(cache_info->second.hash, code_size, cache_info->second.has_hle_program,
+                     parameters.size(), sample, time);
+}
+
+void MacroEngine::ExecuteImpl(u32 method, const std::vector<u32>& parameters) {
     auto compiled_macro = macro_cache.find(method);
     if (compiled_macro != macro_cache.end()) {
         const auto& cache_info = compiled_macro->second;
@@ -134,6 +165,11 @@ std::unique_ptr<MacroEngine> GetMacroEngine(Engines::Maxwell3D& maxwell3d) {
     }
 #ifdef ARCHITECTURE_x86_64
     return std::make_unique<MacroJITx64>(maxwell3d);
+#elif defined(ARCHITECTURE_arm64) && defined(SUYU_ARM64_MACRO_JIT)
+    if (Settings::values.enable_arm64_macro_jit) {
+        return std::make_unique<MacroJITArm64>(maxwell3d);
+    }
+    return std::make_unique<MacroInterpreter>(maxwell3d);
 #else
     return std::make_unique<MacroInterpreter>(maxwell3d);
 #endif
@@ -96,6 +96,7 @@ union MethodAddress {
 } // namespace Macro
 
 class HLEMacro;
+class MacroProfiler;
 
 class CachedMacro {
 public:
@@ -123,10 +124,18 @@ public:
     // Compiles the macro if its not in the cache, and executes the compiled macro
     void Execute(u32 method, const std::vector<u32>& parameters);
 
+    // Records every macro call in the profiler, profiling stops when it's null
+    void SetProfiler(MacroProfiler* profiler_) {
+        profiler = profiler_;
+    }
+
 protected:
     virtual std::unique_ptr<CachedMacro> Compile(const std::vector<u32>& code) = 0;
 
 private:
+    void ExecuteImpl(u32 method, const std::vector<u32>& parameters);
+    void ExecuteProfiled(u32 method, const std::vector<u32>& parameters);
+
     struct CacheInfo {
         std::unique_ptr<CachedMacro> lle_program{};
         std::unique_ptr<CachedMacro> hle_program{};
@@ -137,6 +146,7 @@ private:
     std::unordered_map<u32, CacheInfo> macro_cache;
     std::unordered_map<u32, std::vector<u32>> uploaded_macro_code;
     std::unique_ptr<HLEMacro> hle_macros;
+    MacroProfiler* profiler{};
     Engines::Maxwell3D& maxwell3d;
 };
 
@@ -0,0 +1,543 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <oaknut/code_block.hpp>
+#include <oaknut/oaknut.hpp>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/macro/macro_jit_arm64.h"
+
+MICROPROFILE_DEFINE(MacroJitCompile, "GPU", "Compile macro JIT", MP_RGB(173, 255, 47));
+MICROPROFILE_DEFINE(MacroJitExecute, "GPU", "Execute macro JIT", MP_RGB(255, 255, 0));
+
+namespace Tegra {
+namespace {
+using namespace oaknut::util;
+
+// The JIT state lives in callee-saved registers, so calls into the emulator don't clobber it.
+constexpr oaknut::XReg STATE = X19;
+constexpr oaknut::XReg PARAMETERS = X20;
+constexpr oaknut::XReg MAX_PARAMETER = X21;
+constexpr oaknut::WReg METHOD_ADDRESS = W22;
+constexpr oaknut::XReg BRANCH_HOLDER = X23;
+constexpr oaknut::WReg RESULT = W24;
+
+// Upper bound of host instructions emitted for a single macro instruction, the longest being a
+// parameter fetch followed by a send.
+constexpr size_t MAX_INSTRUCTIONS_PER_OPCODE = 64;
+// Prologue, epilogue and the delayed branch stub.
+constexpr size_t MAX_EXTRA_INSTRUCTIONS = 64;
+
+class MacroJITArm64Impl final : public CachedMacro {
+public:
+    explicit MacroJITArm64Impl(Engines::Maxwell3D& maxwell3d_, const std::vector<u32>& code_)
+        : code{code_}, maxwell3d{maxwell3d_},
+          code_block{(code_.size() * MAX_INSTRUCTIONS_PER_OPCODE + MAX_EXTRA_INSTRUCTIONS) *
+                     sizeof(u32)},
+          c{code_block.ptr()} {
+        Compile();
+    }
+
+    void Execute(const std::vector<u32>& parameters, u32 method) override;
+
+    void Compile_ALU(Macro::Opcode opcode);
+    void Compile_AddImmediate(Macro::Opcode opcode);
+    void Compile_ExtractInsert(Macro::Opcode opcode);
+    void Compile_ExtractShiftLeftImmediate(Macro::Opcode opcode);
+    void Compile_ExtractShiftLeftRegister(Macro::Opcode opcode);
+    void Compile_Read(Macro::Opcode opcode);
+    void Compile_Branch(Macro::Opcode opcode);
+
+private:
+    void Optimizer_ScanFlags();
+
+    void Compile();
+    void Compile_NextInstruction();
+
+    oaknut::WReg Compile_FetchParameter(oaknut::WReg dst);
+    oaknut::WReg Compile_GetRegister(u32 index, oaknut::WReg dst);
+    void Compile_SetRegister(u32 index, oaknut::WReg src);
+    void Compile_AddConstant(oaknut::WReg dst, oaknut::WReg src, s32 value);
+
+    void Compile_ProcessResult(Macro::ResultOperation operation, u32 reg);
+    void Compile_Send(oaknut::WReg value);
+
+    Macro::Opcode GetOpCode() const;
+
+    struct JITState {
+        Engines::Maxwell3D* maxwell3d{};
+        const u32* maxwell3d_regs{};
+        std::array<u32, Macro::NUM_MACRO_REGISTERS> registers{};
+        u32 carry_flag{};
+    };
+    using ProgramType = void (*)(JITState*, const u32*, const u32*);
+
+    static constexpr u32 RegisterOffset(u32 index) {
+        return static_cast<u32>(offsetof(JITState, registers) + index * sizeof(u32));
+    }
+
+    struct OptimizerState {
+        bool can_skip_carry{};
+    };
+    OptimizerState optimizer{};
+
+    ProgramType program{nullptr};
+
+    /// Label of every instruction, followed by the end of the code.
+    std::vector<oaknut::Label> labels;
+    /// Whether the instruction may run in the delay slot of the previous one.
+    std::vector<bool> is_delay_slot;
+    oaknut::Label take_delayed_branch{};
+
+    u32 pc{};
+
+    const std::vector<u32>& code;
+    Engines::Maxwell3D& maxwell3d;
+
+    oaknut::CodeBlock code_block;
+    oaknut::CodeGenerator c;
+};
+
+void MacroJITArm64Impl::Execute(const std::vector<u32>& parameters, u32 method) {
+    MICROPROFILE_SCOPE(MacroJitExecute);
+    ASSERT_OR_EXECUTE(program != nullptr, { return; });
+    JITState state{};
+    state.maxwell3d = &maxwell3d;
+    state.maxwell3d_regs = maxwell3d.regs.reg_array.data();
+    program(&state, parameters.data(), parameters.data() + parameters.size());
+}
+
+void MacroJITArm64Impl::Compile_ALU(Macro::Opcode opcode) {
+    // Sources are zero extended to 64 bits, so the carry of additions is bit 32 of the wide result
+    // and the carry of subtractions is the inverted sign of the wide result.
+    const auto src_a = Compile_GetRegister(opcode.src_a, W0);
+    const auto src_b = Compile_GetRegister(opcode.src_b, W1);
+    const auto store_carry = [this](int shift, bool invert) {
+        c.LSR(X2, X2, shift);
+        if (invert) {
+            c.EOR(W2, W2, 1);
+        }
+        c.STR(W2, STATE, offsetof(JITState, carry_flag));
+    };
+
+    switch (opcode.alu_operation) {
+    case Macro::ALUOperation::Add:
+        if (optimizer.can_skip_carry) {
+            c.ADD(RESULT, src_a, src_b);
+        } else {
+            c.ADD(X2, X0, X1);
+            c.MOV(RESULT, W2);
+            store_carry(32, false);
+        }
+        break;
+    case Macro::ALUOperation::AddWithCarry:
+        c.LDR(W3, STATE, offsetof(JITState, carry_flag));
+        c.ADD(X2, X0, X1);
+        c.ADD(X2, X2, X3);
+        c.MOV(RESULT, W2);
+        store_carry(32, false);
+        break;
+    case Macro::ALUOperation::Subtract:
+        if (optimizer.can_skip_carry) {
+            c.SUB(RESULT, src_a, src_b);
+        } else {
+            c.SUB(X2, X0, X1);
+            c.MOV(RESULT, W2);
+            store_carry(63, true);
+        }
+        break;
+    case Macro::ALUOperation::SubtractWithBorrow:
+        c.LDR(W3, STATE, offsetof(JITState, carry_flag));
+        c.SUB(X2, X0, X1);
+        c.ADD(X2, X2, X3);
+        c.SUB(X2, X2, 1);
+        c.MOV(RESULT, W2);
+        store_carry(63, true);
+        break;
+    case Macro::ALUOperation::Xor:
+        c.EOR(RESULT, src_a, src_b);
+        break;
+    case Macro::ALUOperation::Or:
+        c.ORR(RESULT, src_a, src_b);
+        break;
+    case Macro::ALUOperation::And:
+        c.AND(RESULT, src_a, src_b);
+        break;
+    case Macro::ALUOperation::AndNot:
+        c.BIC(RESULT, src_a, src_b);
+        break;
+    case Macro::ALUOperation::Nand:
+        c.AND(RESULT, src_a, src_b);
+        c.MVN(RESULT, RESULT);
+        break;
+    default:
+        UNIMPLEMENTED_MSG("Unimplemented ALU operation {}", opcode.alu_operation.Value());
+        c.MOV(RESULT, WZR);
+        break;
+    }
+    Compile_ProcessResult(opcode.result_operation, opcode.dst);
+}
+
+void MacroJITArm64Impl::Compile_AddImmediate(Macro::Opcode opcode) {
+    const auto src = Compile_GetRegister(opcode.src_a, RESULT);
+    Compile_AddConstant(RESULT, src, opcode.immediate);
+    Compile_ProcessResult(opcode.result_operation, opcode.dst);
+}
+
+void MacroJITArm64Impl::Compile_ExtractInsert(Macro::Opcode opcode) {
+    const u32 size = opcode.bf_size;
+    const u32 src_bit = opcode.bf_src_bit;
+    const u32 dst_bit = opcode.bf_dst_bit;
+    const auto dst = Compile_GetRegister(opcode.src_a, RESULT);
+    const auto src = Compile_GetRegister(opcode.src_b, W1);
+
+    if (size == 0) {
+        // An empty bitfield leaves the destination untouched.
+    } else if (src_bit + size <= 32 && dst_bit + size <= 32) {
+        c.UBFX(src, src, src_bit, size);
+        c.BFI(dst, src, dst_bit, size);
+    } else {
+        // Fields crossing the top of the register are truncated like the interpreter does.
+        const u32 mask = opcode.GetBitfieldMask();
+        c.LSR(src, src, src_bit);
+        c.MOV(W2, mask);
+        c.AND(src, src, W2);
+        c.LSL(src, src, dst_bit);
+        c.MOV(W2, ~(mask << dst_bit));
+        c.AND(dst, dst, W2);
+        c.ORR(dst, dst, src);
+    }
+    Compile_ProcessResult(opcode.result_operation, opcode.dst);
+}
+
+void MacroJITArm64Impl::Compile_ExtractShiftLeftImmediate(Macro::Opcode opcode) {
+    const u32 size = opcode.bf_size;
+    const u32 dst_bit = opcode.bf_dst_bit;
+    const auto shift = Compile_GetRegister(opcode.src_a, W0);
+    const auto src = Compile_GetRegister(opcode.src_b, W1);
+
+    if (size == 0) {
+        c.MOV(RESULT, WZR);
+    } else {
+        c.LSRV(src, src, shift);
+        if (dst_bit + size <= 32) {
+            c.UBFIZ(RESULT, src, dst_bit, size);
+        } else {
+            c.MOV(W2, opcode.GetBitfieldMask());
+            c.AND(src, src, W2);
+            c.LSL(RESULT, src, dst_bit);
+        }
+    }
+    Compile_ProcessResult(opcode.result_operation, opcode.dst);
+}
+
+void MacroJITArm64Impl::Compile_ExtractShiftLeftRegister(Macro::Opcode opcode) {
+    const u32 size = opcode.bf_size;
+    const u32 src_bit = opcode.bf_src_bit;
+    const auto shift = Compile_GetRegister(opcode.src_a, W0);
+    const auto src = Compile_GetRegister(opcode.src_b, W1);
+
+    if (size == 0) {
+        c.MOV(RESULT, WZR);
+    } else {
+        if (src_bit + size <= 32) {
+            c.UBFX(src, src, src_bit, size);
+        } else {
+            c.LSR(src, src, src_bit);
+            c.MOV(W2, opcode.GetBitfieldMask());
+            c.AND(src, src, W2);
+        }
+        c.LSLV(RESULT, src, shift);
+    }
+    Compile_ProcessResult(opcode.result_operation, opcode.dst);
+}
+
+void MacroJITArm64Impl::Compile_Read(Macro::Opcode opcode) {
+    // Equivalent to Engines::Maxwell3D::GetRegisterValue
+    const auto src = Compile_GetRegister(opcode.src_a, W0);
+    Compile_AddConstant(W0, src, opcode.immediate);
+    c.LDR(X1, STATE, offsetof(JITState, maxwell3d_regs));
+    c.LSL(X0, X0, 2);
+    c.ADD(X1, X1, X0);
+    c.LDR(RESULT, X1, 0);
+    Compile_ProcessResult(opcode.result_operation, opcode.dst);
+}
+
+void Send(Engines::Maxwell3D* maxwell3d, Macro::MethodAddress method_address, u32 value) {
+    maxwell3d->CallMethod(method_address.address, value, true);
+}
+
+void MacroJITArm64Impl::Compile_Send(oaknut::WReg value) {
+    c.MOV(W2, value);
+    c.MOV(W1, METHOD_ADDRESS);
+    c.LDR(X0, STATE, offsetof(JITState, maxwell3d));
+    c.MOV(X16, reinterpret_cast<u64>(&Send));
+    c.BLR(X16);
+
+    // Increment the method address by the method increment, keeping the increment.
+    c.UBFX(W0, METHOD_ADDRESS, 12, 6);
+    c.ADD(W0, METHOD_ADDRESS, W0);
+    c.BFI(METHOD_ADDRESS, W0, 0, 12);
+}
+
+void MacroJITArm64Impl::Compile_Branch(Macro::Opcode opcode) {
+    ASSERT_MSG(!is_delay_slot[pc], "Executing a branch in a delay slot is not valid");
+    const s32 jump_address =
+        static_cast<s32>(pc) + static_cast<s32>(opcode.GetBranchTarget() / sizeof(s32));
+    const bool is_valid_target =
+        jump_address >= 0 && static_cast<size_t>(jump_address) < code.size();
+    ASSERT_MSG(is_valid_target, "Macro branch target {} is out of bounds", jump_address);
+    oaknut::Label& target = is_valid_target ? labels[jump_address] : labels.back();
+
+    oaknut::Label not_taken;
+    const auto value = Compile_GetRegister(opcode.src_a, W0);
+    switch (opcode.branch_condition) {
+    case Macro::BranchCondition::Zero:
+        c.CBNZ(value, not_taken);
+        break;
+    case Macro::BranchCondition::NotZero:
+        c.CBZ(value, not_taken);
+        break;
+    }
+
+    if (opcode.branch_annul) {
+        c.B(target);
+    } else {
+        // Run the delay slot first, it takes the branch held in BRANCH_HOLDER.
+        c.ADR(BRANCH_HOLDER, target);
+        c.B(labels[pc + 1]);
+    }
+
+    c.l(not_taken);
+}
+
+void MacroJITArm64Impl::Optimizer_ScanFlags() {
+    optimizer.can_skip_carry = true;
+    is_delay_slot.assign(code.size() + 1, false);
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Macro::Opcode op{code[i]};
+
+        if (op.operation == Macro::Operation::ALU) {
+            // Carry handling is only emitted when an operation of the macro consumes it
+            if (op.alu_operation == Macro::ALUOperation::AddWithCarry ||
+                op.alu_operation == Macro::ALUOperation::SubtractWithBorrow) {
+                optimizer.can_skip_carry = false;
+            }
+        }
+
+        // Exits and branches without the annul bit execute the next instruction before leaving
+        const bool is_delayed_branch =
+            op.operation == Macro::Operation::Branch && !op.branch_annul;
+        if (op.is_exit || is_delayed_branch) {
+            is_delay_slot[i + 1] = true;
+        }
+    }
+}
+
+void MacroJITArm64Impl::Compile() {
+    MICROPROFILE_SCOPE(MacroJitCompile);
+    labels.resize(code.size() + 1);
+    Optimizer_ScanFlags();
+
+    code_block.unprotect();
+
+    c.STP(X29, X30, SP, PRE_INDEXED, -64);
+    c.MOV(X29, SP);
+    c.STP(X19, X20, SP, 16);
+    c.STP(X21, X22, SP, 32);
+    c.STP(X23, X24, SP, 48);
+
+    // JIT state
+    c.MOV(STATE, X0);
+    c.MOV(PARAMETERS, X1);
+    c.MOV(MAX_PARAMETER, X2);
+    c.MOV(RESULT, WZR);
+    c.MOV(METHOD_ADDRESS, WZR);
+    c.MOV(BRANCH_HOLDER, XZR);
+
+    Compile_SetRegister(1, Compile_FetchParameter(W0));
+
+    for (pc = 0; pc < code.size(); ++pc) {
+        Compile_NextInstruction();
+    }
+
+    // End of code
+    c.l(labels.back());
+    c.LDP(X23, X24, SP, 48);
+    c.LDP(X21, X22, SP, 32);
+    c.LDP(X19, X20, SP, 16);
+    c.LDP(X29, X30, SP, POST_INDEXED, 64);
+    c.RET();
+
+    c.l(take_delayed_branch);
+    c.MOV(X0, BRANCH_HOLDER);
+    c.MOV(BRANCH_HOLDER, XZR);
+    c.BR(X0);
+
+    code_block.protect();
+    code_block.invalidate_all();
+    program = reinterpret_cast<ProgramType>(code_block.ptr());
+}
+
+void MacroJITArm64Impl::Compile_NextInstruction() {
+    const auto opcode = GetOpCode();
+    c.l(labels[pc]);
+
+    switch (opcode.operation) {
+    case Macro::Operation::ALU:
+        Compile_ALU(opcode);
+        break;
+    case Macro::Operation::AddImmediate:
+        Compile_AddImmediate(opcode);
+        break;
+    case Macro::Operation::ExtractInsert:
+        Compile_ExtractInsert(opcode);
+        break;
+    case Macro::Operation::ExtractShiftLeftImmediate:
+        Compile_ExtractShiftLeftImmediate(opcode);
+        break;
+    case Macro::Operation::ExtractShiftLeftRegister:
+        Compile_ExtractShiftLeftRegister(opcode);
+        break;
+    case Macro::Operation::Read:
+        Compile_Read(opcode);
+        break;
+    case Macro::Operation::Branch:
+        Compile_Branch(opcode);
+        break;
+    default:
+        UNIMPLEMENTED_MSG("Unimplemented opcode {}", opcode.operation.Value());
+        break;
+    }
+
+    if (is_delay_slot[pc]) {
+        // Take the branch, or the exit, of the previous instruction
+        c.CBNZ(BRANCH_HOLDER, take_delayed_branch);
+    }
+    if (opcode.is_exit) {
+        // Exit after running the delay slot. Exits within a delay slot are ignored.
+        c.ADR(BRANCH_HOLDER, labels.back());
+    }
+}
+
+static void WarnInvalidParameter(uintptr_t parameter, uintptr_t max_parameter) {
+    LOG_CRITICAL(HW_GPU,
+                 "Macro JIT: invalid parameter access 0x{:x} (0x{:x} is the last parameter)",
+                 parameter, max_parameter - sizeof(u32));
+}
+
+oaknut::WReg MacroJITArm64Impl::Compile_FetchParameter(oaknut::WReg dst) {
+    oaknut::Label parameter_ok;
+    oaknut::Label end;
+    c.SUB(X0, MAX_PARAMETER, PARAMETERS);
+    c.CBNZ(X0, parameter_ok);
+    c.MOV(X0, PARAMETERS);
+    c.MOV(X1, MAX_PARAMETER);
+    c.MOV(X16, reinterpret_cast<u64>(&WarnInvalidParameter));
+    c.BLR(X16);
+    c.MOV(dst, WZR);
+    c.B(end);
+    c.l(parameter_ok);
+    c.LDR(dst, PARAMETERS, POST_INDEXED, sizeof(u32));
+    c.l(end);
+    return dst;
+}
+
+oaknut::WReg MacroJITArm64Impl::Compile_GetRegister(u32 index, oaknut::WReg dst) {
+    if (index == 0) {
+        // Register 0 is always zero
+        c.MOV(dst, WZR);
+    } else {
+        c.LDR(dst, STATE, RegisterOffset(index));
+    }
+    return dst;
+}
+
+void MacroJITArm64Impl::Compile_SetRegister(u32 index, oaknut::WReg src) {
+    // Register 0 is supposed to always return 0. NOP is implemented as a store to the zero
+    // register.
+    if (index == 0) {
+        return;
+    }
+    c.STR(src, STATE, RegisterOffset(index));
+}
+
+void MacroJITArm64Impl::Compile_AddConstant(oaknut::WReg dst, oaknut::WReg src, s32 value) {
+    if (value >= 0 && value < 0x1000) {
+        c.ADD(dst, src, static_cast<u32>(value));
+    } else if (value < 0 && value > -0x1000) {
+        c.SUB(dst, src, static_cast<u32>(-value));
+    } else {
+        c.MOV(W2, static_cast<u32>(value));
+        c.ADD(dst, src, W2);
+    }
+}
+
+void MacroJITArm64Impl::Compile_ProcessResult(Macro::ResultOperation operation, u32 reg) {
+    const auto SetMethodAddress = [this](oaknut::WReg src) { c.MOV(METHOD_ADDRESS, src); };
+
+    switch (operation) {
+    case Macro::ResultOperation::IgnoreAndFetch:
+        Compile_SetRegister(reg, Compile_FetchParameter(W0));
+        break;
+    case Macro::ResultOperation::Move:
+        Compile_SetRegister(reg, RESULT);
+        break;
+    case Macro::ResultOperation::MoveAndSetMethod:
+        Compile_SetRegister(reg, RESULT);
+        SetMethodAddress(RESULT);
+        break;
+    case Macro::ResultOperation::FetchAndSend:
+        // Fetch parameter and send result.
+        Compile_SetRegister(reg, Compile_FetchParameter(W0));
+        Compile_Send(RESULT);
+        break;
+    case Macro::ResultOperation::MoveAndSend:
+        // Move and send result.
+        Compile_SetRegister(reg, RESULT);
+        Compile_Send(RESULT);
+        break;
+    case Macro::ResultOperation::FetchAndSetMethod:
+        // Fetch parameter and use result as Method Address.
+        Compile_SetRegister(reg, Compile_FetchParameter(W0));
+        SetMethodAddress(RESULT);
+        break;
+    case Macro::ResultOperation::MoveAndSetMethodFetchAndSend:
+        // Move result and use as Method Address, then fetch and send parameter.
+        Compile_SetRegister(reg, RESULT);
+        SetMethodAddress(RESULT);
+        Compile_Send(Compile_FetchParameter(W2));
+        break;
+    case Macro::ResultOperation::MoveAndSetMethodSend:
+        // Move result and use as Method Address, then send bits 12:17 of result.
+        Compile_SetRegister(reg, RESULT);
+        SetMethodAddress(RESULT);
+        c.UBFX(W2, RESULT, 12, 6);
+        Compile_Send(W2);
+        break;
+    default:
+        UNIMPLEMENTED_MSG("Unimplemented macro operation {}", operation);
+        break;
+    }
+}
+
+Macro::Opcode MacroJITArm64Impl::GetOpCode() const {
+    ASSERT(pc < code.size());
+    return {code[pc]};
+}
+} // Anonymous namespace
+
+MacroJITArm64::MacroJITArm64(Engines::Maxwell3D& maxwell3d_)
+    : MacroEngine{maxwell3d_}, maxwell3d{maxwell3d_} {}
+
+std::unique_ptr<CachedMacro> MacroJITArm64::Compile(const std::vector<u32>& code) {
+    return std::make_unique<MacroJITArm64Impl>(maxwell3d, code);
+}
+} // namespace Tegra
@@ -0,0 +1,172 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <iterator>
+
+#include <fmt/format.h>
+
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/macro/macro_profiler.h"
+
+namespace Tegra {
+namespace {
+static_assert(MacroProfiler::NUM_METHODS == Engines::Maxwell3D::Regs::NUM_REGS);
+
+// Number of macros listed as HLE candidates.
+constexpr std::size_t MAX_CANDIDATES = 10;
+// Number of register ranges listed for every candidate.
+constexpr std::size_t MAX_REGISTER_RANGES = 12;
+
+double ToMilliseconds(std::chrono::nanoseconds time) {
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+double ToMicroseconds(std::chrono::nanoseconds time, u64 count) {
+    return count ? std::chrono::duration<double, std::micro>(time).count() /
+                       static_cast<double>(count)
+                 : 0.0;
+}
+
+double PerCall(u64 value, u64 count) {
+    return count ? static_cast<double>(value) / static_cast<double>(count) : 0.0;
+}
+
+/// Formats the written registers as ranges of consecutive registers.
+std::string FormatRegisters(const std::bitset<MacroProfiler::NUM_METHODS>& written) {
+    std::string out;
+    std::size_t num_ranges = 0;
+    for (std::size_t method = 0; method < written.size(); ++method) {
+        if (!written[method]) {
+            continue;
+        }
+        std::size_t last = method;
+        while (last + 1 < written.size() && written[last + 1]) {
+            ++last;
+        }
+        if (num_ranges++ == MAX_REGISTER_RANGES) {
+            out += " ...";
+            break;
+        }
+        if (last == method) {
+            fmt::format_to(std::back_inserter(out), " {:#x}", method);
+        } else {
+            fmt::format_to(std::back_inserter(out), " {:#x}-{:#x}", method, last);
+        }
+        method = last;
+    }
+    return out.empty() ? " none" : out;
+}
+} // Anonymous namespace
+
+void MacroProfiler::Record(u64 hash, std::size_t code_size, bool has_hle,
+                           std::size_t num_parameters, const Sample& sample,
+                           std::chrono::nanoseconds time) {
+    std::scoped_lock lock{mutex};
+    Entry& entry = entries[hash];
+    entry.hash = hash;
+    entry.code_size = code_size;
+    entry.has_hle = has_hle;
+    ++entry.invocations;
+    entry.parameters += num_parameters;
+    entry.methods += sample.methods;
+    entry.time += time;
+    entry.side_effect_time += sample.side_effect_time;
+    entry.written |= sample.written;
+}
+
+std::vector<MacroProfiler::Entry> MacroProfiler::GetEntries() const {
+    std::vector<Entry> result;
+    {
+        std::scoped_lock lock{mutex};
+        result.reserve(entries.size());
+        for (const auto& [hash, entry] : entries) {
+            result.push_back(entry);
+        }
+    }
+    std::ranges::sort(result, std::greater{}, &Entry::time);
+    return result;
+}
+
+std::string MacroProfiler::GetReport() const {
+    const std::vector<Entry> profile = GetEntries();
+
+    u64 invocations = 0;
+    std::chrono::nanoseconds time{};
+    for (const Entry& entry : profile) {
+        invocations += entry.invocations;
+        time += entry.time;
+    }
+
+    std::string out;
+    auto it = std::back_inserter(out);
+    fmt::format_to(it, "Macro profile: {} macros, {} calls, {:.3f} ms\n", profile.size(),
+                   invocations, ToMilliseconds(time));
+    fmt::format_to(it, "  {:<16} {:>4} {:>6} {:>10} {:>11} {:>12} {:>11} {:>10}\n", "hash", "mode",
+                   "size", "calls", "params/call", "methods/call", "total ms", "us/call");
+    for (const Entry& entry : profile) {
+        fmt::format_to(it, "  {:016x} {:>4} {:>6} {:>10} {:>11.1f} {:>12.1f} {:>11.3f} {:>10.3f}\n",
+                       entry.hash, entry.has_hle ? "hle" : "lle", entry.code_size,
+                       entry.invocations, PerCall(entry.parameters, entry.invocations),
+                       PerCall(entry.methods, entry.invocations), ToMilliseconds(entry.time),
+                       ToMicroseconds(entry.time, entry.invocations));
+    }
+
+    std::vector<const Entry*> candidates;
+    for (const Entry& entry : profile) {
+        if (entry.PotentialSavings().count() > 0) {
+            candidates.push_back(&entry);
+        }
+    }
+    std::ranges::sort(candidates, std::greater{},
+                      [](const Entry* entry) { return entry->PotentialSavings(); });
+    if (candidates.size() > MAX_CANDIDATES) {
+        candidates.resize(MAX_CANDIDATES);
+    }
+
+    out += "\nHLE candidates, by time spent running the macro outside of its side effects:\n";
+    if (candidates.empty()) {
+        out += "  none\n";
+    }
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        const Entry& entry = *candidates[i];
+        const std::chrono::nanoseconds savings = entry.PotentialSavings();
+        fmt::format_to(it, "  {:>2}. {:016x}: {:.3f} ms ({:.1f}% of macro time), {} calls, "
+                       "{:.1f} methods/call\n",
+                       i + 1, entry.hash, ToMilliseconds(savings),
+                       time.count() ? 100.0 * ToMilliseconds(savings) / ToMilliseconds(time) : 0.0,
+                       entry.invocations, PerCall(entry.methods, entry.invocations));
+        fmt::format_to(it, "      writes{}\n", FormatRegisters(entry.written));
+    }
+    return out;
+}
+
+void MacroProfiler::Dump(u64 program_id) const {
+    const auto base_dir{Common::FS::GetSuyuPath(Common::FS::SuyuPath::DumpDir)};
+    const auto macro_dir{base_dir / "macros"};
+    if (!Common::FS::CreateDir(base_dir) || !Common::FS::CreateDir(macro_dir)) {
+        LOG_ERROR(Common_Filesystem, "Failed to create macro dump directories");
+        return;
+    }
+    const auto path{macro_dir / fmt::format("profile_{:016X}.txt", program_id)};
+    const std::string report = GetReport();
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write,
+                            Common::FS::FileType::TextFile};
+    if (file.WriteString(report) != report.size()) {
+        LOG_ERROR(Common_Filesystem, "Failed to write the macro profile to {}",
+                  Common::FS::PathToUTF8String(path));
+        return;
+    }
+    LOG_INFO(HW_GPU, "Macro profile written to {}", Common::FS::PathToUTF8String(path));
+}
+
+void MacroProfiler::Reset() {
+    std::scoped_lock lock{mutex};
+    entries.clear();
+}
+
+} // namespace Tegra
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <bitset>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Tegra {
+
+/**
+ * Gathers how often and how long every macro runs, keyed by the hash of its code, to find the
+ * macros worth replacing with an HLE implementation.
+ */
+class MacroProfiler {
+public:
+    /// Number of Maxwell3D registers a macro can write.
+    static constexpr std::size_t NUM_METHODS = 0xE00;
+
+    /// Methods emitted by a single macro call.
+    struct Sample {
+        void Record(u32 method) {
+            ++methods;
+            if (method < NUM_METHODS) {
+                written.set(method);
+            }
+        }
+
+        u64 methods{};
+        std::bitset<NUM_METHODS> written;
+        /// Time spent in the side effects of the emitted methods, such as draws.
+        std::chrono::nanoseconds side_effect_time{};
+    };
+
+    struct Entry {
+        u64 hash{};
+        std::size_t code_size{};
+        bool has_hle{};
+        u64 invocations{};
+        u64 parameters{};
+        u64 methods{};
+        std::chrono::nanoseconds time{};
+        std::chrono::nanoseconds side_effect_time{};
+        std::bitset<NUM_METHODS> written;
+
+        /// Time an HLE implementation could save, the side effects have to run regardless.
+        [[nodiscard]] std::chrono::nanoseconds PotentialSavings() const {
+            return has_hle ? std::chrono::nanoseconds{} : time - side_effect_time;
+        }
+    };
+
+    /// Records a macro call that took the given time.
+    void Record(u64 hash, std::size_t code_size, bool has_hle, std::size_t num_parameters,
+                const Sample& sample, std::chrono::nanoseconds time);
+
+    /// Returns the profiled macros, the most time consuming first.
+    [[nodiscard]] std::vector<Entry> GetEntries() const;
+
+    /// Returns a report of the profiled macros, ranking the macros worth implementing in HLE.
+    [[nodiscard]] std::string GetReport() const;
+
+    /// Writes the report to the macro dump directory.
+    void Dump(u64 program_id) const;
+
+    /// Discards the gathered profile.
+    void Reset();
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<u64, Entry> entries;
+};
+
+} // namespace Tegra
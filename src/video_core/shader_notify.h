@@ -11,6 +11,16 @@ class ShaderNotify {
 public:
     [[nodiscard]] int ShadersBuilding() noexcept;
 
+    /// Returns the number of shaders that started building since the counters were created.
+    [[nodiscard]] int ShadersQueued() const noexcept {
+        return num_building.load(std::memory_order::relaxed);
+    }
+
+    /// Returns the number of shaders that finished building since the counters were created.
+    [[nodiscard]] int ShadersCompleted() const noexcept {
+        return num_complete.load(std::memory_order::relaxed);
+    }
+
     void MarkShaderComplete() noexcept {
         ++num_complete;
     }
@@ -22,7 +22,7 @@
 #include "common/polyfill_ranges.h"
 #include "common/scratch_buffer.h"
 #include "common/slot_vector.h"
-#include "common/thread_worker.h"
+#include "common/task_scheduler.h"
 #include "video_core/compatible_formats.h"
 #include "video_core/control/channel_state_cache.h"
 #include "video_core/delayed_destruction_ring.h"
@@ -489,7 +489,7 @@ private:
     u64 modification_tick = 0;
     u64 frame_tick = 0;
 
-    Common::ThreadWorker texture_decode_worker{1, "TextureDecoder"};
+    Common::TaskQueue texture_decode_worker{Common::TaskPriority::TextureTranscode, 1};
     std::vector<std::unique_ptr<AsyncDecodeContext>> async_decodes;
 
     // Join caching
@@ -1,13 +1,17 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <thread>
+
 #include "video_core/textures/workers.h"
 
 namespace Tegra::Texture {
 
-Common::ThreadWorker& GetThreadWorkers() {
-    static Common::ThreadWorker workers{std::max(std::thread::hardware_concurrency(), 2U) / 2,
-                                        "ImageTranscode"};
+Common::TaskQueue& GetThreadWorkers() {
+    // Callers block until their decodes complete, so these always preempt background work.
+    static Common::TaskQueue workers{Common::TaskPriority::FrameCritical,
+                                     std::max(std::thread::hardware_concurrency(), 2U) / 2};
 
     return workers;
 }